@@ -1,7 +1,15 @@
 #include "ai_agent.h"
+#include "ai_scheduler.h"
+#include "game_logic.h"
+#include "game_actions.h"
+#include "heuristic_policy.h"
+#include "game_store.h"
+#include "json_reader.h"
+#include "json_writer.h"
 #include "sse_handler.h"
 #include <sstream>
 #include <random>
+#include <algorithm>
 
 namespace catan {
 namespace ai {
@@ -214,38 +222,40 @@ AIGameState getAIGameState(const Game& game, int playerId) {
         }
     }
     
+    const BoardTopology& topo = boardTopology();
+    
     // Board state - hexes
-    for (const auto& [coord, hex] : game.board.hexes) {
+    for (HexId h = 0; h < NUM_HEXES; h++) {
         AIGameState::HexInfo info;
-        info.q = coord.q;
-        info.r = coord.r;
-        info.type = hex.type;
-        info.numberToken = hex.numberToken;
-        info.hasRobber = hex.hasRobber;
+        info.q = topo.hexCoords[h].q;
+        info.r = topo.hexCoords[h].r;
+        info.type = game.board.hexType[h];
+        info.numberToken = game.board.numberToken[h];
+        info.hasRobber = (game.board.robberHex == h);
         state.hexes.push_back(info);
     }
     
     // Board state - buildings (only occupied)
-    for (const auto& [coord, vertex] : game.board.vertices) {
-        if (vertex.building != Building::None) {
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        if (game.board.hasBuilding(v)) {
             AIGameState::VertexInfo info;
-            info.hexQ = coord.hex.q;
-            info.hexR = coord.hex.r;
-            info.direction = coord.direction;
-            info.building = vertex.building;
-            info.ownerPlayerId = vertex.ownerPlayerId;
+            info.hexQ = topo.vertexCoords[v].hex.q;
+            info.hexR = topo.vertexCoords[v].hex.r;
+            info.direction = topo.vertexCoords[v].direction;
+            info.building = game.board.building[v];
+            info.ownerPlayerId = game.board.vertexOwner[v];
             state.buildings.push_back(info);
         }
     }
     
     // Board state - roads (only edges with roads)
-    for (const auto& [coord, edge] : game.board.edges) {
-        if (edge.hasRoad) {
+    for (EdgeId e = 0; e < NUM_EDGES; e++) {
+        if (game.board.hasRoad(e)) {
             AIGameState::EdgeInfo info;
-            info.hexQ = coord.hex.q;
-            info.hexR = coord.hex.r;
-            info.direction = coord.direction;
-            info.ownerPlayerId = edge.ownerPlayerId;
+            info.hexQ = topo.edgeCoords[e].hex.q;
+            info.hexR = topo.edgeCoords[e].hex.r;
+            info.direction = topo.edgeCoords[e].direction;
+            info.ownerPlayerId = game.board.roadOwner[e];
             state.roads.push_back(info);
         }
     }
@@ -270,28 +280,23 @@ AIGameState getAIGameState(const Game& game, int playerId) {
                 
             case GamePhase::MainTurn:
                 // Building options (if affordable)
-                if (player->resources.wood >= 1 && player->resources.brick >= 1 && 
-                    player->roadsRemaining > 0) {
+                if (canAfford(player->resources, ROAD_COST) && player->roadsRemaining > 0) {
                     state.availableTools.push_back("build_road");
                 }
-                if (player->resources.wood >= 1 && player->resources.brick >= 1 &&
-                    player->resources.wheat >= 1 && player->resources.sheep >= 1 &&
-                    player->settlementsRemaining > 0) {
+                if (canAfford(player->resources, SETTLEMENT_COST) && player->settlementsRemaining > 0) {
                     state.availableTools.push_back("build_settlement");
                 }
-                if (player->resources.wheat >= 2 && player->resources.ore >= 3 &&
-                    player->citiesRemaining > 0) {
+                if (canAfford(player->resources, CITY_COST) && player->citiesRemaining > 0) {
                     state.availableTools.push_back("build_city");
                 }
-                if (player->resources.wheat >= 1 && player->resources.sheep >= 1 &&
-                    player->resources.ore >= 1) {
+                if (canAfford(player->resources, DEV_CARD_COST)) {
                     state.availableTools.push_back("buy_dev_card");
                 }
                 
                 // Trading
-                if (player->resources.wood >= 4 || player->resources.brick >= 4 ||
-                    player->resources.wheat >= 4 || player->resources.sheep >= 4 ||
-                    player->resources.ore >= 4) {
+                if (player->resources[Resource::Wood] >= 4 || player->resources[Resource::Brick] >= 4 ||
+                    player->resources[Resource::Wheat] >= 4 || player->resources[Resource::Sheep] >= 4 ||
+                    player->resources[Resource::Ore] >= 4) {
                     state.availableTools.push_back("bank_trade");
                 }
                 
@@ -326,8 +331,8 @@ AIGameState getAIGameState(const Game& game, int playerId) {
     state.availableTools.push_back("send_chat");
     
     // Check for active trades that this player can respond to
-    for (const auto& trade : game.tradeOffers) {
-        if (trade.isActive && trade.fromPlayerId != playerId) {
+    game.tradeOffers.forEachActive([&](const TradeOffer& trade) {
+        if (trade.fromPlayerId != playerId) {
             // Can respond if trade is open or directed to this player
             if (trade.toPlayerId == -1 || trade.toPlayerId == playerId) {
                 // Check if hasn't already responded
@@ -346,7 +351,7 @@ AIGameState getAIGameState(const Game& game, int playerId) {
                 }
             }
         }
-    }
+    });
     
     // Add recent chat messages (last 20)
     auto chatMessageTypeToString = [](ChatMessageType type) -> std::string {
@@ -361,228 +366,440 @@ AIGameState getAIGameState(const Game& game, int playerId) {
         }
     };
     
-    size_t chatStart = game.chatMessages.size() > 20 ? game.chatMessages.size() - 20 : 0;
-    for (size_t i = chatStart; i < game.chatMessages.size(); i++) {
-        const auto& msg = game.chatMessages[i];
-        // Include public messages or messages to/from this player
-        if (msg.toPlayerId == -1 || msg.toPlayerId == playerId || msg.fromPlayerId == playerId) {
-            AIGameState::ChatMessageInfo info;
-            info.id = msg.id;
-            info.fromPlayerId = msg.fromPlayerId;
-            if (msg.fromPlayerId >= 0 && msg.fromPlayerId < (int)game.players.size()) {
-                info.fromPlayerName = game.players[msg.fromPlayerId].name;
-            } else {
-                info.fromPlayerName = "System";
-            }
-            info.toPlayerId = msg.toPlayerId;
-            info.content = msg.content;
-            info.type = chatMessageTypeToString(msg.type);
-            info.relatedTradeId = msg.relatedTradeId;
-            state.recentChatMessages.push_back(info);
+    auto visible = [playerId](const ChatEntry& msg) { return msg.visibleTo(playerId); };
+    game.chatMessages.forEachRecent(20, visible, [&](const ChatEntry& msg) {
+        AIGameState::ChatMessageInfo info;
+        info.id = std::to_string(msg.id);
+        info.fromPlayerId = msg.fromPlayerId;
+        if (msg.fromPlayerId >= 0 && msg.fromPlayerId < (int)game.players.size()) {
+            info.fromPlayerName = game.players[msg.fromPlayerId].name;
+        } else {
+            info.fromPlayerName = "System";
         }
-    }
+        info.toPlayerId = msg.toPlayerId;
+        info.content = std::string(msg.content);
+        info.type = chatMessageTypeToString(msg.type);
+        info.relatedTradeId = msg.relatedTradeId;
+        state.recentChatMessages.push_back(info);
+    });
     
     // Add active trade offers
-    for (const auto& trade : game.tradeOffers) {
-        if (trade.isActive) {
-            // Include if it's visible to this player
-            if (trade.toPlayerId == -1 || trade.toPlayerId == playerId || trade.fromPlayerId == playerId) {
-                AIGameState::TradeOfferInfo info;
-                info.tradeId = trade.id;
-                info.fromPlayerId = trade.fromPlayerId;
-                if (trade.fromPlayerId >= 0 && trade.fromPlayerId < (int)game.players.size()) {
-                    info.fromPlayerName = game.players[trade.fromPlayerId].name;
-                }
-                info.toPlayerId = trade.toPlayerId;
-                info.offeringWood = trade.offering.wood;
-                info.offeringBrick = trade.offering.brick;
-                info.offeringWheat = trade.offering.wheat;
-                info.offeringSheep = trade.offering.sheep;
-                info.offeringOre = trade.offering.ore;
-                info.requestingWood = trade.requesting.wood;
-                info.requestingBrick = trade.requesting.brick;
-                info.requestingWheat = trade.requesting.wheat;
-                info.requestingSheep = trade.requesting.sheep;
-                info.requestingOre = trade.requesting.ore;
-                info.isActive = trade.isActive;
-                info.acceptedBy = trade.acceptedByPlayerIds;
-                info.rejectedBy = trade.rejectedByPlayerIds;
-                state.activeTrades.push_back(info);
+    game.tradeOffers.forEachActive([&](const TradeOffer& trade) {
+        // Include if it's visible to this player
+        if (trade.toPlayerId == -1 || trade.toPlayerId == playerId || trade.fromPlayerId == playerId) {
+            AIGameState::TradeOfferInfo info;
+            info.tradeId = trade.id;
+            info.fromPlayerId = trade.fromPlayerId;
+            if (trade.fromPlayerId >= 0 && trade.fromPlayerId < (int)game.players.size()) {
+                info.fromPlayerName = game.players[trade.fromPlayerId].name;
             }
+            info.toPlayerId = trade.toPlayerId;
+            info.offeringWood = trade.offering[Resource::Wood];
+            info.offeringBrick = trade.offering[Resource::Brick];
+            info.offeringWheat = trade.offering[Resource::Wheat];
+            info.offeringSheep = trade.offering[Resource::Sheep];
+            info.offeringOre = trade.offering[Resource::Ore];
+            info.requestingWood = trade.requesting[Resource::Wood];
+            info.requestingBrick = trade.requesting[Resource::Brick];
+            info.requestingWheat = trade.requesting[Resource::Wheat];
+            info.requestingSheep = trade.requesting[Resource::Sheep];
+            info.requestingOre = trade.requesting[Resource::Ore];
+            info.isActive = trade.isActive;
+            info.acceptedBy = trade.acceptedByPlayerIds;
+            info.rejectedBy = trade.rejectedByPlayerIds;
+            state.activeTrades.push_back(info);
         }
-    }
+    });
     
     return state;
 }
 
+static void writeResourceCounts(JsonWriter& json, int wood, int brick, int wheat, int sheep, int ore) {
+    json.beginObject();
+    json.key("wood").value(wood);
+    json.key("brick").value(brick);
+    json.key("wheat").value(wheat);
+    json.key("sheep").value(sheep);
+    json.key("ore").value(ore);
+    json.endObject();
+}
+
+static void writeLastRoll(JsonWriter& json, const DiceRoll& roll) {
+    json.beginObject();
+    json.key("die1").value(roll.die1);
+    json.key("die2").value(roll.die2);
+    json.key("total").value(roll.total());
+    json.endObject();
+}
+
+static void writeDevCards(JsonWriter& json, const std::vector<DevCardType>& cards) {
+    json.beginArray();
+    for (DevCardType card : cards) {
+        json.value(devCardToString(card));
+    }
+    json.endArray();
+}
+
+static void writeOtherPlayer(JsonWriter& json, const AIGameState::OtherPlayer& p) {
+    json.beginObject();
+    json.key("id").value(p.id);
+    json.key("name").value(p.name);
+    json.key("resourceCount").value(p.resourceCount);
+    json.key("devCardCount").value(p.devCardCount);
+    json.key("knightsPlayed").value(p.knightsPlayed);
+    json.key("hasLongestRoad").value(p.hasLongestRoad);
+    json.key("hasLargestArmy").value(p.hasLargestArmy);
+    json.key("visibleVictoryPoints").value(p.visibleVictoryPoints);
+    json.endObject();
+}
+
+static void writeBuilding(JsonWriter& json, const AIGameState::VertexInfo& b) {
+    json.beginObject();
+    json.key("hexQ").value(b.hexQ);
+    json.key("hexR").value(b.hexR);
+    json.key("direction").value(b.direction);
+    json.key("building").value(buildingToString(b.building));
+    json.key("ownerPlayerId").value(b.ownerPlayerId);
+    json.endObject();
+}
+
+static void writeRoad(JsonWriter& json, const AIGameState::EdgeInfo& r) {
+    json.beginObject();
+    json.key("hexQ").value(r.hexQ);
+    json.key("hexR").value(r.hexR);
+    json.key("direction").value(r.direction);
+    json.key("ownerPlayerId").value(r.ownerPlayerId);
+    json.endObject();
+}
+
+static void writeTools(JsonWriter& json, const std::vector<std::string>& tools) {
+    json.beginArray();
+    for (const auto& tool : tools) {
+        json.value(tool);
+    }
+    json.endArray();
+}
+
+static void writeChatMessage(JsonWriter& json, const AIGameState::ChatMessageInfo& msg) {
+    json.beginObject();
+    json.key("id").value(msg.id);
+    json.key("fromPlayerId").value(msg.fromPlayerId);
+    json.key("fromPlayerName").value(msg.fromPlayerName);
+    json.key("toPlayerId").value(msg.toPlayerId);
+    json.key("content").value(msg.content);
+    json.key("type").value(msg.type);
+    json.key("relatedTradeId").value(msg.relatedTradeId);
+    json.endObject();
+}
+
+static void writeTrades(JsonWriter& json, const std::vector<AIGameState::TradeOfferInfo>& trades) {
+    json.beginArray();
+    for (const auto& trade : trades) {
+        json.beginObject();
+        json.key("tradeId").value(trade.tradeId);
+        json.key("fromPlayerId").value(trade.fromPlayerId);
+        json.key("fromPlayerName").value(trade.fromPlayerName);
+        json.key("toPlayerId").value(trade.toPlayerId);
+        json.key("offering");
+        writeResourceCounts(json, trade.offeringWood, trade.offeringBrick, trade.offeringWheat,
+                            trade.offeringSheep, trade.offeringOre);
+        json.key("requesting");
+        writeResourceCounts(json, trade.requestingWood, trade.requestingBrick, trade.requestingWheat,
+                            trade.requestingSheep, trade.requestingOre);
+        json.key("isActive").value(trade.isActive);
+        json.key("acceptedBy").beginArray();
+        for (int id : trade.acceptedBy) json.value(id);
+        json.endArray();
+        json.key("rejectedBy").beginArray();
+        for (int id : trade.rejectedBy) json.value(id);
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+}
+
 std::string aiGameStateToJson(const AIGameState& state) {
-    std::ostringstream json;
-    
-    json << "{";
+    JsonWriter json(8192);
+    json.beginObject();
     
     // Player info
-    json << "\"playerId\":" << state.playerId << ",";
-    json << "\"playerName\":\"" << state.playerName << "\",";
-    json << "\"resources\":{";
-    json << "\"wood\":" << state.resources.wood << ",";
-    json << "\"brick\":" << state.resources.brick << ",";
-    json << "\"wheat\":" << state.resources.wheat << ",";
-    json << "\"sheep\":" << state.resources.sheep << ",";
-    json << "\"ore\":" << state.resources.ore;
-    json << "},";
+    json.key("playerId").value(state.playerId);
+    json.key("playerName").value(state.playerName);
+    json.key("resources");
+    writeResourceCounts(json, state.resources[Resource::Wood], state.resources[Resource::Brick], state.resources[Resource::Wheat],
+                        state.resources[Resource::Sheep], state.resources[Resource::Ore]);
     
     // Dev cards
-    json << "\"devCards\":[";
-    for (size_t i = 0; i < state.devCards.size(); i++) {
-        if (i > 0) json << ",";
-        json << "\"" << devCardToString(state.devCards[i]) << "\"";
-    }
-    json << "],";
+    json.key("devCards");
+    writeDevCards(json, state.devCards);
     
     // Building pieces remaining
-    json << "\"settlementsRemaining\":" << state.settlementsRemaining << ",";
-    json << "\"citiesRemaining\":" << state.citiesRemaining << ",";
-    json << "\"roadsRemaining\":" << state.roadsRemaining << ",";
-    json << "\"knightsPlayed\":" << state.knightsPlayed << ",";
+    json.key("settlementsRemaining").value(state.settlementsRemaining);
+    json.key("citiesRemaining").value(state.citiesRemaining);
+    json.key("roadsRemaining").value(state.roadsRemaining);
+    json.key("knightsPlayed").value(state.knightsPlayed);
     
     // Game state
-    json << "\"phase\":\"" << phaseToString(state.phase) << "\",";
-    json << "\"isMyTurn\":" << (state.isMyTurn ? "true" : "false") << ",";
+    json.key("phase").value(phaseToString(state.phase));
+    json.key("isMyTurn").value(state.isMyTurn);
     
     if (state.lastRoll) {
-        json << "\"lastRoll\":{\"die1\":" << state.lastRoll->die1 
-             << ",\"die2\":" << state.lastRoll->die2 
-             << ",\"total\":" << state.lastRoll->total() << "},";
+        json.key("lastRoll");
+        writeLastRoll(json, *state.lastRoll);
     }
     
     // Other players
-    json << "\"otherPlayers\":[";
-    for (size_t i = 0; i < state.otherPlayers.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& p = state.otherPlayers[i];
-        json << "{\"id\":" << p.id;
-        json << ",\"name\":\"" << p.name << "\"";
-        json << ",\"resourceCount\":" << p.resourceCount;
-        json << ",\"devCardCount\":" << p.devCardCount;
-        json << ",\"knightsPlayed\":" << p.knightsPlayed;
-        json << ",\"hasLongestRoad\":" << (p.hasLongestRoad ? "true" : "false");
-        json << ",\"hasLargestArmy\":" << (p.hasLargestArmy ? "true" : "false");
-        json << ",\"visibleVictoryPoints\":" << p.visibleVictoryPoints;
-        json << "}";
+    json.key("otherPlayers").beginArray();
+    for (const auto& p : state.otherPlayers) {
+        writeOtherPlayer(json, p);
     }
-    json << "],";
+    json.endArray();
     
     // Board - hexes
-    json << "\"hexes\":[";
-    for (size_t i = 0; i < state.hexes.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& h = state.hexes[i];
-        json << "{\"q\":" << h.q << ",\"r\":" << h.r;
-        json << ",\"type\":\"" << hexTypeToString(h.type) << "\"";
-        json << ",\"numberToken\":" << h.numberToken;
-        json << ",\"hasRobber\":" << (h.hasRobber ? "true" : "false");
-        json << "}";
+    json.key("hexes").beginArray();
+    for (const auto& h : state.hexes) {
+        json.beginObject();
+        json.key("q").value(h.q);
+        json.key("r").value(h.r);
+        json.key("type").value(hexTypeToString(h.type));
+        json.key("numberToken").value(h.numberToken);
+        json.key("hasRobber").value(h.hasRobber);
+        json.endObject();
     }
-    json << "],";
+    json.endArray();
     
     // Board - buildings
-    json << "\"buildings\":[";
-    for (size_t i = 0; i < state.buildings.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& b = state.buildings[i];
-        json << "{\"hexQ\":" << b.hexQ << ",\"hexR\":" << b.hexR;
-        json << ",\"direction\":" << b.direction;
-        json << ",\"building\":\"" << buildingToString(b.building) << "\"";
-        json << ",\"ownerPlayerId\":" << b.ownerPlayerId;
-        json << "}";
+    json.key("buildings").beginArray();
+    for (const auto& b : state.buildings) {
+        writeBuilding(json, b);
     }
-    json << "],";
+    json.endArray();
     
     // Board - roads
-    json << "\"roads\":[";
-    for (size_t i = 0; i < state.roads.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& r = state.roads[i];
-        json << "{\"hexQ\":" << r.hexQ << ",\"hexR\":" << r.hexR;
-        json << ",\"direction\":" << r.direction;
-        json << ",\"ownerPlayerId\":" << r.ownerPlayerId;
-        json << "}";
+    json.key("roads").beginArray();
+    for (const auto& r : state.roads) {
+        writeRoad(json, r);
     }
-    json << "],";
+    json.endArray();
     
     // Available tools
-    json << "\"availableTools\":[";
-    for (size_t i = 0; i < state.availableTools.size(); i++) {
-        if (i > 0) json << ",";
-        json << "\"" << state.availableTools[i] << "\"";
-    }
-    json << "],";
+    json.key("availableTools");
+    writeTools(json, state.availableTools);
     
     // Recent chat messages
-    json << "\"recentChatMessages\":[";
-    for (size_t i = 0; i < state.recentChatMessages.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& msg = state.recentChatMessages[i];
-        json << "{\"id\":\"" << msg.id << "\"";
-        json << ",\"fromPlayerId\":" << msg.fromPlayerId;
-        json << ",\"fromPlayerName\":\"" << msg.fromPlayerName << "\"";
-        json << ",\"toPlayerId\":" << msg.toPlayerId;
-        // Escape special characters in content
-        std::string escapedContent;
-        for (char c : msg.content) {
-            if (c == '"') escapedContent += "\\\"";
-            else if (c == '\\') escapedContent += "\\\\";
-            else if (c == '\n') escapedContent += "\\n";
-            else if (c == '\r') escapedContent += "\\r";
-            else if (c == '\t') escapedContent += "\\t";
-            else escapedContent += c;
-        }
-        json << ",\"content\":\"" << escapedContent << "\"";
-        json << ",\"type\":\"" << msg.type << "\"";
-        json << ",\"relatedTradeId\":" << msg.relatedTradeId;
-        json << "}";
+    json.key("recentChatMessages").beginArray();
+    for (const auto& msg : state.recentChatMessages) {
+        writeChatMessage(json, msg);
     }
-    json << "],";
+    json.endArray();
     
     // Active trades
-    json << "\"activeTrades\":[";
-    for (size_t i = 0; i < state.activeTrades.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& trade = state.activeTrades[i];
-        json << "{\"tradeId\":" << trade.tradeId;
-        json << ",\"fromPlayerId\":" << trade.fromPlayerId;
-        json << ",\"fromPlayerName\":\"" << trade.fromPlayerName << "\"";
-        json << ",\"toPlayerId\":" << trade.toPlayerId;
-        json << ",\"offering\":{";
-        json << "\"wood\":" << trade.offeringWood;
-        json << ",\"brick\":" << trade.offeringBrick;
-        json << ",\"wheat\":" << trade.offeringWheat;
-        json << ",\"sheep\":" << trade.offeringSheep;
-        json << ",\"ore\":" << trade.offeringOre << "}";
-        json << ",\"requesting\":{";
-        json << "\"wood\":" << trade.requestingWood;
-        json << ",\"brick\":" << trade.requestingBrick;
-        json << ",\"wheat\":" << trade.requestingWheat;
-        json << ",\"sheep\":" << trade.requestingSheep;
-        json << ",\"ore\":" << trade.requestingOre << "}";
-        json << ",\"isActive\":" << (trade.isActive ? "true" : "false");
-        json << ",\"acceptedBy\":[";
-        for (size_t j = 0; j < trade.acceptedBy.size(); j++) {
-            if (j > 0) json << ",";
-            json << trade.acceptedBy[j];
-        }
-        json << "],\"rejectedBy\":[";
-        for (size_t j = 0; j < trade.rejectedBy.size(); j++) {
-            if (j > 0) json << ",";
-            json << trade.rejectedBy[j];
+    json.key("activeTrades");
+    writeTrades(json, state.activeTrades);
+    
+    json.endObject();
+    return json.take();
+}
+
+std::string aiGameStateDeltaToJson(const AIGameState& before, const AIGameState& after) {
+    JsonWriter json(1024);
+    json.beginObject();
+    
+    // Always present: what the next decision hinges on
+    json.key("phase").value(phaseToString(after.phase));
+    json.key("isMyTurn").value(after.isMyTurn);
+    json.key("resources");
+    writeResourceCounts(json, after.resources[Resource::Wood], after.resources[Resource::Brick], after.resources[Resource::Wheat],
+                        after.resources[Resource::Sheep], after.resources[Resource::Ore]);
+    json.key("availableTools");
+    writeTools(json, after.availableTools);
+    
+    // The rest only when it changed
+    auto sameRoll = [](const std::optional<DiceRoll>& a, const std::optional<DiceRoll>& b) {
+        if (!a || !b) return !a && !b;
+        return a->die1 == b->die1 && a->die2 == b->die2;
+    };
+    if (after.lastRoll && !sameRoll(before.lastRoll, after.lastRoll)) {
+        json.key("lastRoll");
+        writeLastRoll(json, *after.lastRoll);
+    }
+    if (after.devCards != before.devCards) {
+        json.key("devCards");
+        writeDevCards(json, after.devCards);
+    }
+    if (after.settlementsRemaining != before.settlementsRemaining) {
+        json.key("settlementsRemaining").value(after.settlementsRemaining);
+    }
+    if (after.citiesRemaining != before.citiesRemaining) {
+        json.key("citiesRemaining").value(after.citiesRemaining);
+    }
+    if (after.roadsRemaining != before.roadsRemaining) {
+        json.key("roadsRemaining").value(after.roadsRemaining);
+    }
+    if (after.knightsPlayed != before.knightsPlayed) {
+        json.key("knightsPlayed").value(after.knightsPlayed);
+    }
+    
+    auto samePlayer = [](const AIGameState::OtherPlayer& a, const AIGameState::OtherPlayer& b) {
+        return a.id == b.id && a.resourceCount == b.resourceCount && a.devCardCount == b.devCardCount &&
+               a.knightsPlayed == b.knightsPlayed && a.hasLongestRoad == b.hasLongestRoad &&
+               a.hasLargestArmy == b.hasLargestArmy && a.visibleVictoryPoints == b.visibleVictoryPoints;
+    };
+    bool playersOpen = false;
+    for (size_t i = 0; i < after.otherPlayers.size(); i++) {
+        if (i < before.otherPlayers.size() && samePlayer(before.otherPlayers[i], after.otherPlayers[i])) continue;
+        if (!playersOpen) {
+            json.key("otherPlayers").beginArray();
+            playersOpen = true;
+        }
+        writeOtherPlayer(json, after.otherPlayers[i]);
+    }
+    if (playersOpen) json.endArray();
+    
+    for (size_t i = 0; i < after.hexes.size(); i++) {
+        bool moved = i >= before.hexes.size() || !before.hexes[i].hasRobber;
+        if (after.hexes[i].hasRobber && moved) {
+            json.key("robberHex").beginObject();
+            json.key("q").value(after.hexes[i].q);
+            json.key("r").value(after.hexes[i].r);
+            json.endObject();
         }
-        json << "]}";
     }
-    json << "]";
     
-    json << "}";
+    // Pieces are only ever added or upgraded, so anything not seen before is new
+    auto sameBuilding = [](const AIGameState::VertexInfo& a, const AIGameState::VertexInfo& b) {
+        return a.hexQ == b.hexQ && a.hexR == b.hexR && a.direction == b.direction &&
+               a.building == b.building && a.ownerPlayerId == b.ownerPlayerId;
+    };
+    bool buildingsOpen = false;
+    for (const auto& b : after.buildings) {
+        bool seen = std::any_of(before.buildings.begin(), before.buildings.end(),
+                                [&](const AIGameState::VertexInfo& old) { return sameBuilding(old, b); });
+        if (seen) continue;
+        if (!buildingsOpen) {
+            json.key("newBuildings").beginArray();
+            buildingsOpen = true;
+        }
+        writeBuilding(json, b);
+    }
+    if (buildingsOpen) json.endArray();
+    
+    bool roadsOpen = false;
+    for (const auto& r : after.roads) {
+        bool seen = std::any_of(before.roads.begin(), before.roads.end(), [&](const AIGameState::EdgeInfo& old) {
+            return old.hexQ == r.hexQ && old.hexR == r.hexR && old.direction == r.direction;
+        });
+        if (seen) continue;
+        if (!roadsOpen) {
+            json.key("newRoads").beginArray();
+            roadsOpen = true;
+        }
+        writeRoad(json, r);
+    }
+    if (roadsOpen) json.endArray();
+    
+    bool chatOpen = false;
+    for (const auto& msg : after.recentChatMessages) {
+        bool seen = std::any_of(before.recentChatMessages.begin(), before.recentChatMessages.end(),
+                                [&](const AIGameState::ChatMessageInfo& old) { return old.id == msg.id; });
+        if (seen) continue;
+        if (!chatOpen) {
+            json.key("newChatMessages").beginArray();
+            chatOpen = true;
+        }
+        writeChatMessage(json, msg);
+    }
+    if (chatOpen) json.endArray();
     
-    return json.str();
+    // Trades are few; resend the whole list if anything about them changed
+    auto sameTrade = [](const AIGameState::TradeOfferInfo& a, const AIGameState::TradeOfferInfo& b) {
+        return a.tradeId == b.tradeId && a.isActive == b.isActive &&
+               a.acceptedBy == b.acceptedBy && a.rejectedBy == b.rejectedBy;
+    };
+    bool tradesChanged = before.activeTrades.size() != after.activeTrades.size() ||
+        !std::equal(after.activeTrades.begin(), after.activeTrades.end(), before.activeTrades.begin(), sameTrade);
+    if (tradesChanged) {
+        json.key("activeTrades");
+        writeTrades(json, after.activeTrades);
+    }
+    
+    json.endObject();
+    return json.take();
+}
+
+// ============================================================================
+// TOOL ARGUMENTS
+// ============================================================================
+
+static Resource resourceFromString(const std::string& name) {
+    if (name == "wood") return Resource::Wood;
+    if (name == "brick") return Resource::Brick;
+    if (name == "wheat") return Resource::Wheat;
+    if (name == "sheep") return Resource::Sheep;
+    if (name == "ore") return Resource::Ore;
+    return Resource::None;
+}
+
+static ResourceHand readHand(const JsonValue& args, const char* prefix) {
+    std::string key = prefix;
+    size_t base = key.size();
+    auto field = [&](const char* name) {
+        key.resize(base);
+        key += name;
+        return args.getInt(key, 0);
+    };
+    ResourceHand hand;
+    hand[Resource::Wood] = field("Wood");
+    hand[Resource::Brick] = field("Brick");
+    hand[Resource::Wheat] = field("Wheat");
+    hand[Resource::Sheep] = field("Sheep");
+    hand[Resource::Ore] = field("Ore");
+    return hand;
+}
+
+Action actionFromArguments(ActionType type, const JsonValue& args, int playerId) {
+    Action action;
+    action.type = type;
+    action.playerId = playerId;
+
+    HexCoord hex{args.getInt("hexQ", 0), args.getInt("hexR", 0)};
+    int direction = args.getInt("direction", 0);
+    switch (type) {
+        case ActionType::PlaceSetupSettlement:
+        case ActionType::BuildSettlement:
+        case ActionType::BuildCity:
+            action.vertex = boardTopology().vertexId({hex, direction});
+            break;
+        case ActionType::PlaceSetupRoad:
+        case ActionType::BuildRoad:
+            action.edge = boardTopology().edgeId({hex, direction});
+            break;
+        case ActionType::MoveRobber:
+            action.hex = boardTopology().hexId(hex);
+            action.victimId = args.getInt("stealFromPlayerId", -1);
+            break;
+        case ActionType::BankTrade:
+            action.give = resourceFromString(args.getString("give"));
+            action.receive = resourceFromString(args.getString("receive"));
+            break;
+        case ActionType::SendChat:
+        case ActionType::ProposeTrade:
+        case ActionType::CounterTrade:
+            action.toPlayerId = args.getInt("toPlayerId", -1);
+            action.message = args.getString("message");
+            action.offering = readHand(args, "give");
+            action.requesting = readHand(args, "want");
+            action.tradeId = args.getInt("originalTradeId", -1);
+            break;
+        case ActionType::AcceptTrade:
+        case ActionType::RejectTrade:
+        case ActionType::CancelTrade:
+            action.tradeId = args.getInt("tradeId", -1);
+            break;
+        default:
+            break;
+    }
+    return action;
 }
 
 // ============================================================================
@@ -701,15 +918,15 @@ int AIPlayerManager::aiPlayerCount() const {
 // AI TURN EXECUTOR - Server-side AI turn processing
 // ============================================================================
 
-AITurnExecutor::AITurnExecutor(Game* game, const std::string& gameId, LLMConfigManager& llmConfig)
-    : game(game), gameId(gameId), llmConfig(llmConfig) {}
+AITurnExecutor::AITurnExecutor(std::shared_ptr<Game> game, const std::string& gameId, LLMConfigManager& llmConfig)
+    : game(std::move(game)), gameId(gameId), llmConfig(llmConfig) {}
 
 AITurnExecutor::~AITurnExecutor() {
     stopProcessing();
 }
 
-std::string AITurnExecutor::buildSystemPrompt() const {
-    return 
+const std::string& AITurnExecutor::buildSystemPrompt() {
+    static const std::string prompt =
         "You are playing a game of Catan. You are an AI player competing against other players "
         "(both human and other AI players). Your goal is to win by being the first to reach 10 victory points. "
         "Victory points come from: settlements (1 VP), cities (2 VP), longest road (2 VP), "
@@ -748,53 +965,43 @@ std::string AITurnExecutor::buildSystemPrompt() const {
         "== IMPORTANT ==\n"
         "Always use one of the available tools. Look at 'availableTools' to see what you can do. "
         "When your turn is complete (in main_turn phase), use end_turn.\n"
+        "After the first message of a turn you are sent only what changed since your last action; "
+        "anything not mentioned is as before.\n"
         "BE SOCIAL! Send at least one chat message per turn to keep the game lively and fun!";
+    return prompt;
 }
 
-std::string AITurnExecutor::buildUserMessage(const AIGameState& state) const {
+std::string AITurnExecutor::buildUserMessage(const AIGameState& state, const AIGameState* previous) const {
+    if (previous) {
+        return "Changes since your last action:\n" + aiGameStateDeltaToJson(*previous, state) +
+               "\n\nChoose your next action from availableTools.";
+    }
     return "Current game state:\n" + aiGameStateToJson(state) + 
            "\n\nIt's your turn. Choose an action from availableTools.";
 }
 
-std::vector<LLMTool> AITurnExecutor::buildToolList() const {
-    std::vector<LLMTool> tools;
-    auto defs = getToolDefinitions();
-    for (const auto& def : defs) {
-        LLMTool tool;
-        tool.name = def.name;
-        tool.description = def.description;
-        tool.parametersSchema = def.parametersSchema;
-        tools.push_back(tool);
-    }
+const std::vector<LLMTool>& AITurnExecutor::buildToolList() {
+    static const std::vector<LLMTool> tools = []() {
+        std::vector<LLMTool> list;
+        for (const auto& def : getToolDefinitions()) {
+            LLMTool tool;
+            tool.name = def.name;
+            tool.description = def.description;
+            tool.parametersSchema = def.parametersSchema;
+            list.push_back(tool);
+        }
+        return list;
+    }();
     return tools;
 }
 
-// Simple JSON int parser
-static int parseJsonInt(const std::string& json, const std::string& key, int defaultValue = 0) {
-    std::string searchKey = "\"" + key + "\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return defaultValue;
-    pos += searchKey.length();
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t')) pos++;
-    size_t endPos = pos;
-    if (json[endPos] == '-') endPos++;
-    while (endPos < json.size() && std::isdigit(json[endPos])) endPos++;
-    if (endPos == pos) return defaultValue;
-    try {
-        return std::stoi(json.substr(pos, endPos - pos));
-    } catch (...) {
-        return defaultValue;
-    }
-}
-
-static std::string parseJsonStr(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\":\"";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return "";
-    pos += searchKey.length();
-    size_t endPos = json.find("\"", pos);
-    if (endPos == std::string::npos) return "";
-    return json.substr(pos, endPos - pos);
+void AITurnExecutor::TurnUsage::add(const LLMResponse& response) {
+    requests++;
+    requestBytes += response.requestBytes;
+    inputTokens += response.inputTokens;
+    cachedInputTokens += response.cachedInputTokens;
+    cacheWriteTokens += response.cacheWriteTokens;
+    outputTokens += response.outputTokens;
 }
 
 ToolResult AITurnExecutor::executeToolCall(const LLMToolCall& toolCall, int playerId) {
@@ -806,669 +1013,70 @@ ToolResult AITurnExecutor::executeToolCall(const LLMToolCall& toolCall, int play
         return result;
     }
     
-    Player* player = game->getPlayerById(playerId);
-    if (!player) {
-        result.message = "Player not found";
+    const std::string& tool = toolCall.toolName;
+    ActionType type;
+    if (!actionTypeFromName(tool, type)) {
+        result.message = "Unknown tool: " + tool;
         return result;
     }
     
-    const std::string& tool = toolCall.toolName;
-    const std::string& args = toolCall.arguments;
-    
-    // Building costs
-    static const ResourceHand ROAD_COST = {1, 1, 0, 0, 0};
-    static const ResourceHand SETTLEMENT_COST = {1, 1, 1, 1, 0};
-    static const ResourceHand CITY_COST = {0, 0, 2, 0, 3};
-    static const ResourceHand DEV_CARD_COST = {0, 0, 1, 1, 1};
-    
-    auto canAfford = [](const ResourceHand& have, const ResourceHand& cost) {
-        return have.wood >= cost.wood && have.brick >= cost.brick &&
-               have.wheat >= cost.wheat && have.sheep >= cost.sheep &&
-               have.ore >= cost.ore;
-    };
-    
-    auto subtractResources = [](ResourceHand& from, const ResourceHand& cost) {
-        from.wood -= cost.wood;
-        from.brick -= cost.brick;
-        from.wheat -= cost.wheat;
-        from.sheep -= cost.sheep;
-        from.ore -= cost.ore;
-    };
-    
-    if (tool == "roll_dice") {
-        if (game->phase != GamePhase::Rolling) {
-            result.message = "Cannot roll now";
-            return result;
-        }
-        
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_int_distribution<> die(1, 6);
-        
-        DiceRoll roll;
-        roll.die1 = die(gen);
-        roll.die2 = die(gen);
-        game->lastRoll = roll;
-        
-        if (roll.total() == 7) {
-            game->phase = GamePhase::Robber;
-            result.message = "Rolled " + std::to_string(roll.total()) + " - must move robber";
-        } else {
-            // Distribute resources
-            for (const auto& [coord, hex] : game->board.hexes) {
-                if (hex.numberToken == roll.total() && !hex.hasRobber) {
-                    Resource resource = hexTypeToResource(hex.type);
-                    if (resource == Resource::None) continue;
-                    
-                    for (int dir = 0; dir < 6; dir++) {
-                        VertexCoord vc{coord, dir};
-                        auto it = game->board.vertices.find(vc);
-                        if (it != game->board.vertices.end() && it->second.ownerPlayerId >= 0) {
-                            Player* owner = game->getPlayerById(it->second.ownerPlayerId);
-                            if (owner) {
-                                int amount = (it->second.building == Building::City) ? 2 : 1;
-                                owner->resources[resource] += amount;
-                            }
-                        }
-                    }
-                }
-            }
-            game->phase = GamePhase::MainTurn;
-            result.message = "Rolled " + std::to_string(roll.total());
-        }
-        result.success = true;
-        result.data = "{\"die1\":" + std::to_string(roll.die1) + 
-                      ",\"die2\":" + std::to_string(roll.die2) + 
-                      ",\"total\":" + std::to_string(roll.total()) + "}";
-    }
-    else if (tool == "end_turn") {
-        if (game->phase != GamePhase::MainTurn) {
-            result.message = "Cannot end turn in this phase";
-            return result;
-        }
-        
-        game->currentPlayerIndex = (game->currentPlayerIndex + 1) % game->players.size();
-        game->phase = GamePhase::Rolling;
-        game->devCardPlayedThisTurn = false;
-        
-        result.success = true;
-        result.message = "Turn ended";
-        result.data = "{\"nextPlayer\":" + std::to_string(game->currentPlayerIndex) + "}";
-    }
-    else if (tool == "build_road") {
-        if (game->phase != GamePhase::MainTurn) {
-            result.message = "Cannot build in this phase";
-            return result;
-        }
-        if (!canAfford(player->resources, ROAD_COST)) {
-            result.message = "Not enough resources";
-            return result;
-        }
-        if (player->roadsRemaining <= 0) {
-            result.message = "No roads remaining";
-            return result;
-        }
-        
-        int hexQ = parseJsonInt(args, "hexQ", 0);
-        int hexR = parseJsonInt(args, "hexR", 0);
-        int direction = parseJsonInt(args, "direction", 0);
-        
-        subtractResources(player->resources, ROAD_COST);
-        player->roadsRemaining--;
-        
-        EdgeCoord coord{{hexQ, hexR}, direction};
-        auto it = game->board.edges.find(coord);
-        if (it != game->board.edges.end()) {
-            it->second.hasRoad = true;
-            it->second.ownerPlayerId = player->id;
-        }
-        
-        result.success = true;
-        result.message = "Built road";
-    }
-    else if (tool == "build_settlement") {
-        if (game->phase != GamePhase::MainTurn) {
-            result.message = "Cannot build in this phase";
-            return result;
-        }
-        if (!canAfford(player->resources, SETTLEMENT_COST)) {
-            result.message = "Not enough resources";
-            return result;
-        }
-        if (player->settlementsRemaining <= 0) {
-            result.message = "No settlements remaining";
-            return result;
-        }
-        
-        int hexQ = parseJsonInt(args, "hexQ", 0);
-        int hexR = parseJsonInt(args, "hexR", 0);
-        int direction = parseJsonInt(args, "direction", 0);
-        
-        subtractResources(player->resources, SETTLEMENT_COST);
-        player->settlementsRemaining--;
-        
-        VertexCoord coord{{hexQ, hexR}, direction};
-        auto it = game->board.vertices.find(coord);
-        if (it != game->board.vertices.end()) {
-            it->second.building = Building::Settlement;
-            it->second.ownerPlayerId = player->id;
-        }
-        
-        result.success = true;
-        result.message = "Built settlement";
-    }
-    else if (tool == "build_city") {
-        if (game->phase != GamePhase::MainTurn) {
-            result.message = "Cannot build in this phase";
-            return result;
-        }
-        if (!canAfford(player->resources, CITY_COST)) {
-            result.message = "Not enough resources";
-            return result;
-        }
-        if (player->citiesRemaining <= 0) {
-            result.message = "No cities remaining";
-            return result;
-        }
-        
-        int hexQ = parseJsonInt(args, "hexQ", 0);
-        int hexR = parseJsonInt(args, "hexR", 0);
-        int direction = parseJsonInt(args, "direction", 0);
-        
-        VertexCoord coord{{hexQ, hexR}, direction};
-        auto it = game->board.vertices.find(coord);
-        if (it == game->board.vertices.end() || 
-            it->second.building != Building::Settlement ||
-            it->second.ownerPlayerId != player->id) {
-            result.message = "No settlement to upgrade";
-            return result;
-        }
-        
-        subtractResources(player->resources, CITY_COST);
-        player->citiesRemaining--;
-        player->settlementsRemaining++;
-        it->second.building = Building::City;
-        
-        result.success = true;
-        result.message = "Upgraded to city";
-    }
-    else if (tool == "buy_dev_card") {
-        if (game->phase != GamePhase::MainTurn) {
-            result.message = "Cannot buy in this phase";
-            return result;
-        }
-        if (!canAfford(player->resources, DEV_CARD_COST)) {
-            result.message = "Not enough resources";
-            return result;
-        }
-        if (game->devCardDeck.empty()) {
-            result.message = "No dev cards remaining";
-            return result;
-        }
-        
-        subtractResources(player->resources, DEV_CARD_COST);
-        
-        DevCardType card = game->devCardDeck.back();
-        game->devCardDeck.pop_back();
-        player->devCards.push_back(card);
-        
-        std::string cardName;
-        switch (card) {
-            case DevCardType::Knight: cardName = "knight"; break;
-            case DevCardType::VictoryPoint: cardName = "victory_point"; break;
-            case DevCardType::RoadBuilding: cardName = "road_building"; break;
-            case DevCardType::YearOfPlenty: cardName = "year_of_plenty"; break;
-            case DevCardType::Monopoly: cardName = "monopoly"; break;
-        }
-        
-        result.success = true;
-        result.message = "Bought " + cardName;
-        result.data = "{\"card\":\"" + cardName + "\"}";
-    }
-    else if (tool == "bank_trade") {
-        if (game->phase != GamePhase::MainTurn) {
-            result.message = "Cannot trade in this phase";
-            return result;
-        }
-        
-        std::string giveStr = parseJsonStr(args, "give");
-        std::string receiveStr = parseJsonStr(args, "receive");
-        
-        auto stringToResource = [](const std::string& name) -> Resource {
-            if (name == "wood") return Resource::Wood;
-            if (name == "brick") return Resource::Brick;
-            if (name == "wheat") return Resource::Wheat;
-            if (name == "sheep") return Resource::Sheep;
-            if (name == "ore") return Resource::Ore;
-            return Resource::None;
-        };
-        
-        Resource give = stringToResource(giveStr);
-        Resource receive = stringToResource(receiveStr);
-        
-        if (give == Resource::None || receive == Resource::None) {
-            result.message = "Invalid resources";
-            return result;
-        }
-        
-        int ratio = 4;
-        if (player->resources[give] < ratio) {
-            result.message = "Not enough resources";
-            return result;
-        }
-        
-        player->resources[give] -= ratio;
-        player->resources[receive] += 1;
-        
-        result.success = true;
-        result.message = "Traded " + giveStr + " for " + receiveStr;
-    }
-    else if (tool == "move_robber") {
-        if (game->phase != GamePhase::Robber) {
-            result.message = "Not in robber phase";
-            return result;
-        }
-        
-        int hexQ = parseJsonInt(args, "hexQ", 0);
-        int hexR = parseJsonInt(args, "hexR", 0);
-        int stealFrom = parseJsonInt(args, "stealFromPlayerId", -1);
-        
-        // Move robber
-        HexCoord oldLoc = game->board.robberLocation;
-        HexCoord newLoc{hexQ, hexR};
-        
-        auto oldIt = game->board.hexes.find(oldLoc);
-        if (oldIt != game->board.hexes.end()) {
-            oldIt->second.hasRobber = false;
-        }
-        
-        auto newIt = game->board.hexes.find(newLoc);
-        if (newIt != game->board.hexes.end()) {
-            newIt->second.hasRobber = true;
-        }
-        game->board.robberLocation = newLoc;
-        
-        // Steal from player
-        std::string stolenResource = "none";
-        if (stealFrom >= 0 && stealFrom < (int)game->players.size() && stealFrom != playerId) {
-            Player* victim = &game->players[stealFrom];
-            if (victim->resources.total() > 0) {
-                std::vector<Resource> available;
-                if (victim->resources.wood > 0) available.push_back(Resource::Wood);
-                if (victim->resources.brick > 0) available.push_back(Resource::Brick);
-                if (victim->resources.wheat > 0) available.push_back(Resource::Wheat);
-                if (victim->resources.sheep > 0) available.push_back(Resource::Sheep);
-                if (victim->resources.ore > 0) available.push_back(Resource::Ore);
-                
-                if (!available.empty()) {
-                    static std::random_device rd;
-                    static std::mt19937 gen(rd());
-                    std::uniform_int_distribution<> dis(0, available.size() - 1);
-                    Resource stolen = available[dis(gen)];
-                    victim->resources[stolen]--;
-                    player->resources[stolen]++;
-                    stolenResource = resourceToString(stolen);
-                }
-            }
-        }
-        
-        game->phase = GamePhase::MainTurn;
-        
-        result.success = true;
-        result.message = "Moved robber" + (stolenResource != "none" ? ", stole " + stolenResource : "");
-    }
-    else if (tool == "send_chat") {
-        int toPlayerId = parseJsonInt(args, "toPlayerId", -1);
-        std::string message = parseJsonStr(args, "message");
-        
-        if (message.empty()) {
-            result.message = "Message cannot be empty";
-            return result;
-        }
-        
-        // Create chat message
-        ChatMessage chatMsg;
-        chatMsg.id = std::to_string(game->nextChatMessageId++);
-        chatMsg.fromPlayerId = playerId;
-        chatMsg.toPlayerId = toPlayerId;
-        chatMsg.content = message;
-        chatMsg.type = ChatMessageType::Normal;
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        
-        game->chatMessages.push_back(chatMsg);
-        
-        // Broadcast SSE
-        SSEEvent sseEvent = GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, player->name,
-            chatMsg.toPlayerId, chatMsg.content, "normal"
-        );
-        sseManager.broadcastToGame(gameId, sseEvent);
-        
-        result.success = true;
-        result.message = "Message sent";
-        result.data = "{\"messageId\":\"" + chatMsg.id + "\"}";
-    }
-    else if (tool == "propose_trade") {
-        int toPlayerId = parseJsonInt(args, "toPlayerId", -1);
-        std::string message = parseJsonStr(args, "message");
-        
-        ResourceHand offering;
-        offering.wood = parseJsonInt(args, "giveWood", 0);
-        offering.brick = parseJsonInt(args, "giveBrick", 0);
-        offering.wheat = parseJsonInt(args, "giveWheat", 0);
-        offering.sheep = parseJsonInt(args, "giveSheep", 0);
-        offering.ore = parseJsonInt(args, "giveOre", 0);
-        
-        ResourceHand requesting;
-        requesting.wood = parseJsonInt(args, "wantWood", 0);
-        requesting.brick = parseJsonInt(args, "wantBrick", 0);
-        requesting.wheat = parseJsonInt(args, "wantWheat", 0);
-        requesting.sheep = parseJsonInt(args, "wantSheep", 0);
-        requesting.ore = parseJsonInt(args, "wantOre", 0);
-        
-        // Validate
-        if (player->resources.wood < offering.wood ||
-            player->resources.brick < offering.brick ||
-            player->resources.wheat < offering.wheat ||
-            player->resources.sheep < offering.sheep ||
-            player->resources.ore < offering.ore) {
-            result.message = "Not enough resources to offer";
-            return result;
-        }
-        
-        // Create trade
-        TradeOffer trade;
-        trade.id = game->nextTradeId++;
-        trade.fromPlayerId = playerId;
-        trade.toPlayerId = toPlayerId;
-        trade.offering = offering;
-        trade.requesting = requesting;
-        trade.isActive = true;
-        
-        // Create chat message
-        ChatMessage chatMsg;
-        chatMsg.id = std::to_string(game->nextChatMessageId++);
-        chatMsg.fromPlayerId = playerId;
-        chatMsg.toPlayerId = toPlayerId;
-        chatMsg.type = ChatMessageType::TradeProposal;
-        chatMsg.relatedTradeId = trade.id;
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        
-        std::ostringstream desc;
-        desc << "📦 Trade Proposal: ";
-        if (!message.empty()) desc << message << " - ";
-        desc << "Offering ";
-        bool first = true;
-        if (offering.wood > 0) { desc << offering.wood << " wood"; first = false; }
-        if (offering.brick > 0) { desc << (first ? "" : ", ") << offering.brick << " brick"; first = false; }
-        if (offering.wheat > 0) { desc << (first ? "" : ", ") << offering.wheat << " wheat"; first = false; }
-        if (offering.sheep > 0) { desc << (first ? "" : ", ") << offering.sheep << " sheep"; first = false; }
-        if (offering.ore > 0) { desc << (first ? "" : ", ") << offering.ore << " ore"; first = false; }
-        desc << " for ";
-        first = true;
-        if (requesting.wood > 0) { desc << requesting.wood << " wood"; first = false; }
-        if (requesting.brick > 0) { desc << (first ? "" : ", ") << requesting.brick << " brick"; first = false; }
-        if (requesting.wheat > 0) { desc << (first ? "" : ", ") << requesting.wheat << " wheat"; first = false; }
-        if (requesting.sheep > 0) { desc << (first ? "" : ", ") << requesting.sheep << " sheep"; first = false; }
-        if (requesting.ore > 0) { desc << (first ? "" : ", ") << requesting.ore << " ore"; first = false; }
-        chatMsg.content = desc.str();
-        
-        trade.chatMessageId = chatMsg.id;
-        game->tradeOffers.push_back(trade);
-        game->chatMessages.push_back(chatMsg);
-        
-        // Broadcast
-        SSEEvent chatEvent = GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_proposal"
-        );
-        sseManager.broadcastToGame(gameId, chatEvent);
-        
-        SSEEvent tradeEvent = GameEvents::createTradeProposedEvent(
-            trade.id, trade.fromPlayerId, player->name, trade.toPlayerId,
-            offering.wood, offering.brick, offering.wheat, offering.sheep, offering.ore,
-            requesting.wood, requesting.brick, requesting.wheat, requesting.sheep, requesting.ore,
-            message
-        );
-        sseManager.broadcastToGame(gameId, tradeEvent);
-        
-        result.success = true;
-        result.message = "Trade proposed";
-        result.data = "{\"tradeId\":" + std::to_string(trade.id) + "}";
-    }
-    else if (tool == "accept_trade") {
-        int tradeId = parseJsonInt(args, "tradeId", -1);
-        
-        TradeOffer* trade = nullptr;
-        for (auto& t : game->tradeOffers) {
-            if (t.id == tradeId) {
-                trade = &t;
-                break;
-            }
-        }
-        
-        if (!trade) {
-            result.message = "Trade not found";
-            return result;
-        }
-        
-        if (!trade->isActive) {
-            result.message = "Trade no longer active";
-            return result;
-        }
-        
-        if (trade->fromPlayerId == playerId) {
-            result.message = "Cannot accept own trade";
-            return result;
-        }
-        
-        // Verify resources
-        if (player->resources.wood < trade->requesting.wood ||
-            player->resources.brick < trade->requesting.brick ||
-            player->resources.wheat < trade->requesting.wheat ||
-            player->resources.sheep < trade->requesting.sheep ||
-            player->resources.ore < trade->requesting.ore) {
-            result.message = "Not enough resources";
-            return result;
-        }
-        
-        Player* proposer = game->getPlayerById(trade->fromPlayerId);
-        if (!proposer ||
-            proposer->resources.wood < trade->offering.wood ||
-            proposer->resources.brick < trade->offering.brick ||
-            proposer->resources.wheat < trade->offering.wheat ||
-            proposer->resources.sheep < trade->offering.sheep ||
-            proposer->resources.ore < trade->offering.ore) {
-            trade->isActive = false;
-            result.message = "Proposer no longer has resources";
-            return result;
-        }
-        
-        // Execute trade
-        proposer->resources.wood -= trade->offering.wood;
-        proposer->resources.brick -= trade->offering.brick;
-        proposer->resources.wheat -= trade->offering.wheat;
-        proposer->resources.sheep -= trade->offering.sheep;
-        proposer->resources.ore -= trade->offering.ore;
-        
-        player->resources.wood += trade->offering.wood;
-        player->resources.brick += trade->offering.brick;
-        player->resources.wheat += trade->offering.wheat;
-        player->resources.sheep += trade->offering.sheep;
-        player->resources.ore += trade->offering.ore;
-        
-        player->resources.wood -= trade->requesting.wood;
-        player->resources.brick -= trade->requesting.brick;
-        player->resources.wheat -= trade->requesting.wheat;
-        player->resources.sheep -= trade->requesting.sheep;
-        player->resources.ore -= trade->requesting.ore;
-        
-        proposer->resources.wood += trade->requesting.wood;
-        proposer->resources.brick += trade->requesting.brick;
-        proposer->resources.wheat += trade->requesting.wheat;
-        proposer->resources.sheep += trade->requesting.sheep;
-        proposer->resources.ore += trade->requesting.ore;
-        
-        trade->isActive = false;
-        trade->acceptedByPlayerIds.push_back(playerId);
-        
-        // Chat message
-        ChatMessage chatMsg;
-        chatMsg.id = std::to_string(game->nextChatMessageId++);
-        chatMsg.fromPlayerId = playerId;
-        chatMsg.toPlayerId = -1;
-        chatMsg.type = ChatMessageType::TradeAccept;
-        chatMsg.relatedTradeId = trade->id;
-        chatMsg.content = "✅ " + player->name + " accepted the trade with " + proposer->name + "!";
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        game->chatMessages.push_back(chatMsg);
-        
-        // Broadcast
-        SSEEvent execEvent = GameEvents::createTradeExecutedEvent(
-            trade->id, trade->fromPlayerId, proposer->name, playerId, player->name
-        );
-        sseManager.broadcastToGame(gameId, execEvent);
-        
-        SSEEvent chatEvent = GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_accept"
-        );
-        sseManager.broadcastToGame(gameId, chatEvent);
-        
-        result.success = true;
-        result.message = "Trade executed";
-    }
-    else if (tool == "reject_trade") {
-        int tradeId = parseJsonInt(args, "tradeId", -1);
-        
-        TradeOffer* trade = nullptr;
-        for (auto& t : game->tradeOffers) {
-            if (t.id == tradeId) {
-                trade = &t;
-                break;
-            }
-        }
-        
-        if (!trade) {
-            result.message = "Trade not found";
-            return result;
-        }
-        
-        trade->rejectedByPlayerIds.push_back(playerId);
-        
-        // Chat message
-        ChatMessage chatMsg;
-        chatMsg.id = std::to_string(game->nextChatMessageId++);
-        chatMsg.fromPlayerId = playerId;
-        chatMsg.toPlayerId = -1;
-        chatMsg.type = ChatMessageType::TradeReject;
-        chatMsg.relatedTradeId = trade->id;
-        chatMsg.content = "❌ " + player->name + " rejected the trade.";
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        game->chatMessages.push_back(chatMsg);
-        
-        SSEEvent chatEvent = GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_reject"
-        );
-        sseManager.broadcastToGame(gameId, chatEvent);
-        
-        result.success = true;
-        result.message = "Trade rejected";
+    Action action = actionFromArguments(type, JsonValue::parse(toolCall.arguments), playerId);
+    ActionResult applied = applyAction(*game, action);
+    if (!applied.ok()) {
+        result.message = actionErrorMessage(applied.error, type);
+        return result;
     }
-    else if (tool == "counter_trade") {
-        int originalTradeId = parseJsonInt(args, "originalTradeId", -1);
-        std::string message = parseJsonStr(args, "message");
-        
-        TradeOffer* originalTrade = nullptr;
-        for (auto& t : game->tradeOffers) {
-            if (t.id == originalTradeId) {
-                originalTrade = &t;
-                break;
-            }
-        }
-        
-        if (!originalTrade) {
-            result.message = "Original trade not found";
-            return result;
-        }
-        
-        ResourceHand offering;
-        offering.wood = parseJsonInt(args, "giveWood", 0);
-        offering.brick = parseJsonInt(args, "giveBrick", 0);
-        offering.wheat = parseJsonInt(args, "giveWheat", 0);
-        offering.sheep = parseJsonInt(args, "giveSheep", 0);
-        offering.ore = parseJsonInt(args, "giveOre", 0);
-        
-        ResourceHand requesting;
-        requesting.wood = parseJsonInt(args, "wantWood", 0);
-        requesting.brick = parseJsonInt(args, "wantBrick", 0);
-        requesting.wheat = parseJsonInt(args, "wantWheat", 0);
-        requesting.sheep = parseJsonInt(args, "wantSheep", 0);
-        requesting.ore = parseJsonInt(args, "wantOre", 0);
-        
-        if (player->resources.wood < offering.wood ||
-            player->resources.brick < offering.brick ||
-            player->resources.wheat < offering.wheat ||
-            player->resources.sheep < offering.sheep ||
-            player->resources.ore < offering.ore) {
-            result.message = "Not enough resources";
-            return result;
-        }
-        
-        // Create counter trade
-        TradeOffer counterTrade;
-        counterTrade.id = game->nextTradeId++;
-        counterTrade.fromPlayerId = playerId;
-        counterTrade.toPlayerId = originalTrade->fromPlayerId;
-        counterTrade.offering = offering;
-        counterTrade.requesting = requesting;
-        counterTrade.isActive = true;
-        
-        // Chat message
-        ChatMessage chatMsg;
-        chatMsg.id = std::to_string(game->nextChatMessageId++);
-        chatMsg.fromPlayerId = playerId;
-        chatMsg.toPlayerId = originalTrade->fromPlayerId;
-        chatMsg.type = ChatMessageType::TradeCounter;
-        chatMsg.relatedTradeId = counterTrade.id;
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        
-        std::string proposerName = "Unknown";
-        if (originalTrade->fromPlayerId >= 0 && originalTrade->fromPlayerId < (int)game->players.size()) {
-            proposerName = game->players[originalTrade->fromPlayerId].name;
+    GameEvents::broadcastActionEvents(*game, action, applied);
+    
+    result.success = true;
+    switch (type) {
+        case ActionType::RollDice: {
+            int total = applied.roll.total();
+            result.message = "Rolled " + std::to_string(total) + (total == 7 ? " - must move robber" : "");
+            result.data = "{\"die1\":" + std::to_string(applied.roll.die1) +
+                          ",\"die2\":" + std::to_string(applied.roll.die2) +
+                          ",\"total\":" + std::to_string(total) + "}";
+            break;
         }
-        
-        std::ostringstream desc;
-        desc << "🔄 Counter-offer to " << proposerName;
-        if (!message.empty()) desc << ": " << message;
-        chatMsg.content = desc.str();
-        
-        counterTrade.chatMessageId = chatMsg.id;
-        game->tradeOffers.push_back(counterTrade);
-        game->chatMessages.push_back(chatMsg);
-        
-        SSEEvent tradeEvent = GameEvents::createTradeProposedEvent(
-            counterTrade.id, counterTrade.fromPlayerId, player->name, counterTrade.toPlayerId,
-            offering.wood, offering.brick, offering.wheat, offering.sheep, offering.ore,
-            requesting.wood, requesting.brick, requesting.wheat, requesting.sheep, requesting.ore,
-            message
-        );
-        sseManager.broadcastToGame(gameId, tradeEvent);
-        
-        SSEEvent chatEvent = GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_counter"
-        );
-        sseManager.broadcastToGame(gameId, chatEvent);
-        
-        result.success = true;
-        result.message = "Counter-offer made";
-        result.data = "{\"counterTradeId\":" + std::to_string(counterTrade.id) + "}";
-    }
-    else {
-        result.message = "Unknown tool: " + tool;
+        case ActionType::EndTurn:
+            result.message = "Turn ended";
+            result.data = "{\"nextPlayer\":" + std::to_string(applied.nextPlayer) + "}";
+            break;
+        case ActionType::PlaceSetupSettlement: result.message = "Placed settlement"; break;
+        case ActionType::PlaceSetupRoad: result.message = "Placed road"; break;
+        case ActionType::BuildRoad: result.message = "Built road"; break;
+        case ActionType::BuildSettlement: result.message = "Built settlement"; break;
+        case ActionType::BuildCity: result.message = "Upgraded to city"; break;
+        case ActionType::BuyDevCard:
+            result.message = "Bought " + devCardToString(applied.card);
+            result.data = "{\"card\":\"" + devCardToString(applied.card) + "\"}";
+            break;
+        case ActionType::BankTrade:
+            result.message = "Traded " + std::to_string(applied.ratio) + " " + resourceToString(action.give) +
+                             " for " + resourceToString(action.receive);
+            break;
+        case ActionType::MoveRobber:
+            result.message = "Moved robber";
+            if (applied.stolen != Resource::None) result.message += ", stole " + resourceToString(applied.stolen);
+            break;
+        case ActionType::SendChat:
+            result.message = "Message sent";
+            result.data = "{\"messageId\":\"" + std::to_string(applied.chatMessageId) + "\"}";
+            break;
+        case ActionType::ProposeTrade:
+            result.message = "Trade proposed";
+            result.data = "{\"tradeId\":" + std::to_string(applied.tradeId) + "}";
+            break;
+        case ActionType::CounterTrade:
+            result.message = "Counter-offer made";
+            result.data = "{\"counterTradeId\":" + std::to_string(applied.tradeId) + "}";
+            break;
+        case ActionType::AcceptTrade: result.message = "Trade executed"; break;
+        case ActionType::RejectTrade: result.message = "Trade rejected"; break;
+        case ActionType::CancelTrade: result.message = "Trade cancelled"; break;
+        case ActionType::Count: break;
     }
+    if (applied.winner >= 0) result.message += " - game won";
     
     return result;
 }
@@ -1478,6 +1086,10 @@ std::string AITurnExecutor::describeAction(const std::string& toolName, const To
         return "Rolled dice: " + result.message;
     } else if (toolName == "end_turn") {
         return "Ended turn";
+    } else if (toolName == "place_setup_settlement") {
+        return "Placed a starting settlement";
+    } else if (toolName == "place_setup_road") {
+        return "Placed a starting road";
     } else if (toolName == "build_road") {
         return "Built a road";
     } else if (toolName == "build_settlement") {
@@ -1495,33 +1107,38 @@ std::string AITurnExecutor::describeAction(const std::string& toolName, const To
 }
 
 bool AITurnExecutor::startProcessing() {
-    if (status.load() == Status::Processing) {
-        return false;  // Already processing
-    }
-    
-    if (!hasAIPendingTurns()) {
-        return false;  // No AI turns to process
-    }
-    
-    shouldStop = false;
-    status = Status::Processing;
-    
-    // Start processing thread
-    if (processingThread.joinable()) {
-        processingThread.join();
+    uint64_t gen;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (status.load() == Status::Processing) {
+            return false;  // Already processing
+        }
+        
+        if (!hasAIPendingTurns()) {
+            return false;  // No AI turns to process
+        }
+        
+        shouldStop = false;
+        status = Status::Processing;
+        turn = TurnProgress();
+        gen = ++generation;
     }
     
-    processingThread = std::thread([this]() {
-        processAITurns();
-    });
-    
+    // Callers may hold the game lock, so don't look at the move here. The
+    // first step goes in as local and requeues itself if it needs the model.
+    scheduleStep(gen, true);
     return true;
 }
 
 void AITurnExecutor::stopProcessing() {
     shouldStop = true;
-    if (processingThread.joinable()) {
-        processingThread.join();
+    {
+        // Orphan any queued step and wait out the one that may be running
+        std::unique_lock<std::mutex> lock(mutex);
+        generation++;
+        speculations.clear();
+        speculationCv.notify_all();
+        stepCv.wait(lock, [this]() { return !stepRunning; });
     }
     status = Status::Idle;
 }
@@ -1569,11 +1186,47 @@ std::string AITurnExecutor::statusToJson() const {
     json << "\"currentAIPlayerId\":" << currentAIPlayerId << ",";
     
     if (!lastError.empty()) {
-        json << "\"error\":\"" << lastError << "\",";
+        json << "\"error\":\"" << escapeJson(lastError) << "\",";
     }
     
     json << "\"hasAIPendingTurns\":" << (hasAIPendingTurns() ? "true" : "false") << ",";
-    json << "\"llmProvider\":\"" << llmConfig.getConfig().provider << "\",";
+    json << "\"llmProvider\":\"" << escapeJson(llmConfig.getConfig().provider) << "\",";
+    json << "\"staleSnapshots\":" << staleSnapshots.load() << ",";
+    json << "\"localActions\":" << localActions.load() << ",";
+    json << "\"llmCalls\":" << llmCalls.load() << ",";
+    json << "\"speculation\":{\"pending\":" << speculations.size()
+         << ",\"hits\":" << speculationHits.load()
+         << ",\"stale\":" << speculationsStale.load() << "},";
+    
+    // Model traffic: request bytes sent and tokens billed, split into
+    // uncached and cache-served prompt tokens
+    auto writeUsage = [&json](const char* name, const TurnUsage& usage) {
+        json << "\"" << name << "\":{";
+        json << "\"requests\":" << usage.requests << ",";
+        json << "\"requestBytes\":" << usage.requestBytes << ",";
+        json << "\"inputTokens\":" << usage.inputTokens << ",";
+        json << "\"cachedInputTokens\":" << usage.cachedInputTokens << ",";
+        json << "\"cacheWriteTokens\":" << usage.cacheWriteTokens << ",";
+        json << "\"outputTokens\":" << usage.outputTokens;
+        json << "},";
+    };
+    writeUsage("currentTurn", currentTurnUsage);
+    writeUsage("lastTurn", lastTurnUsage);
+    writeUsage("totalUsage", totalUsage);
+    
+    // Game::mutex contention
+    if (game) {
+        const GameLockStats& stats = game->lockStats;
+        uint64_t acquisitions = stats.acquisitions.load();
+        json << "\"lockStats\":{";
+        json << "\"gameVersion\":" << game->version.load() << ",";
+        json << "\"acquisitions\":" << acquisitions << ",";
+        json << "\"totalWaitMs\":" << stats.totalWaitNs.load() / 1000000.0 << ",";
+        json << "\"totalHoldMs\":" << stats.totalHoldNs.load() / 1000000.0 << ",";
+        json << "\"avgHoldUs\":" << (acquisitions ? stats.totalHoldNs.load() / 1000.0 / acquisitions : 0.0) << ",";
+        json << "\"maxHoldMs\":" << stats.maxHoldNs.load() / 1000000.0;
+        json << "},";
+    }
     
     // Recent actions
     json << "\"recentActions\":[";
@@ -1583,12 +1236,12 @@ std::string AITurnExecutor::statusToJson() const {
         const auto& entry = actionLog[i];
         json << "{";
         json << "\"playerId\":" << entry.playerId << ",";
-        json << "\"playerName\":\"" << entry.playerName << "\",";
-        json << "\"action\":\"" << entry.action << "\",";
-        json << "\"description\":\"" << entry.description << "\",";
+        json << "\"playerName\":\"" << escapeJson(entry.playerName) << "\",";
+        json << "\"action\":\"" << escapeJson(entry.action) << "\",";
+        json << "\"description\":\"" << escapeJson(entry.description) << "\",";
         json << "\"success\":" << (entry.success ? "true" : "false");
         if (!entry.error.empty()) {
-            json << ",\"error\":\"" << entry.error << "\"";
+            json << ",\"error\":\"" << escapeJson(entry.error) << "\"";
         }
         json << "}";
     }
@@ -1598,134 +1251,226 @@ std::string AITurnExecutor::statusToJson() const {
     return json.str();
 }
 
-void AITurnExecutor::processAITurns() {
-    while (!shouldStop && hasAIPendingTurns()) {
-        int playerId = game->currentPlayerIndex;
-        currentAIPlayerId = playerId;
-        
-        // Broadcast AI thinking event
-        if (playerId >= 0 && playerId < (int)game->players.size()) {
+void AITurnExecutor::scheduleStep(uint64_t gen, bool local) {
+    // Humans at the table get their AI opponents' moves first
+    bool humanWaiting = false;
+    for (const auto& p : game->players) {
+        if (p.isHuman()) {
+            humanWaiting = true;
+            break;
+        }
+    }
+    
+    std::weak_ptr<AITurnExecutor> weakSelf = weak_from_this();
+    auto task = [weakSelf, gen, local]() {
+        if (auto self = weakSelf.lock()) {
+            self->runStep(gen, local);
+        }
+    };
+    auto priority = humanWaiting ? AIScheduler::Priority::HumanWaiting : AIScheduler::Priority::Background;
+    if (local) {
+        AIScheduler::instance().submitLocal(llmConfig.getConfig().provider, priority, std::move(task));
+        return;
+    }
+    
+    // Rough prompt size for the provider's token bucket (~4 chars per token)
+    size_t chars = 0;
+    for (const auto& msg : turn.messages) {
+        chars += msg.content.size();
+        if (msg.toolCall) chars += msg.toolCall->arguments.size();
+    }
+    double estimatedTokens = static_cast<double>(chars + 6000) / 4.0 + llmConfig.getConfig().maxTokens;
+    AIScheduler::instance().submit(llmConfig.getConfig().provider, priority, estimatedTokens, std::move(task));
+}
+
+bool AITurnExecutor::nextStepIsLocal() const {
+    LLMProvider* llm = llmConfig.getProvider();
+    if (!game || !llm) return true;  // the step fails without a model call
+    
+    GameLock lock(*game, GameLock::Mode::Read);
+    const int playerId = turn.playerId >= 0 ? turn.playerId : game->currentPlayerIndex;
+    if (game->phase == GamePhase::Finished || game->currentPlayerIndex != playerId) {
+        return true;  // the step just ends the turn
+    }
+    return localDecision(*llm, playerId).has_value();
+}
+
+void AITurnExecutor::runStep(uint64_t gen, bool local) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (gen != generation) return;  // run was stopped or restarted
+        stepRunning = true;
+    }
+    
+    bool scheduleNext = false;
+    bool failed = false;
+    
+    if (!shouldStop) {
+        if (turn.playerId < 0 && hasAIPendingTurns()) {
+            // Start the next AI player's turn
+            turn = TurnProgress();
+            turn.playerId = game->currentPlayerIndex;
+            currentAIPlayerId = turn.playerId;
+            
+            // Broadcast AI thinking event
             SSEEvent thinkingEvent;
             thinkingEvent.event = GameEvents::AI_THINKING;
-            thinkingEvent.data = "{\"playerId\":" + std::to_string(playerId) + 
-                                ",\"playerName\":\"" + game->players[playerId].name + "\"}";
-            thinkingEvent.id = sseManager.nextEventId();
+            thinkingEvent.data = "{\"playerId\":" + std::to_string(turn.playerId) + 
+                                ",\"playerName\":\"" + escapeJson(game->players[turn.playerId].name) + "\"}";
             sseManager.broadcastToGame(gameId, thinkingEvent);
         }
         
-        if (!processSingleAITurn(playerId)) {
-            // Error occurred - broadcast error event
-            SSEEvent errorEvent;
-            errorEvent.event = GameEvents::AI_ERROR;
-            errorEvent.data = "{\"error\":\"" + lastError + "\"}";
-            errorEvent.id = sseManager.nextEventId();
-            sseManager.broadcastToGame(gameId, errorEvent);
-            
-            status = Status::Error;
-            return;
+        if (turn.playerId >= 0) {
+            switch (processAIAction(local)) {
+                case StepOutcome::Continue:
+                case StepOutcome::Requeue:
+                    scheduleNext = true;
+                    break;
+                case StepOutcome::TurnDone:
+                    turn = TurnProgress();
+                    {
+                        std::lock_guard<std::mutex> usageLock(mutex);
+                        if (currentTurnUsage.requests > 0) lastTurnUsage = currentTurnUsage;
+                        currentTurnUsage = TurnUsage();
+                    }
+                    scheduleNext = hasAIPendingTurns();
+                    break;
+                case StepOutcome::Failed:
+                    failed = true;
+                    break;
+            }
         }
-        
-        // Small delay between turns for rate limiting
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
-    currentAIPlayerId = -1;
-    status = Status::Completed;
+    if (!failed && !shouldStop) {
+        speculateNextTurn();
+    }
+    
+    if (failed) {
+        // Error occurred - broadcast error event
+        SSEEvent errorEvent;
+        errorEvent.event = GameEvents::AI_ERROR;
+        errorEvent.data = "{\"error\":\"" + escapeJson(lastError) + "\"}";
+        sseManager.broadcastToGame(gameId, errorEvent);
+        
+        status = Status::Error;
+    } else if (!scheduleNext && !shouldStop) {
+        currentAIPlayerId = -1;
+        status = Status::Completed;
+        
+        // Broadcast AI turns complete event
+        SSEEvent completeEvent;
+        completeEvent.event = GameEvents::AI_TURN_COMPLETE;
+        completeEvent.data = "{\"message\":\"All AI turns completed\"}";
+        sseManager.broadcastToGame(gameId, completeEvent);
+    }
     
-    // Broadcast AI turns complete event
-    SSEEvent completeEvent;
-    completeEvent.event = GameEvents::AI_TURN_COMPLETE;
-    completeEvent.data = "{\"message\":\"All AI turns completed\"}";
-    completeEvent.id = sseManager.nextEventId();
-    sseManager.broadcastToGame(gameId, completeEvent);
+    bool nextLocal = scheduleNext && nextStepIsLocal();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stepRunning = false;
+        if (scheduleNext && !shouldStop && gen == generation) {
+            scheduleStep(gen, nextLocal);
+        }
+    }
+    stepCv.notify_all();
 }
 
-bool AITurnExecutor::processSingleAITurn(int playerId) {
-    if (!game) return false;
+AITurnExecutor::StepOutcome AITurnExecutor::processAIAction(bool local) {
+    if (!game) return StepOutcome::Failed;
     
+    const int playerId = turn.playerId;
     Player* player = game->getPlayerById(playerId);
-    if (!player || !player->isAI()) return false;
+    if (!player || !player->isAI()) return StepOutcome::TurnDone;
     
     LLMProvider* llm = llmConfig.getProvider();
     if (!llm) {
         lastError = "No LLM provider configured";
-        return false;
+        return StepOutcome::Failed;
     }
     
-    std::string systemPrompt = buildSystemPrompt();
-    std::vector<LLMTool> tools = buildToolList();
-    std::vector<LLMMessage> messages;
-    
-    int maxActions = 20;  // Safety limit
-    int actionCount = 0;
-    
-    while (actionCount < maxActions && !shouldStop) {
-        actionCount++;
-        
-        // Check if still this AI's turn
-        if (game->currentPlayerIndex != playerId) {
-            break;  // Turn has ended
+    const int maxActions = 20;  // Safety limit
+    if (turn.actionCount >= maxActions) {
+        // Restarting a turn that went nowhere would just spin a scheduler worker
+        GameLock lock(*game, GameLock::Mode::Read);
+        if (game->phase != GamePhase::Finished && game->currentPlayerIndex == playerId) {
+            lastError = player->name + " made no progress in " + std::to_string(maxActions) + " actions";
+            return StepOutcome::Failed;
         }
-        
-        // Get current state and build message
-        std::lock_guard<std::mutex> lock(game->mutex);
-        AIGameState state = getAIGameState(*game, playerId);
-        
-        if (!state.isMyTurn) {
-            break;  // Not our turn anymore
-        }
-        
-        // Build user message with current state
-        LLMMessage userMsg;
-        userMsg.role = LLMMessage::Role::User;
-        userMsg.content = buildUserMessage(state);
-        messages.push_back(userMsg);
-        
-        // Call LLM
-        LLMResponse llmResponse = llm->chat(messages, tools, systemPrompt);
-        
-        if (!llmResponse.success) {
-            lastError = "LLM call failed: " + llmResponse.error;
-            
-            AIActionLogEntry logEntry;
-            logEntry.playerId = playerId;
-            logEntry.playerName = player->name;
-            logEntry.action = "llm_error";
-            logEntry.description = lastError;
-            logEntry.success = false;
-            logEntry.error = llmResponse.error;
-            logEntry.timestamp = std::chrono::steady_clock::now();
-            
-            {
-                std::lock_guard<std::mutex> logLock(mutex);
-                actionLog.push_back(logEntry);
-            }
-            
-            // Fall back to mock behavior
-            llmResponse.toolCall = LLMToolCall{"end_turn", "{}"};
-            llmResponse.success = true;
+        return StepOutcome::TurnDone;
+    }
+    
+    // Snapshot the state under the lock; the LLM round-trip runs without it
+    AIGameState state;
+    uint64_t snapshotVersion;
+    std::optional<LLMToolCall> localCall;
+    {
+        GameLock lock(*game, GameLock::Mode::Read);
+        if (game->phase == GamePhase::Finished || game->currentPlayerIndex != playerId) {
+            return StepOutcome::TurnDone;  // Turn has ended, or the game has
+        }
+        snapshotVersion = game->version.load();
+        localCall = localDecision(*llm, playerId);
+        if (!localCall) {
+            if (local) return StepOutcome::Requeue;
+            state = getAIGameState(*game, playerId);
         }
-        
-        if (!llmResponse.toolCall) {
-            // No tool call, LLM gave text response - try to continue
-            LLMMessage assistantMsg;
-            assistantMsg.role = LLMMessage::Role::Assistant;
-            assistantMsg.content = llmResponse.textContent;
-            messages.push_back(assistantMsg);
-            continue;
+    }
+    turn.actionCount++;
+    
+    if (localCall) {
+        return applyLocalAction(*localCall, playerId, snapshotVersion);
+    }
+    
+    if (!state.isMyTurn) {
+        return StepOutcome::TurnDone;  // Not our turn anymore
+    }
+    
+    // The turn's first decision may already have been asked for while the
+    // previous turn was played. The conversation then starts from the state
+    // the model was shown; the next prompt's delta covers any chat since.
+    std::optional<LLMToolCall> speculatedCall;
+    if (!turn.shown) {
+        if (auto speculation = takeSpeculation(playerId, state)) {
+            state = std::move(speculation->state);
+            speculatedCall = std::move(speculation->call);
         }
+    }
+    
+    const std::string& systemPrompt = buildSystemPrompt();
+    const std::vector<LLMTool>& tools = buildToolList();
+    std::vector<LLMMessage>& messages = turn.messages;
+    
+    // Build user message with current state; after the first action of the
+    // turn the conversation already holds the rest
+    LLMMessage userMsg;
+    userMsg.role = LLMMessage::Role::User;
+    userMsg.content = buildUserMessage(state, turn.shown ? &*turn.shown : nullptr);
+    messages.push_back(userMsg);
+    
+    // Call LLM
+    LLMResponse llmResponse;
+    if (speculatedCall) {
+        llmResponse.success = true;
+        llmResponse.toolCall = std::move(speculatedCall);
+    } else {
+        llmCalls++;
+        llmResponse = llm->chat(messages, tools, systemPrompt);
+        std::lock_guard<std::mutex> usageLock(mutex);
+        currentTurnUsage.add(llmResponse);
+        totalUsage.add(llmResponse);
+    }
+    
+    if (!llmResponse.success) {
+        lastError = "LLM call failed: " + llmResponse.error;
         
-        // Execute the tool
-        ToolResult result = executeToolCall(*llmResponse.toolCall, playerId);
-        
-        // Log the action
         AIActionLogEntry logEntry;
         logEntry.playerId = playerId;
         logEntry.playerName = player->name;
-        logEntry.action = llmResponse.toolCall->toolName;
-        logEntry.description = describeAction(llmResponse.toolCall->toolName, result);
-        logEntry.success = result.success;
-        logEntry.error = result.success ? "" : result.message;
+        logEntry.action = "llm_error";
+        logEntry.description = lastError;
+        logEntry.success = false;
+        logEntry.error = llmResponse.error;
         logEntry.timestamp = std::chrono::steady_clock::now();
         
         {
@@ -1733,38 +1478,345 @@ bool AITurnExecutor::processSingleAITurn(int playerId) {
             actionLog.push_back(logEntry);
         }
         
-        // Broadcast SSE event
-        SSEEvent sseEvent = GameEvents::createAIActionEvent(
-            playerId, player->name, 
-            logEntry.action, logEntry.description, 
-            result.success
-        );
-        sseManager.broadcastToGame(gameId, sseEvent);
-        
-        // Add assistant message with tool call
+        // Fall back to mock behavior
+        llmResponse.toolCall = LLMToolCall{"end_turn", "{}"};
+        llmResponse.success = true;
+    }
+    
+    if (!llmResponse.toolCall) {
+        // No tool call, LLM gave text response - try to continue
         LLMMessage assistantMsg;
         assistantMsg.role = LLMMessage::Role::Assistant;
-        assistantMsg.toolCall = *llmResponse.toolCall;
+        assistantMsg.content = llmResponse.textContent;
         messages.push_back(assistantMsg);
-        
-        // Add tool result message
-        LLMMessage toolResultMsg;
-        toolResultMsg.role = LLMMessage::Role::ToolResult;
-        toolResultMsg.content = result.success ? 
-            ("Success: " + result.message) : 
-            ("Error: " + result.message);
-        messages.push_back(toolResultMsg);
-        
-        // Check if turn ended
-        if (llmResponse.toolCall->toolName == "end_turn" && result.success) {
-            break;
+        turn.shown = std::move(state);
+        return StepOutcome::Continue;
+    }
+    
+    // Re-acquire and make sure nothing moved while the model was thinking.
+    // If it did, drop this decision and ask again from a fresh snapshot;
+    // after MAX_STALE_RETRIES the call is applied anyway, since
+    // executeToolCall validates it against the live state.
+    ToolResult result;
+    {
+        GameLock lock(*game);
+        if (game->version.load() != snapshotVersion && turn.staleRetries < MAX_STALE_RETRIES) {
+            turn.staleRetries++;
+            staleSnapshots++;
+            messages.pop_back();  // the user message built from the stale snapshot
+            turn.actionCount--;
+            return StepOutcome::Continue;
+        }
+        turn.staleRetries = 0;
+        result = executeToolCall(*llmResponse.toolCall, playerId);
+    }
+    turn.shown = std::move(state);
+    
+    recordAction(playerId, player->name, llmResponse.toolCall->toolName, result);
+    
+    // Add assistant message with tool call
+    LLMMessage assistantMsg;
+    assistantMsg.role = LLMMessage::Role::Assistant;
+    assistantMsg.toolCall = *llmResponse.toolCall;
+    messages.push_back(assistantMsg);
+    
+    // Add tool result message
+    LLMMessage toolResultMsg;
+    toolResultMsg.role = LLMMessage::Role::ToolResult;
+    if (!llmResponse.toolCall->id.empty()) toolResultMsg.toolCallId = llmResponse.toolCall->id;
+    toolResultMsg.content = result.success ? 
+        ("Success: " + result.message) : 
+        ("Error: " + result.message);
+    messages.push_back(toolResultMsg);
+    
+    // Check if turn ended
+    if (llmResponse.toolCall->toolName == "end_turn" && result.success) {
+        return StepOutcome::TurnDone;
+    }
+    
+    return StepOutcome::Continue;
+}
+
+std::optional<LLMToolCall> AITurnExecutor::localDecision(LLMProvider& llm, int playerId) const {
+    if (turn.localRejected) return std::nullopt;
+    
+    // A provider that plays from the game decides everything itself
+    if (auto call = llm.decide(*game, playerId)) {
+        return call;
+    }
+    
+    // The model has no setup tools, so the heuristic policy always places
+    // setup pieces. In hybrid mode it also takes the moves with no real
+    // choice in them (rolling, ending a turn with nothing to build).
+    PolicyAction action = chooseAction(*game, playerId);
+    bool setup = action.type == PolicyActionType::PlaceSetupSettlement ||
+                 action.type == PolicyActionType::PlaceSetupRoad;
+    bool forced = action.forced && llmConfig.getConfig().hybrid;
+    if (action.type == PolicyActionType::None || !(setup || forced)) {
+        return std::nullopt;
+    }
+    return policyToolCall(action);
+}
+
+AITurnExecutor::StepOutcome AITurnExecutor::applyLocalAction(const LLMToolCall& call, int playerId,
+                                                             uint64_t snapshotVersion) {
+    ToolResult result;
+    std::string playerName;
+    {
+        GameLock lock(*game);
+        if (game->version.load() != snapshotVersion) {
+            // Deciding again is cheap, but still counts towards the action limit
+            return StepOutcome::Continue;
+        }
+        result = executeToolCall(call, playerId);
+        if (const Player* player = game->getPlayerById(playerId)) playerName = player->name;
+    }
+    localActions++;
+    
+    // Not added to the conversation: the next prompt carries the state it led to
+    recordAction(playerId, playerName, call.toolName, result);
+    
+    if (!result.success) {
+        turn.localRejected = true;
+        return StepOutcome::Continue;
+    }
+    if (call.toolName == "end_turn") {
+        return StepOutcome::TurnDone;
+    }
+    return StepOutcome::Continue;
+}
+
+// ============================================================================
+// SPECULATION
+// ============================================================================
+
+// What a speculative decision has to agree with: the whole prompt, except
+// chat (the next prompt's delta brings that in) and how the dice split
+static std::string speculationKey(AIGameState state) {
+    state.recentChatMessages.clear();
+    if (state.lastRoll) {
+        int total = state.lastRoll->total();
+        state.lastRoll->die1 = std::min(6, total - 1);
+        state.lastRoll->die2 = total - state.lastRoll->die1;
+    }
+    return aiGameStateToJson(state);
+}
+
+// Dice totals grouped by what they produce, most likely first, one total
+// standing for each group. 7 is left out: it leads to the robber.
+static std::vector<int> likelyRolls(const GameBoard& board, size_t maxRolls) {
+    auto sameProduction = [](const std::vector<ProductionEntry>& a, const std::vector<ProductionEntry>& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+            [](const ProductionEntry& x, const ProductionEntry& y) {
+                return x.playerId == y.playerId && x.resource == y.resource && x.amount == y.amount;
+            });
+    };
+    
+    struct Group { int total; int ways; int bestWays; };
+    std::vector<Group> groups;
+    for (int total = 2; total <= 12; total++) {
+        if (total == 7) continue;
+        int ways = 6 - std::abs(7 - total);
+        auto it = std::find_if(groups.begin(), groups.end(), [&](const Group& g) {
+            return sameProduction(board.production[g.total], board.production[total]);
+        });
+        if (it == groups.end()) {
+            groups.push_back({total, ways, ways});
+        } else {
+            it->ways += ways;
+            if (ways > it->bestWays) {
+                it->total = total;
+                it->bestWays = ways;
+            }
         }
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) { return a.ways > b.ways; });
+    
+    std::vector<int> totals;
+    for (size_t i = 0; i < groups.size() && i < maxRolls; i++) totals.push_back(groups[i].total);
+    return totals;
+}
+
+void AITurnExecutor::speculateNextTurn() {
+    // Only in hybrid mode does a turn open with a local roll, leaving the
+    // post-roll decision as the first one to wait on
+    const LLMConfig& config = llmConfig.getConfig();
+    LLMProvider* llm = llmConfig.getProvider();
+    if (!config.hybrid || !llm || !llm->isRemote()) return;
+    
+    int nextPlayerIndex;
+    int currentPlayerId;
+    uint64_t version;
+    std::vector<int> rolls;
+    std::string encoded;
+    {
+        GameLock lock(*game, GameLock::Mode::Read);
+        if (game->phase != GamePhase::Rolling && game->phase != GamePhase::Robber &&
+            game->phase != GamePhase::MainTurn) {
+            return;
+        }
+        if (game->players.empty()) return;
+        currentPlayerId = game->players[game->currentPlayerIndex].id;
+        nextPlayerIndex = (game->currentPlayerIndex + 1) % static_cast<int>(game->players.size());
+        if (!game->players[nextPlayerIndex].isAI()) return;
         
-        // Small delay between actions
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        version = game->version.load();
+        {
+            std::lock_guard<std::mutex> specLock(mutex);
+            if (version == speculatedVersion) return;
+            speculatedVersion = version;
+        }
+        rolls = likelyRolls(game->board, MAX_SPECULATIVE_ROLLS);
+        encoded = encodeGame(*game);
     }
     
-    return true;
+    // Play each roll out on a copy of the game, as the turn would start
+    for (int total : rolls) {
+        Game copy;
+        if (!decodeGame(encoded, copy)) return;
+        copy.currentPlayerIndex = nextPlayerIndex;
+        copy.devCardPlayedThisTurn = false;
+        copy.lastRoll = DiceRoll{std::min(6, total - 1), total - std::min(6, total - 1)};
+        distributeResources(copy, total);
+        copy.phase = GamePhase::MainTurn;
+        
+        const int playerId = copy.players[nextPlayerIndex].id;
+        AIGameState state = getAIGameState(copy, playerId);
+        std::string key = speculationKey(state);
+        std::string prompt = buildUserMessage(state, nullptr);
+        
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Plans for a player whose turn has come and gone can't be used.
+            // The current player's are left for its first decision to take.
+            size_t before = speculations.size();
+            speculations.erase(std::remove_if(speculations.begin(), speculations.end(),
+                [&](const Speculation& s) { return s.playerId != playerId && s.playerId != currentPlayerId; }),
+                speculations.end());
+            speculationsStale += before - speculations.size();
+            
+            auto existing = std::find_if(speculations.begin(), speculations.end(),
+                [&](const Speculation& s) { return s.key == key; });
+            if (existing != speculations.end()) {
+                existing->version = version;    // nothing it depends on moved
+                continue;
+            }
+            if (!AIScheduler::instance().trySpeculate(config.provider)) return;
+            
+            // Keep the newest plans; older ones assumed a position that has passed
+            while (speculations.size() >= 2 * MAX_SPECULATIVE_ROLLS) {
+                speculations.erase(speculations.begin());
+            }
+            Speculation speculation;
+            speculation.id = id = nextSpeculationId++;
+            speculation.playerId = playerId;
+            speculation.version = version;
+            speculation.key = std::move(key);
+            speculation.state = std::move(state);
+            speculations.push_back(std::move(speculation));
+        }
+        
+        double estimatedTokens = static_cast<double>(prompt.size() + 6000) / 4.0 + config.maxTokens;
+        std::weak_ptr<AITurnExecutor> weakSelf = weak_from_this();
+        AIScheduler::instance().submit(config.provider, AIScheduler::Priority::Speculative, estimatedTokens,
+            [weakSelf, id, prompt = std::move(prompt)]() {
+                if (auto self = weakSelf.lock()) {
+                    self->runSpeculation(id, prompt);
+                }
+            });
+    }
+}
+
+void AITurnExecutor::runSpeculation(uint64_t id, const std::string& prompt) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(speculations.begin(), speculations.end(),
+                               [&](const Speculation& s) { return s.id == id; });
+        if (it == speculations.end() || shouldStop) return;    // dropped while queued
+        it->started = true;
+    }
+    
+    LLMResponse response;
+    if (LLMProvider* llm = llmConfig.getProvider()) {
+        LLMMessage userMsg;
+        userMsg.role = LLMMessage::Role::User;
+        userMsg.content = prompt;
+        response = llm->chat({userMsg}, buildToolList(), buildSystemPrompt());
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        totalUsage.add(response);
+        for (Speculation& speculation : speculations) {
+            if (speculation.id != id) continue;
+            speculation.ready = true;
+            if (response.success && response.toolCall) speculation.call = response.toolCall;
+        }
+    }
+    speculationCv.notify_all();
+}
+
+std::optional<AITurnExecutor::Speculation> AITurnExecutor::takeSpeculation(int playerId, const AIGameState& state) {
+    std::string key = speculationKey(state);
+    auto matching = [&](const Speculation& s) { return s.playerId == playerId && s.key == key; };
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    if (speculations.empty()) return std::nullopt;
+    
+    // Already being asked: waiting for that answer beats asking again. A
+    // plan still in the speculative queue may not run for a long while
+    // (that queue only gets idle workers), so it is dropped below and the
+    // turn asks straight away.
+    auto inFlight = std::find_if(speculations.begin(), speculations.end(), matching);
+    if (inFlight != speculations.end() && inFlight->started) {
+        auto timeout = std::chrono::milliseconds(llmConfig.getConfig().requestTimeoutMs);
+        speculationCv.wait_for(lock, timeout, [&]() {
+            auto it = std::find_if(speculations.begin(), speculations.end(), matching);
+            return it == speculations.end() || it->ready || shouldStop;
+        });
+    }
+    
+    std::optional<Speculation> taken;
+    auto it = std::find_if(speculations.begin(), speculations.end(), matching);
+    if (it != speculations.end() && it->ready && it->call) {
+        taken = std::move(*it);
+        speculations.erase(it);
+        speculationHits++;
+    }
+    
+    // Whatever else was planned for this player assumed another position
+    size_t before = speculations.size();
+    speculations.erase(std::remove_if(speculations.begin(), speculations.end(),
+        [&](const Speculation& s) { return s.playerId == playerId; }), speculations.end());
+    speculationsStale += before - speculations.size();
+    return taken;
+}
+
+void AITurnExecutor::recordAction(int playerId, const std::string& playerName,
+                                  const std::string& toolName, const ToolResult& result) {
+    AIActionLogEntry logEntry;
+    logEntry.playerId = playerId;
+    logEntry.playerName = playerName;
+    logEntry.action = toolName;
+    logEntry.description = describeAction(toolName, result);
+    logEntry.success = result.success;
+    logEntry.error = result.success ? "" : result.message;
+    logEntry.timestamp = std::chrono::steady_clock::now();
+    
+    {
+        std::lock_guard<std::mutex> logLock(mutex);
+        actionLog.push_back(logEntry);
+    }
+    
+    // Broadcast SSE event
+    SSEEvent sseEvent = GameEvents::createAIActionEvent(
+        playerId, playerName,
+        logEntry.action, logEntry.description,
+        result.success
+    );
+    // A robber description names the stolen card, which spectators don't see
+    sseManager.broadcastToGame(gameId, sseEvent, toolName != "move_robber");
 }
 
 }  // namespace ai
@@ -9,13 +9,16 @@
 #include <mutex>
 #include <condition_variable>
 #include <queue>
+#include <memory>
 #include "catan_types.h"
+#include "game_actions.h"
 #include "llm_provider.h"
 
 // Forward declaration for SSE
 namespace catan {
     class SSEManager;
     extern SSEManager sseManager;
+    class JsonValue;
 }
 
 namespace catan {
@@ -151,6 +154,12 @@ struct ToolResult {
     std::string data;       // JSON data if applicable
 };
 
+// The game action a tool call asks for, with its arguments read as the tool
+// definitions spell them (hexQ/hexR/direction, give/receive, giveWood...,
+// tradeId). The REST bodies use the same names. Whether the action is
+// legal is left to applyAction.
+Action actionFromArguments(ActionType type, const JsonValue& args, int playerId);
+
 // ============================================================================
 // AI TOOL DEFINITIONS FOR LLM
 // These are serialized to JSON for the LLM to understand available actions
@@ -256,6 +265,11 @@ AIGameState getAIGameState(const Game& game, int playerId);
 // Convert AIGameState to JSON string
 std::string aiGameStateToJson(const AIGameState& state);
 
+// What changed between two states of the same player, for the later
+// prompts of a turn: phase, hand and available tools always, everything
+// else (new pieces, robber, other players, chat, trades) only if it moved
+std::string aiGameStateDeltaToJson(const AIGameState& before, const AIGameState& after);
+
 // ============================================================================
 // AI TURN PROCESSOR
 // Processes an AI player's turn by calling tools
@@ -317,7 +331,7 @@ struct AIActionLogEntry {
 // Handles processing AI turns on the server using LLM providers
 // ============================================================================
 
-class AITurnExecutor {
+class AITurnExecutor : public std::enable_shared_from_this<AITurnExecutor> {
 public:
     enum class Status {
         Idle,
@@ -327,16 +341,31 @@ public:
     };
     
 private:
-    Game* game;
+    std::shared_ptr<Game> game;     // kept alive while steps are queued
     std::string gameId;  // For SSE broadcasting
     LLMConfigManager& llmConfig;
     
-    // Processing state
+    // Processing state. Work runs as steps on the shared AIScheduler; a
+    // step belongs to the run it was scheduled for, so steps left queued
+    // by a stopped run are ignored.
     std::atomic<Status> status{Status::Idle};
     std::atomic<bool> shouldStop{false};
-    std::thread processingThread;
+    uint64_t generation = 0;            // guarded by mutex
+    bool stepRunning = false;           // guarded by mutex
+    std::condition_variable stepCv;
     mutable std::mutex mutex;
     
+    // Conversation for the AI turn in progress (touched only by the running step)
+    struct TurnProgress {
+        int playerId = -1;              // -1 = next step starts a new turn
+        std::vector<LLMMessage> messages;
+        int actionCount = 0;
+        int staleRetries = 0;
+        bool localRejected = false;     // a locally chosen move failed; ask the model instead
+        std::optional<AIGameState> shown;   // state the conversation last described
+    };
+    TurnProgress turn;
+    
     // Action log
     mutable std::vector<AIActionLogEntry> actionLog;
     
@@ -344,15 +373,69 @@ private:
     int currentAIPlayerId = -1;
     std::string lastError;
     
+    // Decisions discarded because the game changed during the LLM call
+    std::atomic<uint64_t> staleSnapshots{0};
+    static constexpr int MAX_STALE_RETRIES = 3;
+    
+    // Model traffic of the turn in progress, the one before it and the
+    // executor's lifetime (all guarded by mutex)
+    struct TurnUsage {
+        int requests = 0;
+        uint64_t requestBytes = 0;
+        uint64_t inputTokens = 0;
+        uint64_t cachedInputTokens = 0;
+        uint64_t cacheWriteTokens = 0;
+        uint64_t outputTokens = 0;
+        
+        void add(const LLMResponse& response);
+    };
+    TurnUsage currentTurnUsage;
+    TurnUsage lastTurnUsage;
+    TurnUsage totalUsage;
+    
+    // Speculative first decisions for the next AI player's turn, asked for
+    // while an earlier turn is still being played. Each assumes one roll;
+    // the turn uses the one matching where it actually starts and drops
+    // the rest. Guarded by mutex.
+    struct Speculation {
+        uint64_t id = 0;
+        int playerId = -1;
+        uint64_t version = 0;               // game version it was planned from
+        std::string key;                    // speculationKey() of the state it assumes
+        AIGameState state;                  // as shown to the model
+        std::optional<LLMToolCall> call;    // the model's answer
+        bool started = false;               // request sent (off the speculative queue)
+        bool ready = false;                 // answered (call may still be empty)
+    };
+    std::vector<Speculation> speculations;
+    uint64_t nextSpeculationId = 1;
+    uint64_t speculatedVersion = 0;     // last version speculateNextTurn planned from
+    std::condition_variable speculationCv;
+    std::atomic<uint64_t> speculationHits{0};
+    std::atomic<uint64_t> speculationsStale{0};
+    static constexpr size_t MAX_SPECULATIVE_ROLLS = 2;
+    
+    // Moves played without a model round-trip (a provider that plays from
+    // the game, or the hybrid front stage) versus model calls made
+    std::atomic<uint64_t> localActions{0};
+    std::atomic<uint64_t> llmCalls{0};
+    
     // Helper methods
-    std::string buildSystemPrompt() const;
-    std::string buildUserMessage(const AIGameState& state) const;
-    std::vector<LLMTool> buildToolList() const;
+    // The system prompt and tools are the same for every request, so they
+    // are built once per process; providers mark them as a cacheable prefix
+    static const std::string& buildSystemPrompt();
+    static const std::vector<LLMTool>& buildToolList();
+    
+    // The full state for a turn's first prompt, then only what changed
+    // since `previous`
+    std::string buildUserMessage(const AIGameState& state, const AIGameState* previous) const;
     ToolResult executeToolCall(const LLMToolCall& toolCall, int playerId);
     std::string describeAction(const std::string& toolName, const ToolResult& result) const;
+    void recordAction(int playerId, const std::string& playerName,
+                      const std::string& toolName, const ToolResult& result);
     
 public:
-    AITurnExecutor(Game* game, const std::string& gameId, LLMConfigManager& llmConfig);
+    AITurnExecutor(std::shared_ptr<Game> game, const std::string& gameId, LLMConfigManager& llmConfig);
     ~AITurnExecutor();
     
     // Start processing AI turns (non-blocking)
@@ -383,11 +466,42 @@ public:
     std::string statusToJson() const;
     
 private:
-    // Main processing loop (runs in thread)
-    void processAITurns();
+    enum class StepOutcome {
+        Continue,       // more actions in this turn
+        TurnDone,       // turn ended (or hit the action limit)
+        Requeue,        // a step queued as local needs the model after all
+        Failed          // unrecoverable error, lastError is set
+    };
+    
+    // Queue the next step of run `gen` on the scheduler. A local step is
+    // played without the model and is not charged to the provider's limits.
+    void scheduleStep(uint64_t gen, bool local);
+    
+    // Whether the next step will be played without calling the model
+    bool nextStepIsLocal() const;
+    
+    // Scheduler entry point: starts a turn if needed and performs one action
+    void runStep(uint64_t gen, bool local);
+    
+    // One snapshot -> LLM -> apply cycle for the turn in progress. A step
+    // queued as local does not call the model; it asks to be queued again.
+    StepOutcome processAIAction(bool local);
+    
+    // The move to play without asking the model, if any. Call with the
+    // game lock held.
+    std::optional<LLMToolCall> localDecision(LLMProvider& llm, int playerId) const;
+    
+    // Applies a local decision made at snapshotVersion
+    StepOutcome applyLocalAction(const LLMToolCall& call, int playerId, uint64_t snapshotVersion);
+    
+    // Plans the next player's first decision if they are an AI, the
+    // provider is remote and its speculation budget allows
+    void speculateNextTurn();
+    void runSpeculation(uint64_t id, const std::string& prompt);
     
-    // Process a single AI player's turn
-    bool processSingleAITurn(int playerId);
+    // The speculation made for this state, waiting for its answer if it is
+    // still in flight. Drops every other speculation for the player.
+    std::optional<Speculation> takeSpeculation(int playerId, const AIGameState& state);
 };
 
 // ============================================================================
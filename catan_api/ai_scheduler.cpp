@@ -0,0 +1,295 @@
+#include "ai_scheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace catan {
+namespace ai {
+
+// ============================================================================
+// AI SCHEDULER IMPLEMENTATION
+// ============================================================================
+
+AIScheduler::AIScheduler(int workerCount) {
+    if (workerCount <= 0) {
+        const char* env = std::getenv("CATAN_AI_WORKERS");
+        workerCount = (env && *env) ? std::atoi(env) : 32;
+        workerCount = std::max(1, workerCount);
+    }
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+AIScheduler::~AIScheduler() {
+    shutdown();
+}
+
+AIScheduler& AIScheduler::instance() {
+    static AIScheduler scheduler;
+    return scheduler;
+}
+
+void AIScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+AIScheduler::ProviderLimits AIScheduler::defaultLimits(const std::string& provider) {
+    ProviderLimits limits;
+    // Local providers make no network calls, so the remote API limits don't apply
+    if (provider == "mock" || provider == "heuristic") {
+        limits.maxConcurrent = 64;
+        limits.requestsPerSecond = 0;
+        limits.tokensPerSecond = 0;
+    }
+    return limits;
+}
+
+AIScheduler::ProviderState& AIScheduler::providerFor(const std::string& name) {
+    auto it = providers.find(name);
+    if (it == providers.end()) {
+        ProviderState state;
+        state.limits = defaultLimits(name);
+        state.requestBudget = std::max(1.0, state.limits.requestsPerSecond);
+        state.tokenBudget = state.limits.tokensPerSecond;
+        state.speculationBudget = std::max(1.0, state.limits.speculationsPerSecond * SPECULATION_BURST_SECONDS);
+        it = providers.emplace(name, state).first;
+    }
+    return it->second;
+}
+
+void AIScheduler::setProviderLimits(const std::string& provider, const ProviderLimits& limits) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ProviderState& state = providerFor(provider);
+        state.limits = limits;
+        state.requestBudget = std::min(state.requestBudget, std::max(1.0, limits.requestsPerSecond));
+        state.tokenBudget = std::min(state.tokenBudget, limits.tokensPerSecond);
+    }
+    cv.notify_all();
+}
+
+AIScheduler::ProviderLimits AIScheduler::getProviderLimits(const std::string& provider) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = providers.find(provider);
+    return it != providers.end() ? it->second.limits : defaultLimits(provider);
+}
+
+void AIScheduler::submit(const std::string& provider, Priority priority, double estimatedTokens, Task task) {
+    enqueue(priority, QueuedTask{provider, estimatedTokens, std::move(task), Clock::now()});
+}
+
+void AIScheduler::submitLocal(const std::string& provider, Priority priority, Task task) {
+    QueuedTask queued{provider, 0, std::move(task), Clock::now()};
+    queued.local = true;
+    enqueue(priority, std::move(queued));
+}
+
+void AIScheduler::enqueue(Priority priority, QueuedTask task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        providerFor(task.provider);
+        if (priority == Priority::HumanWaiting) {
+            humanQueue.push_back(std::move(task));
+        } else if (priority == Priority::Speculative) {
+            speculativeQueue.push_back(std::move(task));
+        } else {
+            backgroundQueue.push_back(std::move(task));
+        }
+    }
+    cv.notify_one();
+}
+
+bool AIScheduler::trySpeculate(const std::string& provider) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) return false;
+    ProviderState& state = providerFor(provider);
+    const ProviderLimits& limits = state.limits;
+
+    auto now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - state.lastSpeculationRefill).count();
+    state.lastSpeculationRefill = now;
+    state.speculationBudget = std::min(std::max(1.0, limits.speculationsPerSecond * SPECULATION_BURST_SECONDS),
+                                       state.speculationBudget + elapsed * limits.speculationsPerSecond);
+
+    // Real requests held back by the limits come first
+    auto waiting = [&](const std::deque<QueuedTask>& queue) {
+        return std::any_of(queue.begin(), queue.end(),
+                           [&](const QueuedTask& task) { return task.provider == provider; });
+    };
+    bool requestsTight = waiting(humanQueue) || waiting(backgroundQueue);
+    if (limits.speculationsPerSecond <= 0 || state.speculationBudget < 1.0 || requestsTight) {
+        state.speculationsDenied++;
+        return false;
+    }
+    state.speculationBudget -= 1.0;
+    state.speculationsGranted++;
+    return true;
+}
+
+bool AIScheduler::admit(ProviderState& provider, QueuedTask& task, Clock::time_point now,
+                        Clock::time_point& wakeAt) {
+    const ProviderLimits& limits = provider.limits;
+    if (provider.inFlight >= limits.maxConcurrent) {
+        return false;  // a finishing step will notify
+    }
+
+    // Refill both token buckets; each holds at most one second of budget
+    double elapsed = std::chrono::duration<double>(now - provider.lastRefill).count();
+    provider.lastRefill = now;
+    if (limits.requestsPerSecond > 0) {
+        provider.requestBudget = std::min(std::max(1.0, limits.requestsPerSecond),
+                                          provider.requestBudget + elapsed * limits.requestsPerSecond);
+    }
+    if (limits.tokensPerSecond > 0) {
+        provider.tokenBudget = std::min(limits.tokensPerSecond,
+                                        provider.tokenBudget + elapsed * limits.tokensPerSecond);
+    }
+
+    // A step bigger than the whole bucket runs once the bucket is full
+    double tokensNeeded = std::min(task.estimatedTokens, limits.tokensPerSecond);
+    bool requestsOk = limits.requestsPerSecond <= 0 || provider.requestBudget >= 1.0;
+    bool tokensOk = limits.tokensPerSecond <= 0 || provider.tokenBudget >= tokensNeeded;
+
+    if (!requestsOk || !tokensOk) {
+        double waitSeconds = 0;
+        if (!requestsOk) {
+            waitSeconds = std::max(waitSeconds, (1.0 - provider.requestBudget) / limits.requestsPerSecond);
+        }
+        if (!tokensOk) {
+            waitSeconds = std::max(waitSeconds, (tokensNeeded - provider.tokenBudget) / limits.tokensPerSecond);
+        }
+        auto readyAt = now + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(waitSeconds));
+        wakeAt = std::min(wakeAt, readyAt);
+        if (!task.throttled) {
+            task.throttled = true;
+            provider.throttled++;
+        }
+        return false;
+    }
+
+    if (limits.requestsPerSecond > 0) provider.requestBudget -= 1.0;
+    if (limits.tokensPerSecond > 0) provider.tokenBudget -= tokensNeeded;
+    return true;
+}
+
+bool AIScheduler::takeRunnable(std::deque<QueuedTask>& queue, Clock::time_point now,
+                               Clock::time_point& wakeAt, QueuedTask& out) {
+    size_t limit = std::min(queue.size(), SCAN_LIMIT);
+    for (size_t i = 0; i < limit; i++) {
+        ProviderState& provider = providerFor(queue[i].provider);
+        if (queue[i].local) {
+            out = std::move(queue[i]);
+            queue.erase(queue.begin() + static_cast<std::ptrdiff_t>(i));
+            provider.dispatchedLocal++;
+            return true;
+        }
+        if (!admit(provider, queue[i], now, wakeAt)) continue;
+
+        out = std::move(queue[i]);
+        queue.erase(queue.begin() + static_cast<std::ptrdiff_t>(i));
+        provider.inFlight++;
+        provider.dispatched++;
+        provider.totalQueueMs += std::chrono::duration<double, std::milli>(now - out.enqueuedAt).count();
+        return true;
+    }
+    return false;
+}
+
+void AIScheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (running) {
+        auto now = Clock::now();
+        auto wakeAt = Clock::time_point::max();
+        QueuedTask next;
+
+        bool preferBackground = humanStreak >= HUMAN_BURST;
+        bool found = false;
+        if (preferBackground) {
+            found = takeRunnable(backgroundQueue, now, wakeAt, next);
+            if (found) humanStreak = 0;
+        }
+        if (!found) {
+            found = takeRunnable(humanQueue, now, wakeAt, next);
+            if (found) humanStreak++;
+        }
+        if (!found && !preferBackground) {
+            found = takeRunnable(backgroundQueue, now, wakeAt, next);
+            if (found) humanStreak = 0;
+        }
+        if (!found) {
+            found = takeRunnable(speculativeQueue, now, wakeAt, next);
+        }
+
+        if (!found) {
+            if (wakeAt == Clock::time_point::max()) {
+                cv.wait(lock);
+            } else {
+                cv.wait_until(lock, wakeAt);
+            }
+            continue;
+        }
+
+        lock.unlock();
+        try {
+            next.task();
+        } catch (const std::exception& e) {
+            std::cerr << "AI scheduler task failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+
+        if (!next.local) {
+            providerFor(next.provider).inFlight--;
+            cv.notify_one();  // a concurrency slot opened
+        }
+    }
+}
+
+std::string AIScheduler::statsToJson() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::ostringstream json;
+    json << "{";
+    json << "\"workers\":" << workers.size() << ",";
+    json << "\"queuedHumanWaiting\":" << humanQueue.size() << ",";
+    json << "\"queuedBackground\":" << backgroundQueue.size() << ",";
+    json << "\"queuedSpeculative\":" << speculativeQueue.size() << ",";
+    json << "\"providers\":{";
+    bool first = true;
+    for (const auto& entry : providers) {
+        const ProviderState& state = entry.second;
+        if (!first) json << ",";
+        first = false;
+        json << "\"" << entry.first << "\":{";
+        json << "\"maxConcurrent\":" << state.limits.maxConcurrent << ",";
+        json << "\"requestsPerSecond\":" << state.limits.requestsPerSecond << ",";
+        json << "\"tokensPerSecond\":" << state.limits.tokensPerSecond << ",";
+        json << "\"speculationsPerSecond\":" << state.limits.speculationsPerSecond << ",";
+        json << "\"speculationsGranted\":" << state.speculationsGranted << ",";
+        json << "\"speculationsDenied\":" << state.speculationsDenied << ",";
+        json << "\"inFlight\":" << state.inFlight << ",";
+        json << "\"dispatched\":" << state.dispatched << ",";
+        json << "\"dispatchedLocal\":" << state.dispatchedLocal << ",";
+        json << "\"throttled\":" << state.throttled << ",";
+        json << "\"avgQueueMs\":" << (state.dispatched ? state.totalQueueMs / state.dispatched : 0.0);
+        json << "}";
+    }
+    json << "}";
+    json << "}";
+    return json.str();
+}
+
+}  // namespace ai
+}  // namespace catan
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+namespace catan {
+namespace ai {
+
+// ============================================================================
+// AI SCHEDULER
+// Process-wide pool that runs AI work for every game. Executors submit one
+// step at a time (an LLM call plus applying its tool call); the scheduler
+// decides when each step may run based on the provider's concurrency and
+// rate limits, and prefers games where a human is waiting.
+// ============================================================================
+
+class AIScheduler {
+public:
+    enum class Priority {
+        HumanWaiting,   // a human is at the table watching the clock
+        Background,     // AI-only games
+        Speculative     // work that may be thrown away; runs only when nothing else can
+    };
+
+    // Limits per provider name ("anthropic", "openai", "mock", ...).
+    // A rate of 0 means unlimited.
+    struct ProviderLimits {
+        int maxConcurrent = 16;
+        double requestsPerSecond = 10.0;
+        double tokensPerSecond = 80000.0;
+        double speculationsPerSecond = 0.5;     // see trySpeculate; 0 disables speculation
+    };
+
+    using Task = std::function<void()>;
+
+    explicit AIScheduler(int workerCount = 0);
+    ~AIScheduler();
+
+    static AIScheduler& instance();
+
+    // Queue a step. estimatedTokens is charged against the provider's token
+    // bucket when the step is dispatched.
+    void submit(const std::string& provider, Priority priority, double estimatedTokens, Task task);
+
+    // Queue a step that is played without calling the provider (setup
+    // placements, forced moves). It takes a worker in priority order but is
+    // not held back by, or charged to, the provider's limits.
+    void submitLocal(const std::string& provider, Priority priority, Task task);
+
+    // Asks for one speculative call's worth of the provider's budget. Denied
+    // when its speculation bucket is empty or real requests for it are
+    // queued; a granted call is then submitted as Speculative. The bucket
+    // holds a few seconds' worth, enough to plan several rolls at once.
+    bool trySpeculate(const std::string& provider);
+
+    void setProviderLimits(const std::string& provider, const ProviderLimits& limits);
+    ProviderLimits getProviderLimits(const std::string& provider) const;
+
+    void shutdown();
+
+    std::string statsToJson() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double SPECULATION_BURST_SECONDS = 4.0;
+
+    struct QueuedTask {
+        std::string provider;
+        double estimatedTokens;
+        Task task;
+        Clock::time_point enqueuedAt;
+        bool throttled = false;         // already counted in ProviderState::throttled
+        bool local = false;             // see submitLocal
+    };
+
+    struct ProviderState {
+        ProviderLimits limits;
+        int inFlight = 0;
+        double requestBudget = 0;
+        double tokenBudget = 0;
+        Clock::time_point lastRefill = Clock::now();
+
+        uint64_t dispatched = 0;
+        uint64_t dispatchedLocal = 0;   // steps run through submitLocal
+        uint64_t throttled = 0;         // steps that had to wait for rate budget
+        double totalQueueMs = 0;
+
+        double speculationBudget = 0;
+        Clock::time_point lastSpeculationRefill = Clock::now();
+        uint64_t speculationsGranted = 0;
+        uint64_t speculationsDenied = 0;
+    };
+
+    // Human-priority steps may run this many times in a row before a
+    // runnable background step gets a turn, so AI-only games never starve
+    static constexpr int HUMAN_BURST = 4;
+    static constexpr size_t SCAN_LIMIT = 32;
+
+    std::vector<std::thread> workers;
+    std::deque<QueuedTask> humanQueue;
+    std::deque<QueuedTask> backgroundQueue;
+    std::deque<QueuedTask> speculativeQueue;
+    std::unordered_map<std::string, ProviderState> providers;
+    int humanStreak = 0;
+    bool running = true;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+
+    void workerLoop();
+    ProviderState& providerFor(const std::string& name);
+    void enqueue(Priority priority, QueuedTask task);
+    static ProviderLimits defaultLimits(const std::string& provider);
+
+    // Finds a dispatchable step in the queue; if every candidate is throttled,
+    // lowers wakeAt to the earliest time one could run. Caller holds mutex.
+    bool takeRunnable(std::deque<QueuedTask>& queue, Clock::time_point now,
+                      Clock::time_point& wakeAt, QueuedTask& out);
+    bool admit(ProviderState& provider, QueuedTask& task, Clock::time_point now,
+               Clock::time_point& wakeAt);
+};
+
+}  // namespace ai
+}  // namespace catan
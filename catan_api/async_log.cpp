@@ -0,0 +1,136 @@
+#include "async_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace catan {
+
+namespace {
+
+constexpr size_t BATCH_BYTES = 64 * 1024;
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(50);
+
+size_t roundUpPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+}  // namespace
+
+AsyncLog::AsyncLog(int fd, size_t capacity)
+    : fd(fd), mask(roundUpPowerOfTwo(capacity < 2 ? 2 : capacity) - 1),
+      slots(std::make_unique<Slot[]>(mask + 1)) {
+    for (size_t i = 0; i <= mask; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+AsyncLog::~AsyncLog() {
+    stop();
+}
+
+void AsyncLog::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread(&AsyncLog::run, this);
+}
+
+void AsyncLog::stop() {
+    if (!running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCv.notify_one();
+    if (thread.joinable()) thread.join();
+    drain();
+}
+
+void AsyncLog::write(std::string_view line) {
+    size_t length = std::min(line.size(), LINE_BYTES - 1);
+    bool newline = length == 0 || line[length - 1] != '\n';
+
+    if (!running.load(std::memory_order_relaxed)) {
+        std::string text(line.substr(0, length));
+        if (newline) text += '\n';
+        writeAll(text.data(), text.size());
+        written.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Claim a slot: it is free when its sequence equals the position
+    uint64_t pos = tail.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[pos & mask];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);    // full
+            return;
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::memcpy(slot->text, line.data(), length);
+    if (newline) slot->text[length++] = '\n';
+    slot->length = static_cast<uint16_t>(length);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // The writer wakes on its own every IDLE_WAIT; a nudge every 64 lines
+    // keeps a burst from filling the ring without a notify per line
+    if (sleeping.load(std::memory_order_relaxed) && (pos & 63) == 0) {
+        wakeCv.notify_one();
+    }
+}
+
+size_t AsyncLog::drain() {
+    char batch[BATCH_BYTES];
+    size_t used = 0;
+    size_t lines = 0;
+
+    for (;;) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;   // not published yet
+        if (used + slot.length > sizeof(batch)) {
+            writeAll(batch, used);
+            used = 0;
+        }
+        std::memcpy(batch + used, slot.text, slot.length);
+        used += slot.length;
+        slot.sequence.store(head + mask + 1, std::memory_order_release);       // free for the next lap
+        head++;
+        lines++;
+    }
+
+    if (used > 0) writeAll(batch, used);
+    written.fetch_add(lines, std::memory_order_relaxed);
+    return lines;
+}
+
+void AsyncLog::run() {
+    while (running.load()) {
+        if (drain() > 0) continue;
+        sleeping.store(true);
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCv.wait_for(lock, IDLE_WAIT);
+        sleeping.store(false);
+    }
+}
+
+void AsyncLog::writeAll(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;     // nowhere to report it
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+}
+
+}  // namespace catan
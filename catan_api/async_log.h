@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace catan {
+
+// ============================================================================
+// ASYNC LOG
+// Log lines are copied into a fixed ring of slots by the calling thread and
+// written to the file descriptor by a background thread, many lines to a
+// write() call. Logging costs a copy and a couple of atomics and never waits
+// on the output; when the ring is full the line is dropped and counted.
+// The ring is a bounded multi-producer queue (sequence number per slot), so
+// producers never take a lock.
+// ============================================================================
+
+class AsyncLog {
+public:
+    static constexpr size_t LINE_BYTES = 248;   // longer lines are cut short
+
+    explicit AsyncLog(int fd = 1, size_t capacity = 8192);     // capacity is rounded up to a power of two
+    ~AsyncLog();                                                // writes out what is queued
+
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog& operator=(const AsyncLog&) = delete;
+
+    void start();
+    void stop();
+
+    // Queues one line; a newline is added if it lacks one. Before start()
+    // (or after stop()) the line is written straight away.
+    void write(std::string_view line);
+
+    uint64_t writtenLines() const { return written.load(std::memory_order_relaxed); }
+    uint64_t droppedLines() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        uint16_t length = 0;
+        char text[LINE_BYTES];
+    };
+
+    int fd;
+    size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(64) std::atomic<uint64_t> tail{0};     // next slot to claim
+    alignas(64) uint64_t head = 0;                  // next slot to drain; writer thread only
+
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> dropped{0};
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> sleeping{false};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    std::thread thread;
+
+    void run();
+    size_t drain();         // writes out what is ready; returns lines written
+    void writeAll(const char* data, size_t length);
+};
+
+}  // namespace catan
@@ -1,8 +1,7 @@
 #include "catan_types.h"
-#include <random>
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
+#include <map>
+#include <charconv>
 
 namespace catan {
 
@@ -11,90 +10,262 @@ namespace catan {
 // ============================================================================
 
 static std::string generateGameId() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 15);
-    
-    std::stringstream ss;
-    for (int i = 0; i < 8; i++) {
-        ss << std::hex << dis(gen);
-    }
-    return ss.str();
+    return secureRandomHex(4);
 }
 
 std::string GameManager::createGame(const std::string& name, int maxPlayers) {
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    std::string gameId = generateGameId();
-    
-    auto game = std::make_unique<Game>();
-    game->gameId = gameId;
+    auto game = std::make_shared<Game>();
     game->name = name;
     game->maxPlayers = maxPlayers;
     game->phase = GamePhase::WaitingForPlayers;
-    game->board = generateRandomBoard();
+    seedGame(*game, secureRandom64());
     game->createdAt = std::chrono::steady_clock::now();
-    game->lastActivity = game->createdAt;
-    
-    // Initialize dev card deck (25 cards total in base game)
-    game->devCardDeck = {
-        // 14 Knights
-        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
-        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
-        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
-        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
-        DevCardType::Knight, DevCardType::Knight,
-        // 5 Victory Points
-        DevCardType::VictoryPoint, DevCardType::VictoryPoint,
-        DevCardType::VictoryPoint, DevCardType::VictoryPoint,
-        DevCardType::VictoryPoint,
-        // 2 Road Building
-        DevCardType::RoadBuilding, DevCardType::RoadBuilding,
-        // 2 Year of Plenty
-        DevCardType::YearOfPlenty, DevCardType::YearOfPlenty,
-        // 2 Monopoly
-        DevCardType::Monopoly, DevCardType::Monopoly
-    };
+    game->touch();
+    game->chatMessages = ChatHistory(chatHistoryLimit);
+    game->tradeOffers = TradeBook(tradeHistoryLimit);
     
-    // Shuffle the deck
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(game->devCardDeck.begin(), game->devCardDeck.end(), g);
-    
-    games[gameId] = std::move(game);
+    // Only the insert locks, and only the id's stripe; retry on the
+    // (unlikely) id collision
+    std::string gameId;
+    do {
+        gameId = idPrefix + generateGameId();
+        game->gameId = gameId;
+    } while (!games.insert(gameId, std::move(game)));
     return gameId;
 }
 
-Game* GameManager::getGame(const std::string& gameId) {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto it = games.find(gameId);
-    if (it != games.end()) {
-        return it->second.get();
+std::shared_ptr<Game> GameManager::getGame(const std::string& gameId) {
+    std::shared_ptr<Game> result = getLoadedGame(gameId);
+    if (result || !loader) return result;
+    
+    // Load outside any lock; if another thread loaded it first, use theirs
+    auto game = std::make_shared<Game>();
+    game->chatMessages = ChatHistory(chatHistoryLimit);
+    game->tradeOffers = TradeBook(tradeHistoryLimit);
+    if (!loader(gameId, *game)) return nullptr;
+    game->gameId = gameId;
+    
+    result = game;
+    if (!games.insert(gameId, std::move(game))) {
+        result = getLoadedGame(gameId);
     }
-    return nullptr;
+    return result;
+}
+
+std::shared_ptr<Game> GameManager::installGame(const std::string& gameId,
+                                               const std::function<bool(Game& game)>& fill) {
+    auto game = std::make_shared<Game>();
+    game->chatMessages = ChatHistory(chatHistoryLimit);
+    game->tradeOffers = TradeBook(tradeHistoryLimit);
+    if (!fill(*game)) return nullptr;
+    game->gameId = gameId;
+    
+    std::shared_ptr<Game> result = game;
+    if (!games.insert(gameId, std::move(game))) return nullptr;
+    return result;
+}
+
+std::shared_ptr<Game> GameManager::getLoadedGame(const std::string& gameId) const {
+    std::shared_ptr<Game> result;
+    games.visit(gameId, [&](const std::shared_ptr<Game>& game) { result = game; });
+    return result;
 }
 
 std::vector<std::string> GameManager::listGames() {
-    std::lock_guard<std::mutex> lock(mutex);
     std::vector<std::string> result;
-    for (const auto& pair : games) {
-        if (!pair.second->isPrivate) {
-            result.push_back(pair.first);
+    games.forEach([&](const std::string& gameId, const std::shared_ptr<Game>& game) {
+        if (!game->isPrivate) {
+            result.push_back(gameId);
         }
-    }
+    });
     return result;
 }
 
 bool GameManager::removeGame(const std::string& gameId) {
-    std::lock_guard<std::mutex> lock(mutex);
-    return games.erase(gameId) > 0;
+    return games.erase(gameId);
 }
 
 size_t GameManager::gameCount() const {
-    std::lock_guard<std::mutex> lock(mutex);
     return games.size();
 }
 
+std::vector<std::shared_ptr<Game>> GameManager::gamesInStripe(size_t stripe) const {
+    std::vector<std::shared_ptr<Game>> result;
+    games.forEachInStripe(stripe, [&](const std::string&, const std::shared_ptr<Game>& game) {
+        result.push_back(game);
+    });
+    return result;
+}
+
+// ============================================================================
+// METRICS
+// ============================================================================
+
+const GameLockMetrics& gameLockMetrics() {
+    static const GameLockMetrics lockMetrics = [] {
+        const char* help = "Time spent waiting for a game lock";
+        const char* holdHelp = "Time a game lock was held";
+        std::string read = metricLabels({{"mode", "read"}});
+        std::string write = metricLabels({{"mode", "write"}});
+        GameLockMetrics m;
+        m.wait[static_cast<int>(GameLock::Mode::Read)] = &metrics().histogram("catan_game_lock_wait_seconds", help, read);
+        m.wait[static_cast<int>(GameLock::Mode::Write)] = &metrics().histogram("catan_game_lock_wait_seconds", help, write);
+        m.hold[static_cast<int>(GameLock::Mode::Read)] = &metrics().histogram("catan_game_lock_hold_seconds", holdHelp, read);
+        m.hold[static_cast<int>(GameLock::Mode::Write)] = &metrics().histogram("catan_game_lock_hold_seconds", holdHelp, write);
+        return m;
+    }();
+    return lockMetrics;
+}
+
+const BoardComputeMetrics& boardComputeMetrics() {
+    static const BoardComputeMetrics computeMetrics = [] {
+        const char* help = "Time spent in board computations";
+        BoardComputeMetrics m;
+        m.longestRoad = &metrics().histogram("catan_board_compute_seconds", help,
+                                             metricLabels({{"op", "longest_road"}}));
+        m.legalMoves = &metrics().histogram("catan_board_compute_seconds", help,
+                                            metricLabels({{"op", "legal_moves"}}));
+        return m;
+    }();
+    return computeMetrics;
+}
+
+// ============================================================================
+// CHAT AND TRADE HISTORY
+// ============================================================================
+
+std::string_view TextArena::store(std::string_view text, uint64_t messageId) {
+    if (chunks.empty() || chunks.back().capacity - chunks.back().used < text.size()) {
+        Chunk chunk;
+        if (spare.data && spare.capacity >= text.size()) {
+            chunk = std::move(spare);
+            spare = Chunk();
+        } else {
+            chunk.capacity = std::max(CHUNK_SIZE, text.size());
+            chunk.data.reset(new char[chunk.capacity]);
+        }
+        chunk.used = 0;
+        chunks.push_back(std::move(chunk));
+    }
+    Chunk& chunk = chunks.back();
+    char* dest = chunk.data.get() + chunk.used;
+    std::copy(text.begin(), text.end(), dest);
+    chunk.used += text.size();
+    chunk.lastMessageId = messageId;
+    return std::string_view(dest, text.size());
+}
+
+void TextArena::releaseThrough(uint64_t messageId) {
+    // The newest chunk is still being filled
+    while (chunks.size() > 1 && chunks.front().lastMessageId <= messageId) {
+        if (chunks.front().capacity == CHUNK_SIZE) {
+            spare = std::move(chunks.front());
+        }
+        chunks.pop_front();
+    }
+}
+
+size_t TextArena::bytesReserved() const {
+    size_t total = spare.capacity;
+    for (const auto& chunk : chunks) total += chunk.capacity;
+    return total;
+}
+
+void ChatHistory::append(const ChatMessage& message) {
+    uint64_t id = 0;
+    std::from_chars(message.id.data(), message.id.data() + message.id.size(), id);
+
+    if (count == ring.size()) {
+        uint64_t evicted = ring[head].id;
+        ring[head] = ChatEntry();
+        head = (head + 1) % ring.size();
+        count--;
+        arena.releaseThrough(evicted);
+    }
+
+    ChatEntry& entry = ring[(head + count) % ring.size()];
+    entry.id = id;
+    entry.fromPlayerId = message.fromPlayerId;
+    entry.toPlayerId = message.toPlayerId;
+    entry.content = arena.store(message.content, id);
+    entry.type = message.type;
+    entry.relatedTradeId = message.relatedTradeId;
+    entry.timestamp = message.timestamp;
+    entry.tradeOffering = message.tradeOffering;
+    entry.tradeRequesting = message.tradeRequesting;
+    count++;
+}
+
+size_t ChatHistory::firstAfter(uint64_t sinceId) const {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (at(mid).id <= sinceId) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void TradeBook::add(const TradeOffer& offer) {
+    // Keep ids contiguous so find() is an index; a skipped id becomes an
+    // inactive placeholder
+    while (!offers.empty() && offers.back().id + 1 < offer.id) {
+        TradeOffer gap{};
+        gap.id = offers.back().id + 1;
+        gap.isActive = false;
+        offers.push_back(gap);
+    }
+    offers.push_back(offer);
+    if (offer.isActive) activeIds.push_back(offer.id);
+
+    // Trades age out from the front. An offer nobody answered expires with
+    // it, so unanswered offers can't grow the book without limit
+    while (offers.size() > limit) {
+        offers.pop_front();
+    }
+    activeIds.erase(std::remove_if(activeIds.begin(), activeIds.end(), [this](int id) {
+        const TradeOffer* active = find(id);
+        return !active || !active->isActive;
+    }), activeIds.end());
+}
+
+TradeOffer* TradeBook::find(int id) {
+    return const_cast<TradeOffer*>(static_cast<const TradeBook*>(this)->find(id));
+}
+
+const TradeOffer* TradeBook::find(int id) const {
+    if (offers.empty() || id < offers.front().id) return nullptr;
+    size_t index = static_cast<size_t>(id - offers.front().id);
+    return index < offers.size() ? &offers[index] : nullptr;
+}
+
+// ============================================================================
+// DEVELOPMENT CARDS
+// ============================================================================
+
+// 25 cards in the base game
+std::vector<DevCardType> standardDevCardDeck() {
+    return {
+        // 14 Knights
+        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
+        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
+        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
+        DevCardType::Knight, DevCardType::Knight, DevCardType::Knight,
+        DevCardType::Knight, DevCardType::Knight,
+        // 5 Victory Points
+        DevCardType::VictoryPoint, DevCardType::VictoryPoint,
+        DevCardType::VictoryPoint, DevCardType::VictoryPoint,
+        DevCardType::VictoryPoint,
+        // 2 Road Building
+        DevCardType::RoadBuilding, DevCardType::RoadBuilding,
+        // 2 Year of Plenty
+        DevCardType::YearOfPlenty, DevCardType::YearOfPlenty,
+        // 2 Monopoly
+        DevCardType::Monopoly, DevCardType::Monopoly
+    };
+}
+
 // ============================================================================
 // BOARD GENERATION
 // ============================================================================
@@ -126,63 +297,28 @@ static const std::vector<int> STANDARD_NUMBERS = {
     2, 3, 3, 4, 4, 5, 5, 6, 6, 8, 8, 9, 9, 10, 10, 11, 11, 12
 };
 
-GameBoard generateRandomBoard() {
+GameBoard generateRandomBoard(GameRng& rng) {
     GameBoard board;
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    const BoardTopology& topo = boardTopology();
     
     // Shuffle resources
     std::vector<HexType> resources = STANDARD_RESOURCES;
-    std::shuffle(resources.begin(), resources.end(), gen);
+    rng.shuffle(resources.begin(), resources.end());
     
     // Shuffle numbers
     std::vector<int> numbers = STANDARD_NUMBERS;
-    std::shuffle(numbers.begin(), numbers.end(), gen);
+    rng.shuffle(numbers.begin(), numbers.end());
     
-    // Place hexes
+    // Place hexes (HexId i is LAND_HEX_COORDS[i])
     int numberIndex = 0;
-    for (size_t i = 0; i < LAND_HEX_COORDS.size(); i++) {
-        Hex hex;
-        hex.coord = LAND_HEX_COORDS[i];
-        hex.type = resources[i];
-        hex.hasRobber = (hex.type == HexType::Desert);
+    for (HexId h = 0; h < NUM_HEXES; h++) {
+        board.hexType[h] = resources[h];
         
-        if (hex.type == HexType::Desert) {
-            hex.numberToken = 0;
-            board.robberLocation = hex.coord;
+        if (resources[h] == HexType::Desert) {
+            board.numberToken[h] = 0;
+            board.robberHex = h;
         } else {
-            hex.numberToken = numbers[numberIndex++];
-        }
-        
-        board.hexes[hex.coord] = hex;
-    }
-    
-    // Initialize vertices (each hex has 6 corners)
-    for (const auto& hexCoord : LAND_HEX_COORDS) {
-        for (int dir = 0; dir < 6; dir++) {
-            VertexCoord vc{hexCoord, dir};
-            if (board.vertices.find(vc) == board.vertices.end()) {
-                Vertex v;
-                v.coord = vc;
-                v.building = Building::None;
-                v.ownerPlayerId = -1;
-                board.vertices[vc] = v;
-            }
-        }
-    }
-    
-    // Initialize edges (each hex has 6 edges)
-    for (const auto& hexCoord : LAND_HEX_COORDS) {
-        for (int dir = 0; dir < 6; dir++) {
-            EdgeCoord ec{hexCoord, dir};
-            if (board.edges.find(ec) == board.edges.end()) {
-                Edge e;
-                e.coord = ec;
-                e.hasRoad = false;
-                e.ownerPlayerId = -1;
-                board.edges[ec] = e;
-            }
+            board.numberToken[h] = static_cast<uint8_t>(numbers[numberIndex++]);
         }
     }
     
@@ -192,7 +328,7 @@ GameBoard generateRandomBoard() {
         PortType::Generic, PortType::Generic, PortType::Generic, PortType::Generic,
         PortType::Wood, PortType::Brick, PortType::Wheat, PortType::Sheep, PortType::Ore
     };
-    std::shuffle(portTypes.begin(), portTypes.end(), gen);
+    rng.shuffle(portTypes.begin(), portTypes.end());
     
     // Define port positions on the outer ring (vertices that touch only 1-2 land hexes)
     // These are the coastal vertices around the board
@@ -217,69 +353,366 @@ GameBoard generateRandomBoard() {
     // Assign port types to positions
     for (size_t i = 0; i < portTypes.size() && i < portPositions.size(); i++) {
         Port port;
-        port.vertex1 = portPositions[i].first;
-        port.vertex2 = portPositions[i].second;
+        port.vertex1 = topo.vertexId(portPositions[i].first);
+        port.vertex2 = topo.vertexId(portPositions[i].second);
         port.type = portTypes[i];
         board.ports.push_back(port);
     }
     
+    for (int total = 2; total <= 12; total++) {
+        board.updateProduction(total);
+    }
+    
     return board;
 }
 
+void seedGame(Game& game, uint64_t seed) {
+    game.seed = seed;
+    game.rng.seed(seed);
+    game.board = generateRandomBoard(game.rng);
+    game.devCardDeck = standardDevCardDeck();
+    game.rng.shuffle(game.devCardDeck.begin(), game.devCardDeck.end());
+}
+
 // ============================================================================
-// COORDINATE HELPERS
+// BOARD TOPOLOGY
 // ============================================================================
 
-// Direction offsets for axial hex coordinates
-static const int HEX_DIRECTIONS[6][2] = {
-    {0, -1},  // N
-    {1, -1},  // NE
-    {1, 0},   // SE
-    {0, 1},   // S
-    {-1, 1},  // SW
-    {-1, 0}   // NW
+// Corner positions of a pointy-top hex in the same layout the UI draws
+// (direction 0 at the top, clockwise). x is in units of sqrt(3)/2 * size and
+// y in units of size/2, so every corner of every hex lands on an integer
+// point and shared corners compare equal.
+static const int VERTEX_OFFSETS[6][2] = {
+    {0, -2}, {1, -1}, {1, 1}, {0, 2}, {-1, 1}, {-1, -1}
 };
 
-std::vector<VertexCoord> getAdjacentVertices(const HexCoord& hex) {
-    std::vector<VertexCoord> result;
-    for (int dir = 0; dir < 6; dir++) {
-        result.push_back({hex, dir});
+static std::pair<int, int> vertexPoint(const HexCoord& hex, int direction) {
+    return {2 * hex.q + hex.r + VERTEX_OFFSETS[direction][0],
+            3 * hex.r + VERTEX_OFFSETS[direction][1]};
+}
+
+// Edge d runs from corner d to corner d+1; its key is the sum of the two
+// corner points (twice the midpoint)
+static std::pair<int, int> edgePoint(const HexCoord& hex, int direction) {
+    auto a = vertexPoint(hex, direction);
+    auto b = vertexPoint(hex, (direction + 1) % 6);
+    return {a.first + b.first, a.second + b.second};
+}
+
+static void appendId(uint8_t* list, size_t size, uint8_t id) {
+    for (size_t i = 0; i < size; i++) {
+        if (list[i] == id) return;
+        if (list[i] == INVALID_ID) {
+            list[i] = id;
+            return;
+        }
     }
-    return result;
 }
 
-std::vector<EdgeCoord> getAdjacentEdges(const HexCoord& hex) {
-    std::vector<EdgeCoord> result;
-    for (int dir = 0; dir < 6; dir++) {
-        result.push_back({hex, dir});
+static BoardTopology buildBoardTopology() {
+    BoardTopology topo;
+    topo.hexLookup.fill(INVALID_ID);
+    topo.vertexLookup.fill(INVALID_ID);
+    topo.edgeLookup.fill(INVALID_ID);
+    for (auto& list : topo.vertexHexes) list.fill(INVALID_ID);
+    for (auto& list : topo.vertexEdges) list.fill(INVALID_ID);
+    for (auto& list : topo.vertexNeighbors) list.fill(INVALID_ID);
+    
+    // Number land hexes, corners and sides in LAND_HEX_COORDS order; the
+    // first spelling seen for a corner or side becomes its canonical one
+    std::map<std::pair<int, int>, VertexId> vertexByPoint;
+    std::map<std::pair<int, int>, EdgeId> edgeByPoint;
+    
+    for (HexId h = 0; h < NUM_HEXES; h++) {
+        const HexCoord& hex = LAND_HEX_COORDS[h];
+        topo.hexCoords[h] = hex;
+        topo.hexLookup[BoardTopology::gridCell(hex)] = h;
+        
+        for (int d = 0; d < 6; d++) {
+            auto vp = vertexPoint(hex, d);
+            auto vIt = vertexByPoint.find(vp);
+            if (vIt == vertexByPoint.end()) {
+                VertexId id = static_cast<VertexId>(vertexByPoint.size());
+                vIt = vertexByPoint.emplace(vp, id).first;
+                topo.vertexCoords[id] = {hex, d};
+            }
+            topo.hexVertices[h][d] = vIt->second;
+            appendId(topo.vertexHexes[vIt->second].data(), 3, h);
+            
+            auto ep = edgePoint(hex, d);
+            auto eIt = edgeByPoint.find(ep);
+            if (eIt == edgeByPoint.end()) {
+                EdgeId id = static_cast<EdgeId>(edgeByPoint.size());
+                eIt = edgeByPoint.emplace(ep, id).first;
+                topo.edgeCoords[id] = {hex, d};
+            }
+            topo.hexEdges[h][d] = eIt->second;
+        }
     }
-    return result;
+    
+    // Edge endpoints and the reverse vertex -> edge / vertex -> vertex lists
+    for (HexId h = 0; h < NUM_HEXES; h++) {
+        for (int d = 0; d < 6; d++) {
+            EdgeId e = topo.hexEdges[h][d];
+            VertexId a = topo.hexVertices[h][d];
+            VertexId b = topo.hexVertices[h][(d + 1) % 6];
+            topo.edgeVertices[e] = {a, b};
+            appendId(topo.vertexEdges[a].data(), 3, e);
+            appendId(topo.vertexEdges[b].data(), 3, e);
+            appendId(topo.vertexNeighbors[a].data(), 3, b);
+            appendId(topo.vertexNeighbors[b].data(), 3, a);
+        }
+    }
+    
+    // Bitboard forms of the adjacency lists
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        topo.vertexNeighborMask[v] = 0;
+        for (VertexId n : topo.vertexNeighbors[v]) {
+            if (n != INVALID_ID) topo.vertexNeighborMask[v] |= vertexBit(n);
+        }
+        topo.vertexEdgeMask[v] = EdgeMask();
+        for (EdgeId e : topo.vertexEdges[v]) {
+            if (e != INVALID_ID) topo.vertexEdgeMask[v] |= EdgeMask::bit(e);
+        }
+    }
+    for (EdgeId e = 0; e < NUM_EDGES; e++) {
+        topo.edgeVertexMask[e] = vertexBit(topo.edgeVertices[e][0]) | vertexBit(topo.edgeVertices[e][1]);
+    }
+    
+    // Spellings from ocean hexes resolve to the land corner or side they touch
+    for (int q = -BoardTopology::GRID_RADIUS; q <= BoardTopology::GRID_RADIUS; q++) {
+        for (int r = -BoardTopology::GRID_RADIUS; r <= BoardTopology::GRID_RADIUS; r++) {
+            HexCoord hex{q, r};
+            int cell = BoardTopology::gridCell(hex);
+            for (int d = 0; d < 6; d++) {
+                auto vIt = vertexByPoint.find(vertexPoint(hex, d));
+                if (vIt != vertexByPoint.end()) topo.vertexLookup[cell * 6 + d] = vIt->second;
+                auto eIt = edgeByPoint.find(edgePoint(hex, d));
+                if (eIt != edgeByPoint.end()) topo.edgeLookup[cell * 6 + d] = eIt->second;
+            }
+        }
+    }
+    
+    return topo;
 }
 
-std::vector<HexCoord> getHexesAdjacentToVertex(const VertexCoord& vertex) {
-    // A vertex touches up to 3 hexes
-    std::vector<HexCoord> result;
-    result.push_back(vertex.hex);
+const BoardTopology& boardTopology() {
+    static const BoardTopology topology = buildBoardTopology();
+    return topology;
+}
+
+// ============================================================================
+// BOARD MUTATORS
+// ============================================================================
+
+// Refresh the dice totals of the hexes around a vertex
+static void updateProductionAt(GameBoard& board, VertexId v) {
+    for (HexId h : boardTopology().vertexHexes[v]) {
+        if (h == INVALID_ID) break;
+        if (board.numberToken[h]) board.updateProduction(board.numberToken[h]);
+    }
+}
+
+void GameBoard::placeSettlement(VertexId v, int playerId) {
+    const BoardTopology& topo = boardTopology();
+    VertexMask bit = vertexBit(v);
     
-    // The two neighboring hexes depend on the vertex direction
-    int d1 = vertex.direction;
-    int d2 = (vertex.direction + 5) % 6;  // previous direction
+    // Unvalidated tool paths can build over someone else's piece
+    int previous = vertexOwner[v];
+    if (previous >= 0 && previous < MAX_PLAYERS) {
+        playerBuildings[previous] &= ~bit;
+        playerCities[previous] &= ~bit;
+    }
     
-    HexCoord neighbor1{
-        vertex.hex.q + HEX_DIRECTIONS[d1][0],
-        vertex.hex.r + HEX_DIRECTIONS[d1][1]
-    };
-    HexCoord neighbor2{
-        vertex.hex.q + HEX_DIRECTIONS[d2][0],
-        vertex.hex.r + HEX_DIRECTIONS[d2][1]
-    };
+    building[v] = Building::Settlement;
+    vertexOwner[v] = static_cast<int8_t>(playerId);
+    occupiedVertices |= bit;
+    blockedVertices |= bit | topo.vertexNeighborMask[v];
+    if (playerId >= 0 && playerId < MAX_PLAYERS) {
+        playerBuildings[playerId] |= bit;
+    }
     
-    result.push_back(neighbor1);
-    result.push_back(neighbor2);
+    updateProductionAt(*this, v);
     
-    return result;
+    // A building cuts opponents' roads through this vertex
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (playerRoadEnds[p] & bit) {
+            updateRoadComponents(p, topo.vertexEdgeMask[v]);
+        }
+    }
+}
+
+void GameBoard::upgradeToCity(VertexId v) {
+    building[v] = Building::City;
+    int owner = vertexOwner[v];
+    if (owner >= 0 && owner < MAX_PLAYERS) {
+        playerCities[owner] |= vertexBit(v);
+    }
+    updateProductionAt(*this, v);
+}
+
+void GameBoard::placeRoad(EdgeId e, int playerId) {
+    const BoardTopology& topo = boardTopology();
+    EdgeMask bit = EdgeMask::bit(e);
+    
+    int previous = roadOwner[e];
+    if (previous >= 0 && previous < MAX_PLAYERS) {
+        playerRoads[previous] &= ~bit;
+        playerRoadEnds[previous] = 0;
+        forEachEdge(playerRoads[previous], [&](EdgeId r) {
+            playerRoadEnds[previous] |= topo.edgeVertexMask[r];
+        });
+    }
+    
+    roadOwner[e] = static_cast<int8_t>(playerId);
+    occupiedEdges |= bit;
+    if (playerId >= 0 && playerId < MAX_PLAYERS) {
+        playerRoads[playerId] |= bit;
+        playerRoadEnds[playerId] |= topo.edgeVertexMask[e];
+    }
+    
+    // The new road can join components at either end; a replaced road can
+    // split its old owner's network
+    const auto& ends = topo.edgeVertices[e];
+    EdgeMask affected = topo.vertexEdgeMask[ends[0]] | topo.vertexEdgeMask[ends[1]];
+    if (previous >= 0 && previous < MAX_PLAYERS) {
+        updateRoadComponents(previous, affected);
+    }
+    if (playerId >= 0 && playerId < MAX_PLAYERS) {
+        updateRoadComponents(playerId, affected);
+    }
+}
+
+void GameBoard::moveRobber(HexId h) {
+    HexId previous = robberHex;
+    robberHex = h;
+    if (previous != INVALID_ID && numberToken[previous]) updateProduction(numberToken[previous]);
+    if (h != INVALID_ID && numberToken[h]) updateProduction(numberToken[h]);
+}
+
+// ============================================================================
+// PRODUCTION INDEX
+// ============================================================================
+
+void GameBoard::updateProduction(int total) {
+    const BoardTopology& topo = boardTopology();
+    auto& entries = production[total];
+    entries.clear();
+    
+    for (HexId h = 0; h < NUM_HEXES; h++) {
+        if (numberToken[h] != total || robberHex == h) continue;
+        Resource resource = hexTypeToResource(hexType[h]);
+        if (resource == Resource::None) continue;
+        
+        for (VertexId v : topo.hexVertices[h]) {
+            int owner = vertexOwner[v];
+            if (owner < 0) continue;
+            int amount = (building[v] == Building::City) ? 2 : 1;
+            
+            auto it = std::find_if(entries.begin(), entries.end(), [&](const ProductionEntry& e) {
+                return e.playerId == owner && e.resource == resource;
+            });
+            if (it != entries.end()) {
+                it->amount += amount;
+            } else {
+                entries.push_back({owner, resource, amount});
+            }
+        }
+    }
 }
 
+// ============================================================================
+// LONGEST ROAD TRACKING
+// ============================================================================
+
+// Vertices the player's roads cannot pass through
+static VertexMask roadBlockers(const GameBoard& board, int playerId) {
+    return board.occupiedVertices & ~board.playerBuildings[playerId];
+}
+
+// Longest road continuing from vertex over roads not yet visited (a bitmask
+// of edge IDs). The road arrived at vertex, so it carries on through the far
+// end of each next edge; the edge it came in by is already visited.
+static int longestRoadFrom(const EdgeMask& roads, VertexMask blocked,
+                           VertexId vertex, EdgeMask& visited) {
+    if (blocked & vertexBit(vertex)) return 0;  // opponent building
+    const BoardTopology& topo = boardTopology();
+    
+    int maxLength = 0;
+    EdgeMask next = topo.vertexEdgeMask[vertex] & roads & ~visited;
+    forEachEdge(next, [&](EdgeId nextEdge) {
+        const auto& ends = topo.edgeVertices[nextEdge];
+        VertexId farEnd = ends[0] == vertex ? ends[1] : ends[0];
+        visited |= EdgeMask::bit(nextEdge);
+        maxLength = std::max(maxLength, 1 + longestRoadFrom(roads, blocked, farEnd, visited));
+        visited &= ~EdgeMask::bit(nextEdge);
+    });
+    return maxLength;
+}
+
+// Every road has an end edge, so starting from each edge in each direction
+// covers them all
+static int longestRoadIn(const EdgeMask& roads, VertexMask blocked) {
+    const BoardTopology& topo = boardTopology();
+    int longest = 0;
+    forEachEdge(roads, [&](EdgeId e) {
+        EdgeMask visited = EdgeMask::bit(e);
+        for (VertexId vertex : topo.edgeVertices[e]) {
+            longest = std::max(longest, 1 + longestRoadFrom(roads, blocked, vertex, visited));
+        }
+    });
+    return longest;
+}
+
+void GameBoard::updateRoadComponents(int playerId, const EdgeMask& affected) {
+    ScopedTimer timer(*boardComputeMetrics().longestRoad);
+    const BoardTopology& topo = boardTopology();
+    const EdgeMask& roads = playerRoads[playerId];
+    auto& components = roadComponents[playerId];
+    
+    // Pull out every component the change touches, plus any new roads
+    EdgeMask pending = affected & roads;
+    for (size_t i = 0; i < components.size();) {
+        if ((components[i].edges & affected).any()) {
+            pending |= components[i].edges & roads;
+            components[i] = components.back();
+            components.pop_back();
+        } else {
+            i++;
+        }
+    }
+    
+    // Flood-fill them back into connected pieces
+    VertexMask blocked = roadBlockers(*this, playerId);
+    while (pending.any()) {
+        EdgeMask component;
+        EdgeMask frontier = pending.lo ? EdgeMask{pending.lo & (~pending.lo + 1), 0}
+                                       : EdgeMask{0, pending.hi & (~pending.hi + 1)};  // lowest edge
+        while (frontier.any()) {
+            component |= frontier;
+            pending &= ~frontier;
+            EdgeMask next;
+            forEachEdge(frontier, [&](EdgeId e) {
+                for (VertexId v : topo.edgeVertices[e]) {
+                    if (!(blocked & vertexBit(v))) next |= topo.vertexEdgeMask[v];
+                }
+            });
+            frontier = next & pending;
+        }
+        components.push_back({component, longestRoadIn(component, blocked)});
+    }
+    
+    int longest = 0;
+    for (const auto& component : components) {
+        longest = std::max(longest, component.longestRoad);
+    }
+    longestRoad[playerId] = longest;
+}
+
+// ============================================================================
+// RESOURCE HELPERS
+// ============================================================================
+
 Resource hexTypeToResource(HexType type) {
     switch (type) {
         case HexType::Forest:    return Resource::Wood;
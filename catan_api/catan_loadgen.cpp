@@ -0,0 +1,819 @@
+// Open-loop load generator for catan_server. Creates games through the REST
+// API, fills them with mock-LLM AI players, plays the human seat of each with
+// a mix of roll/buy/trade/chat/end-turn requests at a fixed arrival rate, and
+// holds SSE subscribers on the games' event streams.
+//
+//   g++ -std=c++17 -O2 -o catan_loadgen catan_loadgen.cpp json_reader.cpp
+//       json_writer.cpp metrics.cpp -lpthread
+//   ./catan_loadgen --port 8080 --games 200 --rate 2000 --duration 30 --sse 2000
+//
+// Requests are scheduled at fixed intervals whether or not earlier ones have
+// been answered, and latency is measured from the scheduled time, so a
+// stalled server shows up in the percentiles instead of lowering the rate
+// (no coordinated omission). Service time, from the request actually being
+// sent, is reported alongside for comparison.
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "json_reader.h"
+#include "metrics.h"
+
+using Clock = std::chrono::steady_clock;
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int games = 100;
+    int aiPlayers = 3;                  // per game, next to the one human seat we play
+    double rate = 1000;                 // requests per second, all connections together
+    double duration = 30;               // seconds measured, after the warmup
+    double warmup = 5;                  // seconds of traffic before measuring starts
+    int connections = 32;               // one sender thread per connection
+    int sse = 1000;                     // SSE subscribers, spread over the games
+    uint64_t seed = 1;
+    bool configureMock = true;          // POST /llm/config {"provider":"mock"} first
+};
+
+void printUsage() {
+    std::cout << "usage: catan_loadgen [--host H] [--port N] [--games N] [--ai-players 1-3]\n"
+                 "                     [--rate REQ_PER_SEC] [--duration SEC] [--warmup SEC]\n"
+                 "                     [--connections N] [--sse N] [--seed N] [--keep-provider]\n";
+}
+
+bool parseArgs(int argc, char** argv, LoadConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* value = nullptr;
+        if (arg == "--keep-provider") {
+            config.configureMock = false;
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if ((value = next()) == nullptr) {
+            return false;
+        } else if (arg == "--host") {
+            config.host = value;
+        } else if (arg == "--port") {
+            config.port = std::atoi(value);
+        } else if (arg == "--games") {
+            config.games = std::max(1, std::atoi(value));
+        } else if (arg == "--ai-players") {
+            config.aiPlayers = std::clamp(std::atoi(value), 1, 3);
+        } else if (arg == "--rate") {
+            config.rate = std::max(1.0, std::atof(value));
+        } else if (arg == "--duration") {
+            config.duration = std::max(1.0, std::atof(value));
+        } else if (arg == "--warmup") {
+            config.warmup = std::max(0.0, std::atof(value));
+        } else if (arg == "--connections") {
+            config.connections = std::max(1, std::atoi(value));
+        } else if (arg == "--sse") {
+            config.sse = std::max(0, std::atoi(value));
+        } else if (arg == "--seed") {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+// ============================================================================
+// ENDPOINT STATS
+// ============================================================================
+
+enum Endpoint {
+    EP_CREATE_GAME, EP_JOIN, EP_ADD_AI, EP_START, EP_GET_STATE, EP_SETUP_SETTLEMENT,
+    EP_SETUP_ROAD, EP_ROLL, EP_BUY_ROAD, EP_BUY_SETTLEMENT, EP_BUY_CITY, EP_BUY_DEVCARD,
+    EP_BANK_TRADE, EP_SEND_CHAT, EP_GET_CHAT, EP_END_TURN, EP_COUNT
+};
+
+const char* ENDPOINT_NAMES[EP_COUNT] = {
+    "POST /games", "POST /games/{id}/join", "POST /games/{id}/add-ai", "POST /games/{id}/start",
+    "GET /games/{id}", "POST /games/{id}/setup/settlement", "POST /games/{id}/setup/road",
+    "POST /games/{id}/roll", "POST /games/{id}/buy/road", "POST /games/{id}/buy/settlement",
+    "POST /games/{id}/buy/city", "POST /games/{id}/buy/devcard", "POST /games/{id}/trade/bank",
+    "POST /games/{id}/chat", "GET /games/{id}/chat", "POST /games/{id}/end-turn"
+};
+
+// Histograms and counters are per-thread internally, so every sender
+// records straight into the shared set
+struct EndpointStats {
+    catan::Histogram latency;           // from the scheduled send time
+    catan::Histogram service;           // from the actual send
+    catan::Counter ok;                  // 2xx
+    catan::Counter rejected;            // 4xx: mostly moves the rules turn down
+    catan::Counter failed;              // 5xx, or no response at all
+};
+
+EndpointStats endpointStats[EP_COUNT];
+catan::Histogram sseLag;
+std::atomic<bool> measuring{false};
+
+// ============================================================================
+// HTTP CONNECTION
+// One blocking keep-alive connection per sender. The server always answers
+// with a Content-Length body.
+// ============================================================================
+
+sockaddr_in resolve(const std::string& host, int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &result) == 0 && result) {
+            addr.sin_addr = reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr;
+            freeaddrinfo(result);
+        }
+    }
+    return addr;
+}
+
+struct Response {
+    int status = 0;                     // 0 if the request failed outright
+    std::string body;
+};
+
+class Connection {
+public:
+    explicit Connection(const sockaddr_in& addr) : addr(addr) {}
+    ~Connection() { close(); }
+
+    Response request(const char* method, const std::string& path, const std::string& body,
+                     const std::string& token) {
+        Response response;
+        for (int attempt = 0; attempt < 2; attempt++) {
+            if (fd < 0 && !open()) return response;
+
+            std::string head = std::string(method) + " " + path + " HTTP/1.1\r\nHost: loadgen\r\n";
+            if (!token.empty()) head += "Authorization: Bearer " + token + "\r\n";
+            if (!body.empty()) head += "Content-Type: application/json\r\n";
+            head += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+            head += body;
+
+            if (!sendAll(head) || !readResponse(response)) {
+                close();
+                if (reused) continue;   // the server may have closed an idle connection
+                return Response();
+            }
+            return response;
+        }
+        return Response();
+    }
+
+private:
+    sockaddr_in addr;
+    int fd = -1;
+    bool reused = false;
+    std::string buffer;
+
+    bool open() {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+            close();
+            return false;
+        }
+        reused = false;
+        buffer.clear();
+        return true;
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+    bool sendAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool fill() {
+        char chunk[16384];
+        ssize_t n;
+        do {
+            n = ::recv(fd, chunk, sizeof(chunk), 0);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    bool readResponse(Response& response) {
+        size_t headEnd;
+        while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        if (buffer.compare(0, 5, "HTTP/") != 0) return false;
+        response.status = std::atoi(buffer.c_str() + buffer.find(' ') + 1);
+
+        size_t length = 0;
+        bool closeAfter = false;
+        for (size_t pos = buffer.find("\r\n") + 2; pos < headEnd;) {
+            size_t eol = buffer.find("\r\n", pos);
+            std::string line = buffer.substr(pos, eol - pos);
+            std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+            if (line.compare(0, 15, "content-length:") == 0) length = std::strtoull(line.c_str() + 15, nullptr, 10);
+            if (line.compare(0, 11, "connection:") == 0 && line.find("close") != std::string::npos) closeAfter = true;
+            pos = eol + 2;
+        }
+
+        size_t bodyStart = headEnd + 4;
+        while (buffer.size() < bodyStart + length) {
+            if (!fill()) return false;
+        }
+        response.body = buffer.substr(bodyStart, length);
+        buffer.erase(0, bodyStart + length);
+        if (closeAfter) close();
+        reused = true;
+        return true;
+    }
+};
+
+// ============================================================================
+// SSE SUBSCRIBERS
+// One epoll thread holds every subscriber. Chat messages the senders post
+// carry their send time ("lg@<ns>"), so each copy a subscriber receives
+// gives one delivery-lag sample.
+// ============================================================================
+
+class SSEPool {
+public:
+    SSEPool(const sockaddr_in& addr, int target) : addr(addr), target(target) {}
+
+    // A game the subscribers may watch; `replaces` is a game given up on,
+    // whose subscribers move over
+    void addGame(const std::string& gameId, const std::string& replaces = "") {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back({gameId, replaces});
+    }
+
+    void run(const std::atomic<bool>& running, int games) {
+        epollFd = epoll_create1(0);
+        const size_t perGame = games > 0 ? (static_cast<size_t>(target) + games - 1) / games : 0;
+        epoll_event events[256];
+
+        while (running.load()) {
+            std::deque<std::pair<std::string, std::string>> added;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                added.swap(pending);
+            }
+            for (auto& [gameId, replaces] : added) {
+                if (!replaces.empty()) {
+                    for (auto& sub : subscribers) {
+                        if (sub.gameId != replaces) continue;
+                        sub.gameId = gameId;
+                        reconnect(sub);
+                    }
+                    continue;
+                }
+                for (size_t i = 0; i < perGame && subscribers.size() < static_cast<size_t>(target); i++) {
+                    subscribers.push_back(Subscriber{});
+                    subscribers.back().index = subscribers.size() - 1;
+                    subscribers.back().gameId = gameId;
+                    reconnect(subscribers.back());
+                }
+            }
+
+            int n = epoll_wait(epollFd, events, 256, 50);
+            for (int i = 0; i < n; i++) {
+                Subscriber& sub = subscribers[events[i].data.u64];
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    disconnects++;
+                    reconnect(sub);
+                } else if (!sub.requested && (events[i].events & EPOLLOUT)) {
+                    sendRequest(sub);
+                } else if (events[i].events & EPOLLIN) {
+                    readEvents(sub);
+                }
+            }
+        }
+        for (auto& sub : subscribers) {
+            if (sub.fd >= 0) ::close(sub.fd);
+        }
+        ::close(epollFd);
+    }
+
+    size_t subscriberCount() const { return subscribers.size(); }
+    size_t connectedCount() const {
+        return static_cast<size_t>(std::count_if(subscribers.begin(), subscribers.end(),
+                                                 [](const Subscriber& s) { return s.streaming; }));
+    }
+    uint64_t eventCount() const { return eventsReceived; }
+    uint64_t disconnectCount() const { return disconnects; }
+
+private:
+    struct Subscriber {
+        size_t index = 0;               // in subscribers, and the epoll data
+        std::string gameId;
+        int fd = -1;
+        bool requested = false;
+        bool streaming = false;         // past the response head
+        std::string buffer;
+    };
+
+    sockaddr_in addr;
+    int target;
+    int epollFd = -1;
+    std::mutex mutex;
+    std::deque<std::pair<std::string, std::string>> pending;
+    std::deque<Subscriber> subscribers;    // stable addresses as it grows
+    uint64_t eventsReceived = 0;
+    uint64_t disconnects = 0;
+
+    void reconnect(Subscriber& sub) {
+        if (sub.fd >= 0) ::close(sub.fd);
+        sub.requested = sub.streaming = false;
+        sub.buffer.clear();
+        sub.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (sub.fd < 0) return;
+        ::connect(sub.fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u64 = sub.index;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, sub.fd, &ev);
+    }
+
+    void sendRequest(Subscriber& sub) {
+        std::string request = "GET /games/" + sub.gameId + "/events HTTP/1.1\r\nHost: loadgen\r\n"
+                              "Accept: text/event-stream\r\n\r\n";
+        if (::send(sub.fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size())) {
+            disconnects++;
+            reconnect(sub);
+            return;
+        }
+        sub.requested = true;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = sub.index;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, sub.fd, &ev);
+    }
+
+    void readEvents(Subscriber& sub) {
+        char chunk[16384];
+        for (;;) {
+            ssize_t n = ::recv(sub.fd, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                sub.buffer.append(chunk, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n < 0 && errno == EINTR) continue;
+            disconnects++;
+            reconnect(sub);
+            return;
+        }
+
+        const uint64_t receivedAt = nowNs();
+        size_t start = 0;
+        if (!sub.streaming) {
+            size_t headEnd = sub.buffer.find("\r\n\r\n");
+            if (headEnd == std::string::npos) return;
+            sub.streaming = sub.buffer.compare(0, 12, "HTTP/1.1 200") == 0;
+            start = headEnd + 4;
+        }
+        for (size_t end; (end = sub.buffer.find("\n\n", start)) != std::string::npos; start = end + 2) {
+            eventsReceived++;
+            for (size_t mark = sub.buffer.find("lg@", start); mark != std::string::npos && mark < end;
+                 mark = sub.buffer.find("lg@", mark + 3)) {
+                uint64_t sentAt = std::strtoull(sub.buffer.c_str() + mark + 3, nullptr, 10);
+                if (measuring.load(std::memory_order_relaxed) && sentAt && receivedAt > sentAt) {
+                    sseLag.record(receivedAt - sentAt);
+                }
+            }
+        }
+        sub.buffer.erase(0, start);
+    }
+};
+
+// ============================================================================
+// GAME DRIVER
+// Plays the human seat of one game. Each call to step() issues the game's
+// next request and updates what we know from the reply. A seat whose roll
+// was a 7 stays in the robber phase (there is no human robber endpoint), so
+// such a game is given up and replaced with a new one.
+// ============================================================================
+
+struct Location {
+    int q = 0, r = 0, direction = 0;
+};
+
+std::string locationBody(const Location& loc) {
+    return "{\"hexQ\":" + std::to_string(loc.q) + ",\"hexR\":" + std::to_string(loc.r) +
+           ",\"direction\":" + std::to_string(loc.direction) + "}";
+}
+
+std::vector<Location> parseLocations(const catan::JsonValue& list) {
+    std::vector<Location> out;
+    for (const catan::JsonValue& item : list.items()) {
+        out.push_back({item.getInt("hexQ"), item.getInt("hexR"), item.getInt("direction")});
+    }
+    return out;
+}
+
+class GameDriver {
+public:
+    GameDriver(const LoadConfig& config, SSEPool& sse, uint64_t seed)
+        : config(config), sse(sse), rng(seed) {}
+
+    void step(Connection& conn, Clock::time_point scheduled) {
+        switch (stage) {
+            case Stage::Create: {
+                Response r = send(conn, scheduled, EP_CREATE_GAME, "POST", "/games", "{\"name\":\"loadgen\"}");
+                catan::JsonValue json = catan::JsonValue::parse(r.body);
+                if (r.status / 100 == 2 && !json.getString("gameId").empty()) {
+                    previousGameId = gameId;
+                    gameId = json.getString("gameId");
+                    stage = Stage::Join;
+                }
+                return;
+            }
+            case Stage::Join: {
+                Response r = send(conn, scheduled, EP_JOIN, "POST", gamePath("/join"), "{\"name\":\"loadgen\"}");
+                catan::JsonValue json = catan::JsonValue::parse(r.body);
+                if (r.status / 100 == 2) {
+                    token = json.getString("token");
+                    playerId = json.getInt("playerId");
+                    stage = Stage::AddAI;
+                }
+                return;
+            }
+            case Stage::AddAI: {
+                Response r = send(conn, scheduled, EP_ADD_AI, "POST", gamePath("/add-ai"),
+                                  "{\"count\":" + std::to_string(config.aiPlayers) + "}");
+                if (r.status / 100 == 2) stage = Stage::Start;
+                return;
+            }
+            case Stage::Start: {
+                Response r = send(conn, scheduled, EP_START, "POST", gamePath("/start"), "{}");
+                if (r.status / 100 == 2) {
+                    stage = Stage::Playing;
+                    phase = "setup";
+                    currentPlayer = 0;
+                    sse.addGame(gameId, previousGameId);
+                }
+                return;
+            }
+            case Stage::Playing:
+                play(conn, scheduled);
+                return;
+        }
+    }
+
+private:
+    enum class Stage { Create, Join, AddAI, Start, Playing };
+
+    const LoadConfig& config;
+    SSEPool& sse;
+    std::mt19937_64 rng;
+
+    Stage stage = Stage::Create;
+    std::string gameId;
+    std::string previousGameId;
+    std::string token;
+    int playerId = 0;
+
+    // Our view of the game, refreshed by GET /games/{id}
+    std::string phase;
+    int currentPlayer = -1;
+    bool stale = true;                  // refresh before acting on the turn
+    catan::JsonValue resources;
+    std::vector<Location> settlementSpots, roadSpots, citySpots;
+    bool placedSetupSettlement = false;
+    Location setupSettlement;
+    int setupRoadDirection = 0;
+    int actionsThisTurn = 0;
+    int lastChatId = 0;
+
+    std::string gamePath(const char* action) const { return "/games/" + gameId + action; }
+
+    Response send(Connection& conn, Clock::time_point scheduled, Endpoint endpoint, const char* method,
+                  const std::string& path, const std::string& body) {
+        auto sentAt = Clock::now();
+        Response response = conn.request(method, path, body, token);
+        auto doneAt = Clock::now();
+
+        if (measuring.load(std::memory_order_relaxed)) {
+            EndpointStats& stats = endpointStats[endpoint];
+            stats.latency.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(doneAt - scheduled).count()));
+            stats.service.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(doneAt - sentAt).count()));
+            if (response.status / 100 == 2) stats.ok.add();
+            else if (response.status / 100 == 4) stats.rejected.add();
+            else stats.failed.add();
+        }
+        return response;
+    }
+
+    bool chance(int percent) { return static_cast<int>(rng() % 100) < percent; }
+
+    void refresh(Connection& conn, Clock::time_point scheduled) {
+        Response r = send(conn, scheduled, EP_GET_STATE, "GET", gamePath(""), "");
+        if (r.status / 100 != 2) return;
+        catan::JsonValue json = catan::JsonValue::parse(r.body);
+        phase = json.getString("phase");
+        currentPlayer = json.getInt("currentPlayer", -1);
+        resources = json["resources"];
+        settlementSpots = parseLocations(json["validSettlementLocations"]);
+        roadSpots = parseLocations(json["validRoadLocations"]);
+        citySpots = parseLocations(json["validCityLocations"]);
+        stale = false;
+    }
+
+    void chat(Connection& conn, Clock::time_point scheduled) {
+        send(conn, scheduled, EP_SEND_CHAT, "POST", gamePath("/chat"),
+             "{\"message\":\"lg@" + std::to_string(nowNs()) + "\"}");
+    }
+
+    void readChat(Connection& conn, Clock::time_point scheduled) {
+        Response r = send(conn, scheduled, EP_GET_CHAT, "GET", gamePath("/chat?since=") + std::to_string(lastChatId), "");
+        catan::JsonValue json = catan::JsonValue::parse(r.body);
+        if (json.has("nextSince")) lastChatId = json.getInt("nextSince", lastChatId);
+    }
+
+    // Waiting on other players: the polling and chatter a real client makes
+    void idle(Connection& conn, Clock::time_point scheduled) {
+        int roll = static_cast<int>(rng() % 100);
+        if (roll < 50) refresh(conn, scheduled);
+        else if (roll < 75) chat(conn, scheduled);
+        else readChat(conn, scheduled);
+    }
+
+    void play(Connection& conn, Clock::time_point scheduled) {
+        if (stale) {
+            refresh(conn, scheduled);
+            return;
+        }
+        if (currentPlayer != playerId) {
+            stale = true;
+            idle(conn, scheduled);
+            return;
+        }
+
+        if (phase == "setup" || phase == "setup_reverse") {
+            setupStep(conn, scheduled);
+        } else if (phase == "rolling") {
+            Response r = send(conn, scheduled, EP_ROLL, "POST", gamePath("/roll"), "");
+            catan::JsonValue json = catan::JsonValue::parse(r.body);
+            if (r.status / 100 == 2) {
+                phase = json.getInt("total") == 7 ? "robber" : "main_turn";
+                actionsThisTurn = 0;
+                stale = true;
+            }
+        } else if (phase == "main_turn") {
+            mainTurnStep(conn, scheduled);
+        } else if (phase == "robber" || phase == "finished") {
+            // Nothing more we can do in this game; start another
+            stage = Stage::Create;
+            token.clear();
+            placedSetupSettlement = false;
+            stale = true;
+            step(conn, scheduled);
+        } else {
+            idle(conn, scheduled);
+            stale = true;
+        }
+    }
+
+    void setupStep(Connection& conn, Clock::time_point scheduled) {
+        if (!placedSetupSettlement) {
+            if (settlementSpots.empty()) {
+                stale = true;
+                idle(conn, scheduled);
+                return;
+            }
+            setupSettlement = settlementSpots[rng() % settlementSpots.size()];
+            Response r = send(conn, scheduled, EP_SETUP_SETTLEMENT, "POST", gamePath("/setup/settlement"),
+                              locationBody(setupSettlement));
+            if (r.status / 100 == 2) {
+                placedSetupSettlement = true;
+                setupRoadDirection = 0;
+            } else {
+                stale = true;
+            }
+            return;
+        }
+        // Any side of the settlement's hex that touches it will do; try them in turn
+        Location road = setupSettlement;
+        road.direction = setupRoadDirection++ % 6;
+        Response r = send(conn, scheduled, EP_SETUP_ROAD, "POST", gamePath("/setup/road"), locationBody(road));
+        if (r.status / 100 == 2) {
+            placedSetupSettlement = false;
+            stale = true;
+        } else if (setupRoadDirection >= 12) {
+            placedSetupSettlement = false;      // give up on this spot; the next refresh picks another
+            stale = true;
+        }
+    }
+
+    void mainTurnStep(Connection& conn, Clock::time_point scheduled) {
+        actionsThisTurn++;
+        stale = true;
+        int pick = static_cast<int>(rng() % 100);
+        if (actionsThisTurn > 6 || pick < 20) {
+            Response r = send(conn, scheduled, EP_END_TURN, "POST", gamePath("/end-turn"), "");
+            if (r.status / 100 == 2) currentPlayer = -1;
+        } else if (pick < 35 && !roadSpots.empty()) {
+            send(conn, scheduled, EP_BUY_ROAD, "POST", gamePath("/buy/road"),
+                 locationBody(roadSpots[rng() % roadSpots.size()]));
+        } else if (pick < 45 && !settlementSpots.empty()) {
+            send(conn, scheduled, EP_BUY_SETTLEMENT, "POST", gamePath("/buy/settlement"),
+                 locationBody(settlementSpots[rng() % settlementSpots.size()]));
+        } else if (pick < 50 && !citySpots.empty()) {
+            send(conn, scheduled, EP_BUY_CITY, "POST", gamePath("/buy/city"),
+                 locationBody(citySpots[rng() % citySpots.size()]));
+        } else if (pick < 60) {
+            send(conn, scheduled, EP_BUY_DEVCARD, "POST", gamePath("/buy/devcard"), "");
+        } else if (pick < 72) {
+            bankTrade(conn, scheduled);
+        } else if (pick < 80) {
+            chat(conn, scheduled);
+            stale = false;
+        } else if (pick < 88) {
+            readChat(conn, scheduled);
+            stale = false;
+        } else {
+            refresh(conn, scheduled);
+        }
+    }
+
+    void bankTrade(Connection& conn, Clock::time_point scheduled) {
+        static const char* NAMES[] = {"wood", "brick", "wheat", "sheep", "ore"};
+        int most = 0, least = 0;
+        for (int i = 1; i < 5; i++) {
+            if (resources.getInt(NAMES[i]) > resources.getInt(NAMES[most])) most = i;
+            if (resources.getInt(NAMES[i]) < resources.getInt(NAMES[least])) least = i;
+        }
+        send(conn, scheduled, EP_BANK_TRADE, "POST", gamePath("/trade/bank"),
+             std::string("{\"give\":\"") + NAMES[most] + "\",\"receive\":\"" + NAMES[least] + "\"}");
+    }
+};
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+std::string ms(uint64_t ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(ns < 10000000 ? 3 : 1) << static_cast<double>(ns) / 1e6;
+    return out.str();
+}
+
+void printReport(const LoadConfig& config, double seconds, const SSEPool& sse) {
+    catan::HistogramSnapshot allLatency, allService;
+    uint64_t ok = 0, rejected = 0, failed = 0;
+
+    std::cout << std::left << std::setw(36) << "endpoint" << std::right
+              << std::setw(9) << "count" << std::setw(9) << "2xx" << std::setw(9) << "4xx" << std::setw(9) << "fail"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "p999 ms"
+              << std::setw(10) << "max ms" << "\n";
+    for (int e = 0; e < EP_COUNT; e++) {
+        EndpointStats& stats = endpointStats[e];
+        catan::HistogramSnapshot latency = stats.latency.snapshot();
+        allLatency.merge(latency);
+        allService.merge(stats.service.snapshot());
+        ok += stats.ok.value();
+        rejected += stats.rejected.value();
+        failed += stats.failed.value();
+        if (latency.count == 0) continue;
+        std::cout << std::left << std::setw(36) << ENDPOINT_NAMES[e] << std::right
+                  << std::setw(9) << latency.count << std::setw(9) << stats.ok.value()
+                  << std::setw(9) << stats.rejected.value() << std::setw(9) << stats.failed.value()
+                  << std::setw(10) << ms(latency.percentile(0.5)) << std::setw(10) << ms(latency.percentile(0.99))
+                  << std::setw(10) << ms(latency.percentile(0.999)) << std::setw(10) << ms(latency.percentile(1.0))
+                  << "\n";
+    }
+
+    std::cout << "\nrequests     " << allLatency.count << " in " << std::fixed << std::setprecision(1) << seconds
+              << " s: " << std::setprecision(1) << static_cast<double>(allLatency.count) / seconds
+              << " req/s (target " << config.rate << ")\n";
+    std::cout << "responses    " << ok << " 2xx, " << rejected << " 4xx, " << failed << " failed\n";
+    std::cout << "latency      p50 " << ms(allLatency.percentile(0.5)) << "  p99 " << ms(allLatency.percentile(0.99))
+              << "  p999 " << ms(allLatency.percentile(0.999)) << "  max " << ms(allLatency.percentile(1.0))
+              << " ms (from scheduled send)\n";
+    std::cout << "service      p50 " << ms(allService.percentile(0.5)) << "  p99 " << ms(allService.percentile(0.99))
+              << "  p999 " << ms(allService.percentile(0.999)) << "  max " << ms(allService.percentile(1.0))
+              << " ms (from actual send)\n";
+
+    catan::HistogramSnapshot lag = sseLag.snapshot();
+    std::cout << "sse          " << sse.connectedCount() << "/" << sse.subscriberCount() << " streaming, "
+              << sse.eventCount() << " events, " << sse.disconnectCount() << " disconnects\n";
+    std::cout << "sse lag      p50 " << ms(lag.percentile(0.5)) << "  p99 " << ms(lag.percentile(0.99))
+              << "  p999 " << ms(lag.percentile(0.999)) << "  max " << ms(lag.percentile(1.0))
+              << " ms over " << lag.count << " chat deliveries\n";
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv) {
+    LoadConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    // Thousands of subscribers need more descriptors than the usual soft limit
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    const sockaddr_in addr = resolve(config.host, config.port);
+    if (config.configureMock) {
+        Connection setup(addr);
+        Response r = setup.request("POST", "/llm/config", "{\"provider\":\"mock\"}", "");
+        if (r.status / 100 != 2) {
+            std::cerr << "cannot reach " << config.host << ":" << config.port << "\n";
+            return 1;
+        }
+    }
+
+    std::atomic<bool> running{true};
+    SSEPool sse(addr, config.sse);
+    std::thread sseThread([&]() { sse.run(running, config.games); });
+
+    // Each sender owns every connections-th game and a slice of the rate,
+    // its slots offset so the senders interleave
+    const int senders = std::min(config.connections, config.games);
+    const auto interval = std::chrono::nanoseconds(static_cast<int64_t>(1e9 * senders / config.rate));
+    const auto start = Clock::now();
+    const auto measureFrom = start + std::chrono::nanoseconds(static_cast<int64_t>(config.warmup * 1e9));
+    const auto stopAt = measureFrom + std::chrono::nanoseconds(static_cast<int64_t>(config.duration * 1e9));
+
+    std::vector<std::thread> threads;
+    for (int s = 0; s < senders; s++) {
+        threads.emplace_back([&, s]() {
+            Connection conn(addr);
+            std::vector<GameDriver> drivers;
+            for (int g = s; g < config.games; g += senders) {
+                drivers.emplace_back(config, sse, config.seed * 1000003 + static_cast<uint64_t>(g));
+            }
+            auto scheduled = start + interval * s / senders;
+            for (size_t next = 0; scheduled < stopAt; next++) {
+                std::this_thread::sleep_until(scheduled);
+                drivers[next % drivers.size()].step(conn, scheduled);
+                scheduled += interval;
+            }
+        });
+    }
+
+    std::this_thread::sleep_until(measureFrom);
+    measuring = true;
+    for (auto& thread : threads) thread.join();
+    measuring = false;
+
+    running = false;
+    sseThread.join();
+    printReport(config, config.duration, sse);
+    return 0;
+}
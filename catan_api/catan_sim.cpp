@@ -0,0 +1,360 @@
+// Headless self-play simulator. Plays heuristic-policy games straight
+// through the rules engine (no HTTP, no LLM), each thread on its own Game,
+// and reports throughput plus where the time went.
+//
+//   g++ -std=c++17 -O2 -o catan_sim catan_sim.cpp catan_game.cpp game_logic.cpp
+//       game_actions.cpp game_delta.cpp json_writer.cpp heuristic_policy.cpp metrics.cpp
+//       random.cpp -lpthread
+//   ./catan_sim --games 100000 --threads 8 --seed 1
+//
+// The same seed gives the same games, and the same checksum, whatever the
+// thread count. Each game is dealt and played from its own seed through
+// seedGame, as the server deals its games, so any one can be replayed.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include "catan_types.h"
+#include "game_logic.h"
+#include "game_actions.h"
+#include "heuristic_policy.h"
+
+using catan::ai::PolicyAction;
+using catan::ai::PolicyActionType;
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+struct SimConfig {
+    uint64_t games = 10000;
+    unsigned threads = 0;               // 0 = one per core
+    uint64_t seed = 1;
+    int players = 4;
+    int maxTurns = 500;                 // a game still going after this is a draw
+    int maxActionsPerTurn = 40;         // guard against a policy that never ends its turn
+    bool profile = true;
+};
+
+void printUsage() {
+    std::cout << "usage: catan_sim [--games N] [--threads N] [--seed N] [--players 2-4]\n"
+                 "                 [--max-turns N] [--no-profile]\n";
+}
+
+bool parseArgs(int argc, char** argv, SimConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* value = nullptr;
+        if (arg == "--no-profile") {
+            config.profile = false;
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if ((value = next()) == nullptr) {
+            return false;
+        } else if (arg == "--games") {
+            config.games = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--threads") {
+            config.threads = static_cast<unsigned>(std::atoi(value));
+        } else if (arg == "--seed") {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--players") {
+            config.players = std::clamp(std::atoi(value), 2, catan::MAX_PLAYERS);
+        } else if (arg == "--max-turns") {
+            config.maxTurns = std::max(1, std::atoi(value));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// PROFILE
+// Per-thread call counts and time for the policy and for each kind of
+// action applied through the rules engine, merged at the end. Timing costs
+// a clock read on each side of the call; --no-profile leaves it out for raw
+// throughput.
+// ============================================================================
+
+constexpr int SECTION_POLICY = 0;
+constexpr int SECTION_WINNER = 1;       // checkForWinner at the end of a game
+constexpr int SECTION_ACTIONS = 2;      // then one per catan::ActionType
+constexpr int SECTION_COUNT = SECTION_ACTIONS + static_cast<int>(catan::ActionType::Count);
+
+std::string sectionName(int section) {
+    if (section == SECTION_POLICY) return "heuristic policy";
+    if (section == SECTION_WINNER) return "checkForWinner";
+    return catan::actionName(static_cast<catan::ActionType>(section - SECTION_ACTIONS));
+}
+
+struct Profile {
+    bool enabled = true;
+    uint64_t calls[SECTION_COUNT] = {};
+    uint64_t ns[SECTION_COUNT] = {};
+
+    void merge(const Profile& other) {
+        for (int s = 0; s < SECTION_COUNT; s++) {
+            calls[s] += other.calls[s];
+            ns[s] += other.ns[s];
+        }
+    }
+};
+
+class ScopedTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ScopedTimer(Profile& profile, int section) : profile(profile), section(section) {
+        if (profile.enabled) start = Clock::now();
+    }
+    ~ScopedTimer() {
+        if (!profile.enabled) return;
+        profile.calls[section]++;
+        profile.ns[section] += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+private:
+    Profile& profile;
+    int section;
+    Clock::time_point start;
+};
+
+// ============================================================================
+// GAME DRIVER
+// Applies policy actions through the rules engine, exactly as the server
+// applies them for its players.
+// ============================================================================
+
+struct GameResult {
+    int winner = -1;                    // -1 for a draw
+    int turns = 0;
+    uint64_t actions = 0;
+    uint64_t illegal = 0;               // actions the rules rejected
+    int winnerPoints = 0;
+    int longestRoad = 0;
+};
+
+struct SimStats {
+    uint64_t games = 0;
+    uint64_t draws = 0;
+    uint64_t turns = 0;
+    uint64_t actions = 0;
+    uint64_t illegal = 0;
+    uint64_t winnerPoints = 0;
+    uint64_t longestRoad = 0;
+    uint64_t checksum = 0;
+    std::vector<uint64_t> winsBySeat = std::vector<uint64_t>(catan::MAX_PLAYERS);
+
+    void add(const GameResult& result, uint64_t gameIndex) {
+        games++;
+        turns += result.turns;
+        actions += result.actions;
+        illegal += result.illegal;
+        longestRoad += result.longestRoad;
+        if (result.winner < 0) {
+            draws++;
+        } else {
+            winsBySeat[result.winner]++;
+            winnerPoints += result.winnerPoints;
+        }
+        // Order-independent, so any thread count gives the same value
+        checksum += (gameIndex + 1) * 1000003u ^ (uint64_t(result.winner + 2) << 32 | uint64_t(result.turns));
+    }
+
+    void merge(const SimStats& other) {
+        games += other.games;
+        draws += other.draws;
+        turns += other.turns;
+        actions += other.actions;
+        illegal += other.illegal;
+        winnerPoints += other.winnerPoints;
+        longestRoad += other.longestRoad;
+        checksum += other.checksum;
+        for (size_t i = 0; i < winsBySeat.size(); i++) winsBySeat[i] += other.winsBySeat[i];
+    }
+};
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+class SimGame {
+public:
+    SimGame(const SimConfig& config, uint64_t seed, Profile& profile)
+        : config(config), profile(profile) {
+        catan::seedGame(game, seed);
+        for (int p = 0; p < config.players; p++) {
+            catan::Player player;
+            player.id = p;
+            player.name = "sim" + std::to_string(p);
+            player.playerType = catan::PlayerType::AI;
+            game.addPlayer(player);
+        }
+        game.phase = catan::GamePhase::Setup;
+    }
+
+    GameResult play() {
+        GameResult result;
+        int actionsThisTurn = 0;
+        while (game.phase != catan::GamePhase::Finished && result.turns < config.maxTurns) {
+            int playerId = game.currentPlayerIndex;
+            PolicyAction action;
+            {
+                ScopedTimer timer(profile, SECTION_POLICY);
+                action = catan::ai::chooseAction(game, playerId);
+            }
+            if (++actionsThisTurn > config.maxActionsPerTurn && game.phase == catan::GamePhase::MainTurn) {
+                action = PolicyAction();
+                action.type = PolicyActionType::EndTurn;
+            }
+
+            result.actions++;
+            if (!apply(action, playerId)) {
+                result.illegal++;
+                // A rejected move must not stall the game
+                if (game.phase != catan::GamePhase::MainTurn) break;
+                action = PolicyAction();
+                action.type = PolicyActionType::EndTurn;
+                apply(action, playerId);
+            }
+            if (action.type == PolicyActionType::EndTurn) {
+                result.turns++;
+                actionsThisTurn = 0;
+            }
+        }
+
+        {
+            ScopedTimer timer(profile, SECTION_WINNER);
+            result.winner = catan::checkForWinner(game);
+        }
+        if (result.winner >= 0) {
+            result.winnerPoints = catan::calculateVictoryPoints(game, result.winner);
+        }
+        for (int p = 0; p < config.players; p++) {
+            result.longestRoad = std::max(result.longestRoad, catan::calculateLongestRoad(game, p));
+        }
+        return result;
+    }
+
+private:
+    const SimConfig& config;
+    Profile& profile;
+    catan::Game game;
+
+    bool apply(const PolicyAction& policy, int playerId) {
+        catan::Action action;
+        action.playerId = playerId;
+        action.vertex = policy.vertex;
+        action.edge = policy.edge;
+        action.hex = policy.hex;
+        action.victimId = policy.victimId;
+        action.give = policy.give;
+        action.receive = policy.receive;
+        switch (policy.type) {
+            case PolicyActionType::RollDice: action.type = catan::ActionType::RollDice; break;
+            case PolicyActionType::PlaceSetupSettlement: action.type = catan::ActionType::PlaceSetupSettlement; break;
+            case PolicyActionType::PlaceSetupRoad: action.type = catan::ActionType::PlaceSetupRoad; break;
+            case PolicyActionType::MoveRobber: action.type = catan::ActionType::MoveRobber; break;
+            case PolicyActionType::BuildCity: action.type = catan::ActionType::BuildCity; break;
+            case PolicyActionType::BuildSettlement: action.type = catan::ActionType::BuildSettlement; break;
+            case PolicyActionType::BuildRoad: action.type = catan::ActionType::BuildRoad; break;
+            case PolicyActionType::BuyDevCard: action.type = catan::ActionType::BuyDevCard; break;
+            case PolicyActionType::BankTrade: action.type = catan::ActionType::BankTrade; break;
+            case PolicyActionType::EndTurn: action.type = catan::ActionType::EndTurn; break;
+            default: return false;
+        }
+        ScopedTimer timer(profile, SECTION_ACTIONS + static_cast<int>(action.type));
+        return catan::applyAction(game, action).ok();
+    }
+};
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+void printReport(const SimConfig& config, const SimStats& stats, const Profile& profile,
+                 double seconds, unsigned threads) {
+    auto perGame = [&](uint64_t total) { return stats.games ? double(total) / stats.games : 0.0; };
+    uint64_t decided = stats.games - stats.draws;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "games        " << stats.games << " on " << threads << " threads, "
+              << config.players << " players, seed " << config.seed << "\n";
+    std::cout << "wall time    " << std::setprecision(3) << seconds << " s\n" << std::setprecision(1);
+    std::cout << "games/sec    " << stats.games / seconds
+              << "  (" << stats.games / seconds * 3600 / 1e6 << "M/hour)\n";
+    std::cout << "actions/sec  " << stats.actions / seconds << "\n";
+    std::cout << "per game     " << perGame(stats.turns) << " turns, " << perGame(stats.actions)
+              << " actions, longest road " << perGame(stats.longestRoad) << "\n";
+    std::cout << "draws        " << stats.draws << " (no winner in " << config.maxTurns << " turns)\n";
+    std::cout << "illegal      " << stats.illegal << " policy actions rejected by the rules\n";
+    std::cout << "wins by seat";
+    for (int p = 0; p < config.players; p++) {
+        std::cout << "  " << p << ": " << (decided ? 100.0 * stats.winsBySeat[p] / decided : 0.0) << "%";
+    }
+    std::cout << "\nwinner VP    " << (decided ? double(stats.winnerPoints) / decided : 0.0) << "\n";
+    std::cout << "checksum     " << std::hex << stats.checksum << std::dec << "\n";
+
+    if (!config.profile) return;
+    uint64_t totalNs = 0;
+    for (int s = 0; s < SECTION_COUNT; s++) totalNs += profile.ns[s];
+    std::cout << "\n" << std::left << std::setw(22) << "section" << std::right
+              << std::setw(14) << "calls" << std::setw(12) << "ns/call"
+              << std::setw(12) << "total ms" << std::setw(9) << "share" << "\n";
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (!profile.calls[s]) continue;
+        std::cout << std::left << std::setw(22) << sectionName(s) << std::right
+                  << std::setw(14) << profile.calls[s]
+                  << std::setw(12) << double(profile.ns[s]) / profile.calls[s]
+                  << std::setw(12) << profile.ns[s] / 1e6
+                  << std::setw(8) << (totalNs ? 100.0 * profile.ns[s] / totalNs : 0.0) << "%\n";
+    }
+    std::cout << "(times are summed over threads; actions include their legality checks)\n";
+}
+
+int main(int argc, char** argv) {
+    SimConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    unsigned threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<uint64_t> nextGame{0};
+    std::vector<SimStats> stats(threads);
+    std::vector<Profile> profiles(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            profiles[t].enabled = config.profile;
+            for (uint64_t i = nextGame++; i < config.games; i = nextGame++) {
+                SimGame game(config, splitmix64(config.seed ^ splitmix64(i)), profiles[t]);
+                stats[t].add(game.play(), i);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SimStats total;
+    Profile profile;
+    for (unsigned t = 0; t < threads; t++) {
+        total.merge(stats[t]);
+        profile.merge(profiles[t]);
+    }
+    printReport(config, total, profile, seconds, threads);
+    return 0;
+}
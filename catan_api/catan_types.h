@@ -5,9 +5,23 @@
 #include <array>
 #include <unordered_map>
 #include <optional>
+#include <deque>
+#include <string_view>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "metrics.h"
+#include "random.h"
+#include "striped_map.h"
 
 namespace catan {
 
@@ -100,57 +114,133 @@ struct EdgeCoord {
     }
 };
 
-}  // namespace catan
+// ============================================================================
+// BOARD TOPOLOGY
+// The standard board has 19 land hexes, 54 vertices and 72 edges. Each gets a
+// small canonical ID, and every (hex, direction) spelling of the same corner
+// or side maps to the same ID. Game logic works on IDs; coordinates are only
+// used at the JSON boundary.
+// ============================================================================
 
-// Hash functions for coordinates (needed for unordered_map)
-namespace std {
-    template<> struct hash<catan::HexCoord> {
-        size_t operator()(const catan::HexCoord& c) const {
-            return hash<int>()(c.q) ^ (hash<int>()(c.r) << 16);
-        }
-    };
+using HexId = uint8_t;
+using VertexId = uint8_t;
+using EdgeId = uint8_t;
+
+constexpr int NUM_HEXES = 19;
+constexpr int NUM_VERTICES = 54;
+constexpr int NUM_EDGES = 72;
+constexpr uint8_t INVALID_ID = 0xFF;
+
+// Per-player bitboards are kept for player IDs below this
+constexpr int MAX_PLAYERS = 6;
+
+// Bit sets over vertex IDs (54 bits) and edge IDs (72 bits)
+using VertexMask = uint64_t;
+
+inline VertexMask vertexBit(VertexId v) { return VertexMask(1) << v; }
+
+struct EdgeMask {
+    uint64_t lo = 0;    // edges 0-63
+    uint64_t hi = 0;    // edges 64-71
     
-    template<> struct hash<catan::VertexCoord> {
-        size_t operator()(const catan::VertexCoord& c) const {
-            return hash<catan::HexCoord>()(c.hex) ^ (hash<int>()(c.direction) << 8);
-        }
-    };
+    static EdgeMask bit(EdgeId e) {
+        EdgeMask m;
+        if (e < 64) m.lo = uint64_t(1) << e;
+        else m.hi = uint64_t(1) << (e - 64);
+        return m;
+    }
     
-    template<> struct hash<catan::EdgeCoord> {
-        size_t operator()(const catan::EdgeCoord& c) const {
-            return hash<catan::HexCoord>()(c.hex) ^ (hash<int>()(c.direction) << 8);
-        }
-    };
-}
+    bool test(EdgeId e) const { return e < 64 ? (lo >> e) & 1 : (hi >> (e - 64)) & 1; }
+    bool any() const { return lo || hi; }
+    int count() const { return __builtin_popcountll(lo) + __builtin_popcountll(hi); }
+    
+    EdgeMask operator|(const EdgeMask& o) const { return {lo | o.lo, hi | o.hi}; }
+    EdgeMask operator&(const EdgeMask& o) const { return {lo & o.lo, hi & o.hi}; }
+    EdgeMask operator~() const { return {~lo, ~hi & ((uint64_t(1) << (NUM_EDGES - 64)) - 1)}; }
+    EdgeMask& operator|=(const EdgeMask& o) { lo |= o.lo; hi |= o.hi; return *this; }
+    EdgeMask& operator&=(const EdgeMask& o) { lo &= o.lo; hi &= o.hi; return *this; }
+};
 
-namespace catan {
+// Call f(id) for each set bit, lowest ID first
+template <typename F>
+void forEachVertex(VertexMask mask, F f) {
+    while (mask) {
+        f(static_cast<VertexId>(__builtin_ctzll(mask)));
+        mask &= mask - 1;
+    }
+}
 
-// ============================================================================
-// BOARD ELEMENTS
-// ============================================================================
+template <typename F>
+void forEachEdge(EdgeMask mask, F f) {
+    for (uint64_t word = mask.lo; word; word &= word - 1) {
+        f(static_cast<EdgeId>(__builtin_ctzll(word)));
+    }
+    for (uint64_t word = mask.hi; word; word &= word - 1) {
+        f(static_cast<EdgeId>(64 + __builtin_ctzll(word)));
+    }
+}
 
-struct Hex {
-    HexCoord coord;
-    HexType type;
-    int numberToken;    // 2-12, 0 for desert/ocean
-    bool hasRobber;
+// Adjacency lists are padded with INVALID_ID (coastal vertices touch fewer
+// than 3 hexes/edges), so loops stop at the first INVALID_ID.
+struct BoardTopology {
+    std::array<HexCoord, NUM_HEXES> hexCoords;
+    std::array<VertexCoord, NUM_VERTICES> vertexCoords;   // canonical spelling
+    std::array<EdgeCoord, NUM_EDGES> edgeCoords;          // canonical spelling
+    
+    std::array<std::array<VertexId, 6>, NUM_HEXES> hexVertices;     // by direction
+    std::array<std::array<EdgeId, 6>, NUM_HEXES> hexEdges;          // by direction
+    std::array<std::array<HexId, 3>, NUM_VERTICES> vertexHexes;
+    std::array<std::array<EdgeId, 3>, NUM_VERTICES> vertexEdges;
+    std::array<std::array<VertexId, 3>, NUM_VERTICES> vertexNeighbors;
+    std::array<std::array<VertexId, 2>, NUM_EDGES> edgeVertices;
+    
+    // The same adjacency as bitboards
+    std::array<VertexMask, NUM_VERTICES> vertexNeighborMask;
+    std::array<EdgeMask, NUM_VERTICES> vertexEdgeMask;
+    std::array<VertexMask, NUM_EDGES> edgeVertexMask;
+    
+    // Coordinate lookup over the land hexes plus the surrounding ocean ring,
+    // indexed by (q + GRID_RADIUS, r + GRID_RADIUS[, direction])
+    static constexpr int GRID_RADIUS = 3;
+    static constexpr int GRID_SIZE = 2 * GRID_RADIUS + 1;
+    std::array<HexId, GRID_SIZE * GRID_SIZE> hexLookup;
+    std::array<VertexId, GRID_SIZE * GRID_SIZE * 6> vertexLookup;
+    std::array<EdgeId, GRID_SIZE * GRID_SIZE * 6> edgeLookup;
+    
+    // Map any spelling to its ID; INVALID_ID if it is not on the board
+    HexId hexId(const HexCoord& c) const {
+        int cell = gridCell(c);
+        return cell < 0 ? INVALID_ID : hexLookup[cell];
+    }
+    VertexId vertexId(const VertexCoord& c) const {
+        int cell = gridCell(c.hex);
+        if (cell < 0 || c.direction < 0 || c.direction > 5) return INVALID_ID;
+        return vertexLookup[cell * 6 + c.direction];
+    }
+    EdgeId edgeId(const EdgeCoord& c) const {
+        int cell = gridCell(c.hex);
+        if (cell < 0 || c.direction < 0 || c.direction > 5) return INVALID_ID;
+        return edgeLookup[cell * 6 + c.direction];
+    }
+    
+    static int gridCell(const HexCoord& c) {
+        int x = c.q + GRID_RADIUS;
+        int y = c.r + GRID_RADIUS;
+        if (x < 0 || x >= GRID_SIZE || y < 0 || y >= GRID_SIZE) return -1;
+        return y * GRID_SIZE + x;
+    }
 };
 
-struct Vertex {
-    VertexCoord coord;
-    Building building;
-    int ownerPlayerId;  // -1 if unoccupied
-};
+// Built once on first use
+const BoardTopology& boardTopology();
 
-struct Edge {
-    EdgeCoord coord;
-    bool hasRoad;
-    int ownerPlayerId;  // -1 if no road
-};
+// ============================================================================
+// BOARD ELEMENTS
+// ============================================================================
 
 struct Port {
-    VertexCoord vertex1;    // ports connect two adjacent vertices
-    VertexCoord vertex2;
+    VertexId vertex1;       // ports connect two adjacent vertices
+    VertexId vertex2;
     PortType type;
 };
 
@@ -158,36 +248,82 @@ struct Port {
 // PLAYER STATE
 // ============================================================================
 
-struct ResourceHand {
-    int wood = 0;
-    int brick = 0;
-    int wheat = 0;
-    int sheep = 0;
-    int ore = 0;
-    
-    int total() const { return wood + brick + wheat + sheep + ore; }
-    
-    int& operator[](Resource r) {
-        switch(r) {
-            case Resource::Wood:  return wood;
-            case Resource::Brick: return brick;
-            case Resource::Wheat: return wheat;
-            case Resource::Sheep: return sheep;
-            case Resource::Ore:   return ore;
-            default: return wood; // shouldn't happen
-        }
+// Resource counts packed one 32-bit lane per Resource value, so comparing or
+// adding whole hands is a couple of SSE2 instructions. Lane 0
+// (Resource::None) and the two padding lanes stay zero.
+struct alignas(16) ResourceHand {
+    std::array<int, 8> lanes{};
+    
+    ResourceHand() = default;
+    constexpr ResourceHand(int wood, int brick, int wheat, int sheep, int ore)
+        : lanes{0, wood, brick, wheat, sheep, ore, 0, 0} {}
+    
+    int& operator[](Resource r) { return lanes[static_cast<size_t>(r)]; }
+    int operator[](Resource r) const { return lanes[static_cast<size_t>(r)]; }
+    
+    int total() const {
+#if defined(__SSE2__)
+        __m128i sum = _mm_add_epi32(half(0), half(1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(sum);
+#else
+        int sum = 0;
+        for (int n : lanes) sum += n;
+        return sum;
+#endif
     }
     
-    int operator[](Resource r) const {
-        switch(r) {
-            case Resource::Wood:  return wood;
-            case Resource::Brick: return brick;
-            case Resource::Wheat: return wheat;
-            case Resource::Sheep: return sheep;
-            case Resource::Ore:   return ore;
-            default: return 0;
+    // At least `cost` of every resource
+    bool covers(const ResourceHand& cost) const {
+#if defined(__SSE2__)
+        __m128i short0 = _mm_cmplt_epi32(half(0), cost.half(0));
+        __m128i short1 = _mm_cmplt_epi32(half(1), cost.half(1));
+        return _mm_movemask_epi8(_mm_or_si128(short0, short1)) == 0;
+#else
+        for (size_t i = 0; i < lanes.size(); i++) {
+            if (lanes[i] < cost.lanes[i]) return false;
         }
+        return true;
+#endif
     }
+    
+    ResourceHand& operator+=(const ResourceHand& other) {
+#if defined(__SSE2__)
+        store(0, _mm_add_epi32(half(0), other.half(0)));
+        store(1, _mm_add_epi32(half(1), other.half(1)));
+#else
+        for (size_t i = 0; i < lanes.size(); i++) lanes[i] += other.lanes[i];
+#endif
+        return *this;
+    }
+    
+    ResourceHand& operator-=(const ResourceHand& other) {
+#if defined(__SSE2__)
+        store(0, _mm_sub_epi32(half(0), other.half(0)));
+        store(1, _mm_sub_epi32(half(1), other.half(1)));
+#else
+        for (size_t i = 0; i < lanes.size(); i++) lanes[i] -= other.lanes[i];
+#endif
+        return *this;
+    }
+    
+    bool operator==(const ResourceHand& other) const {
+#if defined(__SSE2__)
+        __m128i same = _mm_and_si128(_mm_cmpeq_epi32(half(0), other.half(0)),
+                                     _mm_cmpeq_epi32(half(1), other.half(1)));
+        return _mm_movemask_epi8(same) == 0xFFFF;
+#else
+        return lanes == other.lanes;
+#endif
+    }
+    bool operator!=(const ResourceHand& other) const { return !(*this == other); }
+
+private:
+#if defined(__SSE2__)
+    __m128i half(int i) const { return _mm_load_si128(reinterpret_cast<const __m128i*>(lanes.data() + 4 * i)); }
+    void store(int i, __m128i v) { _mm_store_si128(reinterpret_cast<__m128i*>(lanes.data() + 4 * i), v); }
+#endif
 };
 
 struct Player {
@@ -291,16 +427,298 @@ struct ChatMessage {
     std::optional<ResourceHand> tradeRequesting;
 };
 
+// ============================================================================
+// CHAT AND TRADE HISTORY
+// Both are bounded per game. Chat keeps the newest messages in a ring whose
+// text lives in a chunked arena; trades are kept in id order, so a lookup
+// by id is an index, with a separate list of the ones still active.
+// ============================================================================
+
+constexpr size_t DEFAULT_CHAT_HISTORY = 256;
+constexpr size_t DEFAULT_TRADE_HISTORY = 64;
+
+// Append-only text storage released a chunk at a time. Each chunk remembers
+// the newest message stored in it, and is freed once the ring has dropped
+// that message.
+class TextArena {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    std::string_view store(std::string_view text, uint64_t messageId);
+    void releaseThrough(uint64_t messageId);
+    size_t bytesReserved() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0;
+        size_t used = 0;
+        uint64_t lastMessageId = 0;
+    };
+    std::deque<Chunk> chunks;
+    Chunk spare;                    // one released chunk kept for reuse
+};
+
+// A stored chat message. Same fields as ChatMessage, with the id as a
+// number and the text pointing into the history's arena.
+struct ChatEntry {
+    uint64_t id = 0;
+    int fromPlayerId = -1;
+    int toPlayerId = -1;
+    std::string_view content;
+    ChatMessageType type = ChatMessageType::Normal;
+    int relatedTradeId = -1;
+    std::chrono::steady_clock::time_point timestamp;
+    std::optional<ResourceHand> tradeOffering;
+    std::optional<ResourceHand> tradeRequesting;
+
+    bool visibleTo(int playerId) const {
+        return toPlayerId == -1 || toPlayerId == playerId || fromPlayerId == playerId;
+    }
+};
+
+class ChatHistory {
+public:
+    explicit ChatHistory(size_t capacity = DEFAULT_CHAT_HISTORY) : ring(capacity ? capacity : 1) {}
+
+    // Copies the message in, evicting the oldest once full. Message ids are
+    // the increasing decimal strings handed out from Game::nextChatMessageId.
+    void append(const ChatMessage& message);
+
+    size_t size() const { return count; }
+    size_t capacity() const { return ring.size(); }
+    uint64_t latestId() const { return count ? at(count - 1).id : 0; }
+
+    // Visits retained entries with id > sinceId, oldest first, until the
+    // visitor returns false
+    template <typename Visitor>
+    void forEachSince(uint64_t sinceId, Visitor&& visitor) const {
+        for (size_t i = firstAfter(sinceId); i < count; i++) {
+            if (!visitor(at(i))) return;
+        }
+    }
+
+    // Visits the newest `limit` entries for which filter is true, oldest first
+    template <typename Filter, typename Visitor>
+    void forEachRecent(size_t limit, Filter&& filter, Visitor&& visitor) const {
+        size_t start = count;
+        size_t taken = 0;
+        while (start > 0 && taken < limit) {
+            if (filter(at(start - 1))) taken++;
+            start--;
+        }
+        for (size_t i = start; i < count; i++) {
+            if (filter(at(i))) visitor(at(i));
+        }
+    }
+
+private:
+    std::vector<ChatEntry> ring;
+    size_t head = 0;                // oldest entry
+    size_t count = 0;
+    TextArena arena;
+
+    const ChatEntry& at(size_t i) const { return ring[(head + i) % ring.size()]; }
+    size_t firstAfter(uint64_t sinceId) const;
+};
+
+class TradeBook {
+public:
+    explicit TradeBook(size_t capacity = DEFAULT_TRADE_HISTORY) : limit(capacity) {}
+
+    // Trades must be added in increasing id order (Game::nextTradeId)
+    void add(const TradeOffer& offer);
+
+    // Retained trade by id, or nullptr once it has aged out. The newest
+    // `capacity` trades are kept, open or not; older open offers expire.
+    TradeOffer* find(int id);
+    const TradeOffer* find(int id) const;
+
+    // Every retained trade, oldest first
+    std::deque<TradeOffer>::const_iterator begin() const { return offers.begin(); }
+    std::deque<TradeOffer>::const_iterator end() const { return offers.end(); }
+    size_t size() const { return offers.size(); }
+
+    // Visits trades that are still active, oldest first. Closing a trade is
+    // just clearing isActive; the index drops it on the next add.
+    template <typename Visitor>
+    void forEachActive(Visitor&& visitor) const {
+        for (int id : activeIds) {
+            const TradeOffer* offer = find(id);
+            if (offer && offer->isActive) visitor(*offer);
+        }
+    }
+
+private:
+    std::deque<TradeOffer> offers;  // contiguous ids starting at offers.front().id
+    std::vector<int> activeIds;
+    size_t limit;
+};
+
 // ============================================================================
 // FULL GAME STATE
 // ============================================================================
 
+// A connected piece of one player's road network. Roads connect through a
+// shared vertex unless an opponent has built there.
+struct RoadComponent {
+    EdgeMask edges;
+    int longestRoad = 0;        // longest road within this component
+};
+
+// One player's payout on a dice total
+struct ProductionEntry {
+    int playerId;
+    Resource resource;
+    int amount;             // summed over all their buildings on that total
+};
+
+// Board state as flat arrays indexed by topology IDs, plus bitboards that
+// the mutators keep in sync. All writes go through the mutators below.
 struct GameBoard {
-    std::unordered_map<HexCoord, Hex> hexes;
-    std::unordered_map<VertexCoord, Vertex> vertices;
-    std::unordered_map<EdgeCoord, Edge> edges;
+    // Hexes
+    std::array<HexType, NUM_HEXES> hexType{};
+    std::array<uint8_t, NUM_HEXES> numberToken{};   // 2-12, 0 for desert
+    HexId robberHex = INVALID_ID;
+    
+    // Vertices
+    std::array<Building, NUM_VERTICES> building{};
+    std::array<int8_t, NUM_VERTICES> vertexOwner;   // -1 if unoccupied
+    
+    // Edges
+    std::array<int8_t, NUM_EDGES> roadOwner;        // -1 if no road
+    
     std::vector<Port> ports;
-    HexCoord robberLocation;
+    
+    // Bitboards
+    VertexMask occupiedVertices = 0;    // any settlement or city
+    VertexMask blockedVertices = 0;     // occupied or next to one (distance rule)
+    EdgeMask occupiedEdges;
+    std::array<VertexMask, MAX_PLAYERS> playerBuildings{};  // settlements and cities
+    std::array<VertexMask, MAX_PLAYERS> playerCities{};
+    std::array<EdgeMask, MAX_PLAYERS> playerRoads{};
+    std::array<VertexMask, MAX_PLAYERS> playerRoadEnds{};   // vertices touched by the player's roads
+    
+    // Longest-road cache, maintained by the mutators. Only components touched
+    // by a new road or a new settlement are recomputed.
+    std::array<std::vector<RoadComponent>, MAX_PLAYERS> roadComponents;
+    std::array<int, MAX_PLAYERS> longestRoad{};
+    
+    // Production index by dice total (2-12), maintained by the mutators and
+    // moveRobber. The robber's hex is left out.
+    std::array<std::vector<ProductionEntry>, 13> production;
+    
+    GameBoard() {
+        vertexOwner.fill(-1);
+        roadOwner.fill(-1);
+    }
+    
+    bool hasRoad(EdgeId e) const { return roadOwner[e] >= 0; }
+    bool hasBuilding(VertexId v) const { return building[v] != Building::None; }
+    
+    void placeSettlement(VertexId v, int playerId);
+    void upgradeToCity(VertexId v);
+    void placeRoad(EdgeId e, int playerId);
+    
+    // Re-split the player's components that touch `affected` (edges whose
+    // ownership or blocking may have changed) and refresh their lengths
+    void updateRoadComponents(int playerId, const EdgeMask& affected);
+    
+    void moveRobber(HexId h);
+    
+    // Rebuild the production entries for one dice total
+    void updateProduction(int total);
+};
+
+// ============================================================================
+// CHANGE LOG
+// Every write that changes what a client can see gets the next version and a
+// delta, kept in a small ring per game so a reconnecting client can replay
+// what it missed. The deltas are built in game_delta.cpp.
+// ============================================================================
+
+// Client-visible state as of the last recorded change, diffed on each write
+struct PlayerDigest {
+    ResourceHand resources;
+    std::vector<DevCardType> devCards;
+    int settlementsRemaining = 0;
+    int citiesRemaining = 0;
+    int roadsRemaining = 0;
+    int knightsPlayed = 0;
+    int victoryPoints = 0;          // visible VP
+    bool hasLongestRoad = false;
+    bool hasLargestArmy = false;
+};
+
+struct GameDigest {
+    GamePhase phase = GamePhase::WaitingForPlayers;
+    int currentPlayerIndex = 0;
+    int setupRound = 0;
+    int die1 = 0;                   // 0 = no roll yet
+    int die2 = 0;
+    HexId robberHex = INVALID_ID;
+    int winner = -1;
+    std::array<Building, NUM_VERTICES> building{};
+    std::array<int8_t, NUM_VERTICES> vertexOwner;
+    std::array<int8_t, NUM_EDGES> roadOwner;
+    std::vector<PlayerDigest> players;
+    std::vector<int> activeTradeIds;
+    
+    // Build locations offered to the current player
+    int validFor = -1;
+    VertexMask validSettlements = 0;
+    VertexMask validCities = 0;
+    EdgeMask validRoads;
+    
+    GameDigest() {
+        vertexOwner.fill(-1);
+        roadOwner.fill(-1);
+    }
+};
+
+// One version's changes as JSON object members (no braces): the part every
+// viewer sees plus one private part per player
+struct GameChange {
+    uint64_t version = 0;
+    std::string publicJson;
+    std::array<std::string, MAX_PLAYERS> privateJson;
+};
+
+constexpr uint64_t CHANGE_LOG_CAPACITY = 128;
+
+struct ChangeLog {
+    // Ring indexed by version; a slot belongs to the newest version that maps to it
+    std::vector<GameChange> entries = std::vector<GameChange>(CHANGE_LOG_CAPACITY);
+    GameDigest digest;
+    
+    // The change that produced `version`, or nullptr once it has aged out
+    const GameChange* find(uint64_t version) const {
+        const GameChange& entry = entries[version % CHANGE_LOG_CAPACITY];
+        return (version != 0 && entry.version == version) ? &entry : nullptr;
+    }
+};
+
+// Serialized GET /games/{id} snapshots for one version, see game_delta.h.
+// Entries are immutable and shared; a new version replaces them wholesale.
+struct GameStateSnapshot {
+    uint64_t version = 0;
+    std::string json;
+};
+
+struct SnapshotCache {
+    std::mutex mutex;
+    bool valid = false;
+    uint64_t version = 0;
+    std::shared_ptr<const std::string> publicJson;      // members shared by every viewer
+    std::array<std::shared_ptr<const GameStateSnapshot>, MAX_PLAYERS + 1> viewers;  // [0] spectators, [p + 1] player p
+};
+
+// Contention counters for Game::mutex, updated by GameLock
+struct GameLockStats {
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> totalWaitNs{0};
+    std::atomic<uint64_t> totalHoldNs{0};
+    std::atomic<uint64_t> maxHoldNs{0};
 };
 
 struct Game {
@@ -308,18 +726,24 @@ struct Game {
     std::string name;
     
     GameBoard board;
-    std::vector<Player> players;
+    std::vector<Player> players;    // add through addPlayer so playerSlot stays in step
+    std::array<uint8_t, MAX_PLAYERS> playerSlot{};  // index + 1 of the player with each id, 0 for none
     
     // Dev card deck
     std::vector<DevCardType> devCardDeck;
     
+    // The seed the game was dealt from and the generator every later draw
+    // (dice, steals) takes from; see seedGame
+    uint64_t seed = 0;
+    GameRng rng;
+    
     // Turn state
     GamePhase phase = GamePhase::WaitingForPlayers;
     int currentPlayerIndex = 0;
     int setupRound = 0;             // 0 or 1 for setup phases
     std::optional<DiceRoll> lastRoll;
-    std::vector<TradeOffer> tradeOffers;           // All trade offers (active and completed)
-    std::vector<ChatMessage> chatMessages;         // All chat messages
+    TradeBook tradeOffers;          // Recent trade offers (active and completed)
+    ChatHistory chatMessages;       // Recent chat messages
     int nextTradeId = 1;
     int nextChatMessageId = 1;
     bool devCardPlayedThisTurn = false;
@@ -330,17 +754,40 @@ struct Game {
     int largestArmySize = 2;        // minimum to claim
     int largestArmyPlayerId = -1;
     
-    // Timestamps
+    // Timestamps. lastActivity is refreshed whenever a writer releases the
+    // game lock and is read by the reaper without it.
     std::chrono::steady_clock::time_point createdAt;
-    std::chrono::steady_clock::time_point lastActivity;
+    std::atomic<std::chrono::steady_clock::rep> lastActivity{0};
     
     // Settings
     int maxPlayers = 4;
     bool isPrivate = false;
     
-    // Mutex for thread-safe access
+    // Mutex for thread-safe access. Take it through GameLock.
     mutable std::mutex mutex;
+    mutable GameLockStats lockStats;
+
+    // Bumped when a writer releases the lock having changed client-visible
+    // state, so a snapshot taken under one lock can be validated under a
+    // later one. Readable without the lock.
+    std::atomic<uint64_t> version{0};
+    ChangeLog changes;              // guarded by mutex
+
+    // Set, under the lock, once the game has moved to another cluster node.
+    // Writers still holding a pointer to this copy are refused (GameMovedError).
+    std::atomic<bool> retired{false};
+    mutable SnapshotCache snapshots;    // guarded by its own mutex
     
+    void touch() {
+        lastActivity.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                           std::memory_order_relaxed);
+    }
+
+    std::chrono::steady_clock::time_point lastActive() const {
+        using Clock = std::chrono::steady_clock;
+        return Clock::time_point(Clock::duration(lastActivity.load(std::memory_order_relaxed)));
+    }
+
     Player* getCurrentPlayer() {
         if (currentPlayerIndex >= 0 && currentPlayerIndex < (int)players.size()) {
             return &players[currentPlayerIndex];
@@ -349,10 +796,114 @@ struct Game {
     }
     
     Player* getPlayerById(int id) {
-        for (auto& p : players) {
-            if (p.id == id) return &p;
+        if (id < 0 || id >= MAX_PLAYERS || playerSlot[id] == 0) return nullptr;
+        return &players[playerSlot[id] - 1];
+    }
+    
+    const Player* getPlayerById(int id) const {
+        return const_cast<Game*>(this)->getPlayerById(id);
+    }
+    
+    // Appends a player and indexes it by id. Ids must be unique and below
+    // MAX_PLAYERS.
+    Player& addPlayer(Player player) {
+        playerSlot[player.id] = static_cast<uint8_t>(players.size() + 1);
+        players.push_back(std::move(player));
+        return players.back();
+    }
+    
+    void clearPlayers() {
+        players.clear();
+        playerSlot.fill(0);
+    }
+};
+
+// Diff the game against its change log digest and, if anything visible
+// changed, record the next version. Called by GameLock before a write lock
+// is released.
+void commitChanges(Game& game);
+
+// ============================================================================
+// GAME LOCK
+// Scoped lock on Game::mutex that records wait and hold times. Write locks
+// commit their changes (see commitChanges) on release.
+// ============================================================================
+
+// Wait and hold times across all games, by lock mode, for GET /metrics
+struct GameLockMetrics {
+    Histogram* wait[2];     // indexed by GameLock::Mode
+    Histogram* hold[2];
+};
+const GameLockMetrics& gameLockMetrics();
+
+// Time spent recomputing road networks (the longest road) and legal build
+// locations, for GET /metrics
+struct BoardComputeMetrics {
+    Histogram* longestRoad;
+    Histogram* legalMoves;
+};
+const BoardComputeMetrics& boardComputeMetrics();
+
+// Thrown by a write lock on a game that moved to another node while the
+// writer waited; the request is retried on the new owner
+struct GameMovedError : std::runtime_error {
+    explicit GameMovedError(const std::string& gameId)
+        : std::runtime_error("game " + gameId + " moved to another node") {}
+};
+
+class GameLock {
+public:
+    enum class Mode { Read, Write };
+
+    explicit GameLock(const Game& g, Mode m = Mode::Write) : game(g), mode(m) { lock(); }
+    ~GameLock() { unlock(); }
+
+    GameLock(const GameLock&) = delete;
+    GameLock& operator=(const GameLock&) = delete;
+
+    void lock() {
+        if (held) return;
+        auto start = std::chrono::steady_clock::now();
+        game.mutex.lock();
+        if (mode == Mode::Write && game.retired.load()) {
+            game.mutex.unlock();
+            throw GameMovedError(game.gameId);
         }
-        return nullptr;
+        acquiredAt = std::chrono::steady_clock::now();
+        held = true;
+        uint64_t waitNs = elapsedNs(start, acquiredAt);
+        game.lockStats.acquisitions++;
+        game.lockStats.totalWaitNs += waitNs;
+        gameLockMetrics().wait[static_cast<int>(mode)]->record(waitNs);
+    }
+
+    void unlock() {
+        if (!held) return;
+        uint64_t holdNs = elapsedNs(acquiredAt, std::chrono::steady_clock::now());
+        if (mode == Mode::Write) {
+            Game& written = const_cast<Game&>(game);
+            commitChanges(written);
+            written.touch();
+        }
+        held = false;
+        game.mutex.unlock();
+
+        game.lockStats.totalHoldNs += holdNs;
+        gameLockMetrics().hold[static_cast<int>(mode)]->record(holdNs);
+        uint64_t prevMax = game.lockStats.maxHoldNs.load();
+        while (holdNs > prevMax && !game.lockStats.maxHoldNs.compare_exchange_weak(prevMax, holdNs)) {}
+    }
+
+private:
+    const Game& game;
+    Mode mode;
+    bool held = false;
+    std::chrono::steady_clock::time_point acquiredAt;
+
+    static uint64_t elapsedNs(std::chrono::steady_clock::time_point from,
+                              std::chrono::steady_clock::time_point to) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
     }
 };
 
@@ -362,15 +913,48 @@ struct Game {
 
 class GameManager {
 private:
-    std::unordered_map<std::string, std::unique_ptr<Game>> games;
-    mutable std::mutex mutex;
+    // Games are shared so a handler's pointer stays valid if the game is
+    // removed while it runs
+    StripedMap<std::shared_ptr<Game>> games;
+    
+    size_t chatHistoryLimit = DEFAULT_CHAT_HISTORY;
+    size_t tradeHistoryLimit = DEFAULT_TRADE_HISTORY;
+    
+    std::function<bool(const std::string& gameId, Game& game)> loader;
+    std::string idPrefix;
     
 public:
+    // Fills in a game that is not in memory, e.g. from storage. Called on a
+    // getGame miss with a new game carrying this manager's history limits;
+    // returns false if it knows no such game.
+    void setLoader(std::function<bool(const std::string& gameId, Game& game)> gameLoader) {
+        loader = std::move(gameLoader);
+    }
+    
+    // Prepended to the ids of games created from now on (the cluster node)
+    void setIdPrefix(std::string prefix) {
+        idPrefix = std::move(prefix);
+    }
+    
+    // Per-game caps for games created from now on
+    void setHistoryLimits(size_t chatMessages, size_t tradeOffers) {
+        chatHistoryLimit = chatMessages;
+        tradeHistoryLimit = tradeOffers;
+    }
+    
     // Create a new game, returns game ID
     std::string createGame(const std::string& name, int maxPlayers = 4);
     
-    // Get a game by ID (returns nullptr if not found)
-    Game* getGame(const std::string& gameId);
+    // Get a game by ID, loading it on a miss (returns nullptr if not found)
+    std::shared_ptr<Game> getGame(const std::string& gameId);
+    
+    // Adds a game handed over from elsewhere (another node): fill gets a new
+    // game with this manager's history limits. nullptr if fill fails or the
+    // id is already taken.
+    std::shared_ptr<Game> installGame(const std::string& gameId, const std::function<bool(Game& game)>& fill);
+    
+    // Only a game already in memory; never loads
+    std::shared_ptr<Game> getLoadedGame(const std::string& gameId) const;
     
     // List all public games
     std::vector<std::string> listGames();
@@ -380,21 +964,25 @@ public:
     
     // Get count of active games
     size_t gameCount() const;
+    
+    // The games in one stripe of the map, for incremental sweeps
+    static constexpr size_t sweepStripes() { return decltype(games)::stripeCount(); }
+    std::vector<std::shared_ptr<Game>> gamesInStripe(size_t stripe) const;
 };
 
 // ============================================================================
 // UTILITY FUNCTIONS (to be implemented)
 // ============================================================================
 
-// Board generation
-GameBoard generateRandomBoard();
+// Board generation, drawing from rng
+GameBoard generateRandomBoard(GameRng& rng);
+
+// The 25 development cards of the base game, unshuffled
+std::vector<DevCardType> standardDevCardDeck();
 
-// Coordinate helpers
-std::vector<VertexCoord> getAdjacentVertices(const HexCoord& hex);
-std::vector<EdgeCoord> getAdjacentEdges(const HexCoord& hex);
-std::vector<HexCoord> getHexesAdjacentToVertex(const VertexCoord& vertex);
-std::vector<VertexCoord> getVerticesAdjacentToVertex(const VertexCoord& vertex);
-std::vector<EdgeCoord> getEdgesAdjacentToVertex(const VertexCoord& vertex);
+// Seeds a new game's generator, then deals its board and shuffles its dev
+// card deck from it. Everything random afterwards also draws from game.rng.
+void seedGame(Game& game, uint64_t seed);
 
 // Resource production
 Resource hexTypeToResource(HexType type);
@@ -0,0 +1,487 @@
+#include "cluster.h"
+#include "sse_handler.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/tcp.h>
+
+namespace catan {
+
+namespace {
+
+constexpr uint64_t WAKE_TAG = 0;            // client ids start at 1
+constexpr int MAX_RECONNECTS = 3;
+constexpr int MAX_EVENTS = 64;
+
+struct ClusterMetrics {
+    Counter& forwarded;
+    Counter& forwardErrors;
+    Histogram& forwardLatency;
+    Counter& relayedEvents;
+};
+
+const ClusterMetrics& clusterMetrics() {
+    static const ClusterMetrics cluster{
+        metrics().counter("catan_cluster_forwarded_total", "Requests forwarded to the node owning the game"),
+        metrics().counter("catan_cluster_forward_errors_total", "Forwarded requests whose node could not be reached"),
+        metrics().histogram("catan_cluster_forward_seconds", "Round trip of a forwarded request"),
+        metrics().counter("catan_cluster_relayed_events_total", "SSE events relayed from other nodes"),
+    };
+    return cluster;
+}
+
+sockaddr_in resolveAddress(const std::string& hostPort) {
+    size_t colon = hostPort.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == hostPort.size()) {
+        throw std::runtime_error("Cluster node must be host:port: " + hostPort);
+    }
+    std::string host = hostPort.substr(0, colon);
+    std::string port = hostPort.substr(colon + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found) {
+        throw std::runtime_error("Cannot resolve cluster node " + hostPort);
+    }
+    sockaddr_in address;
+    std::memcpy(&address, found->ai_addr, sizeof(address));
+    freeaddrinfo(found);
+    return address;
+}
+
+// One "event:/id:/data:" block, without its blank line
+SSEEvent parseEvent(const std::string& block, bool& comment) {
+    SSEEvent event;
+    comment = true;
+    bool haveData = false;
+    size_t start = 0;
+    while (start < block.size()) {
+        size_t end = block.find('\n', start);
+        if (end == std::string::npos) end = block.size();
+        std::string line = block.substr(start, end - start);
+        start = end + 1;
+        if (line.empty() || line[0] == ':') continue;
+        comment = false;
+
+        size_t colon = line.find(':');
+        std::string field = line.substr(0, colon);
+        std::string value = colon == std::string::npos ? "" : line.substr(colon + 1);
+        if (!value.empty() && value[0] == ' ') value.erase(0, 1);
+        if (field == "event") {
+            event.event = value;
+        } else if (field == "id") {
+            event.id = value;
+        } else if (field == "data") {
+            if (haveData) event.data += '\n';
+            event.data += value;
+            haveData = true;
+        }
+    }
+    return event;
+}
+
+}  // namespace
+
+std::vector<std::string> parseClusterNodes(const std::string& list) {
+    std::vector<std::string> nodes;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string node = list.substr(start, end - start);
+        node.erase(std::remove_if(node.begin(), node.end(), ::isspace), node.end());
+        if (!node.empty()) nodes.push_back(node);
+        start = end + 1;
+    }
+    return nodes;
+}
+
+// ============================================================================
+// SSE RELAY
+// ============================================================================
+
+SSERelay::SSERelay(std::vector<sockaddr_in> addresses, std::vector<std::string> hosts,
+                   std::string secret, Resolver resolver)
+    : addresses(std::move(addresses)), hosts(std::move(hosts)),
+      secret(std::move(secret)), resolver(std::move(resolver)) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        throw std::runtime_error("SSE relay epoll setup failed");
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+}
+
+SSERelay::~SSERelay() {
+    stop();
+    for (auto& entry : upstreams) {
+        if (entry.second.fd >= 0) ::close(entry.second.fd);
+    }
+    ::close(epollFd);
+    ::close(wakeFd);
+}
+
+void SSERelay::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread(&SSERelay::run, this);
+}
+
+void SSERelay::stop() {
+    if (!running.exchange(false)) return;
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+    if (thread.joinable()) thread.join();
+}
+
+void SSERelay::subscribe(uint64_t clientId, const std::string& gameId, const std::string& token,
+                         uint64_t since, bool connectedSent, int hops) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Upstream& up = upstreams[clientId];
+        up.clientId = clientId;
+        up.gameId = gameId;
+        up.token = token;
+        up.lastVersion = since;
+        up.connectedSent = connectedSent;
+        up.hops = hops;
+        toConnect.push_back(clientId);
+    }
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+std::vector<SSERelay::Released> SSERelay::releaseGame(const std::string& gameId) {
+    std::vector<Released> released;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = upstreams.begin(); it != upstreams.end();) {
+        if (it->second.gameId != gameId) {
+            ++it;
+            continue;
+        }
+        released.push_back(Released{it->first, it->second.token, it->second.lastVersion});
+        closeUpstream(it->second);
+        it = upstreams.erase(it);
+    }
+    return released;
+}
+
+size_t SSERelay::relayCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return upstreams.size();
+}
+
+void SSERelay::run() {
+    epoll_event events[MAX_EVENTS];
+
+    while (running.load()) {
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+        if (n < 0 && errno != EINTR) break;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < n; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == WAKE_TAG) {
+                uint64_t counter;
+                while (::read(wakeFd, &counter, sizeof(counter)) > 0) {}
+                continue;
+            }
+            auto it = upstreams.find(tag);
+            if (it == upstreams.end()) continue;
+            Upstream& up = it->second;
+
+            if (!up.requested && (events[i].events & EPOLLOUT) && !(events[i].events & EPOLLERR)) {
+                sendRequest(up);
+            } else if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                readEvents(up);
+            }
+        }
+
+        std::vector<uint64_t> pending;
+        pending.swap(toConnect);
+        for (uint64_t clientId : pending) {
+            auto it = upstreams.find(clientId);
+            if (it != upstreams.end() && it->second.fd < 0) connect(it->second);
+        }
+    }
+}
+
+void SSERelay::connect(Upstream& up) {
+    up.node = resolver(up.gameId);
+    if (up.node < 0 || up.node >= static_cast<int>(addresses.size())) {
+        // Held here now: the client gets the local broadcasts
+        drop(up.clientId, false);
+        return;
+    }
+    up.requested = up.streaming = false;
+    up.buffer.clear();
+    up.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (up.fd < 0) {
+        drop(up.clientId, true);
+        return;
+    }
+    int one = 1;
+    setsockopt(up.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    const sockaddr_in& address = addresses[static_cast<size_t>(up.node)];
+    if (::connect(up.fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 &&
+        errno != EINPROGRESS) {
+        lost(up);
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+    ev.data.u64 = up.clientId;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, up.fd, &ev);
+}
+
+void SSERelay::sendRequest(Upstream& up) {
+    std::string target = "/games/" + up.gameId + "/events";
+    char separator = '?';
+    if (!up.token.empty()) {
+        target += "?token=" + up.token;
+        separator = '&';
+    }
+    if (up.lastVersion > 0) {
+        target += separator;
+        target += "since=" + std::to_string(up.lastVersion);
+    }
+    std::string request = "GET " + target + " HTTP/1.1\r\nHost: " + hosts[static_cast<size_t>(up.node)] +
+                          "\r\nAccept: text/event-stream\r\n" + CLUSTER_HOPS_HEADER + ": " +
+                          std::to_string(up.hops) + "\r\n";
+    if (!secret.empty()) request += std::string(CLUSTER_SECRET_HEADER) + ": " + secret + "\r\n";
+    request += "\r\n";
+
+    if (::send(up.fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size())) {
+        lost(up);
+        return;
+    }
+    up.requested = true;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.u64 = up.clientId;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, up.fd, &ev);
+}
+
+void SSERelay::readEvents(Upstream& up) {
+    char chunk[16384];
+    bool closed = false;
+    for (;;) {
+        ssize_t n = ::recv(up.fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            up.buffer.append(chunk, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closed = true;
+        break;
+    }
+
+    size_t start = 0;
+    if (!up.streaming) {
+        size_t headEnd = up.buffer.find("\r\n\r\n");
+        if (headEnd == std::string::npos) {
+            if (closed) lost(up);
+            return;
+        }
+        if (up.buffer.compare(0, 12, "HTTP/1.1 200") != 0) {
+            drop(up.clientId, true);     // the owner doesn't know the game
+            return;
+        }
+        up.streaming = true;
+        up.failures = 0;
+        start = headEnd + 4;
+    }
+
+    for (size_t end; (end = up.buffer.find("\n\n", start)) != std::string::npos; start = end + 2) {
+        bool comment = false;
+        SSEEvent event = parseEvent(up.buffer.substr(start, end - start), comment);
+        if (comment) {
+            // Upstream keepalive: a chance to notice a client that left
+            if (!sseManager.hasClient(up.clientId)) {
+                drop(up.clientId, false);
+                return;
+            }
+            continue;
+        }
+        if (event.event == "connected") {
+            if (up.connectedSent) continue;
+            up.connectedSent = true;
+        }
+        if (!event.id.empty()) {
+            up.lastVersion = std::strtoull(event.id.c_str(), nullptr, 10);
+        }
+        if (!sseManager.sendToClient(up.clientId, event)) {
+            drop(up.clientId, false);
+            return;
+        }
+        clusterMetrics().relayedEvents.add();
+    }
+    up.buffer.erase(0, start);
+
+    if (closed) lost(up);
+}
+
+void SSERelay::lost(Upstream& up) {
+    closeUpstream(up);
+    if (++up.failures > MAX_RECONNECTS || !running.load()) {
+        drop(up.clientId, true);
+        return;
+    }
+    toConnect.push_back(up.clientId);
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void SSERelay::closeUpstream(Upstream& up) {
+    if (up.fd < 0) return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, up.fd, nullptr);
+    ::close(up.fd);
+    up.fd = -1;
+}
+
+void SSERelay::drop(uint64_t clientId, bool closeClient) {
+    auto it = upstreams.find(clientId);
+    if (it == upstreams.end()) return;
+    closeUpstream(it->second);
+    upstreams.erase(it);
+    // The browser's EventSource reconnects, to whichever node it likes
+    if (closeClient) sseManager.closeClient(clientId);
+}
+
+// ============================================================================
+// CLUSTER NODE
+// ============================================================================
+
+ClusterNode::ClusterNode(ClusterConfig cfg, std::function<bool(const std::string& gameId)> holds)
+    : config(std::move(cfg)), holdsGame(std::move(holds)) {
+    if (config.nodes.size() < 2) {
+        throw std::runtime_error("A cluster needs at least two nodes");
+    }
+    if (config.self < 0 || config.self >= nodeCount()) {
+        throw std::runtime_error("Cluster node index out of range");
+    }
+
+    std::vector<sockaddr_in> addresses;
+    for (const auto& node : config.nodes) {
+        addresses.push_back(resolveAddress(node));
+    }
+    sseRelay = std::make_unique<SSERelay>(std::move(addresses), config.nodes, config.secret,
+                                          [this](const std::string& gameId) {
+        if (holdsGame(gameId)) return -1;
+        int owner = ownerOf(gameId);
+        return owner == self() ? -1 : owner;
+    });
+    sseRelay->start();
+    clusterMetrics();
+}
+
+ClusterNode::~ClusterNode() {
+    sseRelay->stop();
+}
+
+std::string ClusterNode::gameIdPrefix() const {
+    return std::to_string(config.self) + "-";
+}
+
+int ClusterNode::homeOf(const std::string& gameId) const {
+    size_t dash = gameId.find('-');
+    if (dash == 0 || dash == std::string::npos || dash > 3) return config.self;
+    int node = 0;
+    for (size_t i = 0; i < dash; i++) {
+        if (gameId[i] < '0' || gameId[i] > '9') return config.self;
+        node = node * 10 + (gameId[i] - '0');
+    }
+    return node < nodeCount() ? node : config.self;
+}
+
+int ClusterNode::ownerOf(const std::string& gameId) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(locationsMutex);
+        auto it = locations.find(gameId);
+        if (it != locations.end()) return it->second;
+    }
+    return homeOf(gameId);
+}
+
+void ClusterNode::setLocation(const std::string& gameId, int node) {
+    std::unique_lock<std::shared_mutex> lock(locationsMutex);
+    if (node == homeOf(gameId) || node < 0 || node >= nodeCount()) {
+        locations.erase(gameId);
+    } else {
+        locations[gameId] = node;
+    }
+}
+
+bool ClusterNode::authorized(const HTTPRequest& req) const {
+    return config.secret.empty() || req.headers.get(CLUSTER_SECRET_HEADER) == config.secret;
+}
+
+HTTPClientResponse ClusterNode::send(int node, const std::string& method, const std::string& target,
+                                     const std::string& body, HTTPHeaderList headers) {
+    if (!config.secret.empty()) headers.emplace_back(CLUSTER_SECRET_HEADER, config.secret);
+    HTTPClientOptions options;
+    options.connectTimeoutMs = std::min(options.connectTimeoutMs, config.forwardTimeoutMs);
+    options.requestTimeoutMs = config.forwardTimeoutMs;
+    return client.request(method, "http://" + nodeAddress(node) + target, body, headers, options);
+}
+
+HTTPResponse ClusterNode::forward(int node, const HTTPRequest& req, const std::string& gameId, int hops) {
+    const ClusterMetrics& cm = clusterMetrics();
+    cm.forwarded.add();
+
+    HTTPHeaderList headers = {{CLUSTER_HOPS_HEADER, std::to_string(hops)}};
+    for (const char* name : {"authorization", "content-type", "if-none-match"}) {
+        auto it = req.headers.find(name);
+        if (it != req.headers.end()) headers.emplace_back(std::string(it->first), std::string(it->second));
+    }
+    std::string target = req.path;
+    if (!req.query.empty()) target += "?" + req.query;
+
+    HTTPClientResponse reply;
+    try {
+        ScopedTimer timer(cm.forwardLatency);
+        reply = send(node, req.method, target, req.body, std::move(headers));
+    } catch (const std::exception& e) {
+        cm.forwardErrors.add();
+        HTTPResponse response;
+        response.status = 502;
+        response.body = "{\"error\":\"Node " + std::to_string(node) + " unreachable\"}";
+        return response;
+    }
+
+    HTTPResponse response;
+    response.status = reply.status;
+    auto type = reply.headers.find("content-type");
+    if (type != reply.headers.end()) response.contentType = type->second;
+    response.body = std::move(reply.body);
+    for (const char* name : {"etag", "cache-control", "retry-after"}) {
+        auto it = reply.headers.find(name);
+        if (it != reply.headers.end()) response.headers += std::string(name) + ": " + it->second + "\r\n";
+    }
+
+    auto owner = reply.headers.find("x-catan-node");
+    if (owner != reply.headers.end()) {
+        int answered = std::atoi(owner->second.c_str());
+        setLocation(gameId, answered);
+        response.headers += std::string(CLUSTER_NODE_HEADER) + ": " + owner->second + "\r\n";
+    }
+    return response;
+}
+
+}  // namespace catan
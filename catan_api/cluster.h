@@ -0,0 +1,183 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <netinet/in.h>
+
+#include "http_server.h"
+#include "http_client.h"
+
+namespace catan {
+
+// ============================================================================
+// CLUSTER
+// Several servers sharing one game namespace. Each game lives on exactly one
+// node. Its id starts with the index of the node that created it (its home),
+// so any node can route a request for a game it has never seen. Requests for
+// a game held elsewhere are forwarded to the owner over pooled keep-alive
+// connections, and SSE subscriptions are relayed the same way. A game can
+// move to another node; the node it left and its home remember where it
+// went, and forwarded responses name the node that answered so the next
+// request skips the extra hop.
+// ============================================================================
+
+struct ClusterConfig {
+    std::vector<std::string> nodes;     // host:port of every node, the same list on each
+    int self = -1;                      // this node's index in nodes
+    std::string secret;                 // required on /cluster requests when set
+    int forwardTimeoutMs = 10000;
+};
+
+// "host:port,host:port" -> entries; blanks are skipped
+std::vector<std::string> parseClusterNodes(const std::string& list);
+
+constexpr const char* CLUSTER_HOPS_HEADER = "X-Catan-Hops";        // times a request has been forwarded
+constexpr const char* CLUSTER_NODE_HEADER = "X-Catan-Node";        // node that handled a game request
+constexpr const char* CLUSTER_SECRET_HEADER = "X-Catan-Cluster-Secret";
+constexpr int CLUSTER_MAX_HOPS = 3;
+
+// ============================================================================
+// SSE RELAY
+// Feeds local SSE clients from a game's event stream on the node that owns
+// it. One thread multiplexes every upstream connection with epoll. Clients
+// are named by id, never by pointer, so one that has gone away is noticed
+// the next time anything arrives for it (upstream keepalives included). An
+// upstream that drops is reopened from the last version relayed, at
+// whichever node owns the game by then.
+// ============================================================================
+
+class SSERelay {
+public:
+    // Node that owns a game now, or -1 if it is held here
+    using Resolver = std::function<int(const std::string& gameId)>;
+
+    struct Released {
+        uint64_t clientId;
+        std::string token;
+        uint64_t lastVersion;
+    };
+
+    SSERelay(std::vector<sockaddr_in> addresses, std::vector<std::string> hosts,
+             std::string secret, Resolver resolver);
+    ~SSERelay();
+
+    SSERelay(const SSERelay&) = delete;
+    SSERelay& operator=(const SSERelay&) = delete;
+
+    void start();
+    void stop();
+
+    // Relays a game's events into a registered local SSE client. since is
+    // the version the client already has (0 for none); connectedSent says
+    // whether it has had its "connected" event.
+    void subscribe(uint64_t clientId, const std::string& gameId, const std::string& token,
+                   uint64_t since, bool connectedSent, int hops);
+
+    // Stops relaying a game that has moved here. The clients stay registered
+    // under the game and get its local broadcasts from now on.
+    std::vector<Released> releaseGame(const std::string& gameId);
+
+    size_t relayCount() const;
+
+private:
+    struct Upstream {
+        uint64_t clientId = 0;
+        std::string gameId;
+        std::string token;
+        uint64_t lastVersion = 0;
+        bool connectedSent = false;
+        int hops = 1;
+        int node = -1;
+        int fd = -1;
+        bool requested = false;
+        bool streaming = false;         // past the response head
+        int failures = 0;               // reconnects since the last good stream
+        std::string buffer;
+    };
+
+    std::vector<sockaddr_in> addresses;
+    std::vector<std::string> hosts;
+    std::string secret;
+    Resolver resolver;
+
+    mutable std::mutex mutex;           // everything below; held by the thread while it works
+    std::unordered_map<uint64_t, Upstream> upstreams;     // by client id
+    std::vector<uint64_t> toConnect;
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    void run();
+    void connect(Upstream& up);
+    void sendRequest(Upstream& up);
+    void readEvents(Upstream& up);
+    void lost(Upstream& up);            // upstream closed or failed: reconnect or give up
+    void drop(uint64_t clientId, bool closeClient);
+    void closeUpstream(Upstream& up);
+};
+
+// ============================================================================
+// CLUSTER NODE
+// ============================================================================
+
+class ClusterNode {
+public:
+    // holdsGame says whether a game is in memory here. Throws
+    // std::runtime_error on a bad config or an address that doesn't resolve.
+    ClusterNode(ClusterConfig config, std::function<bool(const std::string& gameId)> holdsGame);
+    ~ClusterNode();
+
+    ClusterNode(const ClusterNode&) = delete;
+    ClusterNode& operator=(const ClusterNode&) = delete;
+
+    int self() const { return config.self; }
+    int nodeCount() const { return static_cast<int>(config.nodes.size()); }
+    const std::string& nodeAddress(int node) const { return config.nodes[static_cast<size_t>(node)]; }
+
+    // Prefix of the ids of games created here, "<self>-"
+    std::string gameIdPrefix() const;
+
+    // Node whose index starts the id; self for ids without one
+    int homeOf(const std::string& gameId) const;
+
+    // Where a game not held here should be asked for: where it was last
+    // seen to go, else its home
+    int ownerOf(const std::string& gameId) const;
+    void setLocation(const std::string& gameId, int node);
+
+    // A /cluster request carries the shared secret (always true without one)
+    bool authorized(const HTTPRequest& req) const;
+
+    // Sends a request to another node. Throws std::runtime_error when the
+    // node can't be reached; other statuses are returned.
+    HTTPClientResponse send(int node, const std::string& method, const std::string& target,
+                            const std::string& body, HTTPHeaderList headers = {});
+
+    // Replays a client's request on the node holding the game and returns
+    // that node's response (502 if it is unreachable). Learns the game's
+    // location from the reply.
+    HTTPResponse forward(int node, const HTTPRequest& req, const std::string& gameId, int hops);
+
+    SSERelay& relay() { return *sseRelay; }
+
+private:
+    ClusterConfig config;
+    std::function<bool(const std::string& gameId)> holdsGame;
+    HTTPClient client;                  // internal connections, pooled per node
+    std::unique_ptr<SSERelay> sseRelay;
+
+    // Games that are not at their home, as far as this node knows
+    mutable std::shared_mutex locationsMutex;
+    std::unordered_map<std::string, int> locations;
+};
+
+}  // namespace catan
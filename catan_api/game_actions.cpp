@@ -0,0 +1,450 @@
+#include "game_actions.h"
+#include "game_logic.h"
+#include "metrics.h"
+
+namespace catan {
+
+namespace {
+
+constexpr size_t ACTION_TYPES = static_cast<size_t>(ActionType::Count);
+
+const char* const ACTION_NAMES[ACTION_TYPES] = {
+    "roll_dice", "place_setup_settlement", "place_setup_road", "build_road",
+    "build_settlement", "build_city", "buy_dev_card", "bank_trade", "move_robber",
+    "end_turn", "send_chat", "propose_trade", "accept_trade", "reject_trade",
+    "counter_trade", "cancel_trade"
+};
+
+// Applied and refused counts by action, for GET /metrics
+struct ActionMetrics {
+    Counter* applied[ACTION_TYPES];
+    Counter* refused[ACTION_TYPES];
+};
+
+ActionMetrics& actionMetrics() {
+    static ActionMetrics m = [] {
+        ActionMetrics m{};
+        const char* help = "Game actions by outcome";
+        for (size_t t = 0; t < ACTION_TYPES; t++) {
+            m.applied[t] = &metrics().counter("catan_actions_total", help,
+                metricLabels({{"action", ACTION_NAMES[t]}, {"result", "applied"}}));
+            m.refused[t] = &metrics().counter("catan_actions_total", help,
+                metricLabels({{"action", ACTION_NAMES[t]}, {"result", "refused"}}));
+        }
+        return m;
+    }();
+    return m;
+}
+
+bool isSetupPhase(GamePhase phase) {
+    return phase == GamePhase::Setup || phase == GamePhase::SetupReverse;
+}
+
+// Actions taken on your own turn, as opposed to chat and trade responses
+bool needsTurn(ActionType type) {
+    return type <= ActionType::EndTurn;
+}
+
+uint64_t appendChat(Game& game, int fromPlayerId, int toPlayerId, ChatMessageType type,
+                    int tradeId, std::string content, const TradeOffer* offer = nullptr) {
+    ChatMessage msg;
+    uint64_t id = static_cast<uint64_t>(game.nextChatMessageId++);
+    msg.id = std::to_string(id);
+    msg.fromPlayerId = fromPlayerId;
+    msg.toPlayerId = toPlayerId;
+    msg.type = type;
+    msg.relatedTradeId = tradeId;
+    msg.content = std::move(content);
+    msg.timestamp = std::chrono::steady_clock::now();
+    if (offer) {
+        msg.tradeOffering = offer->offering;
+        msg.tradeRequesting = offer->requesting;
+    }
+    game.chatMessages.append(msg);
+    return id;
+}
+
+void checkWinner(Game& game, ActionResult& result) {
+    int winner = checkForWinner(game);
+    if (winner < 0) return;
+    game.phase = GamePhase::Finished;
+    result.winner = winner;
+}
+
+// One card at random, each card in the hand equally likely
+Resource steal(Player& victim, Player& thief, GameRng& rng) {
+    int total = victim.resources.total();
+    if (total <= 0) return Resource::None;
+    int pick = static_cast<int>(rng.uniform(static_cast<uint64_t>(total)));
+    for (Resource r : {Resource::Wood, Resource::Brick, Resource::Wheat, Resource::Sheep, Resource::Ore}) {
+        if (pick < victim.resources[r]) {
+            victim.resources[r]--;
+            thief.resources[r]++;
+            return r;
+        }
+        pick -= victim.resources[r];
+    }
+    return Resource::None;
+}
+
+// Opens a trade from action.playerId; shared by propose and counter
+void openTrade(Game& game, const Action& action, int toPlayerId, ActionResult& result) {
+    TradeOffer trade;
+    trade.id = game.nextTradeId++;
+    trade.fromPlayerId = action.playerId;
+    trade.toPlayerId = toPlayerId;
+    trade.offering = action.offering;
+    trade.requesting = action.requesting;
+    trade.isActive = true;
+
+    std::string content;
+    if (action.type == ActionType::CounterTrade) {
+        content = "🔄 Counter-offer to Trade #" + std::to_string(action.tradeId) + ": Offering ";
+    } else {
+        content = "📦 Trade Proposal: Offering ";
+    }
+    content += describeResources(action.offering) + " for " + describeResources(action.requesting);
+    if (!action.message.empty()) content += " - \"" + action.message + "\"";
+
+    ChatMessageType type = action.type == ActionType::CounterTrade ? ChatMessageType::TradeCounter
+                                                                   : ChatMessageType::TradeProposal;
+    uint64_t id = appendChat(game, action.playerId, toPlayerId, type, trade.id, std::move(content), &trade);
+    trade.chatMessageId = std::to_string(id);
+    game.tradeOffers.add(trade);
+
+    result.tradeId = trade.id;
+    result.chatMessageId = id;
+}
+
+ActionError apply(Game& game, const Action& action, Player& player, ActionResult& result) {
+    GameBoard& board = game.board;
+    const int playerId = action.playerId;
+
+    if (needsTurn(action.type) && game.currentPlayerIndex != playerId) return ActionError::NotYourTurn;
+
+    switch (action.type) {
+        case ActionType::RollDice: {
+            if (game.phase != GamePhase::Rolling) return ActionError::WrongPhase;
+            DiceRoll roll{game.rng.between(1, 6), game.rng.between(1, 6)};  // braces fix the order
+            game.lastRoll = roll;
+            result.roll = roll;
+            if (roll.total() == 7) {
+                game.phase = GamePhase::Robber;
+                return ActionError::None;
+            }
+            result.production = &distributeResources(game, roll.total());
+            game.phase = GamePhase::MainTurn;
+            return ActionError::None;
+        }
+
+        case ActionType::PlaceSetupSettlement: {
+            if (!isSetupPhase(game.phase)) return ActionError::WrongPhase;
+            // One settlement at a time: the last one still needs its road
+            VertexMask awaitingRoad = board.playerBuildings[playerId] & ~board.playerRoadEnds[playerId];
+            if (awaitingRoad || action.vertex >= NUM_VERTICES ||
+                !placeSetupSettlement(game, playerId, action.vertex)) return ActionError::InvalidLocation;
+            if (game.phase == GamePhase::SetupReverse) {
+                giveInitialResources(game, playerId, action.vertex);
+            }
+            return ActionError::None;
+        }
+
+        case ActionType::PlaceSetupRoad: {
+            if (!isSetupPhase(game.phase)) return ActionError::WrongPhase;
+            // The road has to touch the settlement just placed
+            VertexMask awaitingRoad = board.playerBuildings[playerId] & ~board.playerRoadEnds[playerId];
+            if (action.edge >= NUM_EDGES || !(boardTopology().edgeVertexMask[action.edge] & awaitingRoad) ||
+                !placeSetupRoad(game, playerId, action.edge)) return ActionError::InvalidLocation;
+            advanceSetupPhase(game);
+            result.nextPlayer = game.currentPlayerIndex;
+            return ActionError::None;
+        }
+
+        case ActionType::BuildRoad: {
+            if (game.phase != GamePhase::MainTurn) return ActionError::WrongPhase;
+            if (!canAfford(player.resources, ROAD_COST)) return ActionError::NotEnoughResources;
+            if (player.roadsRemaining <= 0) return ActionError::NoPiecesLeft;
+            if (action.edge >= NUM_EDGES || board.hasRoad(action.edge) ||
+                !isRoadConnectedToNetwork(game, playerId, action.edge)) return ActionError::InvalidLocation;
+            board.placeRoad(action.edge, playerId);
+            subtractResources(player.resources, ROAD_COST);
+            player.roadsRemaining--;
+            updateLongestRoad(game);
+            checkWinner(game, result);
+            return ActionError::None;
+        }
+
+        case ActionType::BuildSettlement: {
+            if (game.phase != GamePhase::MainTurn) return ActionError::WrongPhase;
+            if (!canAfford(player.resources, SETTLEMENT_COST)) return ActionError::NotEnoughResources;
+            if (player.settlementsRemaining <= 0) return ActionError::NoPiecesLeft;
+            if (action.vertex >= NUM_VERTICES ||
+                !(settlementMask(game, playerId) & vertexBit(action.vertex))) return ActionError::InvalidLocation;
+            board.placeSettlement(action.vertex, playerId);
+            subtractResources(player.resources, SETTLEMENT_COST);
+            player.settlementsRemaining--;
+            // The settlement may cut an opponent's road
+            updateLongestRoad(game);
+            checkWinner(game, result);
+            return ActionError::None;
+        }
+
+        case ActionType::BuildCity: {
+            if (game.phase != GamePhase::MainTurn) return ActionError::WrongPhase;
+            if (!canAfford(player.resources, CITY_COST)) return ActionError::NotEnoughResources;
+            if (player.citiesRemaining <= 0) return ActionError::NoPiecesLeft;
+            if (action.vertex >= NUM_VERTICES ||
+                !(cityMask(game, playerId) & vertexBit(action.vertex))) return ActionError::InvalidLocation;
+            board.upgradeToCity(action.vertex);
+            subtractResources(player.resources, CITY_COST);
+            player.citiesRemaining--;
+            player.settlementsRemaining++;      // the settlement comes back
+            checkWinner(game, result);
+            return ActionError::None;
+        }
+
+        case ActionType::BuyDevCard: {
+            if (game.phase != GamePhase::MainTurn) return ActionError::WrongPhase;
+            if (!canAfford(player.resources, DEV_CARD_COST)) return ActionError::NotEnoughResources;
+            if (game.devCardDeck.empty()) return ActionError::DeckEmpty;
+            subtractResources(player.resources, DEV_CARD_COST);
+            result.card = game.devCardDeck.back();
+            game.devCardDeck.pop_back();
+            player.devCards.push_back(result.card);
+            checkWinner(game, result);          // a victory point card counts at once
+            return ActionError::None;
+        }
+
+        case ActionType::BankTrade: {
+            if (game.phase != GamePhase::MainTurn) return ActionError::WrongPhase;
+            if (action.give == Resource::None || action.receive == Resource::None) return ActionError::InvalidResource;
+            if (action.give == action.receive) return ActionError::SameResource;
+            // 2:1 at a matching port, 3:1 at a generic one, else 4:1
+            result.ratio = getTradeRatio(game, playerId, action.give);
+            if (player.resources[action.give] < result.ratio) return ActionError::NotEnoughResources;
+            player.resources[action.give] -= result.ratio;
+            player.resources[action.receive]++;
+            return ActionError::None;
+        }
+
+        case ActionType::MoveRobber: {
+            if (game.phase != GamePhase::Robber) return ActionError::WrongPhase;
+            if (action.hex >= NUM_HEXES) return ActionError::InvalidLocation;
+            board.moveRobber(action.hex);
+            if (action.victimId != playerId) {
+                Player* victim = game.getPlayerById(action.victimId);
+                if (victim) result.stolen = steal(*victim, player, game.rng);
+            }
+            game.phase = GamePhase::MainTurn;
+            return ActionError::None;
+        }
+
+        case ActionType::EndTurn: {
+            if (game.phase != GamePhase::MainTurn) return ActionError::WrongPhase;
+            game.currentPlayerIndex = (game.currentPlayerIndex + 1) % static_cast<int>(game.players.size());
+            game.phase = GamePhase::Rolling;
+            game.devCardPlayedThisTurn = false;
+            result.nextPlayer = game.currentPlayerIndex;
+            return ActionError::None;
+        }
+
+        case ActionType::SendChat: {
+            if (action.message.empty()) return ActionError::EmptyMessage;
+            result.chatMessageId = appendChat(game, playerId, action.toPlayerId, ChatMessageType::Normal,
+                                              -1, action.message);
+            return ActionError::None;
+        }
+
+        case ActionType::ProposeTrade: {
+            if (!canAfford(player.resources, action.offering)) return ActionError::NotEnoughResources;
+            openTrade(game, action, action.toPlayerId, result);
+            return ActionError::None;
+        }
+
+        case ActionType::CounterTrade: {
+            const TradeOffer* original = game.tradeOffers.find(action.tradeId);
+            if (!original) return ActionError::TradeNotFound;
+            if (!canAfford(player.resources, action.offering)) return ActionError::NotEnoughResources;
+            openTrade(game, action, original->fromPlayerId, result);    // back to the proposer
+            return ActionError::None;
+        }
+
+        case ActionType::AcceptTrade: {
+            TradeOffer* trade = game.tradeOffers.find(action.tradeId);
+            if (!trade) return ActionError::TradeNotFound;
+            if (!trade->isActive) return ActionError::TradeInactive;
+            if (trade->fromPlayerId == playerId) return ActionError::OwnTrade;
+            if (trade->toPlayerId != -1 && trade->toPlayerId != playerId) return ActionError::TradeNotForYou;
+            if (!canAfford(player.resources, trade->requesting)) return ActionError::NotEnoughResources;
+            Player* proposer = game.getPlayerById(trade->fromPlayerId);
+            if (!proposer || !canAfford(proposer->resources, trade->offering)) {
+                trade->isActive = false;
+                return ActionError::ProposerCannotPay;
+            }
+
+            subtractResources(proposer->resources, trade->offering);
+            player.resources += trade->offering;
+            subtractResources(player.resources, trade->requesting);
+            proposer->resources += trade->requesting;
+            trade->isActive = false;
+            trade->acceptedByPlayerIds.push_back(playerId);
+
+            result.tradeId = trade->id;
+            result.chatMessageId = appendChat(game, playerId, -1, ChatMessageType::TradeAccept, trade->id,
+                "✅ " + player.name + " accepted the trade with " + proposer->name + "!");
+            return ActionError::None;
+        }
+
+        case ActionType::RejectTrade: {
+            TradeOffer* trade = game.tradeOffers.find(action.tradeId);
+            if (!trade) return ActionError::TradeNotFound;
+            if (!trade->isActive) return ActionError::TradeInactive;
+            trade->rejectedByPlayerIds.push_back(playerId);
+            result.tradeId = trade->id;
+            result.chatMessageId = appendChat(game, playerId, -1, ChatMessageType::TradeReject, trade->id,
+                                              "❌ " + player.name + " rejected the trade.");
+            return ActionError::None;
+        }
+
+        case ActionType::CancelTrade: {
+            TradeOffer* trade = game.tradeOffers.find(action.tradeId);
+            if (!trade) return ActionError::TradeNotFound;
+            if (trade->fromPlayerId != playerId) return ActionError::NotProposer;
+            if (!trade->isActive) return ActionError::TradeInactive;
+            trade->isActive = false;
+            result.tradeId = trade->id;
+            result.chatMessageId = appendChat(game, playerId, -1, ChatMessageType::System, trade->id,
+                                              "🚫 " + player.name + " cancelled their trade offer.");
+            return ActionError::None;
+        }
+
+        case ActionType::Count:
+            break;
+    }
+    return ActionError::UnknownAction;
+}
+
+}  // namespace
+
+ActionResult applyAction(Game& game, const Action& action) {
+    ActionResult result;
+    Player* player = game.getPlayerById(action.playerId);
+    if (action.type >= ActionType::Count) {
+        result.error = ActionError::UnknownAction;
+        return result;
+    }
+    result.error = player ? apply(game, action, *player, result) : ActionError::PlayerNotFound;
+
+    ActionMetrics& m = actionMetrics();
+    size_t t = static_cast<size_t>(action.type);
+    (result.ok() ? m.applied[t] : m.refused[t])->add();
+    return result;
+}
+
+size_t applyActions(Game& game, const Action* actions, size_t count, ActionResult* results) {
+    for (size_t i = 0; i < count; i++) {
+        results[i] = applyAction(game, actions[i]);
+        if (!results[i].ok()) return i;
+    }
+    return count;
+}
+
+const char* actionName(ActionType type) {
+    size_t t = static_cast<size_t>(type);
+    return t < ACTION_TYPES ? ACTION_NAMES[t] : "unknown";
+}
+
+bool actionTypeFromName(std::string_view name, ActionType& type) {
+    for (size_t t = 0; t < ACTION_TYPES; t++) {
+        if (name == ACTION_NAMES[t]) {
+            type = static_cast<ActionType>(t);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* actionErrorMessage(ActionError error, ActionType type) {
+    switch (error) {
+        case ActionError::None: return "";
+        case ActionError::PlayerNotFound: return "Player not found";
+        case ActionError::NotYourTurn: return "Not your turn";
+        case ActionError::WrongPhase:
+            switch (type) {
+                case ActionType::RollDice: return "Cannot roll now, phase is not Rolling";
+                case ActionType::PlaceSetupSettlement:
+                case ActionType::PlaceSetupRoad: return "Not in setup phase";
+                case ActionType::BuyDevCard: return "Cannot buy during this phase";
+                case ActionType::BankTrade: return "Cannot trade during this phase";
+                case ActionType::MoveRobber: return "Not in robber phase";
+                case ActionType::EndTurn: return "Cannot end turn during this phase";
+                default: return "Cannot build during this phase";
+            }
+        case ActionError::NotEnoughResources:
+            switch (type) {
+                case ActionType::BuildRoad: return "Not enough resources. Road costs 1 wood + 1 brick";
+                case ActionType::BuildSettlement:
+                    return "Not enough resources. Settlement costs 1 wood + 1 brick + 1 wheat + 1 sheep";
+                case ActionType::BuildCity: return "Not enough resources. City costs 2 wheat + 3 ore";
+                case ActionType::BuyDevCard: return "Not enough resources. Dev card costs 1 wheat + 1 sheep + 1 ore";
+                case ActionType::BankTrade: return "Not enough resources for this bank trade";
+                case ActionType::ProposeTrade:
+                case ActionType::CounterTrade: return "You don't have enough resources to offer";
+                default: return "You don't have enough resources";
+            }
+        case ActionError::NoPiecesLeft:
+            switch (type) {
+                case ActionType::BuildRoad: return "No roads remaining";
+                case ActionType::BuildSettlement: return "No settlements remaining";
+                default: return "No cities remaining";
+            }
+        case ActionError::InvalidLocation:
+            switch (type) {
+                case ActionType::PlaceSetupSettlement: return "Invalid settlement location for setup";
+                case ActionType::PlaceSetupRoad: return "Road must connect to the settlement just placed";
+                case ActionType::BuildRoad: return "Invalid road location. Must connect to your network.";
+                case ActionType::BuildSettlement:
+                    return "Invalid settlement location. Must be on your road network and 2+ edges from other buildings.";
+                case ActionType::BuildCity: return "Invalid city location. Must upgrade your own settlement.";
+                default: return "Invalid robber location";
+            }
+        case ActionError::DeckEmpty: return "No development cards remaining";
+        case ActionError::InvalidResource: return "Invalid resources. Use: wood, brick, wheat, sheep, ore";
+        case ActionError::SameResource: return "Cannot trade same resource";
+        case ActionError::EmptyMessage: return "Message cannot be empty";
+        case ActionError::TradeNotFound: return "Trade not found";
+        case ActionError::TradeInactive: return "Trade is no longer active";
+        case ActionError::OwnTrade: return "Cannot accept your own trade";
+        case ActionError::TradeNotForYou: return "This trade is not for you";
+        case ActionError::ProposerCannotPay: return "Proposer no longer has the resources";
+        case ActionError::NotProposer: return "Only the proposer can cancel this trade";
+        case ActionError::UnknownAction: return "Unknown action";
+    }
+    return "Action refused";
+}
+
+int actionErrorStatus(ActionError error) {
+    switch (error) {
+        case ActionError::None: return 200;
+        case ActionError::PlayerNotFound:
+        case ActionError::TradeNotFound: return 404;
+        case ActionError::NotProposer: return 403;
+        default: return 400;
+    }
+}
+
+std::string describeResources(const ResourceHand& hand) {
+    static const std::pair<Resource, const char*> names[] = {
+        {Resource::Wood, "wood"}, {Resource::Brick, "brick"}, {Resource::Wheat, "wheat"},
+        {Resource::Sheep, "sheep"}, {Resource::Ore, "ore"}
+    };
+    std::string text;
+    for (const auto& [resource, name] : names) {
+        if (hand[resource] <= 0) continue;
+        if (!text.empty()) text += ", ";
+        text += std::to_string(hand[resource]) + " " + name;
+    }
+    return text.empty() ? "nothing" : text;
+}
+
+}  // namespace catan
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "catan_types.h"
+
+namespace catan {
+
+// ============================================================================
+// GAME ACTIONS
+// Every move a player can make, as one typed value, and the one place the
+// rules for it are checked and applied. The REST handlers, the AI tool
+// endpoint, the server-side AI executor and the simulator all go through
+// applyAction, so a rule lives in exactly one spot. Board, dice, building
+// and turn actions allocate nothing beyond the game's own containers; chat
+// and trade actions append their message to the game's history.
+// ============================================================================
+
+enum class ActionType : uint8_t {
+    RollDice,
+    PlaceSetupSettlement,
+    PlaceSetupRoad,
+    BuildRoad,
+    BuildSettlement,
+    BuildCity,
+    BuyDevCard,
+    BankTrade,
+    MoveRobber,
+    EndTurn,
+    SendChat,
+    ProposeTrade,
+    AcceptTrade,
+    RejectTrade,
+    CounterTrade,
+    CancelTrade,
+    Count
+};
+
+struct Action {
+    ActionType type = ActionType::EndTurn;
+    int playerId = -1;                  // who is acting
+    VertexId vertex = INVALID_ID;       // settlements and cities
+    EdgeId edge = INVALID_ID;           // roads
+    HexId hex = INVALID_ID;             // robber
+    int victimId = -1;                  // robber; -1 steals from nobody
+    Resource give = Resource::None;     // bank trade
+    Resource receive = Resource::None;
+    ResourceHand offering;              // propose and counter
+    ResourceHand requesting;
+    int tradeId = -1;                   // accept, reject, cancel; the original for a counter
+    int toPlayerId = -1;                // chat and proposals; -1 for everyone
+    std::string message;                // chat text, or a note on a trade
+};
+
+enum class ActionError : uint8_t {
+    None,
+    PlayerNotFound,
+    NotYourTurn,
+    WrongPhase,
+    NotEnoughResources,
+    NoPiecesLeft,
+    InvalidLocation,
+    DeckEmpty,
+    InvalidResource,
+    SameResource,
+    EmptyMessage,
+    TradeNotFound,
+    TradeInactive,
+    OwnTrade,
+    TradeNotForYou,
+    ProposerCannotPay,
+    NotProposer,
+    UnknownAction
+};
+
+// What an action did. Fields an action doesn't touch keep their defaults.
+struct ActionResult {
+    ActionError error = ActionError::None;
+    DiceRoll roll{0, 0};                                // roll_dice
+    const std::vector<ProductionEntry>* production = nullptr;  // paid by the roll; valid until the board changes
+    DevCardType card = DevCardType::Knight;             // buy_dev_card
+    int ratio = 0;                                      // bank_trade, also set when it is refused
+    Resource stolen = Resource::None;                   // move_robber
+    int tradeId = -1;                                   // trade created (propose, counter) or closed
+    uint64_t chatMessageId = 0;                         // message appended to the chat history
+    int nextPlayer = -1;                                // end_turn, place_setup_road
+    int winner = -1;                                    // set once the action wins the game
+
+    bool ok() const { return error == ActionError::None; }
+};
+
+// Checks and applies one action. Dice and steals draw from game.rng, so the
+// same seed and actions replay the same game. Call with the game's write
+// lock held.
+ActionResult applyAction(Game& game, const Action& action);
+
+// Applies actions in order until one is refused; those before it stay
+// applied. Returns how many were applied, each with its result in results.
+size_t applyActions(Game& game, const Action* actions, size_t count, ActionResult* results);
+
+// Action names as the AI tools spell them ("build_road", ...)
+const char* actionName(ActionType type);
+bool actionTypeFromName(std::string_view name, ActionType& type);
+
+// Human-readable reason and HTTP status for a refusal
+const char* actionErrorMessage(ActionError error, ActionType type);
+int actionErrorStatus(ActionError error);
+
+// "2 wood, 1 ore"; "nothing" for an empty hand
+std::string describeResources(const ResourceHand& hand);
+
+}  // namespace catan
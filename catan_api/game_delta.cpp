@@ -0,0 +1,641 @@
+#include "game_delta.h"
+#include "game_logic.h"
+#include <algorithm>
+
+namespace catan {
+
+// ============================================================================
+// STRING CONVERSIONS
+// ============================================================================
+
+std::string phaseToString(GamePhase phase) {
+    switch (phase) {
+        case GamePhase::WaitingForPlayers: return "waiting_for_players";
+        case GamePhase::Setup: return "setup";
+        case GamePhase::SetupReverse: return "setup_reverse";
+        case GamePhase::Rolling: return "rolling";
+        case GamePhase::Robber: return "robber";
+        case GamePhase::Stealing: return "stealing";
+        case GamePhase::MainTurn: return "main_turn";
+        case GamePhase::Trading: return "trading";
+        case GamePhase::Finished: return "finished";
+        default: return "unknown";
+    }
+}
+
+std::string hexTypeToString(HexType type) {
+    switch (type) {
+        case HexType::Desert: return "desert";
+        case HexType::Forest: return "forest";
+        case HexType::Hills: return "hills";
+        case HexType::Fields: return "fields";
+        case HexType::Pasture: return "pasture";
+        case HexType::Mountains: return "mountains";
+        case HexType::Ocean: return "ocean";
+        default: return "unknown";
+    }
+}
+
+std::string portTypeToString(PortType type) {
+    switch (type) {
+        case PortType::Generic: return "generic";
+        case PortType::Wood: return "wood";
+        case PortType::Brick: return "brick";
+        case PortType::Wheat: return "wheat";
+        case PortType::Sheep: return "sheep";
+        case PortType::Ore: return "ore";
+        default: return "generic";
+    }
+}
+
+static const char* devCardToString(DevCardType card) {
+    switch (card) {
+        case DevCardType::Knight: return "knight";
+        case DevCardType::VictoryPoint: return "victory_point";
+        case DevCardType::RoadBuilding: return "road_building";
+        case DevCardType::YearOfPlenty: return "year_of_plenty";
+        case DevCardType::Monopoly: return "monopoly";
+    }
+    return "knight";
+}
+
+// ============================================================================
+// SHARED WRITERS
+// ============================================================================
+
+void writeLocationFields(JsonWriter& json, const HexCoord& hex, int direction) {
+    json.key("hexQ").value(hex.q);
+    json.key("hexR").value(hex.r);
+    json.key("direction").value(direction);
+}
+
+void writeVertexList(JsonWriter& json, VertexMask vertices) {
+    const BoardTopology& topo = boardTopology();
+    json.beginArray();
+    forEachVertex(vertices, [&](VertexId v) {
+        json.beginObject();
+        writeLocationFields(json, topo.vertexCoords[v].hex, topo.vertexCoords[v].direction);
+        json.endObject();
+    });
+    json.endArray();
+}
+
+void writeEdgeList(JsonWriter& json, const EdgeMask& edges) {
+    const BoardTopology& topo = boardTopology();
+    json.beginArray();
+    forEachEdge(edges, [&](EdgeId e) {
+        json.beginObject();
+        writeLocationFields(json, topo.edgeCoords[e].hex, topo.edgeCoords[e].direction);
+        json.endObject();
+    });
+    json.endArray();
+}
+
+// Members of a written object without its braces ("" for {})
+static std::string objectMembers(std::string object) {
+    if (object.size() <= 2) return std::string();
+    object.pop_back();
+    object.erase(0, 1);
+    return object;
+}
+
+static void writeResources(JsonWriter& json, const ResourceHand& hand) {
+    json.beginObject();
+    json.key("wood").value(hand[Resource::Wood]);
+    json.key("brick").value(hand[Resource::Brick]);
+    json.key("wheat").value(hand[Resource::Wheat]);
+    json.key("sheep").value(hand[Resource::Sheep]);
+    json.key("ore").value(hand[Resource::Ore]);
+    json.endObject();
+}
+
+static void writeDevCards(JsonWriter& json, const std::vector<DevCardType>& cards) {
+    json.beginArray();
+    for (DevCardType card : cards) json.value(devCardToString(card));
+    json.endArray();
+}
+
+// Entry of the public "players" array
+static void writePlayerSummary(JsonWriter& json, const Game& game, const Player& p) {
+    json.beginObject();
+    json.key("id").value(p.id);
+    json.key("name").value(p.name);
+    json.key("type").value(p.playerType == PlayerType::AI ? "ai" : "human");
+    json.key("resourceCount").value(p.resources.total());
+    json.key("devCardCount").value(p.devCards.size());
+    json.key("knightsPlayed").value(p.knightsPlayed);
+    json.key("hasLongestRoad").value(p.hasLongestRoad);
+    json.key("hasLargestArmy").value(p.hasLargestArmy);
+    json.key("victoryPoints").value(calculateVisibleVictoryPoints(game, p.id));
+    json.key("settlementsRemaining").value(p.settlementsRemaining);
+    json.key("citiesRemaining").value(p.citiesRemaining);
+    json.key("roadsRemaining").value(p.roadsRemaining);
+    json.endObject();
+}
+
+static void writeBuilding(JsonWriter& json, const GameBoard& board, VertexId v) {
+    const VertexCoord& coord = boardTopology().vertexCoords[v];
+    json.beginObject();
+    writeLocationFields(json, coord.hex, coord.direction);
+    switch (board.building[v]) {
+        case Building::Settlement: json.key("building").value("settlement"); break;
+        case Building::City: json.key("building").value("city"); break;
+        default: json.key("building").value("none"); break;
+    }
+    json.key("playerId").value(static_cast<int>(board.vertexOwner[v]));
+    json.endObject();
+}
+
+static void writeRoad(JsonWriter& json, const GameBoard& board, EdgeId e) {
+    const EdgeCoord& coord = boardTopology().edgeCoords[e];
+    json.beginObject();
+    writeLocationFields(json, coord.hex, coord.direction);
+    json.key("playerId").value(static_cast<int>(board.roadOwner[e]));
+    json.endObject();
+}
+
+static void writeLastRoll(JsonWriter& json, int die1, int die2) {
+    json.beginObject();
+    json.key("die1").value(die1);
+    json.key("die2").value(die2);
+    json.key("total").value(die1 + die2);
+    json.endObject();
+}
+
+static void writeRobberLocation(JsonWriter& json, HexId robberHex) {
+    const HexCoord& robber = boardTopology().hexCoords[robberHex];
+    json.beginObject();
+    json.key("q").value(robber.q);
+    json.key("r").value(robber.r);
+    json.endObject();
+}
+
+// ============================================================================
+// BUILD LOCATIONS
+// ============================================================================
+
+namespace {
+
+// Locations offered to a player; a list is only offered on the player's own
+// turn, in a phase where they can build it and can pay for it
+struct BuildOptions {
+    bool settlements = false;
+    bool roads = false;
+    bool cities = false;
+    VertexMask settlementLocations = 0;
+    VertexMask cityLocations = 0;
+    EdgeMask roadLocations;
+};
+
+BuildOptions buildOptions(const Game& game, int playerId) {
+    ScopedTimer timer(*boardComputeMetrics().legalMoves);
+    BuildOptions options;
+    if (playerId < 0 || playerId >= static_cast<int>(game.players.size()) ||
+        game.currentPlayerIndex != playerId) {
+        return options;
+    }
+
+    if (game.phase == GamePhase::Setup || game.phase == GamePhase::SetupReverse) {
+        options.settlements = true;
+        options.settlementLocations = setupSettlementMask(game);
+    } else if (game.phase == GamePhase::MainTurn) {
+        const Player& player = game.players[playerId];
+        if (canAfford(player.resources, SETTLEMENT_COST) && player.settlementsRemaining > 0) {
+            options.settlements = true;
+            options.settlementLocations = settlementMask(game, playerId);
+        }
+        if (canAfford(player.resources, ROAD_COST) && player.roadsRemaining > 0) {
+            options.roads = true;
+            options.roadLocations = roadMask(game, playerId);
+        }
+        if (canAfford(player.resources, CITY_COST) && player.citiesRemaining > 0) {
+            options.cities = true;
+            options.cityLocations = cityMask(game, playerId);
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
+// ============================================================================
+// FULL SNAPSHOT
+// Written in two parts so the public one can be shared between viewers:
+// {"gameId", "version", "yourPlayerId", <viewer's fields>, <public fields>}
+// ============================================================================
+
+static std::string publicStateMembers(const Game& game) {
+    const BoardTopology& topo = boardTopology();
+    const GameBoard& board = game.board;
+
+    // Sized from the last one this thread built
+    static thread_local size_t lastPublicSize = 8192;
+    JsonWriter json(lastPublicSize + 256);
+    json.beginObject();
+    json.key("phase").value(phaseToString(game.phase));
+    json.key("currentPlayer").value(game.currentPlayerIndex);
+    json.key("playerCount").value(game.players.size());
+    json.key("setupRound").value(game.setupRound);
+
+    if (game.lastRoll) {
+        json.key("lastRoll");
+        writeLastRoll(json, game.lastRoll->die1, game.lastRoll->die2);
+    }
+
+    json.key("players").beginArray();
+    for (const auto& p : game.players) {
+        writePlayerSummary(json, game, p);
+    }
+    json.endArray();
+
+    json.key("hexes").beginArray();
+    for (HexId h = 0; h < NUM_HEXES; h++) {
+        json.beginObject();
+        json.key("q").value(topo.hexCoords[h].q);
+        json.key("r").value(topo.hexCoords[h].r);
+        json.key("type").value(hexTypeToString(board.hexType[h]));
+        json.key("numberToken").value(static_cast<int>(board.numberToken[h]));
+        json.key("hasRobber").value(board.robberHex == h);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("vertices").beginArray();
+    forEachVertex(board.occupiedVertices, [&](VertexId v) { writeBuilding(json, board, v); });
+    json.endArray();
+
+    json.key("edges").beginArray();
+    forEachEdge(board.occupiedEdges, [&](EdgeId e) { writeRoad(json, board, e); });
+    json.endArray();
+
+    json.key("ports").beginArray();
+    for (const auto& port : board.ports) {
+        const VertexCoord& v1 = topo.vertexCoords[port.vertex1];
+        const VertexCoord& v2 = topo.vertexCoords[port.vertex2];
+        json.beginObject();
+        json.key("type").value(portTypeToString(port.type));
+        json.key("v1q").value(v1.hex.q);
+        json.key("v1r").value(v1.hex.r);
+        json.key("v1d").value(v1.direction);
+        json.key("v2q").value(v2.hex.q);
+        json.key("v2r").value(v2.hex.r);
+        json.key("v2d").value(v2.direction);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("robberLocation");
+    writeRobberLocation(json, board.robberHex);
+
+    int winner = checkForWinner(game);
+    if (winner >= 0) {
+        json.key("winner").value(winner);
+    }
+    json.endObject();
+
+    lastPublicSize = json.size();
+    return objectMembers(json.take());
+}
+
+// The viewer's resources, dev cards, building counts and, on their turn,
+// valid build locations
+static std::string privateStateMembers(const Game& game, int viewerId) {
+    if (viewerId < 0 || viewerId >= static_cast<int>(game.players.size())) return std::string();
+    const Player& player = game.players[viewerId];
+
+    JsonWriter json(1024);
+    json.beginObject();
+    json.key("resources");
+    writeResources(json, player.resources);
+    json.key("devCards");
+    writeDevCards(json, player.devCards);
+    json.key("settlementsRemaining").value(player.settlementsRemaining);
+    json.key("citiesRemaining").value(player.citiesRemaining);
+    json.key("roadsRemaining").value(player.roadsRemaining);
+
+    BuildOptions options = buildOptions(game, viewerId);
+    if (options.settlements) {
+        json.key("validSettlementLocations");
+        writeVertexList(json, options.settlementLocations);
+    }
+    if (options.roads) {
+        json.key("validRoadLocations");
+        writeEdgeList(json, options.roadLocations);
+    }
+    if (options.cities) {
+        json.key("validCityLocations");
+        writeVertexList(json, options.cityLocations);
+    }
+    json.endObject();
+    return objectMembers(json.take());
+}
+
+static std::string assembleState(const Game& game, int viewerId, const std::string& shared) {
+    std::string own = privateStateMembers(game, viewerId);
+
+    JsonWriter json(shared.size() + own.size() + 128);
+    json.beginObject();
+    json.key("gameId").value(game.gameId);
+    json.key("version").value(game.version.load());
+    json.key("yourPlayerId").value(viewerId);
+    json.endObject();
+
+    std::string out = json.take();
+    out.pop_back();     // reopen the object
+    if (!own.empty()) out.append(1, ',').append(own);
+    if (!shared.empty()) out.append(1, ',').append(shared);
+    out += '}';
+    return out;
+}
+
+std::string gameStateJson(const Game& game, int viewerId) {
+    return assembleState(game, viewerId, publicStateMembers(game));
+}
+
+// ============================================================================
+// SNAPSHOT CACHE
+// ============================================================================
+
+static int snapshotSlot(const Game& game, int viewerId) {
+    if (viewerId < 0) return 0;
+    if (viewerId >= MAX_PLAYERS || viewerId >= static_cast<int>(game.players.size())) return -1;
+    return viewerId + 1;
+}
+
+SharedGameState findCachedGameState(const Game& game, int viewerId) {
+    int slot = snapshotSlot(game, viewerId);
+    if (slot < 0) return nullptr;
+
+    SnapshotCache& cache = game.snapshots;
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (!cache.valid || cache.version != game.version.load()) return nullptr;
+    return cache.viewers[slot];
+}
+
+SharedGameState cachedGameState(const Game& game, int viewerId) {
+    const uint64_t version = game.version.load();
+    int slot = snapshotSlot(game, viewerId);
+    if (slot < 0) {
+        auto snapshot = std::make_shared<GameStateSnapshot>();
+        snapshot->version = version;
+        snapshot->json = gameStateJson(game, viewerId);
+        return snapshot;
+    }
+
+    SnapshotCache& cache = game.snapshots;
+    std::shared_ptr<const std::string> shared;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (cache.valid && cache.version == version) {
+            if (cache.viewers[slot]) return cache.viewers[slot];
+            shared = cache.publicJson;
+        }
+    }
+
+    // Serialize outside the cache mutex; the game lock keeps the state still
+    if (!shared) shared = std::make_shared<const std::string>(publicStateMembers(game));
+    auto snapshot = std::make_shared<GameStateSnapshot>();
+    snapshot->version = version;
+    snapshot->json = assembleState(game, viewerId, *shared);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (!cache.valid || cache.version != version) {
+        cache.valid = true;
+        cache.version = version;
+        cache.publicJson = shared;
+        cache.viewers.fill(nullptr);
+    }
+    cache.viewers[slot] = snapshot;
+    return snapshot;
+}
+
+// ============================================================================
+// CHANGE RECORDING
+// ============================================================================
+
+namespace {
+
+ChangeListener changeListener = nullptr;
+WriteListener writeListener = nullptr;
+
+GameDigest takeDigest(const Game& game) {
+    GameDigest digest;
+    digest.phase = game.phase;
+    digest.currentPlayerIndex = game.currentPlayerIndex;
+    digest.setupRound = game.setupRound;
+    if (game.lastRoll) {
+        digest.die1 = game.lastRoll->die1;
+        digest.die2 = game.lastRoll->die2;
+    }
+    digest.robberHex = game.board.robberHex;
+    digest.winner = checkForWinner(game);
+    digest.building = game.board.building;
+    digest.vertexOwner = game.board.vertexOwner;
+    digest.roadOwner = game.board.roadOwner;
+
+    digest.players.reserve(game.players.size());
+    for (const auto& p : game.players) {
+        PlayerDigest pd;
+        pd.resources = p.resources;
+        pd.devCards = p.devCards;
+        pd.settlementsRemaining = p.settlementsRemaining;
+        pd.citiesRemaining = p.citiesRemaining;
+        pd.roadsRemaining = p.roadsRemaining;
+        pd.knightsPlayed = p.knightsPlayed;
+        pd.victoryPoints = calculateVisibleVictoryPoints(game, p.id);
+        pd.hasLongestRoad = p.hasLongestRoad;
+        pd.hasLargestArmy = p.hasLargestArmy;
+        digest.players.push_back(std::move(pd));
+    }
+
+    game.tradeOffers.forEachActive([&](const TradeOffer& trade) {
+        digest.activeTradeIds.push_back(trade.id);
+    });
+
+    digest.validFor = game.currentPlayerIndex;
+    BuildOptions options = buildOptions(game, game.currentPlayerIndex);
+    digest.validSettlements = options.settlementLocations;
+    digest.validCities = options.cityLocations;
+    digest.validRoads = options.roadLocations;
+    return digest;
+}
+
+bool samePublic(const PlayerDigest& a, const PlayerDigest& b) {
+    return a.resources.total() == b.resources.total() && a.devCards.size() == b.devCards.size() &&
+           a.settlementsRemaining == b.settlementsRemaining && a.citiesRemaining == b.citiesRemaining &&
+           a.roadsRemaining == b.roadsRemaining && a.knightsPlayed == b.knightsPlayed &&
+           a.victoryPoints == b.victoryPoints && a.hasLongestRoad == b.hasLongestRoad &&
+           a.hasLargestArmy == b.hasLargestArmy;
+}
+
+void writePublicChanges(JsonWriter& json, const Game& game, const GameDigest& prev, const GameDigest& next) {
+    if (next.phase != prev.phase) json.key("phase").value(phaseToString(next.phase));
+    if (next.currentPlayerIndex != prev.currentPlayerIndex) json.key("currentPlayer").value(next.currentPlayerIndex);
+    if (next.setupRound != prev.setupRound) json.key("setupRound").value(next.setupRound);
+    if (next.players.size() != prev.players.size()) json.key("playerCount").value(next.players.size());
+
+    if (next.die1 != prev.die1 || next.die2 != prev.die2) {
+        json.key("lastRoll");
+        if (next.die1 == 0) json.null();
+        else writeLastRoll(json, next.die1, next.die2);
+    }
+
+    if (next.robberHex != prev.robberHex && next.robberHex != INVALID_ID) {
+        json.key("robberLocation");
+        writeRobberLocation(json, next.robberHex);
+    }
+
+    bool playersOpen = false;
+    for (size_t i = 0; i < next.players.size(); i++) {
+        if (i < prev.players.size() && samePublic(next.players[i], prev.players[i])) continue;
+        if (!playersOpen) {
+            json.key("players").beginArray();
+            playersOpen = true;
+        }
+        writePlayerSummary(json, game, game.players[i]);
+    }
+    if (playersOpen) json.endArray();
+
+    bool verticesOpen = false;
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        if (next.building[v] == prev.building[v] && next.vertexOwner[v] == prev.vertexOwner[v]) continue;
+        if (!verticesOpen) {
+            json.key("vertices").beginArray();
+            verticesOpen = true;
+        }
+        writeBuilding(json, game.board, v);
+    }
+    if (verticesOpen) json.endArray();
+
+    bool edgesOpen = false;
+    for (EdgeId e = 0; e < NUM_EDGES; e++) {
+        if (next.roadOwner[e] == prev.roadOwner[e]) continue;
+        if (!edgesOpen) {
+            json.key("edges").beginArray();
+            edgesOpen = true;
+        }
+        writeRoad(json, game.board, e);
+    }
+    if (edgesOpen) json.endArray();
+
+    if (next.activeTradeIds != prev.activeTradeIds) {
+        json.key("activeTradeIds").beginArray();
+        for (int id : next.activeTradeIds) json.value(id);
+        json.endArray();
+    }
+
+    if (next.winner != prev.winner) json.key("winner").value(next.winner);
+}
+
+void writePrivateChanges(JsonWriter& json, int playerId, const GameDigest& prev, const GameDigest& next) {
+    const PlayerDigest& now = next.players[playerId];
+    const PlayerDigest* before = playerId < static_cast<int>(prev.players.size()) ? &prev.players[playerId] : nullptr;
+
+    if (!before || now.resources != before->resources) {
+        json.key("resources");
+        writeResources(json, now.resources);
+    }
+    if (!before || now.devCards != before->devCards) {
+        json.key("devCards");
+        writeDevCards(json, now.devCards);
+    }
+    if (!before || now.settlementsRemaining != before->settlementsRemaining) {
+        json.key("settlementsRemaining").value(now.settlementsRemaining);
+    }
+    if (!before || now.citiesRemaining != before->citiesRemaining) {
+        json.key("citiesRemaining").value(now.citiesRemaining);
+    }
+    if (!before || now.roadsRemaining != before->roadsRemaining) {
+        json.key("roadsRemaining").value(now.roadsRemaining);
+    }
+
+    // Build locations: sent whole when they change, cleared when the turn moves on
+    bool isCurrent = next.validFor == playerId;
+    bool wasCurrent = prev.validFor == playerId;
+    bool changed = isCurrent != wasCurrent;
+    if (isCurrent && wasCurrent) {
+        changed = next.validSettlements != prev.validSettlements || next.validCities != prev.validCities ||
+                  next.validRoads.lo != prev.validRoads.lo || next.validRoads.hi != prev.validRoads.hi;
+    }
+    if (changed) {
+        json.key("validSettlementLocations");
+        writeVertexList(json, isCurrent ? next.validSettlements : 0);
+        json.key("validRoadLocations");
+        writeEdgeList(json, isCurrent ? next.validRoads : EdgeMask());
+        json.key("validCityLocations");
+        writeVertexList(json, isCurrent ? next.validCities : 0);
+    }
+}
+
+}  // namespace
+
+void setChangeListener(ChangeListener listener) {
+    changeListener = listener;
+}
+
+void setWriteListener(WriteListener listener) {
+    writeListener = listener;
+}
+
+void resetChangeLog(Game& game) {
+    game.changes = ChangeLog();
+    game.changes.digest = takeDigest(game);
+}
+
+void commitChanges(Game& game) {
+    if (writeListener) writeListener(game);
+
+    ChangeLog& log = game.changes;
+    GameDigest next = takeDigest(game);
+    const GameDigest& prev = log.digest;
+
+    GameChange change;
+    bool changed = false;
+
+    JsonWriter shared(256);
+    shared.beginObject();
+    writePublicChanges(shared, game, prev, next);
+    shared.endObject();
+    change.publicJson = objectMembers(shared.take());
+    changed = !change.publicJson.empty();
+
+    int privateCount = std::min(static_cast<int>(next.players.size()), MAX_PLAYERS);
+    for (int p = 0; p < privateCount; p++) {
+        JsonWriter own(256);
+        own.beginObject();
+        writePrivateChanges(own, p, prev, next);
+        own.endObject();
+        change.privateJson[p] = objectMembers(own.take());
+        changed = changed || !change.privateJson[p].empty();
+    }
+
+    log.digest = std::move(next);
+    if (!changed) return;
+
+    change.version = game.version.load() + 1;
+    GameChange& slot = log.entries[change.version % CHANGE_LOG_CAPACITY];
+    slot = std::move(change);
+    game.version.store(slot.version);
+
+    if (changeListener) changeListener(game, slot);
+}
+
+std::string deltaJson(const GameChange& change, int viewerId) {
+    const std::string* own = (viewerId >= 0 && viewerId < MAX_PLAYERS) ? &change.privateJson[viewerId] : nullptr;
+
+    std::string json;
+    json.reserve(change.publicJson.size() + (own ? own->size() : 0) + 32);
+    json.append("{\"version\":").append(std::to_string(change.version));
+    if (!change.publicJson.empty()) {
+        json += ',';
+        json += change.publicJson;
+    }
+    if (own && !own->empty()) {
+        json += ',';
+        json += *own;
+    }
+    json += '}';
+    return json;
+}
+
+}  // namespace catan
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "catan_types.h"
+#include "json_writer.h"
+
+namespace catan {
+
+// ============================================================================
+// GAME STATE ENCODING
+// What a viewer sees of a game, as JSON. viewerId is the player whose
+// private fields (resources, dev cards, build locations) are included, or
+// -1 for none. Call with the game lock held.
+// ============================================================================
+
+std::string phaseToString(GamePhase phase);
+std::string hexTypeToString(HexType type);
+std::string portTypeToString(PortType type);
+
+// "hexQ", "hexR" and "direction" members
+void writeLocationFields(JsonWriter& json, const HexCoord& hex, int direction);
+
+// Arrays of {hexQ, hexR, direction} in canonical spelling
+void writeVertexList(JsonWriter& json, VertexMask vertices);
+void writeEdgeList(JsonWriter& json, const EdgeMask& edges);
+
+// Full state, as served by GET /games/{id}
+std::string gameStateJson(const Game& game, int viewerId);
+
+// ============================================================================
+// SNAPSHOT CACHE
+// Snapshots are cached per (game, version, viewer). The public part is
+// serialized once per version and shared by every viewer's copy; only the
+// viewer's private fields are spliced in per viewer.
+// ============================================================================
+
+using SharedGameState = std::shared_ptr<const GameStateSnapshot>;
+
+// Snapshot for viewerId at the current version if one is cached, else
+// nullptr. Does not need the game lock.
+SharedGameState findCachedGameState(const Game& game, int viewerId);
+
+// Snapshot for viewerId at the current version, built and cached on a
+// miss. Call with the game lock held.
+SharedGameState cachedGameState(const Game& game, int viewerId);
+
+// ============================================================================
+// GAME DELTAS
+// A delta has the snapshot's top-level keys, holding only what changed in
+// one version: scalars are replaced, "players", "vertices" and "edges" list
+// the entries to upsert, and build location lists are replaced whole.
+// ============================================================================
+
+// Delta body for one viewer: {"version":N, ...changed fields}
+std::string deltaJson(const GameChange& change, int viewerId);
+
+// Called for every recorded change, with the game lock still held, so
+// subscribers see changes in version order
+using ChangeListener = void (*)(const Game& game, const GameChange& change);
+void setChangeListener(ChangeListener listener);
+
+// Called on every write unlock, before the diff and whether or not anything
+// visible changed, with the game lock still held
+using WriteListener = void (*)(const Game& game);
+void setWriteListener(WriteListener listener);
+
+// Starts the change log afresh at the game's current version, for a game
+// loaded from storage rather than built up by writes. Call with the game
+// lock held (or before the game is shared).
+void resetChangeLog(Game& game);
+
+}  // namespace catan
@@ -1,109 +1,23 @@
 #include "game_logic.h"
 #include <algorithm>
-#include <unordered_set>
 
 namespace catan {
 
-// Direction offsets for axial hex coordinates
-static const int HEX_DIRS[6][2] = {
-    {0, -1},  // 0: N
-    {1, -1},  // 1: NE
-    {1, 0},   // 2: SE
-    {0, 1},   // 3: S
-    {-1, 1},  // 4: SW
-    {-1, 0}   // 5: NW
-};
-
 // ============================================================================
-// COORDINATE HELPERS
+// BUILDING COSTS
 // ============================================================================
 
-VertexCoord normalizeVertex(const VertexCoord& vertex) {
-    // Vertices can be represented from 3 different hexes
-    // Normalize to the canonical form (lowest hex coord, direction 0-1)
-    // For simplicity, we use the representation as-is but ensure direction is 0-5
-    VertexCoord norm = vertex;
-    norm.direction = ((norm.direction % 6) + 6) % 6;
-    return norm;
-}
-
-EdgeCoord normalizeEdge(const EdgeCoord& edge) {
-    EdgeCoord norm = edge;
-    norm.direction = ((norm.direction % 6) + 6) % 6;
-    return norm;
-}
-
-std::vector<VertexCoord> getAdjacentVertices(const VertexCoord& vertex) {
-    std::vector<VertexCoord> result;
-    int d = vertex.direction;
-    
-    // Each vertex has 2-3 adjacent vertices
-    // Adjacent in clockwise direction on same hex
-    result.push_back({vertex.hex, (d + 1) % 6});
-    // Adjacent in counter-clockwise direction on same hex
-    result.push_back({vertex.hex, (d + 5) % 6});
-    
-    // Adjacent vertex on neighboring hex
-    HexCoord neighbor = {
-        vertex.hex.q + HEX_DIRS[d][0],
-        vertex.hex.r + HEX_DIRS[d][1]
-    };
-    result.push_back({neighbor, (d + 3) % 6});
-    
-    return result;
-}
+const ResourceHand ROAD_COST = {1, 1, 0, 0, 0};
+const ResourceHand SETTLEMENT_COST = {1, 1, 1, 1, 0};
+const ResourceHand CITY_COST = {0, 0, 2, 0, 3};
+const ResourceHand DEV_CARD_COST = {0, 0, 1, 1, 1};
 
-std::vector<EdgeCoord> getEdgesAtVertex(const VertexCoord& vertex) {
-    std::vector<EdgeCoord> result;
-    int d = vertex.direction;
-    
-    // Each vertex touches 3 edges
-    result.push_back({vertex.hex, d});
-    result.push_back({vertex.hex, (d + 5) % 6});
-    
-    HexCoord neighbor = {
-        vertex.hex.q + HEX_DIRS[d][0],
-        vertex.hex.r + HEX_DIRS[d][1]
-    };
-    result.push_back({neighbor, (d + 4) % 6});
-    
-    return result;
+bool canAfford(const ResourceHand& have, const ResourceHand& cost) {
+    return have.covers(cost);
 }
 
-std::pair<VertexCoord, VertexCoord> getVerticesOfEdge(const EdgeCoord& edge) {
-    // An edge connects two vertices
-    int d = edge.direction;
-    VertexCoord v1 = {edge.hex, d};
-    VertexCoord v2 = {edge.hex, (d + 1) % 6};
-    return {v1, v2};
-}
-
-bool verticesEqual(const VertexCoord& v1, const VertexCoord& v2) {
-    // Check if two vertex coords refer to the same vertex
-    // Vertices can be represented from multiple hexes
-    if (v1.hex == v2.hex && v1.direction == v2.direction) return true;
-    
-    // Check alternate representations
-    auto adj = getAdjacentVertices(v1);
-    // The "opposite" representation is on a neighboring hex
-    HexCoord n1 = {v1.hex.q + HEX_DIRS[v1.direction][0], v1.hex.r + HEX_DIRS[v1.direction][1]};
-    if (n1 == v2.hex && (v1.direction + 3) % 6 == v2.direction) return true;
-    
-    HexCoord n2 = {v1.hex.q + HEX_DIRS[(v1.direction + 5) % 6][0], v1.hex.r + HEX_DIRS[(v1.direction + 5) % 6][1]};
-    if (n2 == v2.hex && (v1.direction + 4) % 6 == v2.direction) return true;
-    
-    return false;
-}
-
-bool edgesEqual(const EdgeCoord& e1, const EdgeCoord& e2) {
-    if (e1.hex == e2.hex && e1.direction == e2.direction) return true;
-    
-    // Check alternate representation (from neighboring hex)
-    int d = e1.direction;
-    HexCoord neighbor = {e1.hex.q + HEX_DIRS[d][0], e1.hex.r + HEX_DIRS[d][1]};
-    if (neighbor == e2.hex && (d + 3) % 6 == e2.direction) return true;
-    
-    return false;
+void subtractResources(ResourceHand& from, const ResourceHand& cost) {
+    from -= cost;
 }
 
 // ============================================================================
@@ -113,20 +27,13 @@ bool edgesEqual(const EdgeCoord& e1, const EdgeCoord& e2) {
 bool playerHasPort(const Game& game, int playerId, PortType portType) {
     // Check if player has a settlement/city adjacent to a port of given type
     for (const auto& port : game.board.ports) {
-        // Check vertex1
-        auto it1 = game.board.vertices.find(port.vertex1);
-        if (it1 != game.board.vertices.end() && 
-            it1->second.ownerPlayerId == playerId &&
-            it1->second.building != Building::None) {
-            if (port.type == portType) return true;
-        }
-        
-        // Check vertex2
-        auto it2 = game.board.vertices.find(port.vertex2);
-        if (it2 != game.board.vertices.end() && 
-            it2->second.ownerPlayerId == playerId &&
-            it2->second.building != Building::None) {
-            if (port.type == portType) return true;
+        if (port.type != portType) continue;
+        for (VertexId v : {port.vertex1, port.vertex2}) {
+            if (v != INVALID_ID &&
+                game.board.hasBuilding(v) &&
+                game.board.vertexOwner[v] == playerId) {
+                return true;
+            }
         }
     }
     return false;
@@ -161,105 +68,56 @@ int getTradeRatio(const Game& game, int playerId, Resource resource) {
 // LONGEST ROAD CALCULATION
 // ============================================================================
 
-// DFS helper for longest road
-static int longestRoadDFS(const Game& game, int playerId, 
-                          const EdgeCoord& currentEdge,
-                          std::unordered_set<std::string>& visited,
-                          int depth) {
-    // Create a key for this edge
-    std::string key = std::to_string(currentEdge.hex.q) + "," + 
-                      std::to_string(currentEdge.hex.r) + "," + 
-                      std::to_string(currentEdge.direction);
-    
-    if (visited.count(key)) return depth - 1;
-    visited.insert(key);
-    
-    int maxLength = depth;
-    
-    // Get the two vertices of this edge
-    auto [v1, v2] = getVerticesOfEdge(currentEdge);
-    
-    // For each vertex, check if we can continue (no opponent settlement blocking)
-    for (const auto& vertex : {v1, v2}) {
-        // Check if there's an opponent's settlement/city blocking
-        auto vIt = game.board.vertices.find(vertex);
-        if (vIt != game.board.vertices.end() && 
-            vIt->second.building != Building::None &&
-            vIt->second.ownerPlayerId != playerId) {
-            continue;  // Blocked by opponent
-        }
-        
-        // Get edges at this vertex and try to continue
-        auto edges = getEdgesAtVertex(vertex);
-        for (const auto& nextEdge : edges) {
-            // Check if this edge has our road
-            auto eIt = game.board.edges.find(nextEdge);
-            if (eIt != game.board.edges.end() && 
-                eIt->second.hasRoad && 
-                eIt->second.ownerPlayerId == playerId) {
-                // Check normalized form too
-                std::string nextKey = std::to_string(nextEdge.hex.q) + "," + 
-                                     std::to_string(nextEdge.hex.r) + "," + 
-                                     std::to_string(nextEdge.direction);
-                if (!visited.count(nextKey)) {
-                    int length = longestRoadDFS(game, playerId, nextEdge, visited, depth + 1);
-                    maxLength = std::max(maxLength, length);
-                }
-            }
-        }
-    }
-    
-    visited.erase(key);
-    return maxLength;
-}
-
+// Road networks are split into components as roads and settlements are
+// placed (GameBoard::updateRoadComponents), so this is a cache read
 int calculateLongestRoad(const Game& game, int playerId) {
-    int longest = 0;
-    
-    // Try starting from each of the player's roads
-    for (const auto& [coord, edge] : game.board.edges) {
-        if (edge.hasRoad && edge.ownerPlayerId == playerId) {
-            std::unordered_set<std::string> visited;
-            int length = longestRoadDFS(game, playerId, coord, visited, 1);
-            longest = std::max(longest, length);
-        }
-    }
-    
-    return longest;
+    if (playerId < 0 || playerId >= MAX_PLAYERS) return 0;
+    return game.board.longestRoad[playerId];
 }
 
+// Decided from the current lengths on every call, not from the last claim: a
+// settlement can cut the holder's road, and then the holder keeps the title
+// only while still longest (ties go to the holder) and at least 5 long
 void updateLongestRoad(Game& game) {
-    int newLongestLength = game.longestRoadLength;
-    int newLongestPlayer = game.longestRoadPlayerId;
+    const int minimumLength = 5;
+    int holder = game.longestRoadPlayerId;
+    int holderLength = holder >= 0 ? calculateLongestRoad(game, holder) : 0;
     
+    int bestLength = 0;
+    int bestPlayer = -1;
+    bool tied = false;
     for (const auto& player : game.players) {
         int roadLength = calculateLongestRoad(game, player.id);
-        
-        if (roadLength >= 5) {  // Minimum 5 to claim longest road
-            if (roadLength > newLongestLength) {
-                newLongestLength = roadLength;
-                newLongestPlayer = player.id;
-            }
+        if (roadLength > bestLength) {
+            bestLength = roadLength;
+            bestPlayer = player.id;
+            tied = false;
+        } else if (roadLength == bestLength) {
+            tied = true;
         }
     }
     
-    // Update flags
-    if (newLongestPlayer != game.longestRoadPlayerId) {
-        // Remove old holder's flag
+    int newHolder = -1;
+    if (bestLength >= minimumLength) {
+        if (holder >= 0 && holderLength == bestLength) {
+            newHolder = holder;
+        } else if (!tied) {
+            newHolder = bestPlayer;     // a tie with nobody ahead leaves it unclaimed
+        }
+    }
+    
+    if (newHolder != game.longestRoadPlayerId) {
         if (game.longestRoadPlayerId >= 0) {
             Player* oldHolder = game.getPlayerById(game.longestRoadPlayerId);
             if (oldHolder) oldHolder->hasLongestRoad = false;
         }
-        
-        // Set new holder's flag
-        if (newLongestPlayer >= 0) {
-            Player* newHolder = game.getPlayerById(newLongestPlayer);
-            if (newHolder) newHolder->hasLongestRoad = true;
+        if (newHolder >= 0) {
+            Player* claimant = game.getPlayerById(newHolder);
+            if (claimant) claimant->hasLongestRoad = true;
         }
-        
-        game.longestRoadPlayerId = newLongestPlayer;
-        game.longestRoadLength = newLongestLength;
+        game.longestRoadPlayerId = newHolder;
     }
+    game.longestRoadLength = newHolder >= 0 ? bestLength : minimumLength - 1;
 }
 
 // ============================================================================
@@ -305,12 +163,10 @@ void updateLargestArmy(Game& game) {
 int calculateVictoryPoints(const Game& game, int playerId, bool includeHidden) {
     int vp = 0;
     
-    // Count settlements and cities on the board
-    for (const auto& [coord, vertex] : game.board.vertices) {
-        if (vertex.ownerPlayerId == playerId) {
-            if (vertex.building == Building::Settlement) vp += 1;
-            else if (vertex.building == Building::City) vp += 2;
-        }
+    // Settlements count 1, cities 2 (cities are in both masks)
+    if (playerId >= 0 && playerId < MAX_PLAYERS) {
+        vp += __builtin_popcountll(game.board.playerBuildings[playerId]);
+        vp += __builtin_popcountll(game.board.playerCities[playerId]);
     }
     
     const Player* player = nullptr;
@@ -358,194 +214,124 @@ int checkForWinner(const Game& game) {
 // BUILDING VALIDATION
 // ============================================================================
 
-bool isVertexDistanceValid(const Game& game, const VertexCoord& vertex) {
-    // Check that no settlement/city is within 1 edge of this vertex
-    auto adjacent = getAdjacentVertices(vertex);
-    
-    // Check the vertex itself
-    auto it = game.board.vertices.find(vertex);
-    if (it != game.board.vertices.end() && it->second.building != Building::None) {
-        return false;
-    }
-    
-    // Check adjacent vertices
-    for (const auto& adj : adjacent) {
-        auto adjIt = game.board.vertices.find(adj);
-        if (adjIt != game.board.vertices.end() && adjIt->second.building != Building::None) {
-            return false;
-        }
-    }
-    
-    return true;
+VertexMask setupSettlementMask(const Game& game) {
+    const VertexMask allVertices = (VertexMask(1) << NUM_VERTICES) - 1;
+    return allVertices & ~game.board.blockedVertices;
 }
 
-bool isRoadConnectedToNetwork(const Game& game, int playerId, const EdgeCoord& edge) {
-    auto [v1, v2] = getVerticesOfEdge(edge);
-    
-    // Check if either vertex has player's settlement/city
-    for (const auto& vertex : {v1, v2}) {
-        auto vIt = game.board.vertices.find(vertex);
-        if (vIt != game.board.vertices.end() && 
-            vIt->second.ownerPlayerId == playerId &&
-            vIt->second.building != Building::None) {
-            return true;
-        }
-        
-        // Check if any adjacent edge has player's road
-        auto edges = getEdgesAtVertex(vertex);
-        for (const auto& adjEdge : edges) {
-            auto eIt = game.board.edges.find(adjEdge);
-            if (eIt != game.board.edges.end() && 
-                eIt->second.hasRoad && 
-                eIt->second.ownerPlayerId == playerId) {
-                return true;
-            }
-        }
-    }
-    
-    return false;
+VertexMask settlementMask(const Game& game, int playerId) {
+    if (playerId < 0 || playerId >= MAX_PLAYERS) return 0;
+    return game.board.playerRoadEnds[playerId] & ~game.board.blockedVertices;
 }
 
-std::vector<VertexCoord> getValidSettlementLocations(const Game& game, int playerId) {
-    std::vector<VertexCoord> valid;
-    
-    for (const auto& [coord, vertex] : game.board.vertices) {
-        // Must be empty
-        if (vertex.building != Building::None) continue;
-        
-        // Must satisfy distance rule
-        if (!isVertexDistanceValid(game, coord)) continue;
-        
-        // Must be connected to player's road network
-        auto edges = getEdgesAtVertex(coord);
-        bool connected = false;
-        for (const auto& edge : edges) {
-            auto eIt = game.board.edges.find(edge);
-            if (eIt != game.board.edges.end() && 
-                eIt->second.hasRoad && 
-                eIt->second.ownerPlayerId == playerId) {
-                connected = true;
-                break;
-            }
-        }
-        
-        if (connected) {
-            valid.push_back(coord);
-        }
-    }
+EdgeMask roadMask(const Game& game, int playerId) {
+    if (playerId < 0 || playerId >= MAX_PLAYERS) return EdgeMask();
+    const BoardTopology& topo = boardTopology();
     
-    return valid;
+    // Any free edge touching one of the player's buildings or road ends
+    EdgeMask reachable;
+    forEachVertex(game.board.playerBuildings[playerId] | game.board.playerRoadEnds[playerId],
+                  [&](VertexId v) { reachable |= topo.vertexEdgeMask[v]; });
+    return reachable & ~game.board.occupiedEdges;
 }
 
-std::vector<EdgeCoord> getValidRoadLocations(const Game& game, int playerId) {
-    std::vector<EdgeCoord> valid;
-    
-    for (const auto& [coord, edge] : game.board.edges) {
-        // Must be empty
-        if (edge.hasRoad) continue;
-        
-        // Must be connected to player's network
-        if (isRoadConnectedToNetwork(game, playerId, coord)) {
-            valid.push_back(coord);
-        }
-    }
+VertexMask cityMask(const Game& game, int playerId) {
+    if (playerId < 0 || playerId >= MAX_PLAYERS) return 0;
+    return game.board.playerBuildings[playerId] & ~game.board.playerCities[playerId];
+}
+
+static std::vector<VertexId> toVertexList(VertexMask mask) {
+    std::vector<VertexId> ids;
+    ids.reserve(__builtin_popcountll(mask));
+    forEachVertex(mask, [&](VertexId v) { ids.push_back(v); });
+    return ids;
+}
+
+static std::vector<EdgeId> toEdgeList(EdgeMask mask) {
+    std::vector<EdgeId> ids;
+    ids.reserve(mask.count());
+    forEachEdge(mask, [&](EdgeId e) { ids.push_back(e); });
+    return ids;
+}
+
+bool isVertexDistanceValid(const Game& game, VertexId vertex) {
+    // No settlement/city on or next to this vertex
+    return !(game.board.blockedVertices & vertexBit(vertex));
+}
+
+bool isRoadConnectedToNetwork(const Game& game, int playerId, EdgeId edge) {
+    if (playerId < 0 || playerId >= MAX_PLAYERS) return false;
     
-    return valid;
+    // Either end has the player's settlement/city or another of their roads
+    VertexMask network = game.board.playerBuildings[playerId] | game.board.playerRoadEnds[playerId];
+    return (boardTopology().edgeVertexMask[edge] & network) != 0;
+}
+
+std::vector<VertexId> getValidSettlementLocations(const Game& game, int playerId) {
+    ScopedTimer timer(*boardComputeMetrics().legalMoves);
+    return toVertexList(settlementMask(game, playerId));
+}
+
+std::vector<EdgeId> getValidRoadLocations(const Game& game, int playerId) {
+    ScopedTimer timer(*boardComputeMetrics().legalMoves);
+    return toEdgeList(roadMask(game, playerId));
+}
+
+std::vector<VertexId> getValidCityLocations(const Game& game, int playerId) {
+    ScopedTimer timer(*boardComputeMetrics().legalMoves);
+    return toVertexList(cityMask(game, playerId));
 }
 
-std::vector<VertexCoord> getValidCityLocations(const Game& game, int playerId) {
-    std::vector<VertexCoord> valid;
+// ============================================================================
+// RESOURCE PRODUCTION
+// ============================================================================
+
+const std::vector<ProductionEntry>& distributeResources(Game& game, int total) {
+    static const std::vector<ProductionEntry> none;
+    if (total < 2 || total > 12) return none;
     
-    for (const auto& [coord, vertex] : game.board.vertices) {
-        // Must be player's settlement
-        if (vertex.ownerPlayerId == playerId && vertex.building == Building::Settlement) {
-            valid.push_back(coord);
-        }
+    const auto& entries = game.board.production[total];
+    for (const auto& entry : entries) {
+        Player* owner = game.getPlayerById(entry.playerId);
+        if (owner) owner->resources[entry.resource] += entry.amount;
     }
-    
-    return valid;
+    return entries;
 }
 
 // ============================================================================
 // SETUP PHASE LOGIC
 // ============================================================================
 
-std::vector<VertexCoord> getValidSetupSettlementLocations(const Game& game) {
-    std::vector<VertexCoord> valid;
-    
-    for (const auto& [coord, vertex] : game.board.vertices) {
-        // Must be empty and satisfy distance rule
-        if (vertex.building == Building::None && isVertexDistanceValid(game, coord)) {
-            // In setup phase, no road connection required
-            // Also check that vertex is adjacent to at least one land hex
-            bool adjacentToLand = false;
-            // The vertex is on this hex
-            auto hexIt = game.board.hexes.find(coord.hex);
-            if (hexIt != game.board.hexes.end() && hexIt->second.type != HexType::Ocean) {
-                adjacentToLand = true;
-            }
-            
-            if (adjacentToLand) {
-                valid.push_back(coord);
-            }
-        }
-    }
-    
-    return valid;
+std::vector<VertexId> getValidSetupSettlementLocations(const Game& game) {
+    ScopedTimer timer(*boardComputeMetrics().legalMoves);
+    // In setup phase, no road connection required; every vertex touches land
+    return toVertexList(setupSettlementMask(game));
 }
 
-std::vector<EdgeCoord> getValidSetupRoadLocations(const Game& game, const VertexCoord& settlement) {
-    std::vector<EdgeCoord> valid;
-    
-    // Get edges adjacent to the settlement
-    auto edges = getEdgesAtVertex(settlement);
-    
-    for (const auto& edge : edges) {
-        auto eIt = game.board.edges.find(edge);
-        if (eIt != game.board.edges.end() && !eIt->second.hasRoad) {
-            valid.push_back(edge);
-        }
-    }
-    
-    return valid;
+std::vector<EdgeId> getValidSetupRoadLocations(const Game& game, VertexId settlement) {
+    ScopedTimer timer(*boardComputeMetrics().legalMoves);
+    // Edges touching the settlement
+    return toEdgeList(boardTopology().vertexEdgeMask[settlement] & ~game.board.occupiedEdges);
 }
 
-bool placeSetupSettlement(Game& game, int playerId, const VertexCoord& location) {
+bool placeSetupSettlement(Game& game, int playerId, VertexId location) {
     Player* player = game.getPlayerById(playerId);
     if (!player) return false;
     
     // Verify location is valid
-    auto validLocations = getValidSetupSettlementLocations(game);
-    bool isValid = false;
-    for (const auto& v : validLocations) {
-        if (v.hex == location.hex && v.direction == location.direction) {
-            isValid = true;
-            break;
-        }
-    }
+    if (location >= NUM_VERTICES || !isVertexDistanceValid(game, location)) return false;
     
-    if (!isValid) return false;
-    
-    // Place settlement
-    auto it = game.board.vertices.find(location);
-    if (it != game.board.vertices.end()) {
-        it->second.building = Building::Settlement;
-        it->second.ownerPlayerId = playerId;
-        player->settlementsRemaining--;
-        return true;
-    }
-    
-    return false;
+    game.board.placeSettlement(location, playerId);
+    player->settlementsRemaining--;
+    return true;
 }
 
-bool placeSetupRoad(Game& game, int playerId, const EdgeCoord& location) {
+bool placeSetupRoad(Game& game, int playerId, EdgeId location) {
     Player* player = game.getPlayerById(playerId);
     if (!player) return false;
     
-    auto it = game.board.edges.find(location);
-    if (it != game.board.edges.end() && !it->second.hasRoad) {
-        it->second.hasRoad = true;
-        it->second.ownerPlayerId = playerId;
+    if (location < NUM_EDGES && !game.board.hasRoad(location)) {
+        game.board.placeRoad(location, playerId);
         player->roadsRemaining--;
         return true;
     }
@@ -553,28 +339,16 @@ bool placeSetupRoad(Game& game, int playerId, const EdgeCoord& location) {
     return false;
 }
 
-void giveInitialResources(Game& game, int playerId, const VertexCoord& settlementLocation) {
+void giveInitialResources(Game& game, int playerId, VertexId settlementLocation) {
     Player* player = game.getPlayerById(playerId);
-    if (!player) return;
-    
-    // Get all hexes adjacent to this vertex
-    std::vector<HexCoord> adjacentHexes;
-    adjacentHexes.push_back(settlementLocation.hex);
-    
-    int d = settlementLocation.direction;
-    HexCoord n1 = {settlementLocation.hex.q + HEX_DIRS[d][0], settlementLocation.hex.r + HEX_DIRS[d][1]};
-    HexCoord n2 = {settlementLocation.hex.q + HEX_DIRS[(d + 5) % 6][0], settlementLocation.hex.r + HEX_DIRS[(d + 5) % 6][1]};
-    adjacentHexes.push_back(n1);
-    adjacentHexes.push_back(n2);
+    if (!player || settlementLocation >= NUM_VERTICES) return;
     
     // Give one resource from each adjacent hex
-    for (const auto& hexCoord : adjacentHexes) {
-        auto hexIt = game.board.hexes.find(hexCoord);
-        if (hexIt != game.board.hexes.end()) {
-            Resource resource = hexTypeToResource(hexIt->second.type);
-            if (resource != Resource::None) {
-                player->resources[resource]++;
-            }
+    for (HexId h : boardTopology().vertexHexes[settlementLocation]) {
+        if (h == INVALID_ID) break;
+        Resource resource = hexTypeToResource(game.board.hexType[h]);
+        if (resource != Resource::None) {
+            player->resources[resource]++;
         }
     }
 }
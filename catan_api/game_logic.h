@@ -1,11 +1,21 @@
 #pragma once
 
 #include "catan_types.h"
-#include <set>
-#include <queue>
 
 namespace catan {
 
+// ============================================================================
+// BUILDING COSTS
+// ============================================================================
+
+extern const ResourceHand ROAD_COST;         // wood, brick
+extern const ResourceHand SETTLEMENT_COST;   // wood, brick, wheat, sheep
+extern const ResourceHand CITY_COST;         // 2 wheat, 3 ore
+extern const ResourceHand DEV_CARD_COST;     // wheat, sheep, ore
+
+bool canAfford(const ResourceHand& have, const ResourceHand& cost);
+void subtractResources(ResourceHand& from, const ResourceHand& cost);
+
 // ============================================================================
 // PORT TRADING LOGIC
 // ============================================================================
@@ -24,7 +34,7 @@ bool playerHasPort(const Game& game, int playerId, PortType portType);
 // Calculate the longest road length for a player
 int calculateLongestRoad(const Game& game, int playerId);
 
-// Update longest road holder (call after any road is built)
+// Update longest road holder (call after any road or settlement is built)
 void updateLongestRoad(Game& game);
 
 // ============================================================================
@@ -48,70 +58,59 @@ int calculateVisibleVictoryPoints(const Game& game, int playerId);
 // Returns player ID of winner, or -1 if no winner
 int checkForWinner(const Game& game);
 
+// ============================================================================
+// RESOURCE PRODUCTION
+// ============================================================================
+
+// Pay out a non-7 dice total from the board's production index.
+// Returns the entries that were paid.
+const std::vector<ProductionEntry>& distributeResources(Game& game, int total);
+
 // ============================================================================
 // SETUP PHASE LOGIC
 // ============================================================================
 
 // Get valid settlement locations for setup phase
-std::vector<VertexCoord> getValidSetupSettlementLocations(const Game& game);
+std::vector<VertexId> getValidSetupSettlementLocations(const Game& game);
 
 // Get valid road locations for setup phase (must connect to just-placed settlement)
-std::vector<EdgeCoord> getValidSetupRoadLocations(const Game& game, const VertexCoord& settlement);
+std::vector<EdgeId> getValidSetupRoadLocations(const Game& game, VertexId settlement);
 
 // Place initial settlement during setup
-bool placeSetupSettlement(Game& game, int playerId, const VertexCoord& location);
+bool placeSetupSettlement(Game& game, int playerId, VertexId location);
 
 // Place initial road during setup (must connect to last placed settlement)
-bool placeSetupRoad(Game& game, int playerId, const EdgeCoord& location);
+bool placeSetupRoad(Game& game, int playerId, EdgeId location);
 
 // Advance setup phase to next player or next phase
 void advanceSetupPhase(Game& game);
 
 // Give initial resources based on second settlement placement
-void giveInitialResources(Game& game, int playerId, const VertexCoord& settlementLocation);
+void giveInitialResources(Game& game, int playerId, VertexId settlementLocation);
 
 // ============================================================================
 // BUILDING VALIDATION
 // ============================================================================
 
+// Legal placements as bitboards; the list functions below are built on these
+VertexMask setupSettlementMask(const Game& game);
+VertexMask settlementMask(const Game& game, int playerId);
+EdgeMask roadMask(const Game& game, int playerId);
+VertexMask cityMask(const Game& game, int playerId);
+
 // Get all valid settlement locations for a player (main game, not setup)
-std::vector<VertexCoord> getValidSettlementLocations(const Game& game, int playerId);
+std::vector<VertexId> getValidSettlementLocations(const Game& game, int playerId);
 
 // Get all valid road locations for a player
-std::vector<EdgeCoord> getValidRoadLocations(const Game& game, int playerId);
+std::vector<EdgeId> getValidRoadLocations(const Game& game, int playerId);
 
 // Get all valid city upgrade locations for a player
-std::vector<VertexCoord> getValidCityLocations(const Game& game, int playerId);
+std::vector<VertexId> getValidCityLocations(const Game& game, int playerId);
 
 // Check if a vertex is at least 2 edges away from any existing settlement/city
-bool isVertexDistanceValid(const Game& game, const VertexCoord& vertex);
+bool isVertexDistanceValid(const Game& game, VertexId vertex);
 
 // Check if a road connects to player's existing network
-bool isRoadConnectedToNetwork(const Game& game, int playerId, const EdgeCoord& edge);
-
-// ============================================================================
-// COORDINATE HELPERS
-// ============================================================================
-
-// Get vertices adjacent to a vertex (the 2-3 neighboring vertices)
-std::vector<VertexCoord> getAdjacentVertices(const VertexCoord& vertex);
-
-// Get edges adjacent to a vertex (the 3 edges that touch this vertex)
-std::vector<EdgeCoord> getEdgesAtVertex(const VertexCoord& vertex);
-
-// Get vertices at the ends of an edge
-std::pair<VertexCoord, VertexCoord> getVerticesOfEdge(const EdgeCoord& edge);
-
-// Normalize vertex coordinate (vertices can be represented multiple ways)
-VertexCoord normalizeVertex(const VertexCoord& vertex);
-
-// Normalize edge coordinate
-EdgeCoord normalizeEdge(const EdgeCoord& edge);
-
-// Check if two vertices are the same (accounting for multiple representations)
-bool verticesEqual(const VertexCoord& v1, const VertexCoord& v2);
-
-// Check if two edges are the same
-bool edgesEqual(const EdgeCoord& e1, const EdgeCoord& e2);
+bool isRoadConnectedToNetwork(const Game& game, int playerId, EdgeId edge);
 
 }  // namespace catan
@@ -0,0 +1,80 @@
+#include "game_reaper.h"
+#include <vector>
+
+namespace catan {
+
+// ============================================================================
+// GAME REAPER IMPLEMENTATION
+// ============================================================================
+
+GameReaper::GameReaper(GameManager& games, GameReaperConfig config, Teardown teardown, Forget forget)
+    : games(games), config(config), teardown(std::move(teardown)), forget(std::move(forget)) {}
+
+GameReaper::~GameReaper() {
+    stop();
+}
+
+void GameReaper::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+    running = true;
+    thread = std::thread([this]() { run(); });
+}
+
+void GameReaper::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    cv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void GameReaper::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        cv.wait_for(lock, config.interval, [this]() { return !running; });
+        if (!running) break;
+        lock.unlock();
+        sweep();
+        lock.lock();
+    }
+}
+
+bool GameReaper::isExpired(const Game& game, Clock::time_point now) const {
+    auto idle = now - game.lastActive();
+    if (idle > config.idleTtl) return true;
+    if (idle <= config.finishedTtl) return false;
+
+    // Only a finished game expires early; phase needs the lock
+    GameLock lock(game, GameLock::Mode::Read);
+    return game.phase == GamePhase::Finished;
+}
+
+size_t GameReaper::sweep() {
+    const size_t stripe = nextStripe;
+    nextStripe = (nextStripe + 1) % GameManager::sweepStripes();
+
+    // Copy the stripe out first so no game lock is taken under the map lock
+    auto now = Clock::now();
+    std::vector<std::string> expired;
+    for (const auto& game : games.gamesInStripe(stripe)) {
+        if (expired.size() >= config.maxRemovalsPerTick) break;
+        if (isExpired(*game, now)) {
+            expired.push_back(game->gameId);
+        }
+    }
+
+    size_t removed = 0;
+    for (const auto& gameId : expired) {
+        if (forget) forget(gameId);
+        if (!games.removeGame(gameId)) continue;
+        if (teardown) teardown(gameId);
+        removed++;
+    }
+    reaped += removed;
+    return removed;
+}
+
+}  // namespace catan
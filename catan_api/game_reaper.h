@@ -0,0 +1,73 @@
+#pragma once
+
+#include "catan_types.h"
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+namespace catan {
+
+// ============================================================================
+// GAME REAPER
+// Background thread that retires games nobody is playing. Each tick sweeps
+// one stripe of the game map and removes at most maxRemovalsPerTick games
+// that have been idle past their TTL, so no single tick does much work.
+// Removing a game only drops the manager's reference; the server's
+// teardown callback releases everything else keyed by the game id. A
+// persisted copy goes first, through the forget callback, so a lookup that
+// misses once the game has left can't load it back.
+// ============================================================================
+
+struct GameReaperConfig {
+    std::chrono::minutes idleTtl{120};      // no writes for this long
+    std::chrono::minutes finishedTtl{15};   // idle this long after someone won
+    std::chrono::seconds interval{15};      // between ticks
+    size_t maxRemovalsPerTick = 16;
+};
+
+class GameReaper {
+public:
+    // Called after a game leaves the manager, off any lock
+    using Teardown = std::function<void(const std::string& gameId)>;
+    // Called just before a game leaves the manager, off any lock
+    using Forget = std::function<void(const std::string& gameId)>;
+
+    GameReaper(GameManager& games, GameReaperConfig config, Teardown teardown, Forget forget = nullptr);
+    ~GameReaper();
+
+    GameReaper(const GameReaper&) = delete;
+    GameReaper& operator=(const GameReaper&) = delete;
+
+    void start();
+    void stop();
+
+    // One tick: sweeps the next stripe. Returns the number of games removed.
+    size_t sweep();
+
+    uint64_t reapedCount() const { return reaped.load(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    GameManager& games;
+    GameReaperConfig config;
+    Teardown teardown;
+    Forget forget;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool running = false;
+
+    size_t nextStripe = 0;          // touched only by the sweeping thread
+    std::atomic<uint64_t> reaped{0};
+
+    void run();
+    bool isExpired(const Game& game, Clock::time_point now) const;
+};
+
+}  // namespace catan
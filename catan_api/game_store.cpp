@@ -0,0 +1,1010 @@
+#include "game_store.h"
+#include "game_delta.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace catan {
+
+// ============================================================================
+// BYTE ENCODING
+// Little-endian fixed-width fields, LEB128 varints, and zigzag for values
+// that may be negative (player ids use -1 for "nobody").
+// ============================================================================
+
+namespace {
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::string& out) : out(out) {}
+
+    void u8(uint8_t value) { out.push_back(static_cast<char>(value)); }
+
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; i++) u8(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            u8(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        u8(static_cast<uint8_t>(value));
+    }
+
+    void sint(int64_t value) {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void str(std::string_view value) {
+        varint(value.size());
+        out.append(value.data(), value.size());
+    }
+
+    void hand(const ResourceHand& value) {
+        sint(value[Resource::Wood]);
+        sint(value[Resource::Brick]);
+        sint(value[Resource::Wheat]);
+        sint(value[Resource::Sheep]);
+        sint(value[Resource::Ore]);
+    }
+
+    void cards(const std::vector<DevCardType>& value) {
+        varint(value.size());
+        for (DevCardType card : value) u8(static_cast<uint8_t>(card));
+    }
+
+private:
+    std::string& out;
+};
+
+// Reads past the end or a malformed varint clear ok; callers check it once
+// at the end rather than after every field
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data) : data(data) {}
+
+    bool ok = true;
+
+    bool atEnd() const { return pos == data.size(); }
+
+    uint8_t u8() {
+        if (pos >= data.size()) { ok = false; return 0; }
+        return static_cast<uint8_t>(data[pos++]);
+    }
+
+    uint64_t u64() {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(u8()) << (8 * i);
+        return value;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = u8();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t sint() {
+        uint64_t raw = varint();
+        return static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    }
+
+    // Small bounded counts (list lengths, hand sizes)
+    int count(int limit) {
+        uint64_t value = varint();
+        if (value > static_cast<uint64_t>(limit)) { ok = false; return 0; }
+        return static_cast<int>(value);
+    }
+
+    std::string_view str() {
+        uint64_t length = varint();
+        if (!ok || length > data.size() - pos) { ok = false; return {}; }
+        std::string_view value = data.substr(pos, length);
+        pos += length;
+        return value;
+    }
+
+    ResourceHand hand() {
+        ResourceHand value;
+        value[Resource::Wood] = amount();
+        value[Resource::Brick] = amount();
+        value[Resource::Wheat] = amount();
+        value[Resource::Sheep] = amount();
+        value[Resource::Ore] = amount();
+        return value;
+    }
+
+    // A resource count; signed so a hand a bug drove negative still loads
+    int amount() {
+        int64_t value = sint();
+        if (value < -MAX_HAND || value > MAX_HAND) { ok = false; return 0; }
+        return static_cast<int>(value);
+    }
+
+    std::vector<DevCardType> cards() {
+        std::vector<DevCardType> value(count(MAX_CARDS));
+        for (auto& card : value) {
+            uint8_t raw = u8();
+            if (raw > static_cast<uint8_t>(DevCardType::Monopoly)) ok = false;
+            card = static_cast<DevCardType>(raw);
+        }
+        return value;
+    }
+
+private:
+    static constexpr int MAX_HAND = 1 << 16;
+    static constexpr int MAX_CARDS = 1 << 10;
+
+    std::string_view data;
+    size_t pos = 0;
+};
+
+template <typename Enum>
+bool decodeEnum(ByteReader& in, Enum last, Enum& out) {
+    uint8_t raw = in.u8();
+    if (raw > static_cast<uint8_t>(last)) return false;
+    out = static_cast<Enum>(raw);
+    return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// GAME ENCODING
+// Layout, in order (v = varint, s = zigzag varint, str = v length + bytes):
+//   u8 format version
+//   str gameId, str name, v maxPlayers, u8 isPrivate
+//   u8 phase, s currentPlayerIndex, v setupRound, u8 die1, u8 die2 (0 = no roll)
+//   u8 devCardPlayedThisTurn, v nextTradeId, v nextChatMessageId
+//   v longestRoadLength, s longestRoadPlayerId, v largestArmySize, s largestArmyPlayerId
+//   v version
+//   u64 seed, u64 rng state[4] (format 2 on; format 1 games get a fresh seed)
+//   cards deck
+//   board: u8 hexType[19], u8 numberToken[19], u8 robberHex,
+//          u8 vertex[54] (building | (owner + 1) << 2),
+//          u8 roads[36] (two edges per byte, owner + 1 per nibble),
+//          v port count, then u8 vertex1, u8 vertex2, u8 type each
+//   v player count, then per player:
+//          s id, str name, str sessionToken, u8 type, hand resources,
+//          cards devCards, cards devCardsPlayedThisTurn,
+//          v settlements, v cities, v roads remaining, v knightsPlayed,
+//          u8 flags (longest road | largest army << 1 | connected << 2)
+//   (hands are five s counts: wood, brick, wheat, sheep, ore)
+//   v trade count, then per retained trade, oldest first:
+//          v id, s from, s to, hand offering, hand requesting,
+//          v count + s ids accepted, v count + s ids rejected,
+//          u8 isActive, str chatMessageId
+//   v chat count, then per retained message, oldest first:
+//          v id, s from, s to, str content, u8 type, s relatedTradeId,
+//          u8 (has offering | has requesting << 1), hands present
+// ============================================================================
+
+std::string encodeGame(const Game& game) {
+    std::string data;
+    data.reserve(1024);
+    ByteWriter out(data);
+
+    out.u8(GAME_FORMAT_VERSION);
+    out.str(game.gameId);
+    out.str(game.name);
+    out.varint(game.maxPlayers);
+    out.u8(game.isPrivate);
+
+    out.u8(static_cast<uint8_t>(game.phase));
+    out.sint(game.currentPlayerIndex);
+    out.varint(game.setupRound);
+    out.u8(game.lastRoll ? game.lastRoll->die1 : 0);
+    out.u8(game.lastRoll ? game.lastRoll->die2 : 0);
+    out.u8(game.devCardPlayedThisTurn);
+    out.varint(game.nextTradeId);
+    out.varint(game.nextChatMessageId);
+    out.varint(game.longestRoadLength);
+    out.sint(game.longestRoadPlayerId);
+    out.varint(game.largestArmySize);
+    out.sint(game.largestArmyPlayerId);
+    out.varint(game.version.load());
+    out.u64(game.seed);
+    for (uint64_t word : game.rng.getState()) out.u64(word);
+    out.cards(game.devCardDeck);
+
+    const GameBoard& board = game.board;
+    for (HexType type : board.hexType) out.u8(static_cast<uint8_t>(type));
+    for (uint8_t token : board.numberToken) out.u8(token);
+    out.u8(board.robberHex);
+    for (int v = 0; v < NUM_VERTICES; v++) {
+        out.u8(static_cast<uint8_t>(board.building[v]) | static_cast<uint8_t>((board.vertexOwner[v] + 1) << 2));
+    }
+    for (int e = 0; e < NUM_EDGES; e += 2) {
+        out.u8(static_cast<uint8_t>((board.roadOwner[e] + 1) | ((board.roadOwner[e + 1] + 1) << 4)));
+    }
+    out.varint(board.ports.size());
+    for (const Port& port : board.ports) {
+        out.u8(port.vertex1);
+        out.u8(port.vertex2);
+        out.u8(static_cast<uint8_t>(port.type));
+    }
+
+    out.varint(game.players.size());
+    for (const Player& player : game.players) {
+        out.sint(player.id);
+        out.str(player.name);
+        out.str(player.sessionToken);
+        out.u8(static_cast<uint8_t>(player.playerType));
+        out.hand(player.resources);
+        out.cards(player.devCards);
+        out.cards(player.devCardsPlayedThisTurn);
+        out.varint(player.settlementsRemaining);
+        out.varint(player.citiesRemaining);
+        out.varint(player.roadsRemaining);
+        out.varint(player.knightsPlayed);
+        out.u8(static_cast<uint8_t>(player.hasLongestRoad | (player.hasLargestArmy << 1) |
+                                    (player.isConnected << 2)));
+    }
+
+    out.varint(game.tradeOffers.size());
+    for (const TradeOffer& trade : game.tradeOffers) {
+        out.varint(trade.id);
+        out.sint(trade.fromPlayerId);
+        out.sint(trade.toPlayerId);
+        out.hand(trade.offering);
+        out.hand(trade.requesting);
+        out.varint(trade.acceptedByPlayerIds.size());
+        for (int id : trade.acceptedByPlayerIds) out.sint(id);
+        out.varint(trade.rejectedByPlayerIds.size());
+        for (int id : trade.rejectedByPlayerIds) out.sint(id);
+        out.u8(trade.isActive);
+        out.str(trade.chatMessageId);
+    }
+
+    out.varint(game.chatMessages.size());
+    game.chatMessages.forEachSince(0, [&](const ChatEntry& entry) {
+        out.varint(entry.id);
+        out.sint(entry.fromPlayerId);
+        out.sint(entry.toPlayerId);
+        out.str(entry.content);
+        out.u8(static_cast<uint8_t>(entry.type));
+        out.sint(entry.relatedTradeId);
+        out.u8(static_cast<uint8_t>(entry.tradeOffering.has_value() | (entry.tradeRequesting.has_value() << 1)));
+        if (entry.tradeOffering) out.hand(*entry.tradeOffering);
+        if (entry.tradeRequesting) out.hand(*entry.tradeRequesting);
+        return true;
+    });
+
+    return data;
+}
+
+bool decodeGame(std::string_view data, Game& game) {
+    ByteReader in(data);
+    uint8_t format = in.u8();
+    if (format == 0 || format > GAME_FORMAT_VERSION) return false;
+
+    auto now = std::chrono::steady_clock::now();
+
+    game.gameId = std::string(in.str());
+    game.name = std::string(in.str());
+    game.maxPlayers = in.count(MAX_PLAYERS);
+    game.isPrivate = in.u8() != 0;
+
+    if (!decodeEnum(in, GamePhase::Finished, game.phase)) return false;
+    game.currentPlayerIndex = static_cast<int>(in.sint());
+    game.setupRound = in.count(UINT8_MAX);
+    int die1 = in.u8();
+    int die2 = in.u8();
+    if (die1 && die2) game.lastRoll = DiceRoll{die1, die2};
+    game.devCardPlayedThisTurn = in.u8() != 0;
+    game.nextTradeId = in.count(INT32_MAX);
+    game.nextChatMessageId = in.count(INT32_MAX);
+    game.longestRoadLength = in.count(NUM_EDGES);
+    game.longestRoadPlayerId = static_cast<int>(in.sint());
+    game.largestArmySize = in.count(INT32_MAX);
+    game.largestArmyPlayerId = static_cast<int>(in.sint());
+    uint64_t version = in.varint();
+    if (format >= 2) {
+        game.seed = in.u64();
+        std::array<uint64_t, 4> state;
+        for (uint64_t& word : state) word = in.u64();
+        game.rng.setState(state);
+    } else {
+        // Saved before games had a seed; the rest of it draws from a new one
+        game.seed = secureRandom64();
+        game.rng.seed(game.seed);
+    }
+    game.devCardDeck = in.cards();
+
+    // Board: raw hex layout first, then pieces through the mutators so the
+    // bitboards, road components and production index come out as they
+    // would have during play
+    GameBoard& board = game.board;
+    for (auto& type : board.hexType) {
+        if (!decodeEnum(in, HexType::Ocean, type)) return false;
+    }
+    for (auto& token : board.numberToken) {
+        token = in.u8();
+        if (token > 12) return false;
+    }
+    HexId robber = in.u8();
+    if (robber != INVALID_ID && robber >= NUM_HEXES) return false;
+
+    std::array<uint8_t, NUM_VERTICES> vertices{};
+    for (auto& vertex : vertices) vertex = in.u8();
+    std::array<uint8_t, NUM_EDGES> roads{};
+    for (int e = 0; e < NUM_EDGES; e += 2) {
+        uint8_t pair = in.u8();
+        roads[e] = pair & 0x0F;
+        roads[e + 1] = pair >> 4;
+    }
+
+    int portCount = in.count(NUM_VERTICES);
+    board.ports.clear();
+    for (int i = 0; i < portCount; i++) {
+        Port port;
+        port.vertex1 = in.u8();
+        port.vertex2 = in.u8();
+        if (!decodeEnum(in, PortType::Ore, port.type)) return false;
+        if (port.vertex1 >= NUM_VERTICES || port.vertex2 >= NUM_VERTICES) return false;
+        board.ports.push_back(port);
+    }
+    if (!in.ok) return false;
+
+    for (int v = 0; v < NUM_VERTICES; v++) {
+        auto type = static_cast<Building>(vertices[v] & 0x03);
+        int owner = (vertices[v] >> 2) - 1;
+        if (type == Building::None) continue;
+        if (type > Building::City || owner < 0 || owner >= MAX_PLAYERS) return false;
+        board.placeSettlement(static_cast<VertexId>(v), owner);
+        if (type == Building::City) board.upgradeToCity(static_cast<VertexId>(v));
+    }
+    for (int e = 0; e < NUM_EDGES; e++) {
+        int owner = roads[e] - 1;
+        if (owner < 0) continue;
+        if (owner >= MAX_PLAYERS) return false;
+        board.placeRoad(static_cast<EdgeId>(e), owner);
+    }
+    board.robberHex = robber;
+    for (int total = 2; total <= 12; total++) {
+        board.updateProduction(total);
+    }
+
+    int playerCount = in.count(MAX_PLAYERS);
+    game.clearPlayers();
+    for (int i = 0; i < playerCount; i++) {
+        Player player;
+        player.id = static_cast<int>(in.sint());
+        if (player.id < 0 || player.id >= MAX_PLAYERS || game.getPlayerById(player.id)) return false;
+        player.name = std::string(in.str());
+        player.sessionToken = std::string(in.str());
+        if (!decodeEnum(in, PlayerType::AI, player.playerType)) return false;
+        player.resources = in.hand();
+        player.devCards = in.cards();
+        player.devCardsPlayedThisTurn = in.cards();
+        player.settlementsRemaining = in.count(UINT8_MAX);
+        player.citiesRemaining = in.count(UINT8_MAX);
+        player.roadsRemaining = in.count(UINT8_MAX);
+        player.knightsPlayed = in.count(INT32_MAX);
+        uint8_t flags = in.u8();
+        player.hasLongestRoad = flags & 1;
+        player.hasLargestArmy = flags & 2;
+        player.isConnected = flags & 4;
+        player.lastActivity = now;
+        game.addPlayer(std::move(player));
+    }
+
+    int tradeCount = in.count(INT32_MAX);
+    for (int i = 0; in.ok && i < tradeCount; i++) {
+        TradeOffer trade{};
+        trade.id = in.count(INT32_MAX);
+        trade.fromPlayerId = static_cast<int>(in.sint());
+        trade.toPlayerId = static_cast<int>(in.sint());
+        trade.offering = in.hand();
+        trade.requesting = in.hand();
+        trade.acceptedByPlayerIds.resize(in.count(MAX_PLAYERS));
+        for (int& id : trade.acceptedByPlayerIds) id = static_cast<int>(in.sint());
+        trade.rejectedByPlayerIds.resize(in.count(MAX_PLAYERS));
+        for (int& id : trade.rejectedByPlayerIds) id = static_cast<int>(in.sint());
+        trade.isActive = in.u8() != 0;
+        trade.chatMessageId = std::string(in.str());
+        game.tradeOffers.add(trade);
+    }
+
+    int chatCount = in.count(INT32_MAX);
+    for (int i = 0; in.ok && i < chatCount; i++) {
+        ChatMessage message;
+        message.id = std::to_string(in.varint());
+        message.fromPlayerId = static_cast<int>(in.sint());
+        message.toPlayerId = static_cast<int>(in.sint());
+        message.content = std::string(in.str());
+        if (!decodeEnum(in, ChatMessageType::System, message.type)) return false;
+        message.relatedTradeId = static_cast<int>(in.sint());
+        uint8_t present = in.u8();
+        if (present & 1) message.tradeOffering = in.hand();
+        if (present & 2) message.tradeRequesting = in.hand();
+        message.timestamp = now;
+        game.chatMessages.append(message);
+    }
+
+    if (!in.ok || !in.atEnd()) return false;
+
+    game.createdAt = now;
+    game.touch();
+    game.version.store(version);
+    resetChangeLog(game);
+    return true;
+}
+
+// ============================================================================
+// RECORD FORMAT
+// Each record is a 32-byte header followed by its body:
+//   u32 magic, u8 type, u8 flags, u8 id length, u8 token count,
+//   u32 body length, u32 body checksum (FNV-1a), u64 game version,
+//   u64 saved at (unix seconds)
+// The body is the game id, each token as u8 length + bytes, then (for a
+// snapshot) the encoded game. Tokens are repeated outside the encoding so
+// the token index can be built without decoding anything.
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t RECORD_MAGIC = 0x4E544143;   // "CATN"
+constexpr size_t HEADER_SIZE = 32;
+constexpr uint8_t RECORD_SNAPSHOT = 1;
+constexpr uint8_t RECORD_TOMBSTONE = 2;
+constexpr uint8_t FLAG_WAITING = 1;
+
+// Compact a shard once it is mostly superseded records
+constexpr uint64_t COMPACT_MIN_DEAD_BYTES = 4 * 1024 * 1024;
+
+struct RecordHeader {
+    uint32_t magic = RECORD_MAGIC;
+    uint8_t type = RECORD_SNAPSHOT;
+    uint8_t flags = 0;
+    uint8_t idLength = 0;
+    uint8_t tokenCount = 0;
+    uint32_t bodyLength = 0;
+    uint32_t checksum = 0;
+    uint64_t version = 0;
+    uint64_t savedAt = 0;
+};
+
+uint32_t fnv1a(std::string_view data) {
+    uint32_t hash = 2166136261u;
+    for (char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void putFixed(std::string& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+uint64_t getFixed(const char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+    return value;
+}
+
+RecordHeader parseHeader(const char* in) {
+    RecordHeader header;
+    header.magic = static_cast<uint32_t>(getFixed(in, 4));
+    header.type = static_cast<uint8_t>(in[4]);
+    header.flags = static_cast<uint8_t>(in[5]);
+    header.idLength = static_cast<uint8_t>(in[6]);
+    header.tokenCount = static_cast<uint8_t>(in[7]);
+    header.bodyLength = static_cast<uint32_t>(getFixed(in + 8, 4));
+    header.checksum = static_cast<uint32_t>(getFixed(in + 12, 4));
+    header.version = getFixed(in + 16, 8);
+    header.savedAt = getFixed(in + 24, 8);
+    return header;
+}
+
+// Appends a record to `out`, returning its length
+uint32_t appendRecord(std::string& out, RecordHeader header, const std::string& gameId,
+                      const std::vector<std::string>& tokens, std::string_view payload) {
+    std::string body;
+    body.reserve(gameId.size() + payload.size() + tokens.size() * 33);
+    body.append(gameId);
+    for (const auto& token : tokens) {
+        body.push_back(static_cast<char>(token.size()));
+        body.append(token);
+    }
+    body.append(payload.data(), payload.size());
+
+    header.idLength = static_cast<uint8_t>(gameId.size());
+    header.tokenCount = static_cast<uint8_t>(tokens.size());
+    header.bodyLength = static_cast<uint32_t>(body.size());
+    header.checksum = fnv1a(body);
+    header.savedAt = static_cast<uint64_t>(std::time(nullptr));
+
+    putFixed(out, header.magic, 4);
+    out.push_back(static_cast<char>(header.type));
+    out.push_back(static_cast<char>(header.flags));
+    out.push_back(static_cast<char>(header.idLength));
+    out.push_back(static_cast<char>(header.tokenCount));
+    putFixed(out, header.bodyLength, 4);
+    putFixed(out, header.checksum, 4);
+    putFixed(out, header.version, 8);
+    putFixed(out, header.savedAt, 8);
+    out.append(body);
+    return static_cast<uint32_t>(HEADER_SIZE + body.size());
+}
+
+bool writeAll(int fd, const char* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t written = ::pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t got = ::pread(fd, data, length, static_cast<off_t>(offset));
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        data += got;
+        length -= static_cast<size_t>(got);
+        offset += static_cast<uint64_t>(got);
+    }
+    return true;
+}
+
+void unmap(const char*& mapped, uint64_t& mappedSize) {
+    if (mapped) ::munmap(const_cast<char*>(mapped), mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+}  // namespace
+
+// ============================================================================
+// GAME STORE IMPLEMENTATION
+// ============================================================================
+
+GameStore::GameStore(GameStoreConfig config, Resolver resolver)
+    : config(std::move(config)), resolver(std::move(resolver)) {
+    if (this->config.shards == 0) this->config.shards = 1;
+}
+
+GameStore::~GameStore() {
+    stop();
+    for (auto& shard : shards) {
+        unmap(shard->mapped, shard->mappedSize);
+        if (shard->fd >= 0) ::close(shard->fd);
+    }
+}
+
+size_t GameStore::shardFor(const std::string& gameId) const {
+    // Stable across builds, unlike std::hash, since it picks a file
+    return fnv1a(gameId) % config.shards;
+}
+
+void GameStore::open() {
+    if (::mkdir(config.directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        throw std::runtime_error("Cannot create " + config.directory + ": " + strerror(errno));
+    }
+
+    for (size_t i = 0; i < config.shards; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->path = config.directory + "/games-" + std::to_string(i) + ".log";
+        openShard(*shard);
+        shards.push_back(std::move(shard));
+    }
+    for (uint32_t i = 0; i < shards.size(); i++) {
+        scanShard(i);
+    }
+}
+
+void GameStore::openShard(Shard& shard) {
+    shard.fd = ::open(shard.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (shard.fd < 0) {
+        throw std::runtime_error("Cannot open " + shard.path + ": " + strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(shard.fd, &info) < 0) {
+        throw std::runtime_error("Cannot stat " + shard.path + ": " + strerror(errno));
+    }
+    shard.size = static_cast<uint64_t>(info.st_size);
+
+    // Records appended later are read with pread; the mapping only covers
+    // what was on disk at open
+    if (shard.size > 0) {
+        void* mapped = ::mmap(nullptr, shard.size, PROT_READ, MAP_SHARED, shard.fd, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Cannot map " + shard.path + ": " + strerror(errno));
+        }
+        shard.mapped = static_cast<const char*>(mapped);
+        shard.mappedSize = shard.size;
+    }
+}
+
+void GameStore::scanShard(uint32_t shardIndex) {
+    Shard& shard = *shards[shardIndex];
+    const uint64_t now = static_cast<uint64_t>(std::time(nullptr));
+    const uint64_t maxAge = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(config.maxAge).count());
+
+    uint64_t offset = 0;
+    while (offset + HEADER_SIZE <= shard.mappedSize) {
+        const char* at = shard.mapped + offset;
+        RecordHeader header = parseHeader(at);
+        uint64_t length = HEADER_SIZE + header.bodyLength;
+        if (header.magic != RECORD_MAGIC || offset + length > shard.mappedSize) break;
+
+        // Only the last record can be torn; earlier ones are checked on load
+        std::string_view body(at + HEADER_SIZE, header.bodyLength);
+        if (offset + length == shard.mappedSize && fnv1a(body) != header.checksum) break;
+
+        std::string gameId(body.substr(0, header.idLength));
+        size_t pos = header.idLength;
+        Location location;
+        location.shard = shardIndex;
+        location.offset = offset;
+        location.length = static_cast<uint32_t>(length);
+        location.version = header.version;
+        location.waiting = header.flags & FLAG_WAITING;
+        for (int t = 0; t < header.tokenCount && pos < body.size(); t++) {
+            size_t tokenLength = static_cast<uint8_t>(body[pos++]);
+            location.tokens.emplace_back(body.substr(pos, tokenLength));
+            pos += tokenLength;
+        }
+        offset += length;
+
+        std::lock_guard<std::mutex> lock(indexMutex);
+        auto existing = index.find(gameId);
+        bool newer = existing == index.end() || header.version >= existing->second.version;
+        bool expired = maxAge > 0 && header.savedAt + maxAge < now;
+        if (header.type == RECORD_SNAPSHOT && newer && !expired) {
+            indexRecord(gameId, std::move(location));
+            continue;
+        }
+        if (newer && existing != index.end()) dropRecord(gameId);
+        shard.deadBytes += length;
+    }
+
+    if (offset < shard.size) {
+        std::cerr << "Game store: truncating " << shard.path << " at " << offset
+                  << " (" << (shard.size - offset) << " bytes of torn or unknown data)" << std::endl;
+        if (::ftruncate(shard.fd, static_cast<off_t>(offset)) < 0) {
+            throw std::runtime_error("Cannot truncate " + shard.path + ": " + strerror(errno));
+        }
+        shard.size = offset;
+        shard.mappedSize = std::min(shard.mappedSize, offset);
+    }
+}
+
+// Both expect indexMutex held
+void GameStore::indexRecord(const std::string& gameId, Location location) {
+    dropRecord(gameId);
+    shards[location.shard]->liveBytes += location.length;
+    for (const auto& token : location.tokens) {
+        tokenIndex[token] = gameId;
+    }
+    index[gameId] = std::move(location);
+}
+
+void GameStore::dropRecord(const std::string& gameId) {
+    auto it = index.find(gameId);
+    if (it == index.end()) return;
+    Shard& shard = *shards[it->second.shard];
+    shard.liveBytes -= it->second.length;
+    shard.deadBytes += it->second.length;
+    for (const auto& token : it->second.tokens) {
+        auto owner = tokenIndex.find(token);
+        if (owner != tokenIndex.end() && owner->second == gameId) tokenIndex.erase(owner);
+    }
+    index.erase(it);
+}
+
+void GameStore::start() {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    if (running) return;
+    running = true;
+    thread = std::thread([this]() { run(); });
+}
+
+void GameStore::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (!running) return;
+        running = false;
+    }
+    pendingCv.notify_all();
+    if (thread.joinable()) thread.join();
+    flush();
+}
+
+void GameStore::markDirty(const std::string& gameId) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    dirty.insert(gameId);
+}
+
+void GameStore::erase(const std::string& gameId) {
+    uint64_t version = 0;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        auto it = index.find(gameId);
+        if (it != index.end()) {
+            version = it->second.version;
+            dropRecord(gameId);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    dirty.erase(gameId);
+    erased[gameId] = version;
+}
+
+void GameStore::run() {
+    std::unique_lock<std::mutex> lock(pendingMutex);
+    while (running) {
+        // Everything marked during one interval shares a batch
+        pendingCv.wait_for(lock, config.flushInterval, [this]() { return !running; });
+        if (!running) break;
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void GameStore::flush() {
+    std::lock_guard<std::mutex> batchLock(flushMutex);
+    std::unordered_set<std::string> games;
+    std::unordered_map<std::string, uint64_t> removed;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        games.swap(dirty);
+        removed.swap(erased);
+    }
+    if (games.empty() && removed.empty()) return;
+    writeBatch(games, removed);
+}
+
+void GameStore::writeBatch(const std::unordered_set<std::string>& games,
+                           const std::unordered_map<std::string, uint64_t>& removed) {
+    struct Pending {
+        std::string gameId;
+        Location location;                      // offset relative to the batch
+        bool tombstone = false;
+    };
+    std::vector<std::string> buffers(shards.size());
+    std::vector<std::vector<Pending>> pending(shards.size());
+
+    for (const auto& gameId : games) {
+        std::shared_ptr<Game> game = resolver(gameId);
+        if (!game) continue;
+
+        RecordHeader header;
+        Pending entry;
+        std::string payload;
+        {
+            GameLock lock(*game, GameLock::Mode::Read);
+            payload = encodeGame(*game);
+            header.version = game->version.load();
+            if (game->phase == GamePhase::WaitingForPlayers && !game->isPrivate) header.flags |= FLAG_WAITING;
+            for (const auto& player : game->players) {
+                if (!player.sessionToken.empty()) entry.location.tokens.push_back(player.sessionToken);
+            }
+        }
+
+        size_t s = shardFor(gameId);
+        entry.gameId = gameId;
+        entry.location.shard = static_cast<uint32_t>(s);
+        entry.location.offset = buffers[s].size();
+        entry.location.version = header.version;
+        entry.location.waiting = header.flags & FLAG_WAITING;
+        entry.location.length = appendRecord(buffers[s], header, gameId, entry.location.tokens, payload);
+        pending[s].push_back(std::move(entry));
+    }
+
+    for (const auto& [gameId, version] : removed) {
+        size_t s = shardFor(gameId);
+        RecordHeader header;
+        header.type = RECORD_TOMBSTONE;
+        header.version = version;
+        Pending entry;
+        entry.gameId = gameId;
+        entry.tombstone = true;
+        entry.location.length = appendRecord(buffers[s], header, gameId, {}, {});
+        pending[s].push_back(std::move(entry));
+    }
+
+    // One write and one sync per shard: the group commit
+    for (uint32_t s = 0; s < shards.size(); s++) {
+        if (buffers[s].empty()) continue;
+        Shard& shard = *shards[s];
+        if (!writeAll(shard.fd, buffers[s].data(), buffers[s].size(), shard.size) ||
+            (config.sync && ::fdatasync(shard.fd) < 0)) {
+            std::cerr << "Game store: write to " << shard.path << " failed: " << strerror(errno) << std::endl;
+            // Drop whatever part landed; the next batch rewrites these games
+            if (::ftruncate(shard.fd, static_cast<off_t>(shard.size)) < 0) {
+                std::cerr << "Game store: cannot truncate " << shard.path << std::endl;
+            }
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            for (const auto& entry : pending[s]) {
+                if (!entry.tombstone) dirty.insert(entry.gameId);
+            }
+            continue;
+        }
+
+        bool compactNow;
+        {
+            std::lock_guard<std::mutex> lock(indexMutex);
+            for (auto& entry : pending[s]) {
+                if (entry.tombstone) {
+                    shard.deadBytes += entry.location.length;
+                    continue;
+                }
+                entry.location.offset += shard.size;
+                indexRecord(entry.gameId, std::move(entry.location));
+            }
+            compactNow = shard.deadBytes >= COMPACT_MIN_DEAD_BYTES && shard.deadBytes > shard.liveBytes;
+        }
+        shard.size += buffers[s].size();
+        records += pending[s].size();
+        if (compactNow) compact(s);
+    }
+    batches++;
+}
+
+// Rewrites a shard with only its live records, then swaps it in. Loads of
+// this shard wait for the swap; other shards are untouched.
+void GameStore::compact(uint32_t shardIndex) {
+    Shard& shard = *shards[shardIndex];
+    std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+
+    std::vector<std::pair<std::string, Location>> live;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        for (const auto& [gameId, location] : index) {
+            if (location.shard == shardIndex) live.emplace_back(gameId, location);
+        }
+    }
+    std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) {
+        return a.second.offset < b.second.offset;
+    });
+
+    std::string tempPath = shard.path + ".compact";
+    int fd = ::open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Game store: cannot compact " << shard.path << ": " << strerror(errno) << std::endl;
+        return;
+    }
+
+    uint64_t size = 0;
+    std::string record;
+    std::vector<uint64_t> offsets;
+    offsets.reserve(live.size());
+    for (const auto& [gameId, location] : live) {
+        if (!readRecord(shard, location, record) || !writeAll(fd, record.data(), record.size(), size)) {
+            std::cerr << "Game store: compaction of " << shard.path << " failed" << std::endl;
+            ::close(fd);
+            ::unlink(tempPath.c_str());
+            return;
+        }
+        offsets.push_back(size);
+        size += record.size();
+    }
+    if (::fdatasync(fd) < 0 || ::rename(tempPath.c_str(), shard.path.c_str()) < 0) {
+        std::cerr << "Game store: compaction of " << shard.path << " failed: " << strerror(errno) << std::endl;
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        return;
+    }
+
+    unmap(shard.mapped, shard.mappedSize);
+    ::close(shard.fd);
+    shard.fd = fd;
+    shard.size = size;
+    if (size > 0) {
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED) {
+            shard.mapped = static_cast<const char*>(mapped);
+            shard.mappedSize = size;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    for (size_t i = 0; i < live.size(); i++) {
+        // An erase may have dropped the game meanwhile
+        auto it = index.find(live[i].first);
+        if (it == index.end() || it->second.shard != shardIndex || it->second.offset != live[i].second.offset) continue;
+        it->second.offset = offsets[i];
+    }
+    shard.liveBytes = size;
+    shard.deadBytes = 0;
+}
+
+bool GameStore::readRecord(const Shard& shard, const Location& location, std::string& out) const {
+    if (location.offset + location.length <= shard.mappedSize) {
+        out.assign(shard.mapped + location.offset, location.length);
+        return true;
+    }
+    out.resize(location.length);
+    return readAll(shard.fd, &out[0], location.length, location.offset);
+}
+
+bool GameStore::load(const std::string& gameId, Game& game) {
+    uint32_t shardIndex;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        auto it = index.find(gameId);
+        if (it == index.end()) return false;
+        shardIndex = it->second.shard;
+    }
+
+    const Shard& shard = *shards[shardIndex];
+    std::string record;
+    {
+        std::shared_lock<std::shared_mutex> shardLock(shard.mutex);
+        Location location;
+        {
+            // Re-read under the shard lock; compaction may have moved it
+            std::lock_guard<std::mutex> lock(indexMutex);
+            auto it = index.find(gameId);
+            if (it == index.end()) return false;
+            location = it->second;
+        }
+        if (!readRecord(shard, location, record)) return false;
+    }
+
+    RecordHeader header = parseHeader(record.data());
+    std::string_view body(record.data() + HEADER_SIZE, record.size() - HEADER_SIZE);
+    if (header.magic != RECORD_MAGIC || header.type != RECORD_SNAPSHOT ||
+        header.bodyLength != body.size() || fnv1a(body) != header.checksum) {
+        std::cerr << "Game store: record for game " << gameId << " is corrupt" << std::endl;
+        return false;
+    }
+
+    size_t pos = header.idLength;
+    for (int t = 0; t < header.tokenCount && pos < body.size(); t++) {
+        pos += 1 + static_cast<uint8_t>(body[pos]);
+    }
+    if (pos > body.size() || !decodeGame(body.substr(pos), game)) {
+        std::cerr << "Game store: cannot decode game " << gameId << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string GameStore::gameForToken(const std::string& token) const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    auto it = tokenIndex.find(token);
+    return it == tokenIndex.end() ? std::string() : it->second;
+}
+
+std::vector<std::string> GameStore::waitingGames() const {
+    std::vector<std::string> result;
+    std::lock_guard<std::mutex> lock(indexMutex);
+    for (const auto& [gameId, location] : index) {
+        if (location.waiting) result.push_back(gameId);
+    }
+    return result;
+}
+
+size_t GameStore::storedGameCount() const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    return index.size();
+}
+
+}  // namespace catan
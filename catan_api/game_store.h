@@ -0,0 +1,150 @@
+#pragma once
+
+#include "catan_types.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+namespace catan {
+
+// ============================================================================
+// BINARY GAME ENCODING
+// A compact, versioned encoding of everything needed to resume a game:
+// board pieces by topology ID, hands, decks, turn state and the retained
+// chat and trade history. Derived board state (bitboards, road components,
+// the production index) is rebuilt through the GameBoard mutators on decode.
+// ============================================================================
+
+// 2 added the game's seed and generator state. Older formats still decode.
+constexpr uint8_t GAME_FORMAT_VERSION = 2;
+
+// Call with the game lock held
+std::string encodeGame(const Game& game);
+
+// Decodes into a freshly constructed game, whose chat and trade capacities
+// are kept. Returns false if the data is malformed or of a newer version.
+bool decodeGame(std::string_view data, Game& game);
+
+// ============================================================================
+// GAME STORE
+// Games persisted to append-only log files, one per shard. A record is the
+// latest encoding of one game (or a tombstone once it is removed), so the
+// newest record for a game wins. Writes are marked dirty by the request
+// path and flushed by a background thread in batches, one write and at most
+// one fdatasync per shard per batch. On open the files are mapped and only
+// the record headers are scanned; a game is decoded the first time someone
+// asks for it.
+// ============================================================================
+
+struct GameStoreConfig {
+    std::string directory;
+    size_t shards = 8;
+    std::chrono::milliseconds flushInterval{100};
+    bool sync = true;                           // fdatasync each batch
+    std::chrono::minutes maxAge{0};             // older records are dropped on open; 0 keeps all
+};
+
+class GameStore {
+public:
+    // Resolves a dirty game id to the loaded game, or nullptr if it is gone
+    using Resolver = std::function<std::shared_ptr<Game>(const std::string& gameId)>;
+
+    GameStore(GameStoreConfig config, Resolver resolver);
+    ~GameStore();
+
+    GameStore(const GameStore&) = delete;
+    GameStore& operator=(const GameStore&) = delete;
+
+    // Opens (or creates) the shard files and indexes their records. Throws
+    // std::runtime_error if the directory or a file cannot be opened.
+    void open();
+    void start();
+    void stop();                                // flushes what is pending
+
+    // Cheap; called on every write unlock
+    void markDirty(const std::string& gameId);
+
+    // Stops writing the game and records its removal
+    void erase(const std::string& gameId);
+
+    // Decodes the stored game into `game`. False if unknown or unreadable.
+    bool load(const std::string& gameId, Game& game);
+
+    // Game a stored player token belongs to, or "" if none
+    std::string gameForToken(const std::string& token) const;
+
+    // Stored games that were still waiting for players, for the lobby
+    std::vector<std::string> waitingGames() const;
+
+    // Writes everything dirty now, on the calling thread
+    void flush();
+
+    size_t storedGameCount() const;
+    uint64_t batchesWritten() const { return batches.load(); }
+    uint64_t recordsWritten() const { return records.load(); }
+
+private:
+    struct Location {
+        uint32_t shard = 0;
+        uint64_t offset = 0;                    // of the record header
+        uint32_t length = 0;                    // header and body
+        uint64_t version = 0;                   // game version when it was written
+        bool waiting = false;
+        std::vector<std::string> tokens;
+    };
+
+    struct Shard {
+        std::string path;
+        int fd = -1;
+        uint64_t size = 0;                      // file size; advanced by the writer only
+        const char* mapped = nullptr;           // read-only view of [0, mappedSize)
+        uint64_t mappedSize = 0;
+        uint64_t liveBytes = 0;
+        uint64_t deadBytes = 0;
+        mutable std::shared_mutex mutex;        // exclusive only while compacting
+    };
+
+    GameStoreConfig config;
+    Resolver resolver;
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    // Lock order: a shard's mutex, then indexMutex
+    mutable std::mutex indexMutex;
+    std::unordered_map<std::string, Location> index;
+    std::unordered_map<std::string, std::string> tokenIndex;    // token -> gameId
+
+    std::mutex pendingMutex;
+    std::condition_variable pendingCv;
+    std::unordered_set<std::string> dirty;
+    std::unordered_map<std::string, uint64_t> erased;          // gameId -> last stored version
+    bool running = false;
+    std::thread thread;
+
+    std::mutex flushMutex;                      // one batch at a time
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> records{0};
+
+    size_t shardFor(const std::string& gameId) const;
+    void openShard(Shard& shard);
+    void scanShard(uint32_t shardIndex);
+    void run();
+    void writeBatch(const std::unordered_set<std::string>& games,
+                    const std::unordered_map<std::string, uint64_t>& removed);
+    void indexRecord(const std::string& gameId, Location location);
+    void dropRecord(const std::string& gameId);
+    void compact(uint32_t shardIndex);
+    bool readRecord(const Shard& shard, const Location& location, std::string& out) const;
+};
+
+}  // namespace catan
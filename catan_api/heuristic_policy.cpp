@@ -0,0 +1,379 @@
+#include "heuristic_policy.h"
+#include "game_logic.h"
+#include "json_writer.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace catan {
+namespace ai {
+
+// ============================================================================
+// POSITION EVALUATION
+// ============================================================================
+
+namespace {
+
+constexpr Resource RESOURCES[] = {
+    Resource::Wood, Resource::Brick, Resource::Wheat, Resource::Sheep, Resource::Ore
+};
+
+int resourceIndex(Resource r) {
+    return static_cast<int>(r) - static_cast<int>(Resource::Wood);
+}
+
+// Pips the player already collects per resource, cities counting twice
+std::array<int, 5> playerProduction(const Game& game, int playerId) {
+    std::array<int, 5> pips{};
+    if (playerId < 0 || playerId >= MAX_PLAYERS) return pips;
+    const GameBoard& board = game.board;
+    const BoardTopology& topo = boardTopology();
+    forEachVertex(board.playerBuildings[playerId], [&](VertexId v) {
+        int weight = board.building[v] == Building::City ? 2 : 1;
+        for (HexId h : topo.vertexHexes[v]) {
+            if (h == INVALID_ID) break;
+            Resource r = hexTypeToResource(board.hexType[h]);
+            if (r != Resource::None) pips[resourceIndex(r)] += weight * tokenPips(board.numberToken[h]);
+        }
+    });
+    return pips;
+}
+
+bool vertexHasPort(const Game& game, VertexId v) {
+    for (const Port& port : game.board.ports) {
+        if (port.vertex1 == v || port.vertex2 == v) return true;
+    }
+    return false;
+}
+
+double vertexValueWith(const Game& game, VertexId v, const std::array<int, 5>& production) {
+    const GameBoard& board = game.board;
+    double value = 0;
+    for (HexId h : boardTopology().vertexHexes[v]) {
+        if (h == INVALID_ID) break;
+        Resource r = hexTypeToResource(board.hexType[h]);
+        if (r == Resource::None) continue;
+        double pips = tokenPips(board.numberToken[h]);
+        if (h == board.robberHex) pips *= 0.5;
+        // A resource the player lacks is worth more than a sixth source of it
+        value += pips * (production[resourceIndex(r)] == 0 ? 1.5 : 1.0);
+    }
+    if (vertexHasPort(game, v)) value += 1.0;
+    return value;
+}
+
+template <typename Score>
+VertexId bestVertex(VertexMask mask, Score score) {
+    VertexId best = INVALID_ID;
+    double bestScore = -1;
+    forEachVertex(mask, [&](VertexId v) {
+        double s = score(v);
+        if (s > bestScore) {
+            bestScore = s;
+            best = v;
+        }
+    });
+    return best;
+}
+
+// Value of extending the network along e: the best settlement spot at its
+// far end, or half the best one step further on
+double roadValue(const Game& game, int playerId, EdgeId e, const std::array<int, 5>& production) {
+    const GameBoard& board = game.board;
+    const BoardTopology& topo = boardTopology();
+    VertexMask network = board.playerBuildings[playerId] | board.playerRoadEnds[playerId];
+    const VertexMask open = ~board.blockedVertices;
+
+    double best = 0;
+    for (VertexId end : topo.edgeVertices[e]) {
+        if (network & vertexBit(end)) continue;
+        if (board.occupiedVertices & vertexBit(end)) continue;     // an opponent's town stops the road
+        if (open & vertexBit(end)) best = std::max(best, vertexValueWith(game, end, production));
+        forEachVertex(topo.vertexNeighborMask[end] & open & ~network, [&](VertexId next) {
+            best = std::max(best, 0.5 * vertexValueWith(game, next, production));
+        });
+    }
+    return best;
+}
+
+// Resources still needed for cost
+ResourceHand shortfall(const ResourceHand& have, const ResourceHand& cost) {
+    ResourceHand missing;
+    for (Resource r : RESOURCES) missing[r] = std::max(0, cost[r] - have[r]);
+    return missing;
+}
+
+// A 4:1 (or port) trade that makes `cost` affordable sooner, giving only
+// what the cost itself doesn't use
+bool planTrade(const Game& game, int playerId, const ResourceHand& have, const ResourceHand& cost,
+               PolicyAction& action) {
+    ResourceHand missing = shortfall(have, cost);
+    if (missing.total() == 0) return false;
+
+    Resource receive = Resource::None;
+    for (Resource r : RESOURCES) {
+        if (missing[r] > 0) { receive = r; break; }
+    }
+
+    Resource give = Resource::None;
+    int giveAmount = 0;
+    int bestSurplus = 0;
+    for (Resource r : RESOURCES) {
+        if (r == receive) continue;
+        int ratio = getTradeRatio(game, playerId, r);
+        int surplus = have[r] - cost[r] - ratio;
+        if (surplus >= 0 && (give == Resource::None || surplus > bestSurplus)) {
+            give = r;
+            giveAmount = ratio;
+            bestSurplus = surplus;
+        }
+    }
+    if (give == Resource::None) return false;
+
+    action.type = PolicyActionType::BankTrade;
+    action.give = give;
+    action.receive = receive;
+    action.giveAmount = giveAmount;
+    return true;
+}
+
+PolicyAction setupAction(const Game& game, int playerId) {
+    const GameBoard& board = game.board;
+    PolicyAction action;
+
+    // Every setup settlement gets its road before the turn passes, so an
+    // own settlement with no own road next to it is waiting for one
+    VertexMask awaitingRoad = board.playerBuildings[playerId] & ~board.playerRoadEnds[playerId];
+    if (awaitingRoad) {
+        VertexId settlement = static_cast<VertexId>(__builtin_ctzll(awaitingRoad));
+        EdgeMask free = boardTopology().vertexEdgeMask[settlement] & ~board.occupiedEdges;
+        auto production = playerProduction(game, playerId);
+        double bestScore = -1;
+        forEachEdge(free, [&](EdgeId e) {
+            double s = roadValue(game, playerId, e, production);
+            if (s > bestScore) {
+                bestScore = s;
+                action.edge = e;
+            }
+        });
+        action.type = PolicyActionType::PlaceSetupRoad;
+        action.forced = free.count() == 1;
+        return action;
+    }
+
+    auto production = playerProduction(game, playerId);
+    action.type = PolicyActionType::PlaceSetupSettlement;
+    action.vertex = bestVertex(setupSettlementMask(game), [&](VertexId v) {
+        return vertexValueWith(game, v, production);
+    });
+    return action;
+}
+
+PolicyAction robberAction(const Game& game, int playerId) {
+    const GameBoard& board = game.board;
+    const BoardTopology& topo = boardTopology();
+    PolicyAction action;
+    action.type = PolicyActionType::MoveRobber;
+
+    // Block the most opponent production on a hex we don't touch ourselves
+    double bestScore = -1e9;
+    for (HexId h = 0; h < NUM_HEXES; h++) {
+        if (h == board.robberHex) continue;
+        double score = 0;
+        for (VertexId v : topo.hexVertices[h]) {
+            int owner = board.vertexOwner[v];
+            if (owner < 0) continue;
+            int weight = board.building[v] == Building::City ? 2 : 1;
+            score += (owner == playerId ? -3.0 : 1.0) * weight;
+        }
+        score *= tokenPips(board.numberToken[h]) + 0.1;
+        if (score > bestScore) {
+            bestScore = score;
+            action.hex = h;
+        }
+    }
+
+    // Steal from whoever on that hex holds the most cards
+    int mostCards = 0;
+    for (VertexId v : topo.hexVertices[action.hex]) {
+        int owner = board.vertexOwner[v];
+        if (owner < 0 || owner == playerId || owner >= static_cast<int>(game.players.size())) continue;
+        int cards = game.players[owner].resources.total();
+        if (cards > mostCards) {
+            mostCards = cards;
+            action.victimId = owner;
+        }
+    }
+    return action;
+}
+
+PolicyAction mainTurnAction(const Game& game, int playerId, const Player& player) {
+    const ResourceHand& have = player.resources;
+    auto production = playerProduction(game, playerId);
+    PolicyAction action;
+
+    VertexMask cities = player.citiesRemaining > 0 ? cityMask(game, playerId) : 0;
+    VertexMask towns = player.settlementsRemaining > 0 ? settlementMask(game, playerId) : 0;
+    EdgeMask roads = player.roadsRemaining > 0 ? roadMask(game, playerId) : EdgeMask();
+    auto score = [&](VertexId v) { return vertexValueWith(game, v, production); };
+
+    if (cities && canAfford(have, CITY_COST)) {
+        action.type = PolicyActionType::BuildCity;
+        action.vertex = bestVertex(cities, score);
+        return action;
+    }
+    if (towns && canAfford(have, SETTLEMENT_COST)) {
+        action.type = PolicyActionType::BuildSettlement;
+        action.vertex = bestVertex(towns, score);
+        return action;
+    }
+
+    // Roads only to reach a new settlement spot
+    EdgeId bestRoad = INVALID_ID;
+    if (!towns && roads.any()) {
+        double bestScore = 0;
+        forEachEdge(roads, [&](EdgeId e) {
+            double s = roadValue(game, playerId, e, production);
+            if (s > bestScore) {
+                bestScore = s;
+                bestRoad = e;
+            }
+        });
+    }
+    if (bestRoad != INVALID_ID && canAfford(have, ROAD_COST)) {
+        action.type = PolicyActionType::BuildRoad;
+        action.edge = bestRoad;
+        return action;
+    }
+
+    // Otherwise work towards the most valuable build we have room for
+    const ResourceHand* goal = nullptr;
+    if (cities) goal = &CITY_COST;
+    else if (towns) goal = &SETTLEMENT_COST;
+    else if (bestRoad != INVALID_ID) goal = &ROAD_COST;
+    else if (!game.devCardDeck.empty()) goal = &DEV_CARD_COST;
+
+    if (goal == &DEV_CARD_COST && canAfford(have, DEV_CARD_COST)) {
+        action.type = PolicyActionType::BuyDevCard;
+        return action;
+    }
+    if (goal && planTrade(game, playerId, have, *goal, action)) {
+        return action;
+    }
+    // A spare dev card beats sitting on cards a 7 could take
+    if (!game.devCardDeck.empty() && canAfford(have, DEV_CARD_COST) && have.total() > 7) {
+        action.type = PolicyActionType::BuyDevCard;
+        return action;
+    }
+
+    // Forced when nothing could be bought or traded at all
+    bool anyMove = canAfford(have, ROAD_COST) || canAfford(have, SETTLEMENT_COST) ||
+                   canAfford(have, CITY_COST) || canAfford(have, DEV_CARD_COST);
+    for (Resource r : RESOURCES) {
+        anyMove = anyMove || have[r] >= getTradeRatio(game, playerId, r);
+    }
+    action.type = PolicyActionType::EndTurn;
+    action.forced = !anyMove;
+    return action;
+}
+
+}  // namespace
+
+int tokenPips(int token) {
+    return (token >= 2 && token <= 12 && token != 7) ? 6 - std::abs(7 - token) : 0;
+}
+
+double vertexValue(const Game& game, int playerId, VertexId v) {
+    if (v >= NUM_VERTICES) return 0;
+    return vertexValueWith(game, v, playerProduction(game, playerId));
+}
+
+// ============================================================================
+// ACTION CHOICE
+// ============================================================================
+
+PolicyAction chooseAction(const Game& game, int playerId) {
+    PolicyAction action;
+    if (playerId < 0 || playerId >= MAX_PLAYERS || game.currentPlayerIndex != playerId) return action;
+    const Player* player = nullptr;
+    for (const auto& p : game.players) {
+        if (p.id == playerId) player = &p;
+    }
+    if (!player) return action;
+
+    switch (game.phase) {
+        case GamePhase::Setup:
+        case GamePhase::SetupReverse:
+            return setupAction(game, playerId);
+        case GamePhase::Rolling:
+            action.type = PolicyActionType::RollDice;
+            action.forced = true;
+            return action;
+        case GamePhase::Robber:
+            return robberAction(game, playerId);
+        case GamePhase::MainTurn:
+            return mainTurnAction(game, playerId, *player);
+        default:
+            return action;
+    }
+}
+
+std::string policyActionName(PolicyActionType type) {
+    switch (type) {
+        case PolicyActionType::RollDice: return "roll_dice";
+        case PolicyActionType::PlaceSetupSettlement: return "place_setup_settlement";
+        case PolicyActionType::PlaceSetupRoad: return "place_setup_road";
+        case PolicyActionType::MoveRobber: return "move_robber";
+        case PolicyActionType::BuildCity: return "build_city";
+        case PolicyActionType::BuildSettlement: return "build_settlement";
+        case PolicyActionType::BuildRoad: return "build_road";
+        case PolicyActionType::BuyDevCard: return "buy_dev_card";
+        case PolicyActionType::BankTrade: return "bank_trade";
+        case PolicyActionType::EndTurn: return "end_turn";
+        default: return "none";
+    }
+}
+
+LLMToolCall policyToolCall(const PolicyAction& action) {
+    static const char* const RESOURCE_NAMES[] = {"wood", "brick", "wheat", "sheep", "ore"};
+    const BoardTopology& topo = boardTopology();
+
+    JsonWriter args(64);
+    args.beginObject();
+    switch (action.type) {
+        case PolicyActionType::PlaceSetupSettlement:
+        case PolicyActionType::BuildSettlement:
+        case PolicyActionType::BuildCity:
+            if (action.vertex < NUM_VERTICES) {
+                const VertexCoord& c = topo.vertexCoords[action.vertex];
+                args.key("hexQ").value(c.hex.q).key("hexR").value(c.hex.r).key("direction").value(c.direction);
+            }
+            break;
+        case PolicyActionType::PlaceSetupRoad:
+        case PolicyActionType::BuildRoad:
+            if (action.edge < NUM_EDGES) {
+                const EdgeCoord& c = topo.edgeCoords[action.edge];
+                args.key("hexQ").value(c.hex.q).key("hexR").value(c.hex.r).key("direction").value(c.direction);
+            }
+            break;
+        case PolicyActionType::MoveRobber:
+            if (action.hex < NUM_HEXES) {
+                const HexCoord& c = topo.hexCoords[action.hex];
+                args.key("hexQ").value(c.q).key("hexR").value(c.r);
+            }
+            args.key("stealFromPlayerId").value(action.victimId);
+            break;
+        case PolicyActionType::BankTrade:
+            if (action.give != Resource::None && action.receive != Resource::None) {
+                args.key("give").value(RESOURCE_NAMES[resourceIndex(action.give)]);
+                args.key("receive").value(RESOURCE_NAMES[resourceIndex(action.receive)]);
+            }
+            break;
+        default:
+            break;
+    }
+    args.endObject();
+    return LLMToolCall{policyActionName(action.type), args.take()};
+}
+
+}  // namespace ai
+}  // namespace catan
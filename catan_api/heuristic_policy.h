@@ -0,0 +1,65 @@
+#pragma once
+
+#include "catan_types.h"
+#include "llm_provider.h"
+
+namespace catan {
+namespace ai {
+
+// ============================================================================
+// HEURISTIC POLICY
+// A fast rule-based player: picks the next action for a player from the
+// board's bitboards and production numbers alone, in microseconds and with
+// no allocation beyond the result. Used by the self-play simulator and as a
+// stand-in for the LLM on simple decisions.
+// ============================================================================
+
+enum class PolicyActionType {
+    None,                   // not this player's move
+    RollDice,
+    PlaceSetupSettlement,
+    PlaceSetupRoad,
+    MoveRobber,
+    BuildCity,
+    BuildSettlement,
+    BuildRoad,
+    BuyDevCard,
+    BankTrade,
+    EndTurn
+};
+
+struct PolicyAction {
+    PolicyActionType type = PolicyActionType::None;
+    VertexId vertex = INVALID_ID;       // settlements and cities
+    EdgeId edge = INVALID_ID;           // roads
+    HexId hex = INVALID_ID;             // robber
+    int victimId = -1;                  // robber; -1 steals from nobody
+    Resource give = Resource::None;     // bank trade
+    Resource receive = Resource::None;
+    int giveAmount = 0;
+
+    // The only legal move in this position (rolling, a setup road with one
+    // free edge, ending a turn with nothing affordable)
+    bool forced = false;
+};
+
+// Dots on a number token: 5 for a 6 or 8, down to 1 for a 2 or 12
+int tokenPips(int token);
+
+// How much a settlement at v would add for the player: pips of the
+// surrounding hexes, weighted towards resources they don't produce yet,
+// plus a little for a port
+double vertexValue(const Game& game, int playerId, VertexId v);
+
+// The next action for the player in the game's current phase. Call with
+// the game lock held.
+PolicyAction chooseAction(const Game& game, int playerId);
+
+std::string policyActionName(PolicyActionType type);
+
+// The action as the AI tool call that performs it (see executeToolCall),
+// with board IDs spelled as hex coordinates
+LLMToolCall policyToolCall(const PolicyAction& action);
+
+}  // namespace ai
+}  // namespace catan
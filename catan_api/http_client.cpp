@@ -0,0 +1,459 @@
+#include "http_client.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+
+namespace catan {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+std::string sslError(const char* what) {
+    char buffer[256];
+    unsigned long code = ERR_get_error();
+    if (code == 0) return what;
+    ERR_error_string_n(code, buffer, sizeof(buffer));
+    return std::string(what) + ": " + buffer;
+}
+
+int remainingMs(Clock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return left > 0 ? static_cast<int>(left) : 0;
+}
+
+// Failure on a pooled connection before the server sent anything; the
+// request is safe to replay on a fresh connection
+struct StaleConnection : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+}  // namespace
+
+// ============================================================================
+// URL / CONNECTION
+// ============================================================================
+
+struct HTTPClient::URL {
+    bool tls = true;
+    std::string host;
+    std::string port;
+    std::string path;
+
+    std::string origin() const {
+        return (tls ? "https://" : "http://") + host + ":" + port;
+    }
+};
+
+struct HTTPClient::Connection {
+    int fd = -1;
+    SSL* ssl = nullptr;
+    std::string origin;
+    std::string host;
+    Clock::time_point lastUsed = Clock::now();
+    std::string readBuffer;  // bytes read past the current parse point
+
+    ~Connection() {
+        if (ssl) SSL_free(ssl);
+        if (fd >= 0) close(fd);
+    }
+
+    // Wait until the socket is ready or the deadline passes
+    void waitFor(short events, Clock::time_point deadline) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = events;
+        while (true) {
+            int timeout = remainingMs(deadline);
+            if (timeout == 0) throw std::runtime_error("HTTP request timed out");
+            int n = poll(&pfd, 1, timeout);
+            if (n > 0) return;
+            if (n == 0) throw std::runtime_error("HTTP request timed out");
+            if (errno != EINTR) throw std::runtime_error("poll failed");
+        }
+    }
+
+    void writeAll(const std::string& data, Clock::time_point deadline) {
+        size_t offset = 0;
+        while (offset < data.size()) {
+            if (ssl) {
+                int n = SSL_write(ssl, data.data() + offset, static_cast<int>(data.size() - offset));
+                if (n > 0) {
+                    offset += static_cast<size_t>(n);
+                    continue;
+                }
+                int err = SSL_get_error(ssl, n);
+                if (err == SSL_ERROR_WANT_WRITE) { waitFor(POLLOUT, deadline); continue; }
+                if (err == SSL_ERROR_WANT_READ) { waitFor(POLLIN, deadline); continue; }
+                throw std::runtime_error(sslError("TLS write failed"));
+            }
+            ssize_t n = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+            if (n > 0) {
+                offset += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { waitFor(POLLOUT, deadline); continue; }
+            throw std::runtime_error("write failed");
+        }
+    }
+
+    // Appends to readBuffer; returns false on orderly close
+    bool readMore(Clock::time_point deadline) {
+        char buffer[16384];
+        while (true) {
+            if (ssl) {
+                int n = SSL_read(ssl, buffer, sizeof(buffer));
+                if (n > 0) {
+                    readBuffer.append(buffer, static_cast<size_t>(n));
+                    return true;
+                }
+                int err = SSL_get_error(ssl, n);
+                if (err == SSL_ERROR_WANT_READ) { waitFor(POLLIN, deadline); continue; }
+                if (err == SSL_ERROR_WANT_WRITE) { waitFor(POLLOUT, deadline); continue; }
+                if (err == SSL_ERROR_ZERO_RETURN) return false;
+                if (err == SSL_ERROR_SYSCALL && ERR_peek_error() == 0) return false;  // EOF without close_notify
+                throw std::runtime_error(sslError("TLS read failed"));
+            }
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                readBuffer.append(buffer, static_cast<size_t>(n));
+                return true;
+            }
+            if (n == 0) return false;
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) { waitFor(POLLIN, deadline); continue; }
+            throw std::runtime_error("read failed");
+        }
+    }
+
+    // A pooled connection the server has closed (or sent stray bytes on) polls readable
+    bool looksAlive() const {
+        if (ssl && SSL_pending(ssl) > 0) return false;
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        return poll(&pfd, 1, 0) == 0;
+    }
+};
+
+// ============================================================================
+// POOL
+// ============================================================================
+
+HTTPClient::HTTPClient() {
+    sslContext = SSL_CTX_new(TLS_client_method());
+    if (!sslContext) {
+        throw std::runtime_error(sslError("SSL_CTX_new failed"));
+    }
+    SSL_CTX_set_min_proto_version(sslContext, TLS1_2_VERSION);
+    SSL_CTX_set_verify(sslContext, SSL_VERIFY_PEER, nullptr);
+    SSL_CTX_set_default_verify_paths(sslContext);
+    SSL_CTX_set_session_cache_mode(sslContext, SSL_SESS_CACHE_CLIENT);
+
+    static const unsigned char alpn[] = { 8, 'h', 't', 't', 'p', '/', '1', '.', '1' };
+    SSL_CTX_set_alpn_protos(sslContext, alpn, sizeof(alpn));
+}
+
+HTTPClient::~HTTPClient() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        idle.clear();
+    }
+    if (sslContext) SSL_CTX_free(sslContext);
+}
+
+HTTPClient& HTTPClient::shared() {
+    static HTTPClient client;
+    return client;
+}
+
+size_t HTTPClient::idleConnectionCount() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    size_t count = 0;
+    for (const auto& entry : idle) count += entry.second.size();
+    return count;
+}
+
+HTTPClient::URL HTTPClient::parseURL(const std::string& url) {
+    URL result;
+    std::string rest;
+    if (url.compare(0, 8, "https://") == 0) {
+        result.tls = true;
+        rest = url.substr(8);
+    } else if (url.compare(0, 7, "http://") == 0) {
+        result.tls = false;
+        rest = url.substr(7);
+    } else {
+        throw std::runtime_error("Unsupported URL: " + url);
+    }
+
+    size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    result.path = (slash == std::string::npos) ? "/" : rest.substr(slash);
+
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos) {
+        result.host = authority.substr(0, colon);
+        result.port = authority.substr(colon + 1);
+    } else {
+        result.host = authority;
+        result.port = result.tls ? "443" : "80";
+    }
+    if (result.host.empty()) {
+        throw std::runtime_error("Missing host in URL: " + url);
+    }
+    return result;
+}
+
+std::unique_ptr<HTTPClient::Connection> HTTPClient::checkout(const URL& url) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto it = idle.find(url.origin());
+    if (it == idle.end()) return nullptr;
+
+    auto& conns = it->second;
+    auto now = Clock::now();
+    while (!conns.empty()) {
+        std::unique_ptr<Connection> conn = std::move(conns.back());
+        conns.pop_back();
+        if (now - conn->lastUsed < std::chrono::seconds(IDLE_TIMEOUT_SECONDS) && conn->looksAlive()) {
+            return conn;
+        }
+    }
+    return nullptr;
+}
+
+void HTTPClient::checkin(std::unique_ptr<Connection> conn) {
+    conn->lastUsed = Clock::now();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto& conns = idle[conn->origin];
+    if (conns.size() < MAX_IDLE_PER_ORIGIN) {
+        conns.push_back(std::move(conn));
+    }
+}
+
+std::unique_ptr<HTTPClient::Connection> HTTPClient::connect(const URL& url, const HTTPClientOptions& options) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(options.connectTimeoutMs);
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addrs = nullptr;
+    if (getaddrinfo(url.host.c_str(), url.port.c_str(), &hints, &addrs) != 0 || !addrs) {
+        throw std::runtime_error("Could not resolve " + url.host);
+    }
+
+    auto conn = std::make_unique<Connection>();
+    conn->origin = url.origin();
+    conn->host = url.host;
+
+    for (struct addrinfo* ai = addrs; ai && conn->fd < 0; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+
+        int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc < 0 && errno == EINPROGRESS) {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (poll(&pfd, 1, remainingMs(deadline)) == 1 &&
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) {
+                rc = 0;
+            }
+        }
+        if (rc == 0) {
+            conn->fd = fd;
+        } else {
+            close(fd);
+        }
+    }
+    freeaddrinfo(addrs);
+
+    if (conn->fd < 0) {
+        throw std::runtime_error("Could not connect to " + url.host + ":" + url.port);
+    }
+
+    int one = 1;
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (url.tls) {
+        conn->ssl = SSL_new(sslContext);
+        SSL_set_fd(conn->ssl, conn->fd);
+        SSL_set_tlsext_host_name(conn->ssl, url.host.c_str());
+        SSL_set1_host(conn->ssl, url.host.c_str());
+
+        while (true) {
+            int rc = SSL_connect(conn->ssl);
+            if (rc == 1) break;
+            int err = SSL_get_error(conn->ssl, rc);
+            if (err == SSL_ERROR_WANT_READ) { conn->waitFor(POLLIN, deadline); continue; }
+            if (err == SSL_ERROR_WANT_WRITE) { conn->waitFor(POLLOUT, deadline); continue; }
+            throw std::runtime_error(sslError("TLS handshake failed"));
+        }
+    }
+
+    opened++;
+    return conn;
+}
+
+// ============================================================================
+// REQUEST
+// ============================================================================
+
+HTTPClientResponse HTTPClient::request(
+    const std::string& method,
+    const std::string& url,
+    const std::string& body,
+    const HTTPHeaderList& headers,
+    const HTTPClientOptions& options
+) {
+    URL target = parseURL(url);
+
+    std::string wire;
+    wire.reserve(256 + body.size());
+    wire += method + " " + target.path + " HTTP/1.1\r\n";
+    wire += "Host: " + target.host + "\r\n";
+    wire += "Connection: keep-alive\r\n";
+    for (const auto& header : headers) {
+        wire += header.first + ": " + header.second + "\r\n";
+    }
+    if (!body.empty() || method == "POST" || method == "PUT") {
+        wire += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    wire += "\r\n";
+    wire += body;
+
+    // One retry: a pooled connection may have been closed by the server
+    // between our liveness check and the write
+    for (int attempt = 0; attempt < 2; attempt++) {
+        std::unique_ptr<Connection> conn = (attempt == 0) ? checkout(target) : nullptr;
+        bool pooled = (conn != nullptr);
+        if (pooled) {
+            reused++;
+        } else {
+            conn = connect(target, options);
+        }
+
+        auto deadline = Clock::now() + std::chrono::milliseconds(options.requestTimeoutMs);
+        HTTPClientResponse response;
+
+        try {
+            try {
+                conn->writeAll(wire, deadline);
+            } catch (const std::runtime_error& e) {
+                if (pooled) throw StaleConnection(e.what());
+                throw;
+            }
+
+            // Status line and headers
+            size_t headerEnd;
+            while ((headerEnd = conn->readBuffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!conn->readMore(deadline)) {
+                    if (pooled && conn->readBuffer.empty()) throw StaleConnection("connection closed");
+                    throw std::runtime_error("Connection closed before response headers");
+                }
+            }
+
+            std::string head = conn->readBuffer.substr(0, headerEnd);
+            conn->readBuffer.erase(0, headerEnd + 4);
+
+            size_t lineEnd = head.find("\r\n");
+            std::string statusLine = head.substr(0, lineEnd);
+            size_t space = statusLine.find(' ');
+            if (space == std::string::npos) throw std::runtime_error("Malformed status line");
+            response.status = std::atoi(statusLine.c_str() + space + 1);
+
+            size_t pos = (lineEnd == std::string::npos) ? head.size() : lineEnd + 2;
+            while (pos < head.size()) {
+                size_t next = head.find("\r\n", pos);
+                if (next == std::string::npos) next = head.size();
+                std::string line = head.substr(pos, next - pos);
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    std::string value = line.substr(colon + 1);
+                    size_t start = value.find_first_not_of(' ');
+                    response.headers[toLower(line.substr(0, colon))] =
+                        (start == std::string::npos) ? "" : value.substr(start);
+                }
+                pos = next + 2;
+            }
+
+            bool keepAlive = toLower(response.headers["connection"]).find("close") == std::string::npos;
+
+            // Body
+            auto te = response.headers.find("transfer-encoding");
+            auto cl = response.headers.find("content-length");
+            if (te != response.headers.end() && toLower(te->second).find("chunked") != std::string::npos) {
+                while (true) {
+                    size_t sizeEnd;
+                    while ((sizeEnd = conn->readBuffer.find("\r\n")) == std::string::npos) {
+                        if (!conn->readMore(deadline)) throw std::runtime_error("Truncated chunked body");
+                    }
+                    size_t chunkSize = std::strtoul(conn->readBuffer.c_str(), nullptr, 16);
+                    conn->readBuffer.erase(0, sizeEnd + 2);
+                    if (chunkSize == 0) {
+                        // Skip trailers up to the terminating blank line
+                        size_t trailerEnd;
+                        while ((trailerEnd = conn->readBuffer.find("\r\n")) != 0) {
+                            if (trailerEnd != std::string::npos) {
+                                conn->readBuffer.erase(0, trailerEnd + 2);
+                                continue;
+                            }
+                            if (!conn->readMore(deadline)) throw std::runtime_error("Truncated chunked body");
+                        }
+                        conn->readBuffer.erase(0, 2);
+                        break;
+                    }
+                    while (conn->readBuffer.size() < chunkSize + 2) {
+                        if (!conn->readMore(deadline)) throw std::runtime_error("Truncated chunked body");
+                    }
+                    response.body.append(conn->readBuffer, 0, chunkSize);
+                    conn->readBuffer.erase(0, chunkSize + 2);
+                }
+            } else if (cl != response.headers.end()) {
+                size_t length = std::strtoul(cl->second.c_str(), nullptr, 10);
+                while (conn->readBuffer.size() < length) {
+                    if (!conn->readMore(deadline)) throw std::runtime_error("Truncated response body");
+                }
+                response.body = conn->readBuffer.substr(0, length);
+                conn->readBuffer.erase(0, length);
+            } else {
+                // No framing: body runs to connection close
+                while (conn->readMore(deadline)) {}
+                response.body.swap(conn->readBuffer);
+                keepAlive = false;
+            }
+
+            if (keepAlive && conn->readBuffer.empty()) {
+                checkin(std::move(conn));
+            }
+            return response;
+        } catch (const StaleConnection&) {
+            if (attempt == 0) continue;
+            throw std::runtime_error("Connection to " + target.origin() + " failed");
+        }
+    }
+
+    throw std::runtime_error("HTTP request failed");
+}
+
+}  // namespace catan
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace catan {
+
+// ============================================================================
+// HTTP CLIENT
+// In-process HTTP/1.1 client (plain or TLS via OpenSSL) with a pool of
+// keep-alive connections per scheme://host:port. Safe to share between
+// threads; each request checks a connection out of the pool for its duration.
+// ============================================================================
+
+using HTTPHeaderList = std::vector<std::pair<std::string, std::string>>;
+
+struct HTTPClientOptions {
+    int connectTimeoutMs = 10000;   // TCP connect + TLS handshake
+    int requestTimeoutMs = 120000;  // whole request, first byte to last
+};
+
+struct HTTPClientResponse {
+    int status = 0;
+    std::unordered_map<std::string, std::string> headers;  // lowercase names
+    std::string body;
+};
+
+class HTTPClient {
+public:
+    HTTPClient();
+    ~HTTPClient();
+
+    HTTPClient(const HTTPClient&) = delete;
+    HTTPClient& operator=(const HTTPClient&) = delete;
+
+    // Throws std::runtime_error on connection, TLS, timeout or protocol errors.
+    // Non-2xx statuses are returned, not thrown.
+    HTTPClientResponse request(
+        const std::string& method,
+        const std::string& url,
+        const std::string& body,
+        const HTTPHeaderList& headers,
+        const HTTPClientOptions& options = HTTPClientOptions()
+    );
+
+    HTTPClientResponse post(
+        const std::string& url,
+        const std::string& body,
+        const HTTPHeaderList& headers,
+        const HTTPClientOptions& options = HTTPClientOptions()
+    ) {
+        return request("POST", url, body, headers, options);
+    }
+
+    // Pool statistics
+    size_t idleConnectionCount() const;
+    uint64_t connectionsOpened() const { return opened.load(); }
+    uint64_t connectionsReused() const { return reused.load(); }
+
+    // Process-wide client so every provider and game shares warm connections
+    static HTTPClient& shared();
+
+private:
+    struct URL;
+    struct Connection;
+
+    // Idle connections kept per origin
+    static constexpr size_t MAX_IDLE_PER_ORIGIN = 16;
+    static constexpr int IDLE_TIMEOUT_SECONDS = 50;
+
+    SSL_CTX* sslContext = nullptr;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<Connection>>> idle;
+    mutable std::mutex poolMutex;
+
+    std::atomic<uint64_t> opened{0};
+    std::atomic<uint64_t> reused{0};
+
+    std::unique_ptr<Connection> checkout(const URL& url);
+    std::unique_ptr<Connection> connect(const URL& url, const HTTPClientOptions& options);
+    void checkin(std::unique_ptr<Connection> conn);
+
+    static URL parseURL(const std::string& url);
+};
+
+}  // namespace catan
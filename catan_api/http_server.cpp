@@ -0,0 +1,1097 @@
+#include "http_server.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace catan {
+
+namespace {
+
+constexpr uint64_t LISTEN_TAG = 0;
+constexpr uint64_t WAKE_TAG = 1;
+constexpr int MAX_EVENTS = 256;
+
+// Input buffers are lent to a connection while it has unparsed bytes and go
+// back to their loop's pool once it is drained, so idle keep-alive and
+// stream connections hold none. Buffers that grew past POOLED_BUFFER_BYTES
+// for a large body are freed instead of pooled.
+constexpr size_t READ_CHUNK = 16384;
+constexpr size_t POOLED_BUFFER_BYTES = 64 * 1024;
+constexpr size_t MAX_POOLED_BUFFERS = 256;
+
+using Clock = std::chrono::steady_clock;
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+HTTPResponse simpleResponse(int status, const char* json) {
+    HTTPResponse response;
+    response.status = status;
+    response.body = json;
+    if (status == 503) {
+        response.headers = "Retry-After: 1\r\n";
+    }
+    return response;
+}
+
+}  // namespace
+
+// ============================================================================
+// HTTP RESPONSE
+// ============================================================================
+
+const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        default:  return "Error";
+    }
+}
+
+std::string serializeHead(const HTTPResponse& response, const char* connectionHeader) {
+    char length[24];
+    int lengthLen = std::snprintf(length, sizeof(length), "%zu", response.body.size());
+
+    std::string head;
+    head.reserve(128 + response.headers.size());
+    head += "HTTP/1.1 ";
+    head += std::to_string(response.status);
+    head += ' ';
+    head += statusText(response.status);
+    head += "\r\nContent-Type: ";
+    head += response.contentType;
+    head += "\r\nContent-Length: ";
+    head.append(length, static_cast<size_t>(lengthLen));
+    head += "\r\n";
+    head += response.headers;
+    if (connectionHeader) head += connectionHeader;
+    head += "\r\n";
+    return head;
+}
+
+// ============================================================================
+// HTTP REQUEST PARSING
+// ============================================================================
+
+HTTPHeaders::const_iterator HTTPHeaders::find(std::string_view name) const {
+    return std::find_if(entries.begin(), entries.end(), [name](const Entry& entry) {
+        return entry.first.size() == name.size() &&
+               std::equal(name.begin(), name.end(), entry.first.begin(), [](char a, char b) {
+                   return std::tolower(static_cast<unsigned char>(a)) ==
+                          std::tolower(static_cast<unsigned char>(b));
+               });
+    });
+}
+
+std::string_view HTTPHeaders::get(std::string_view name) const {
+    auto it = find(name);
+    return it == entries.end() ? std::string_view() : it->second;
+}
+
+bool HTTPRequest::keepAlive() const {
+    std::string value = toLower(std::string(headers.get("connection")));
+    if (version == "HTTP/1.0") {
+        return value.find("keep-alive") != std::string::npos;
+    }
+    return value.find("close") == std::string::npos;
+}
+
+std::string HTTPRequest::queryParam(const std::string& name) const {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) end = query.size();
+        size_t eq = query.find('=', pos);
+        if (eq != std::string::npos && eq < end && query.compare(pos, eq - pos, name) == 0 &&
+            eq - pos == name.size()) {
+            std::string value;
+            for (size_t i = eq + 1; i < end; i++) {
+                char c = query[i];
+                if (c == '+') {
+                    value += ' ';
+                } else if (c == '%' && i + 2 < end &&
+                           std::isxdigit(static_cast<unsigned char>(query[i + 1])) &&
+                           std::isxdigit(static_cast<unsigned char>(query[i + 2]))) {
+                    value += static_cast<char>(std::stoi(query.substr(i + 1, 2), nullptr, 16));
+                    i += 2;
+                } else {
+                    value += c;
+                }
+            }
+            return value;
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+const JsonValue& HTTPRequest::json() const {
+    if (!parsedBody) {
+        parsedBody = JsonValue::parse(body);
+    }
+    return *parsedBody;
+}
+
+HTTPRequestParser::HTTPRequestParser(size_t maxRequestBytes) : maxBytes(maxRequestBytes) {}
+
+HTTPRequestParser::Status HTTPRequestParser::fail(int status) {
+    state = State::Failed;
+    error = status;
+    return Status::Error;
+}
+
+HTTPRequestParser::Status HTTPRequestParser::feed(const char* data, size_t length, size_t& consumed) {
+    consumed = 0;
+    if (state == State::Failed) return Status::Error;
+
+    while (state != State::Done) {
+        size_t available = length - consumed;
+        const char* at = data + consumed;
+
+        switch (state) {
+        case State::Head: {
+            if (available == 0) return Status::NeedMore;
+            // Copy no more than could still fit, then cut back to the blank line
+            size_t room = maxBytes + 4 - head.size();
+            size_t take = std::min(available, room);
+            size_t before = head.size();
+            head.append(at, take);
+
+            size_t end = head.find("\r\n\r\n", scanned >= 3 ? scanned - 3 : 0);
+            if (end == std::string::npos) {
+                scanned = head.size();
+                consumed += take;
+                if (head.size() > maxBytes) return fail(431);
+                continue;
+            }
+            head.resize(end + 4);
+            consumed += head.size() - before;
+            if (!parseHead()) return Status::Error;
+            break;
+        }
+
+        case State::Body: {
+            if (available == 0) return Status::NeedMore;
+            size_t take = static_cast<size_t>(std::min<uint64_t>(available, remaining));
+            request.body.append(at, take);
+            consumed += take;
+            remaining -= take;
+            if (remaining == 0) state = State::Done;
+            break;
+        }
+
+        case State::ChunkSize: {
+            if (!readLine(data, length, consumed)) {
+                return state == State::Failed ? Status::Error : Status::NeedMore;
+            }
+            // chunk-size [; extensions]
+            size_t digits = 0;
+            uint64_t size = 0;
+            while (digits < line.size() && std::isxdigit(static_cast<unsigned char>(line[digits]))) {
+                if (digits >= 15) return fail(413);
+                char c = static_cast<char>(std::tolower(static_cast<unsigned char>(line[digits])));
+                size = size * 16 + static_cast<uint64_t>(c <= '9' ? c - '0' : c - 'a' + 10);
+                digits++;
+            }
+            if (digits == 0) return fail(400);
+            line.clear();
+            if (size == 0) {
+                state = State::Trailer;
+            } else if (request.body.size() + size > maxBytes) {
+                return fail(413);
+            } else {
+                remaining = size;
+                state = State::ChunkData;
+            }
+            break;
+        }
+
+        case State::ChunkData: {
+            if (available == 0) return Status::NeedMore;
+            size_t take = static_cast<size_t>(std::min<uint64_t>(available, remaining));
+            request.body.append(at, take);
+            consumed += take;
+            remaining -= take;
+            if (remaining == 0) state = State::ChunkEnd;
+            break;
+        }
+
+        case State::ChunkEnd:
+            if (!readLine(data, length, consumed)) {
+                return state == State::Failed ? Status::Error : Status::NeedMore;
+            }
+            if (!line.empty()) return fail(400);
+            state = State::ChunkSize;
+            break;
+
+        case State::Trailer:
+            if (!readLine(data, length, consumed)) {
+                return state == State::Failed ? Status::Error : Status::NeedMore;
+            }
+            if (line.empty()) {
+                state = State::Done;
+            } else {
+                line.clear();   // trailer fields are not used
+            }
+            break;
+
+        case State::Done:
+        case State::Failed:
+            break;
+        }
+    }
+    return Status::Complete;
+}
+
+// Accumulates one CRLF-terminated line into `line`, without the terminator
+bool HTTPRequestParser::readLine(const char* data, size_t length, size_t& consumed) {
+    constexpr size_t MAX_LINE = 4096;
+    const char* start = data + consumed;
+    const char* newline = static_cast<const char*>(std::memchr(start, '\n', length - consumed));
+    size_t take = newline ? static_cast<size_t>(newline - start) + 1 : length - consumed;
+    line.append(start, take);
+    consumed += take;
+    if (line.size() > MAX_LINE) {
+        fail(400);
+        return false;
+    }
+    if (!newline) return false;
+    line.pop_back();
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return true;
+}
+
+bool HTTPRequestParser::parseHead() {
+    auto buffer = std::make_shared<std::string>(std::move(head));
+    head.clear();
+    scanned = 0;
+    std::string_view text(*buffer);
+
+    auto trim = [](std::string_view v) {
+        while (!v.empty() && (v.front() == ' ' || v.front() == '\t')) v.remove_prefix(1);
+        while (!v.empty() && (v.back() == ' ' || v.back() == '\t' || v.back() == '\r')) v.remove_suffix(1);
+        return v;
+    };
+
+    // Request line: GET /path HTTP/1.1
+    size_t lineEnd = text.find("\r\n");
+    std::string_view requestLine = text.substr(0, lineEnd);
+    size_t methodEnd = requestLine.find(' ');
+    size_t targetEnd = methodEnd == std::string_view::npos ? methodEnd : requestLine.find(' ', methodEnd + 1);
+    if (methodEnd == 0 || targetEnd == std::string_view::npos) {
+        fail(400);
+        return false;
+    }
+    request.method = std::string(requestLine.substr(0, methodEnd));
+    std::string_view target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    request.version = std::string(trim(requestLine.substr(targetEnd + 1)));
+    if (target.empty() || request.version.compare(0, 5, "HTTP/") != 0) {
+        fail(400);
+        return false;
+    }
+    size_t queryPos = target.find('?');
+    request.path = std::string(target.substr(0, queryPos));
+    if (queryPos != std::string_view::npos) request.query = std::string(target.substr(queryPos + 1));
+
+    // Header lines up to the blank line
+    std::vector<HTTPHeaders::Entry> entries;
+    size_t pos = lineEnd + 2;
+    while (pos < text.size()) {
+        size_t end = text.find("\r\n", pos);
+        if (end == std::string_view::npos || end == pos) break;
+        std::string_view headerLine = text.substr(pos, end - pos);
+        pos = end + 2;
+        size_t colon = headerLine.find(':');
+        if (colon == std::string_view::npos) continue;
+        entries.emplace_back(trim(headerLine.substr(0, colon)), trim(headerLine.substr(colon + 1)));
+    }
+    request.headers = HTTPHeaders(std::move(buffer), std::move(entries));
+
+    std::string_view auth = request.headers.get("authorization");
+    if (auth.substr(0, 7) == "Bearer ") {
+        request.authToken = std::string(auth.substr(7));
+    }
+
+    // Body framing. Conflicting or repeated lengths are refused rather than
+    // guessed at, since a proxy in front may have guessed differently.
+    bool chunked = false;
+    bool haveLength = false;
+    uint64_t contentLength = 0;
+    for (const auto& [name, value] : request.headers) {
+        if (name.size() == 17 && toLower(std::string(name)) == "transfer-encoding") {
+            if (toLower(std::string(value)) != "chunked") {
+                fail(501);
+                return false;
+            }
+            chunked = true;
+        } else if (name.size() == 14 && toLower(std::string(name)) == "content-length") {
+            if (haveLength || value.empty() || value.size() > 15 ||
+                !std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                fail(400);
+                return false;
+            }
+            haveLength = true;
+            contentLength = std::strtoull(std::string(value).c_str(), nullptr, 10);
+        }
+    }
+    if (chunked && haveLength) {
+        fail(400);
+        return false;
+    }
+    if (contentLength > maxBytes) {
+        fail(413);
+        return false;
+    }
+
+    if (chunked) {
+        state = State::ChunkSize;
+    } else if (contentLength > 0) {
+        state = State::Body;
+        remaining = contentLength;
+        request.body.reserve(static_cast<size_t>(contentLength));
+    } else {
+        state = State::Done;
+    }
+
+    if (state != State::Done) {
+        continuePending = toLower(std::string(request.headers.get("expect"))) == "100-continue";
+    }
+    return true;
+}
+
+HTTPRequest HTTPRequestParser::take() {
+    HTTPRequest done = std::move(request);
+    request = HTTPRequest();
+    state = State::Head;
+    line.clear();
+    remaining = 0;
+    continuePending = false;
+    return done;
+}
+
+bool HTTPRequestParser::takeContinue() {
+    bool pending = continuePending;
+    continuePending = false;
+    return pending;
+}
+
+// ============================================================================
+// CONNECTION / LOOP STATE
+// ============================================================================
+
+struct HTTPServer::Connection {
+    uint64_t id = 0;
+    int fd = -1;
+    std::string in;                 // pooled; bytes before inOffset are parsed
+    size_t inOffset = 0;
+    HTTPRequestParser parser;
+    std::deque<std::string> out;    // queued head/body pieces, flushed with writev
+    size_t outOffset = 0;           // bytes of out.front() already sent
+    bool inFlight = false;          // a request is with a worker; later requests wait in `in`
+    bool closeAfterWrite = false;
+    bool peerClosed = false;
+    Clock::time_point lastActivity = Clock::now();
+    std::unique_ptr<StreamSession> stream;  // set once upgraded to a stream
+};
+
+// Hashed timer wheel with one-second ticks. Entries name a connection rather
+// than point at it, so a connection closed before its timer fires is simply
+// skipped.
+struct HTTPServer::TimerWheel {
+    enum class Kind { IdleTimeout, StreamKeepalive };
+
+    struct Entry {
+        uint64_t connectionId;
+        Kind kind;
+        uint32_t rounds;
+    };
+
+    static constexpr size_t SLOTS = 64;
+    std::vector<Entry> slots[SLOTS];
+    uint64_t tick = 0;
+
+    void schedule(uint64_t connectionId, Kind kind, int delaySeconds) {
+        uint64_t delay = static_cast<uint64_t>(std::max(1, delaySeconds));
+        slots[(tick + delay) % SLOTS].push_back(
+            Entry{connectionId, kind, static_cast<uint32_t>((delay - 1) / SLOTS)});
+    }
+
+    // Moves to the next tick and returns the entries that expire on it
+    std::vector<Entry> advance() {
+        tick++;
+        std::vector<Entry>& slot = slots[tick % SLOTS];
+        std::vector<Entry> expired;
+        size_t kept = 0;
+        for (auto& entry : slot) {
+            if (entry.rounds > 0) {
+                entry.rounds--;
+                slot[kept++] = entry;
+            } else {
+                expired.push_back(entry);
+            }
+        }
+        slot.resize(kept);
+        return expired;
+    }
+};
+
+struct HTTPServer::IOLoop {
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::thread thread;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+
+    std::mutex completionsMutex;
+    std::vector<Completion> completions;
+    std::vector<uint64_t> streamWakeups;
+
+    TimerWheel timers;
+    Clock::time_point lastTick = Clock::now();
+
+    std::vector<std::string> bufferPool;
+};
+
+// ============================================================================
+// SERVER LIFECYCLE
+// ============================================================================
+
+HTTPServer::HTTPServer(const HTTPServerConfig& cfg, HTTPHandlers h)
+    : config(cfg), handlers(std::move(h)) {
+    // Writes to a closed peer must surface as EPIPE, not kill the process
+    std::signal(SIGPIPE, SIG_IGN);
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    if (config.ioThreads <= 0) config.ioThreads = static_cast<int>(cores);
+    if (config.workerThreads <= 0) config.workerThreads = std::max(4, static_cast<int>(cores) * 2);
+
+    serverFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (serverFd < 0) {
+        throw std::runtime_error("Socket creation failed");
+    }
+
+    int opt = 1;
+    if (setsockopt(serverFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        close(serverFd);
+        throw std::runtime_error("Setsockopt failed");
+    }
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(config.port);
+
+    if (bind(serverFd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(serverFd);
+        throw std::runtime_error("Bind failed");
+    }
+
+    if (listen(serverFd, config.backlog) < 0) {
+        close(serverFd);
+        throw std::runtime_error("Listen failed");
+    }
+
+    for (int i = 0; i < config.ioThreads; i++) {
+        auto loop = std::make_unique<IOLoop>();
+        loop->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        loop->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->epollFd < 0 || loop->wakeFd < 0) {
+            throw std::runtime_error("epoll setup failed");
+        }
+
+        // Every loop watches the listen socket; EPOLLEXCLUSIVE wakes only one per connection
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.u64 = LISTEN_TAG;
+        epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, serverFd, &ev);
+
+        ev.events = EPOLLIN;
+        ev.data.u64 = WAKE_TAG;
+        epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->wakeFd, &ev);
+
+        loops.push_back(std::move(loop));
+    }
+}
+
+HTTPServer::~HTTPServer() {
+    stop();
+    for (auto& loop : loops) {
+        if (loop->thread.joinable()) loop->thread.join();
+    }
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    for (auto& loop : loops) {
+        for (auto& entry : loop->connections) {
+            close(entry.second->fd);
+        }
+        close(loop->epollFd);
+        close(loop->wakeFd);
+    }
+    if (serverFd >= 0) {
+        close(serverFd);
+    }
+}
+
+void HTTPServer::run() {
+    running = true;
+
+    for (int i = 0; i < config.workerThreads; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+    for (size_t i = 1; i < loops.size(); i++) {
+        IOLoop* loop = loops[i].get();
+        loop->thread = std::thread([this, loop]() { ioLoop(*loop); });
+    }
+
+    // The calling thread drives the first loop
+    ioLoop(*loops[0]);
+
+    for (size_t i = 1; i < loops.size(); i++) {
+        if (loops[i]->thread.joinable()) loops[i]->thread.join();
+    }
+    jobsCv.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+}
+
+void HTTPServer::stop() {
+    if (!running.exchange(false)) return;
+    for (auto& loop : loops) {
+        wake(*loop);
+    }
+    jobsCv.notify_all();
+}
+
+// ============================================================================
+// I/O LOOP
+// ============================================================================
+
+void HTTPServer::ioLoop(IOLoop& loop) {
+    struct epoll_event events[MAX_EVENTS];
+
+    while (running) {
+        auto untilTick = std::chrono::seconds(1) - (Clock::now() - loop.lastTick);
+        int timeoutMs = static_cast<int>(std::max<int64_t>(0,
+            std::chrono::duration_cast<std::chrono::milliseconds>(untilTick).count()));
+
+        int n = epoll_wait(loop.epollFd, events, MAX_EVENTS, timeoutMs);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == LISTEN_TAG) {
+                acceptConnections(loop);
+                continue;
+            }
+            if (tag == WAKE_TAG) {
+                drainCompletions(loop);
+                continue;
+            }
+
+            auto it = loop.connections.find(tag);
+            if (it == loop.connections.end()) continue;
+            Connection& conn = *it->second;
+
+            if (conn.stream) {
+                handleStreamEvent(loop, conn, events[i].events);
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(loop, tag);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                if (!flushOutput(conn)) {
+                    closeConnection(loop, tag);
+                    continue;
+                }
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                handleReadable(loop, conn);
+            }
+        }
+
+        advanceTimers(loop);
+    }
+}
+
+void HTTPServer::acceptConnections(IOLoop& loop) {
+    while (true) {
+        int fd = accept4(serverFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && running) {
+                std::cerr << "Accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto conn = std::make_unique<Connection>();
+        conn->id = nextConnectionId++;
+        conn->fd = fd;
+        conn->parser = HTTPRequestParser(config.maxRequestBytes);
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = conn->id;
+        if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        loop.timers.schedule(conn->id, TimerWheel::Kind::IdleTimeout, config.idleTimeoutSeconds);
+        loop.connections[conn->id] = std::move(conn);
+    }
+}
+
+void HTTPServer::handleReadable(IOLoop& loop, Connection& conn) {
+    uint64_t id = conn.id;
+
+    if (conn.in.capacity() == 0 && !loop.bufferPool.empty()) {
+        conn.in = std::move(loop.bufferPool.back());
+        loop.bufferPool.pop_back();
+    }
+    if (conn.inOffset > 0) {
+        conn.in.erase(0, conn.inOffset);    // only what a pipelined request left behind
+        conn.inOffset = 0;
+    }
+
+    // Edge-triggered: drain until the kernel has nothing more
+    while (true) {
+        size_t used = conn.in.size();
+        conn.in.resize(used + READ_CHUNK);
+        ssize_t n = recv(conn.fd, &conn.in[used], READ_CHUNK, 0);
+        conn.in.resize(used + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+        if (n > 0) {
+            conn.lastActivity = Clock::now();
+            if (conn.in.size() > config.maxRequestBytes * 2) {
+                closeConnection(loop, id);
+                return;
+            }
+            continue;
+        }
+        if (n == 0) {
+            conn.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        closeConnection(loop, id);
+        return;
+    }
+
+    processInput(loop, conn);
+
+    auto it = loop.connections.find(id);
+    if (it != loop.connections.end() && it->second->peerClosed &&
+        !it->second->inFlight && it->second->out.empty()) {
+        closeConnection(loop, id);
+    }
+}
+
+void HTTPServer::processInput(IOLoop& loop, Connection& conn) {
+    // One request per connection is with a worker at a time, so pipelined
+    // requests are answered in order; the rest wait here, unparsed
+    while (!conn.inFlight && !conn.closeAfterWrite && conn.inOffset < conn.in.size()) {
+        size_t consumed = 0;
+        auto status = conn.parser.feed(conn.in.data() + conn.inOffset, conn.in.size() - conn.inOffset, consumed);
+        conn.inOffset += consumed;
+
+        if (status == HTTPRequestParser::Status::Error) {
+            int code = conn.parser.errorStatus();
+            queueResponse(conn, simpleResponse(code, code == 413 || code == 431
+                ? "{\"error\":\"Request too large\"}"
+                : code == 501 ? "{\"error\":\"Unsupported transfer encoding\"}"
+                              : "{\"error\":\"Malformed request\"}"));
+            conn.closeAfterWrite = true;
+            if (!flushOutput(conn)) closeConnection(loop, conn.id);
+            return;
+        }
+        if (status == HTTPRequestParser::Status::NeedMore) {
+            if (conn.parser.takeContinue()) {
+                conn.out.push_back("HTTP/1.1 100 Continue\r\n\r\n");
+                if (!flushOutput(conn)) {
+                    closeConnection(loop, conn.id);
+                    return;
+                }
+            }
+            break;
+        }
+
+        HTTPRequest req = conn.parser.take();
+
+        // A stream is opened on a worker too: resolving it may wait on a game
+        // lock or a load. Nothing after its request is read.
+        int streamFd = handlers.isStream && handlers.isStream(req) ? conn.fd : -1;
+
+        conn.inFlight = true;
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            if (jobs.size() < config.maxQueuedRequests) {
+                jobs.push_back(Job{&loop, conn.id, std::move(req), streamFd});
+                jobsCv.notify_one();
+                if (streamFd >= 0) return;
+                continue;
+            }
+        }
+
+        // Backpressure: workers are saturated, shed the request here
+        conn.inFlight = false;
+        queueResponse(conn, simpleResponse(503, "{\"error\":\"Server busy\"}"));
+        conn.closeAfterWrite = true;
+        if (!flushOutput(conn)) closeConnection(loop, conn.id);
+        return;
+    }
+
+    if (conn.inOffset == conn.in.size()) releaseInput(loop, conn);
+}
+
+void HTTPServer::releaseInput(IOLoop& loop, Connection& conn) {
+    if (conn.in.capacity() == 0) return;
+    if (conn.in.capacity() <= POOLED_BUFFER_BYTES && loop.bufferPool.size() < MAX_POOLED_BUFFERS) {
+        conn.in.clear();
+        loop.bufferPool.push_back(std::move(conn.in));
+    }
+    conn.in = std::string();
+    conn.inOffset = 0;
+}
+
+void HTTPServer::queueResponse(Connection& conn, const HTTPResponse& response) {
+    conn.out.push_back(serializeHead(response, "Connection: close\r\n"));
+    conn.out.push_back(response.body);
+}
+
+bool HTTPServer::flushOutput(Connection& conn) {
+    constexpr size_t MAX_IOV = 16;
+    while (!conn.out.empty()) {
+        iovec iov[MAX_IOV];
+        size_t count = 0;
+        for (auto it = conn.out.begin(); it != conn.out.end() && count < MAX_IOV; ++it) {
+            size_t skip = (it == conn.out.begin()) ? conn.outOffset : 0;
+            if (it->size() == skip) continue;
+            iov[count].iov_base = const_cast<char*>(it->data() + skip);
+            iov[count].iov_len = it->size() - skip;
+            count++;
+        }
+        if (count == 0) {
+            conn.out.clear();
+            break;
+        }
+
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t n = sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (n > 0) {
+            size_t sent = static_cast<size_t>(n);
+            while (sent > 0 && !conn.out.empty()) {
+                size_t left = conn.out.front().size() - conn.outOffset;
+                if (sent < left) {
+                    conn.outOffset += sent;
+                    break;
+                }
+                sent -= left;
+                conn.out.pop_front();
+                conn.outOffset = 0;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;  // EPOLLOUT edge will bring us back
+        }
+        return false;
+    }
+
+    conn.outOffset = 0;
+    conn.lastActivity = Clock::now();
+    if (conn.closeAfterWrite) {
+        shutdown(conn.fd, SHUT_WR);
+        return false;
+    }
+    return true;
+}
+
+void HTTPServer::closeConnection(IOLoop& loop, uint64_t connectionId) {
+    auto it = loop.connections.find(connectionId);
+    if (it == loop.connections.end()) return;
+    if (it->second->stream) {
+        it->second->stream->onClose();
+    }
+    epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+    close(it->second->fd);
+    releaseInput(loop, *it->second);
+    loop.connections.erase(it);
+}
+
+// ============================================================================
+// STREAMS
+// ============================================================================
+
+void HTTPServer::openStream(IOLoop& loop, Connection& conn, std::unique_ptr<StreamSession> session) {
+    uint64_t id = conn.id;
+    if (!session) {
+        queueResponse(conn, simpleResponse(404, "{\"error\":\"Not found\"}"));
+        conn.closeAfterWrite = true;
+        if (!flushOutput(conn)) closeConnection(loop, id);
+        return;
+    }
+
+    conn.stream = std::move(session);
+    releaseInput(loop, conn);
+    loop.timers.schedule(id, TimerWheel::Kind::StreamKeepalive, config.streamKeepaliveSeconds);
+
+    if (!conn.stream->onWritable(conn.fd)) {
+        closeConnection(loop, id);
+    }
+}
+
+void HTTPServer::handleStreamEvent(IOLoop& loop, Connection& conn, uint32_t events) {
+    uint64_t id = conn.id;
+
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        closeConnection(loop, id);
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+        // Stream clients don't send anything after the request; we only watch for EOF
+        char buffer[1024];
+        while (true) {
+            ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) continue;
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            closeConnection(loop, id);
+            return;
+        }
+    }
+    if (events & EPOLLOUT) {
+        if (!conn.stream->onWritable(conn.fd)) {
+            closeConnection(loop, id);
+        }
+    }
+}
+
+void HTTPServer::postStreamWakeup(IOLoop& loop, uint64_t connectionId) {
+    {
+        std::lock_guard<std::mutex> lock(loop.completionsMutex);
+        loop.streamWakeups.push_back(connectionId);
+    }
+    wake(loop);
+}
+
+// ============================================================================
+// TIMERS
+// ============================================================================
+
+void HTTPServer::advanceTimers(IOLoop& loop) {
+    auto now = Clock::now();
+    auto idleLimit = std::chrono::seconds(config.idleTimeoutSeconds);
+
+    while (now - loop.lastTick >= std::chrono::seconds(1)) {
+        loop.lastTick += std::chrono::seconds(1);
+
+        for (const auto& entry : loop.timers.advance()) {
+            auto it = loop.connections.find(entry.connectionId);
+            if (it == loop.connections.end()) continue;
+            Connection& conn = *it->second;
+
+            if (entry.kind == TimerWheel::Kind::StreamKeepalive) {
+                if (!conn.stream->onKeepalive(conn.fd)) {
+                    closeConnection(loop, entry.connectionId);
+                    continue;
+                }
+                loop.timers.schedule(entry.connectionId, entry.kind, config.streamKeepaliveSeconds);
+                continue;
+            }
+
+            // Idle timeout: streams have their own keepalive and never idle out
+            if (conn.stream) continue;
+            auto idleFor = now - conn.lastActivity;
+            if (!conn.inFlight && conn.out.empty() && idleFor >= idleLimit) {
+                closeConnection(loop, entry.connectionId);
+                continue;
+            }
+            int remaining = static_cast<int>(
+                std::chrono::duration_cast<std::chrono::seconds>(idleLimit - idleFor).count());
+            loop.timers.schedule(entry.connectionId, entry.kind, remaining);
+        }
+    }
+}
+
+// ============================================================================
+// WORKER POOL
+// ============================================================================
+
+void HTTPServer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsCv.wait(lock, [this]() { return !jobs.empty() || !running; });
+            if (!running) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        if (job.streamFd >= 0) {
+            postCompletion(*job.loop, openStreamJob(job));
+            continue;
+        }
+
+        Completion completion;
+        completion.connectionId = job.connectionId;
+        completion.keepAlive = job.request.keepAlive();
+        HTTPResponse response;
+        try {
+            response = handlers.route(job.request);
+        } catch (const std::exception& e) {
+            std::cerr << "Handler error: " << e.what() << std::endl;
+            response = simpleResponse(500, "{\"error\":\"Internal server error\"}");
+            completion.keepAlive = false;
+        }
+
+        const char* connectionHeader = nullptr;
+        if (!completion.keepAlive) {
+            connectionHeader = "Connection: close\r\n";
+        } else if (job.request.version == "HTTP/1.0") {
+            connectionHeader = "Connection: keep-alive\r\n";
+        }
+        completion.head = serializeHead(response, connectionHeader);
+        completion.body = std::move(response.body);
+
+        postCompletion(*job.loop, std::move(completion));
+    }
+}
+
+HTTPServer::Completion HTTPServer::openStreamJob(Job& job) {
+    Completion completion;
+    completion.connectionId = job.connectionId;
+    completion.keepAlive = false;
+    completion.opensStream = true;
+
+    IOLoop* owner = job.loop;
+    uint64_t id = job.connectionId;
+    StreamWaker waker = [this, owner, id]() { postStreamWakeup(*owner, id); };
+    try {
+        if (handlers.stream) {
+            completion.stream = handlers.stream(job.request, job.streamFd, std::move(waker));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Stream handler error: " << e.what() << std::endl;
+    }
+    return completion;
+}
+
+void HTTPServer::postCompletion(IOLoop& loop, Completion completion) {
+    {
+        std::lock_guard<std::mutex> lock(loop.completionsMutex);
+        loop.completions.push_back(std::move(completion));
+    }
+    wake(loop);
+}
+
+void HTTPServer::wake(IOLoop& loop) {
+    uint64_t one = 1;
+    ssize_t ignored = write(loop.wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void HTTPServer::drainCompletions(IOLoop& loop) {
+    uint64_t counter;
+    while (read(loop.wakeFd, &counter, sizeof(counter)) > 0) {}
+
+    std::vector<Completion> ready;
+    std::vector<uint64_t> streamWakeups;
+    {
+        std::lock_guard<std::mutex> lock(loop.completionsMutex);
+        ready.swap(loop.completions);
+        streamWakeups.swap(loop.streamWakeups);
+    }
+
+    for (uint64_t id : streamWakeups) {
+        auto it = loop.connections.find(id);
+        if (it == loop.connections.end() || !it->second->stream) continue;
+        if (!it->second->stream->onWritable(it->second->fd)) {
+            closeConnection(loop, id);
+        }
+    }
+
+    for (auto& completion : ready) {
+        auto it = loop.connections.find(completion.connectionId);
+        if (it == loop.connections.end()) {
+            // Peer went away while the worker ran; a session it opened never ran
+            if (completion.stream) completion.stream->onClose();
+            continue;
+        }
+        Connection& conn = *it->second;
+
+        conn.inFlight = false;
+        if (completion.opensStream) {
+            openStream(loop, conn, std::move(completion.stream));
+            auto again = loop.connections.find(completion.connectionId);
+            if (again != loop.connections.end() && again->second->peerClosed) {
+                closeConnection(loop, completion.connectionId);
+            }
+            continue;
+        }
+        conn.out.push_back(std::move(completion.head));
+        if (!completion.body.empty()) conn.out.push_back(std::move(completion.body));
+        if (!completion.keepAlive) {
+            conn.closeAfterWrite = true;
+        }
+        if (!flushOutput(conn)) {
+            closeConnection(loop, completion.connectionId);
+            continue;
+        }
+
+        // Pipelined requests may already be buffered
+        processInput(loop, conn);
+
+        auto again = loop.connections.find(completion.connectionId);
+        if (again != loop.connections.end() && again->second->peerClosed &&
+            !again->second->inFlight && again->second->out.empty()) {
+            closeConnection(loop, completion.connectionId);
+        }
+    }
+}
+
+}  // namespace catan
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include "json_reader.h"
+
+namespace catan {
+
+// ============================================================================
+// HTTP HEADERS
+// Name/value views into the request head, which the headers share ownership
+// of, so parsing a request copies the head once rather than once per header.
+// Names keep the case the client sent and are matched case-insensitively.
+// ============================================================================
+
+class HTTPHeaders {
+public:
+    using Entry = std::pair<std::string_view, std::string_view>;
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+    HTTPHeaders() = default;
+    HTTPHeaders(std::shared_ptr<const std::string> head, std::vector<Entry> entries)
+        : head(std::move(head)), entries(std::move(entries)) {}
+
+    // First header with this name, or end()
+    const_iterator find(std::string_view name) const;
+
+    // Value of the first header with this name, or "" if absent
+    std::string_view get(std::string_view name) const;
+
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+private:
+    std::shared_ptr<const std::string> head;
+    std::vector<Entry> entries;
+};
+
+// ============================================================================
+// HTTP REQUEST
+// ============================================================================
+
+struct HTTPRequest {
+    std::string method;
+    std::string path;       // without the query string
+    std::string query;      // after '?', undecoded
+    std::string version;    // "HTTP/1.1", "HTTP/1.0"
+    HTTPHeaders headers;
+    std::string body;       // de-chunked if it arrived chunked
+
+    // Parsed from Authorization header
+    std::string authToken;
+
+    // Whether the connection should stay open after the response
+    bool keepAlive() const;
+
+    // Percent-decoded query parameter, or "" if absent
+    std::string queryParam(const std::string& name) const;
+
+    // Body parsed as JSON on first use (null if empty or malformed)
+    const JsonValue& json() const;
+
+private:
+    mutable std::optional<JsonValue> parsedBody;
+};
+
+// ============================================================================
+// HTTP REQUEST PARSER
+// Incremental HTTP/1.1 request framing. Bytes are fed as they arrive, in any
+// split; feed() stops at the end of a request so the bytes of a pipelined
+// request behind it stay with the caller. Bodies are framed by
+// Content-Length or chunked transfer coding (chunk extensions and trailers
+// are read and dropped).
+// ============================================================================
+
+class HTTPRequestParser {
+public:
+    enum class Status { NeedMore, Complete, Error };
+
+    explicit HTTPRequestParser(size_t maxRequestBytes = 1 << 20);
+
+    // Consumes from data up to the end of the current request and sets
+    // consumed to the bytes used. After Complete, take() the request before
+    // feeding more; after Error the parser is done and errorStatus() names
+    // the response to send.
+    Status feed(const char* data, size_t length, size_t& consumed);
+
+    // The completed request; resets the parser for the next one
+    HTTPRequest take();
+
+    int errorStatus() const { return error; }
+
+    // True once per request when the client sent "Expect: 100-continue" and
+    // is waiting to be told to send the body
+    bool takeContinue();
+
+private:
+    enum class State { Head, Body, ChunkSize, ChunkData, ChunkEnd, Trailer, Done, Failed };
+
+    size_t maxBytes;
+    State state = State::Head;
+    std::string head;           // request line and headers so far
+    size_t scanned = 0;         // head bytes already searched for the blank line
+    std::string line;           // partial chunk-size or trailer line
+    uint64_t remaining = 0;     // body or chunk bytes still to come
+    bool continuePending = false;
+    int error = 0;
+    HTTPRequest request;
+
+    Status fail(int status);
+    bool parseHead();
+    bool readLine(const char* data, size_t length, size_t& consumed);
+};
+
+// ============================================================================
+// HTTP RESPONSE
+// Head and body stay separate all the way to the socket: the I/O loop sends
+// them with one writev, so a handler's body is never copied into a combined
+// buffer.
+// ============================================================================
+
+struct HTTPResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string headers;        // extra header lines, each ending in "\r\n"
+    std::string body;
+};
+
+// Reason phrase for a status code ("OK", "Not Found", ...)
+const char* statusText(int status);
+
+// Status line and headers through the blank line. connectionHeader is a
+// complete header line or nullptr.
+std::string serializeHead(const HTTPResponse& response, const char* connectionHeader);
+
+// ============================================================================
+// SERVER CONFIGURATION
+// ============================================================================
+
+struct HTTPServerConfig {
+    int port = 8080;
+    int backlog = 1024;                 // listen() backlog
+    int ioThreads = 0;                  // 0 = one per core
+    int workerThreads = 0;              // 0 = two per core (minimum 4)
+    size_t maxQueuedRequests = 4096;    // requests waiting for a worker before we answer 503
+    size_t maxRequestBytes = 1 << 20;   // headers + body
+    int idleTimeoutSeconds = 60;        // keep-alive connections idle longer than this are closed
+    int streamKeepaliveSeconds = 15;    // keepalive period for long-lived streams
+};
+
+// ============================================================================
+// STREAM SESSION
+// A connection upgraded to a long-lived response (SSE). The session stays on
+// the I/O loop that accepted it; every callback runs on that loop's thread
+// and must not block.
+// ============================================================================
+
+class StreamSession {
+public:
+    virtual ~StreamSession() = default;
+
+    // Socket is writable or the session was woken. Return false to close.
+    virtual bool onWritable(int socket) = 0;
+
+    // Timer wheel tick every streamKeepaliveSeconds. Return false to close.
+    virtual bool onKeepalive(int socket) = 0;
+
+    // Connection is going away (peer closed, error, or a callback returned false)
+    virtual void onClose() = 0;
+};
+
+// Asks the owning I/O loop to call onWritable soon. Safe from any thread.
+using StreamWaker = std::function<void()>;
+
+// Request handlers supplied by the application
+struct HTTPHandlers {
+    // Produces the response for a request. Runs on a worker thread.
+    std::function<HTTPResponse(const HTTPRequest&)> route;
+
+    // Returns true if the request opens a long-lived stream (SSE)
+    std::function<bool(const HTTPRequest&)> isStream;
+
+    // Opens a stream session on a non-blocking socket. Runs on a worker
+    // thread, like route, so it may wait on locks or load state. The session
+    // is attached to the connection's I/O loop once it returns, and its
+    // first onWritable flushes what it queued meanwhile; wakeups before then
+    // are dropped. Returning nullptr answers 404.
+    std::function<std::unique_ptr<StreamSession>(const HTTPRequest&, int socket, StreamWaker)> stream;
+};
+
+// ============================================================================
+// HTTP SERVER
+// Non-blocking epoll reactor: one I/O loop per core accepts connections and
+// frames requests, a bounded worker pool runs the handlers. Connections are
+// kept alive between requests and may pipeline them; when the worker queue
+// is full new requests are answered with 503 straight from the I/O loop.
+// Streams stay registered with their loop and are flushed when writable;
+// idle timeouts and stream keepalives run off a per-loop timer wheel.
+// ============================================================================
+
+class HTTPServer {
+public:
+    HTTPServer(const HTTPServerConfig& config, HTTPHandlers handlers);
+    ~HTTPServer();
+
+    // Blocks until stop() is called
+    void run();
+    void stop();
+
+    int ioThreadCount() const { return config.ioThreads; }
+    int workerThreadCount() const { return config.workerThreads; }
+
+private:
+    struct Connection;
+    struct IOLoop;
+    struct TimerWheel;
+
+    struct Job {
+        IOLoop* loop;
+        uint64_t connectionId;
+        HTTPRequest request;
+        int streamFd = -1;              // set for a request that opens a stream
+    };
+
+    struct Completion {
+        uint64_t connectionId;
+        std::string head;
+        std::string body;
+        bool keepAlive;
+        bool opensStream = false;       // stream is the session (null answers 404)
+        std::unique_ptr<StreamSession> stream;
+    };
+
+    HTTPServerConfig config;
+    HTTPHandlers handlers;
+    int serverFd = -1;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> nextConnectionId{2};  // 0 and 1 tag the listen and wake fds
+
+    std::vector<std::unique_ptr<IOLoop>> loops;
+
+    // Worker pool
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsCv;
+
+    void ioLoop(IOLoop& loop);
+    void workerLoop();
+    Completion openStreamJob(Job& job);
+
+    // I/O loop helpers (only called on the loop's own thread)
+    void acceptConnections(IOLoop& loop);
+    void handleReadable(IOLoop& loop, Connection& conn);
+    void processInput(IOLoop& loop, Connection& conn);
+    void releaseInput(IOLoop& loop, Connection& conn);     // returns the input buffer to the pool
+    bool flushOutput(Connection& conn);
+    void queueResponse(Connection& conn, const HTTPResponse& response);  // loop-generated, Connection: close
+    void closeConnection(IOLoop& loop, uint64_t connectionId);
+    void openStream(IOLoop& loop, Connection& conn, std::unique_ptr<StreamSession> session);
+    void handleStreamEvent(IOLoop& loop, Connection& conn, uint32_t events);
+    void drainCompletions(IOLoop& loop);
+    void advanceTimers(IOLoop& loop);
+
+    // Worker / broadcaster -> I/O loop handoff
+    void postCompletion(IOLoop& loop, Completion completion);
+    void postStreamWakeup(IOLoop& loop, uint64_t connectionId);
+    static void wake(IOLoop& loop);
+};
+
+}  // namespace catan
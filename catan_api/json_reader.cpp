@@ -0,0 +1,359 @@
+#include "json_reader.h"
+#include "json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace catan {
+
+// ============================================================================
+// PARSER
+// ============================================================================
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : p(text.data()), begin(text.data()), end(text.data() + text.size()) {}
+
+    bool parseDocument(JsonValue& out) {
+        skipWhitespace();
+        if (!parseValue(out, 0)) return false;
+        skipWhitespace();
+        if (p != end) return fail("trailing characters");
+        return true;
+    }
+
+    std::string error() const {
+        return failure + " at offset " + std::to_string(failedAt - begin);
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 128;
+
+    const char* p;
+    const char* begin;
+    const char* end;
+    std::string failure;
+    const char* failedAt = nullptr;
+
+    bool fail(const char* message) {
+        if (failure.empty()) {
+            failure = message;
+            failedAt = p;
+        }
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    bool literal(const char* word, size_t length) {
+        if (static_cast<size_t>(end - p) < length || std::string_view(p, length) != std::string_view(word, length)) {
+            return fail("invalid literal");
+        }
+        p += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& out, int depth) {
+        if (p >= end) return fail("unexpected end of input");
+        switch (*p) {
+            case '{': return parseObject(out, depth);
+            case '[': return parseArray(out, depth);
+            case '"':
+                out.kind = JsonValue::Type::String;
+                return parseString(out.text);
+            case 't':
+                out.kind = JsonValue::Type::Bool;
+                out.boolean = true;
+                return literal("true", 4);
+            case 'f':
+                out.kind = JsonValue::Type::Bool;
+                out.boolean = false;
+                return literal("false", 5);
+            case 'n':
+                out.kind = JsonValue::Type::Null;
+                return literal("null", 4);
+            default:
+                return parseNumber(out);
+        }
+    }
+
+    bool parseObject(JsonValue& out, int depth) {
+        if (depth >= MAX_DEPTH) return fail("nesting too deep");
+        out.kind = JsonValue::Type::Object;
+        p++;  // '{'
+        skipWhitespace();
+        if (p < end && *p == '}') {
+            p++;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            if (p >= end || *p != '"') return fail("expected member name");
+            out.fields.emplace_back();
+            JsonValue::Member& member = out.fields.back();
+            if (!parseString(member.first)) return false;
+            skipWhitespace();
+            if (p >= end || *p != ':') return fail("expected ':'");
+            p++;
+            skipWhitespace();
+            if (!parseValue(member.second, depth + 1)) return false;
+            skipWhitespace();
+            if (p < end && *p == ',') {
+                p++;
+                continue;
+            }
+            if (p < end && *p == '}') {
+                p++;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool parseArray(JsonValue& out, int depth) {
+        if (depth >= MAX_DEPTH) return fail("nesting too deep");
+        out.kind = JsonValue::Type::Array;
+        p++;  // '['
+        skipWhitespace();
+        if (p < end && *p == ']') {
+            p++;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            out.elements.emplace_back();
+            if (!parseValue(out.elements.back(), depth + 1)) return false;
+            skipWhitespace();
+            if (p < end && *p == ',') {
+                p++;
+                continue;
+            }
+            if (p < end && *p == ']') {
+                p++;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool parseNumber(JsonValue& out) {
+        const char* start = p;
+        if (p < end && *p == '-') p++;
+        if (p >= end || !(*p >= '0' && *p <= '9')) {
+            p = start;
+            return fail("unexpected character");
+        }
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' ||
+                           *p == '+' || *p == '-')) {
+            p++;
+        }
+        double value = 0;
+        auto result = std::from_chars(start, p, value);
+        if (result.ec != std::errc() || result.ptr != p) {
+            p = start;
+            return fail("invalid number");
+        }
+        out.kind = JsonValue::Type::Number;
+        out.number = value;
+        return true;
+    }
+
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool parseHex4(uint32_t& code) {
+        if (end - p < 4) return fail("truncated \\u escape");
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            int digit = hexDigit(p[i]);
+            if (digit < 0) return fail("invalid \\u escape");
+            code = (code << 4) | static_cast<uint32_t>(digit);
+        }
+        p += 4;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parseString(std::string& out) {
+        p++;  // opening quote
+        while (true) {
+            // Copy the run up to the next quote or backslash in one go
+            const char* run = p;
+            while (p < end && *p != '"' && *p != '\\') p++;
+            out.append(run, static_cast<size_t>(p - run));
+            if (p >= end) return fail("unterminated string");
+            if (*p == '"') {
+                p++;
+                return true;
+            }
+
+            p++;  // backslash
+            if (p >= end) return fail("unterminated string");
+            char c = *p++;
+            switch (c) {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (!parseHex4(code)) return false;
+                    // Surrogate pair
+                    if (code >= 0xD800 && code <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        p += 2;
+                        uint32_t low;
+                        if (!parseHex4(low)) return false;
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            appendUtf8(out, 0xFFFD);
+                            code = low;
+                        }
+                    } else if (code >= 0xD800 && code <= 0xDFFF) {
+                        code = 0xFFFD;  // lone surrogate
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+    }
+};
+
+JsonValue JsonValue::parse(std::string_view text, std::string* error) {
+    JsonParser parser(text);
+    JsonValue value;
+    if (!parser.parseDocument(value)) {
+        if (error) *error = parser.error();
+        return JsonValue();
+    }
+    if (error) error->clear();
+    return value;
+}
+
+// ============================================================================
+// ACCESSORS
+// ============================================================================
+
+static const JsonValue& nullValue() {
+    static const JsonValue value;
+    return value;
+}
+
+int JsonValue::asInt(int defaultValue) const {
+    if (kind != Type::Number || !std::isfinite(number)) return defaultValue;
+    if (number < std::numeric_limits<int>::min() || number > std::numeric_limits<int>::max()) {
+        return defaultValue;
+    }
+    return static_cast<int>(number);
+}
+
+int64_t JsonValue::asInt64(int64_t defaultValue) const {
+    if (kind != Type::Number || !std::isfinite(number)) return defaultValue;
+    if (number < -9.2e18 || number > 9.2e18) return defaultValue;
+    return static_cast<int64_t>(number);
+}
+
+const std::string& JsonValue::asString() const {
+    static const std::string empty;
+    return kind == Type::String ? text : empty;
+}
+
+const JsonValue* JsonValue::find(std::string_view key) const {
+    if (kind != Type::Object) return nullptr;
+    for (const auto& member : fields) {
+        if (member.first == key) return &member.second;
+    }
+    return nullptr;
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const {
+    const JsonValue* value = find(key);
+    return value ? *value : nullValue();
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    if (kind != Type::Array || index >= elements.size()) return nullValue();
+    return elements[index];
+}
+
+size_t JsonValue::size() const {
+    if (kind == Type::Array) return elements.size();
+    if (kind == Type::Object) return fields.size();
+    return 0;
+}
+
+std::string JsonValue::getString(std::string_view key, const std::string& defaultValue) const {
+    const JsonValue* value = find(key);
+    return (value && value->kind == Type::String) ? value->text : defaultValue;
+}
+
+// ============================================================================
+// SERIALIZATION
+// ============================================================================
+
+void JsonValue::write(JsonWriter& json) const {
+    switch (kind) {
+        case Type::Null: json.null(); break;
+        case Type::Bool: json.value(boolean); break;
+        case Type::Number:
+            // Integral values print without a fraction
+            if (std::floor(number) == number && std::fabs(number) < 9.0e15) {
+                json.value(static_cast<int64_t>(number));
+            } else {
+                json.value(number);
+            }
+            break;
+        case Type::String: json.value(text); break;
+        case Type::Array:
+            json.beginArray();
+            for (const auto& element : elements) element.write(json);
+            json.endArray();
+            break;
+        case Type::Object:
+            json.beginObject();
+            for (const auto& member : fields) {
+                json.key(member.first);
+                member.second.write(json);
+            }
+            json.endObject();
+            break;
+    }
+}
+
+std::string JsonValue::toJson() const {
+    JsonWriter json(256);
+    write(json);
+    return json.take();
+}
+
+}  // namespace catan
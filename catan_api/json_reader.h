@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace catan {
+
+class JsonWriter;
+
+// ============================================================================
+// JSON READER
+// Single-pass recursive-descent parser producing a small DOM. Every request
+// body and provider response is parsed once; handlers then look fields up
+// in the tree instead of rescanning the text per field. Lookups never
+// throw: a missing key, wrong type or malformed document reads as null and
+// the typed getters fall back to their default.
+// ============================================================================
+
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    using Member = std::pair<std::string, JsonValue>;
+
+    JsonValue() = default;
+
+    // Parses a complete document. On malformed input returns null and, if
+    // error is given, a short description with the byte offset.
+    static JsonValue parse(std::string_view text, std::string* error = nullptr);
+
+    Type type() const { return kind; }
+    bool isNull() const { return kind == Type::Null; }
+    bool isBool() const { return kind == Type::Bool; }
+    bool isNumber() const { return kind == Type::Number; }
+    bool isString() const { return kind == Type::String; }
+    bool isArray() const { return kind == Type::Array; }
+    bool isObject() const { return kind == Type::Object; }
+
+    bool asBool(bool defaultValue = false) const { return kind == Type::Bool ? boolean : defaultValue; }
+    double asDouble(double defaultValue = 0) const { return kind == Type::Number ? number : defaultValue; }
+    int asInt(int defaultValue = 0) const;
+    int64_t asInt64(int64_t defaultValue = 0) const;
+    const std::string& asString() const;    // empty unless a string
+
+    // Object member / array element; missing entries read as null
+    const JsonValue& operator[](std::string_view key) const;
+    const JsonValue& operator[](size_t index) const;
+    const JsonValue* find(std::string_view key) const;
+    bool has(std::string_view key) const { return find(key) != nullptr; }
+
+    size_t size() const;
+    const std::vector<JsonValue>& items() const { return elements; }
+    const std::vector<Member>& members() const { return fields; }
+
+    // Typed member lookups with defaults
+    int getInt(std::string_view key, int defaultValue = 0) const { return (*this)[key].asInt(defaultValue); }
+    double getDouble(std::string_view key, double defaultValue = 0) const { return (*this)[key].asDouble(defaultValue); }
+    bool getBool(std::string_view key, bool defaultValue = false) const { return (*this)[key].asBool(defaultValue); }
+    std::string getString(std::string_view key, const std::string& defaultValue = "") const;
+
+    // Serialize back to compact JSON
+    void write(JsonWriter& json) const;
+    std::string toJson() const;
+
+private:
+    friend class JsonParser;
+
+    Type kind = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string text;
+    std::vector<JsonValue> elements;
+    std::vector<Member> fields;
+};
+
+}  // namespace catan
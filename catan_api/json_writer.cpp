@@ -0,0 +1,197 @@
+#include "json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace catan {
+
+// ============================================================================
+// STRING ESCAPING
+// ============================================================================
+
+namespace {
+
+// Bytes that need escaping: control characters, '"' and '\'
+inline bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+// Length of the prefix of s that can be copied without escaping
+size_t plainPrefix(const char* s, size_t n) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        // Unsigned c < 0x20  <=>  max(c, 0x20) != c
+        __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, space), chunk);
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                       _mm_cmpeq_epi8(chunk, backslash));
+        int mask = _mm_movemask_epi8(special) | (~_mm_movemask_epi8(control) & 0xFFFF);
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+#endif
+    while (i < n && !needsEscape(static_cast<unsigned char>(s[i]))) i++;
+    return i;
+}
+
+}  // namespace
+
+void appendJsonEscaped(std::string& out, std::string_view s) {
+    static const char HEX[] = "0123456789abcdef";
+    const char* data = s.data();
+    size_t n = s.size();
+    size_t i = 0;
+
+    while (i < n) {
+        size_t run = plainPrefix(data + i, n - i);
+        out.append(data + i, run);
+        i += run;
+        if (i >= n) break;
+
+        unsigned char c = static_cast<unsigned char>(data[i++]);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                out.append(u, sizeof(u));
+            }
+        }
+    }
+}
+
+std::string escapeJson(std::string_view s) {
+    std::string out;
+    out.reserve(s.size() + 8);
+    appendJsonEscaped(out, s);
+    return out;
+}
+
+// ============================================================================
+// JSON WRITER
+// ============================================================================
+
+JsonWriter::JsonWriter(size_t capacity) : out(&owned) {
+    owned.reserve(capacity);
+}
+
+JsonWriter::JsonWriter(std::string& buffer) : out(&buffer) {}
+
+std::string& JsonWriter::threadBuffer() {
+    static thread_local std::string buffer = []() {
+        std::string s;
+        s.reserve(64 * 1024);
+        return s;
+    }();
+    buffer.clear();
+    return buffer;
+}
+
+std::string JsonWriter::take() {
+    return std::move(owned);
+}
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (depth == 0) return;
+    uint64_t bit = uint64_t(1) << (depth - 1);
+    if (hasItems & bit) *out += ',';
+    hasItems |= bit;
+}
+
+void JsonWriter::open(char c) {
+    separate();
+    *out += c;
+    if (depth < MAX_DEPTH) {
+        depth++;
+        hasItems &= ~(uint64_t(1) << (depth - 1));
+    }
+}
+
+void JsonWriter::close(char c) {
+    *out += c;
+    if (depth > 0) depth--;
+}
+
+JsonWriter& JsonWriter::beginObject() { open('{'); return *this; }
+JsonWriter& JsonWriter::endObject() { close('}'); return *this; }
+JsonWriter& JsonWriter::beginArray() { open('['); return *this; }
+JsonWriter& JsonWriter::endArray() { close(']'); return *this; }
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    *out += '"';
+    appendJsonEscaped(*out, name);
+    out->append("\":", 2);
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view s) {
+    separate();
+    *out += '"';
+    appendJsonEscaped(*out, s);
+    *out += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    separate();
+    if (b) out->append("true", 4);
+    else out->append("false", 5);
+    return *this;
+}
+
+JsonWriter& JsonWriter::writeInt(int64_t n) {
+    separate();
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), n);
+    out->append(buf, static_cast<size_t>(result.ptr - buf));
+    return *this;
+}
+
+JsonWriter& JsonWriter::writeUint(uint64_t n) {
+    separate();
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), n);
+    out->append(buf, static_cast<size_t>(result.ptr - buf));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double d) {
+    if (!std::isfinite(d)) return null();  // JSON has no NaN/Infinity
+    separate();
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), d);
+    out->append(buf, static_cast<size_t>(result.ptr - buf));
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out->append("null", 4);
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    out->append(json.data(), json.size());
+    return *this;
+}
+
+}  // namespace catan
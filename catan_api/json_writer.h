@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <type_traits>
+
+namespace catan {
+
+// ============================================================================
+// JSON WRITER
+// Streaming writer that appends straight into a string buffer: numbers go
+// through std::to_chars (no locale, no temporaries) and strings through
+// appendJsonEscaped. Commas between members and elements are inserted
+// automatically, so callers only describe structure:
+//
+//     JsonWriter json;
+//     json.beginObject();
+//     json.key("gameId").value(id);
+//     json.key("players").beginArray();
+//     ...
+//     json.endArray();
+//     json.endObject();
+//     return jsonResponse(200, json.take());
+// ============================================================================
+
+// Append s to out as the inside of a JSON string literal (no quotes)
+void appendJsonEscaped(std::string& out, std::string_view s);
+
+// Convenience wrapper for call sites that still build JSON by hand
+std::string escapeJson(std::string_view s);
+
+class JsonWriter {
+public:
+    // Owns its buffer, reserved to `capacity` bytes
+    explicit JsonWriter(size_t capacity = 1024);
+
+    // Appends to a caller-owned buffer (e.g. threadBuffer())
+    explicit JsonWriter(std::string& out);
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    // Member name inside an object; the next call writes its value
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view s);
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b);
+    JsonWriter& value(double d);
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    JsonWriter& value(T n) {
+        if (std::is_signed<T>::value) return writeInt(static_cast<int64_t>(n));
+        return writeUint(static_cast<uint64_t>(n));
+    }
+
+    JsonWriter& null();
+
+    // Pre-serialized JSON value (object, array, number...) written verbatim
+    JsonWriter& raw(std::string_view json);
+
+    const std::string& str() const { return *out; }
+    size_t size() const { return out->size(); }
+
+    // Moves the buffer out; only valid for a writer that owns its buffer
+    std::string take();
+
+    // Per-thread scratch buffer, cleared, with its capacity kept between
+    // uses. For JSON consumed on the same thread (e.g. an outgoing LLM
+    // request body); anything that outlives the call should use take().
+    static std::string& threadBuffer();
+
+private:
+    static constexpr int MAX_DEPTH = 64;
+
+    std::string owned;
+    std::string* out;
+
+    // Bit d set = the container at depth d already has a member/element
+    uint64_t hasItems = 0;
+    int depth = 0;
+    bool afterKey = false;
+
+    JsonWriter& writeInt(int64_t n);
+    JsonWriter& writeUint(uint64_t n);
+    void separate();
+    void open(char c);
+    void close(char c);
+};
+
+}  // namespace catan
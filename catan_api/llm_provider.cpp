@@ -1,76 +1,21 @@
 #include "llm_provider.h"
+#include "heuristic_policy.h"
+#include "http_client.h"
+#include "json_reader.h"
+#include "json_writer.h"
+#include "metrics.h"
 #include <sstream>
 #include <fstream>
 #include <cstdlib>
 #include <stdexcept>
 #include <cstring>
+#include <cstdio>
 #include <array>
 #include <memory>
-#include <unistd.h>
-#include <sys/wait.h>
 
 namespace catan {
 namespace ai {
 
-// ============================================================================
-// HTTPS CLIENT (using curl subprocess)
-// ============================================================================
-
-class CurlHTTPS {
-public:
-    static std::string post(
-        const std::string& url,
-        const std::string& body,
-        const std::vector<std::pair<std::string, std::string>>& headers
-    ) {
-        // Create temp file for request body
-        char bodyFile[] = "/tmp/llm_request_XXXXXX";
-        int bodyFd = mkstemp(bodyFile);
-        if (bodyFd < 0) {
-            throw std::runtime_error("Failed to create temp file for request body");
-        }
-        write(bodyFd, body.c_str(), body.length());
-        close(bodyFd);
-        
-        // Create temp file for response
-        char responseFile[] = "/tmp/llm_response_XXXXXX";
-        int responseFd = mkstemp(responseFile);
-        close(responseFd);
-        
-        // Build curl command
-        std::ostringstream cmd;
-        cmd << "curl -s -X POST ";
-        cmd << "\"" << url << "\" ";
-        cmd << "-d @" << bodyFile << " ";
-        for (const auto& header : headers) {
-            cmd << "-H \"" << header.first << ": " << header.second << "\" ";
-        }
-        cmd << "-o " << responseFile << " 2>/dev/null";
-        
-        // Execute curl
-        int result = system(cmd.str().c_str());
-        
-        // Read response
-        std::string response;
-        std::ifstream responseStream(responseFile);
-        if (responseStream) {
-            std::ostringstream ss;
-            ss << responseStream.rdbuf();
-            response = ss.str();
-        }
-        
-        // Cleanup temp files
-        unlink(bodyFile);
-        unlink(responseFile);
-        
-        if (result != 0) {
-            throw std::runtime_error("curl command failed with code " + std::to_string(result));
-        }
-        
-        return response;
-    }
-};
-
 // ============================================================================
 // HTTP LLM PROVIDER BASE
 // ============================================================================
@@ -80,7 +25,31 @@ std::string HTTPLLMProvider::httpPost(
     const std::string& body,
     const std::vector<std::pair<std::string, std::string>>& headers
 ) {
-    return CurlHTTPS::post(url, body, headers);
+    // Looked up per call: a provider call takes far longer than the lookup
+    const std::string labels = metricLabels({{"provider", getName()}});
+    MetricsRegistry& registry = metrics();
+    Histogram& latency = registry.histogram("catan_llm_request_seconds", "LLM API call latency", labels);
+    Counter& errors = registry.counter("catan_llm_errors_total", "Failed LLM API calls", labels);
+    registry.counter("catan_llm_sent_bytes_total", "Request bytes sent to LLM APIs", labels).add(body.size());
+    
+    // Pooled keep-alive connections shared by every provider instance
+    HTTPClientOptions options;
+    options.connectTimeoutMs = config.connectTimeoutMs;
+    options.requestTimeoutMs = config.requestTimeoutMs;
+    HTTPClientResponse response;
+    {
+        ScopedTimer timer(latency);
+        try {
+            response = HTTPClient::shared().post(url, body, headers, options);
+        } catch (...) {
+            errors.add();
+            throw;
+        }
+    }
+    registry.counter("catan_llm_received_bytes_total", "Response bytes received from LLM APIs", labels)
+        .add(response.body.size());
+    if (response.status >= 400) errors.add();
+    return response.body;
 }
 
 // ============================================================================
@@ -158,6 +127,11 @@ LLMResponse MockLLMProvider::chat(
     response.toolCall = toolCall;
     response.textContent = "Mock AI decided to use " + toolCall.toolName;
     
+    // What a real request would have carried, for the per-turn stats
+    response.requestBytes = systemPrompt.size();
+    for (const auto& msg : messages) response.requestBytes += msg.content.size();
+    for (const auto& tool : tools) response.requestBytes += tool.description.size() + tool.parametersSchema.size();
+    
     return response;
 }
 
@@ -174,59 +148,6 @@ AnthropicProvider::AnthropicProvider(const LLMConfig& config) : HTTPLLMProvider(
     }
 }
 
-// Helper to escape JSON strings
-static std::string escapeJson(const std::string& s) {
-    std::ostringstream result;
-    for (char c : s) {
-        switch (c) {
-            case '"': result << "\\\""; break;
-            case '\\': result << "\\\\"; break;
-            case '\n': result << "\\n"; break;
-            case '\r': result << "\\r"; break;
-            case '\t': result << "\\t"; break;
-            default: result << c;
-        }
-    }
-    return result.str();
-}
-
-// Simple JSON string parser
-static std::string parseJsonString(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\":\"";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) {
-        // Try without quotes (for nested objects)
-        searchKey = "\"" + key + "\":";
-        pos = json.find(searchKey);
-        if (pos == std::string::npos) return "";
-        pos += searchKey.length();
-        // Skip whitespace
-        while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t')) pos++;
-        if (json[pos] == '{' || json[pos] == '[') {
-            // Find matching bracket
-            char open = json[pos];
-            char close = (open == '{') ? '}' : ']';
-            int depth = 1;
-            size_t start = pos;
-            pos++;
-            while (pos < json.size() && depth > 0) {
-                if (json[pos] == open) depth++;
-                else if (json[pos] == close) depth--;
-                pos++;
-            }
-            return json.substr(start, pos - start);
-        }
-        return "";
-    }
-    pos += searchKey.length();
-    size_t endPos = pos;
-    while (endPos < json.size() && json[endPos] != '"') {
-        if (json[endPos] == '\\') endPos++;  // Skip escaped chars
-        endPos++;
-    }
-    return json.substr(pos, endPos - pos);
-}
-
 LLMResponse AnthropicProvider::chat(
     const std::vector<LLMMessage>& messages,
     const std::vector<LLMTool>& tools,
@@ -235,52 +156,86 @@ LLMResponse AnthropicProvider::chat(
     LLMResponse response;
     response.success = false;
     
-    // Build request body
-    std::ostringstream body;
-    body << "{";
-    body << "\"model\":\"" << config.model << "\",";
-    body << "\"max_tokens\":" << config.maxTokens << ",";
+    // Build request body in this thread's scratch buffer (httpPost sends it before returning)
+    std::string& requestBody = JsonWriter::threadBuffer();
+    JsonWriter body(requestBody);
+    body.beginObject();
+    body.key("model").value(config.model);
+    body.key("max_tokens").value(config.maxTokens);
+    
+    // Cache breakpoints: the tools and system prompt are the same for every
+    // request, and the conversation so far is the prefix of the next action's
+    // request in the same turn. Cached prefixes are read at a tenth of the price.
+    auto cacheControl = [&](JsonWriter& w) {
+        if (config.promptCaching) {
+            w.key("cache_control").beginObject().key("type").value("ephemeral").endObject();
+        }
+    };
     
     // System prompt
     if (!systemPrompt.empty()) {
-        body << "\"system\":\"" << escapeJson(systemPrompt) << "\",";
+        body.key("system").beginArray().beginObject();
+        body.key("type").value("text");
+        body.key("text").value(systemPrompt);
+        cacheControl(body);
+        body.endObject().endArray();
     }
     
-    // Messages
-    body << "\"messages\":[";
-    bool first = true;
-    for (const auto& msg : messages) {
-        if (!first) body << ",";
-        first = false;
+    // Messages. Tool results and the state that follows them are user-side
+    // content blocks of the same message; a tool_use must be answered by a
+    // tool_result in the very next message.
+    auto isAssistant = [](const LLMMessage& msg) { return msg.role == LLMMessage::Role::Assistant; };
+    body.key("messages").beginArray();
+    for (size_t i = 0; i < messages.size(); i++) {
+        const LLMMessage& msg = messages[i];
+        bool first = i == 0 || isAssistant(messages[i - 1]) != isAssistant(msg);
+        bool last = i + 1 == messages.size() || isAssistant(messages[i + 1]) != isAssistant(msg);
+        if (first) {
+            body.beginObject();
+            body.key("role").value(isAssistant(msg) ? "assistant" : "user");
+            body.key("content").beginArray();
+        }
+        
+        body.beginObject();
+        if (isAssistant(msg) && msg.toolCall && !msg.toolCall->id.empty()) {
+            body.key("type").value("tool_use");
+            body.key("id").value(msg.toolCall->id);
+            body.key("name").value(msg.toolCall->toolName);
+            body.key("input").raw(msg.toolCall->arguments.empty() ? "{}" : msg.toolCall->arguments);
+        } else if (msg.role == LLMMessage::Role::ToolResult && msg.toolCallId && !msg.toolCallId->empty()) {
+            body.key("type").value("tool_result");
+            body.key("tool_use_id").value(*msg.toolCallId);
+            body.key("content").value(msg.content);
+        } else {
+            // Text can't be empty; a call without an id is described instead
+            std::string text = msg.content;
+            if (msg.toolCall) text = "Called " + msg.toolCall->toolName + " " + msg.toolCall->arguments;
+            body.key("type").value("text");
+            body.key("text").value(text.empty() ? "(no reply)" : text);
+        }
+        if (i + 1 == messages.size()) cacheControl(body);
+        body.endObject();
         
-        body << "{\"role\":\"";
-        switch (msg.role) {
-            case LLMMessage::Role::User: body << "user"; break;
-            case LLMMessage::Role::Assistant: body << "assistant"; break;
-            default: body << "user"; break;
+        if (last) {
+            body.endArray();
+            body.endObject();
         }
-        body << "\",\"content\":\"" << escapeJson(msg.content) << "\"}";
     }
-    body << "],";
+    body.endArray();
     
     // Tools
-    body << "\"tools\":[";
-    first = true;
-    for (const auto& tool : tools) {
-        if (!first) body << ",";
-        first = false;
-        
-        body << "{";
-        body << "\"name\":\"" << tool.name << "\",";
-        body << "\"description\":\"" << escapeJson(tool.description) << "\",";
-        body << "\"input_schema\":" << tool.parametersSchema;
-        body << "}";
+    body.key("tools").beginArray();
+    for (size_t i = 0; i < tools.size(); i++) {
+        body.beginObject();
+        body.key("name").value(tools[i].name);
+        body.key("description").value(tools[i].description);
+        body.key("input_schema").raw(tools[i].parametersSchema);
+        if (i + 1 == tools.size()) cacheControl(body);
+        body.endObject();
     }
-    body << "]";
+    body.endArray();
     
-    body << "}";
-    
-    std::string requestBody = body.str();
+    body.endObject();
     
     // Make request
     try {
@@ -290,6 +245,7 @@ LLMResponse AnthropicProvider::chat(
             {"anthropic-version", "2023-06-01"}
         };
         
+        response.requestBytes = requestBody.size();
         std::string responseBody = httpPost(
             config.baseUrl + "/v1/messages",
             requestBody,
@@ -298,49 +254,38 @@ LLMResponse AnthropicProvider::chat(
         
         response.rawResponse = responseBody;
         
-        // Parse response
-        // Look for tool_use in content
-        if (responseBody.find("\"type\":\"tool_use\"") != std::string::npos) {
-            // Extract tool name and input
-            size_t toolUsePos = responseBody.find("\"type\":\"tool_use\"");
-            size_t namePos = responseBody.find("\"name\":\"", toolUsePos);
-            if (namePos != std::string::npos) {
-                namePos += 8;
-                size_t nameEnd = responseBody.find("\"", namePos);
-                std::string toolName = responseBody.substr(namePos, nameEnd - namePos);
-                
-                // Find input
-                size_t inputPos = responseBody.find("\"input\":", toolUsePos);
-                if (inputPos != std::string::npos) {
-                    inputPos += 8;
-                    // Find the JSON object
-                    size_t inputStart = responseBody.find("{", inputPos);
-                    if (inputStart != std::string::npos) {
-                        int depth = 1;
-                        size_t inputEnd = inputStart + 1;
-                        while (inputEnd < responseBody.size() && depth > 0) {
-                            if (responseBody[inputEnd] == '{') depth++;
-                            else if (responseBody[inputEnd] == '}') depth--;
-                            inputEnd++;
-                        }
-                        std::string input = responseBody.substr(inputStart, inputEnd - inputStart);
-                        
-                        LLMToolCall toolCall;
-                        toolCall.toolName = toolName;
-                        toolCall.arguments = input;
-                        response.toolCall = toolCall;
+        // Parse response: content is a list of text and tool_use blocks
+        JsonValue json = JsonValue::parse(responseBody);
+        const JsonValue& content = json["content"];
+        if (content.isArray()) {
+            for (const JsonValue& block : content.items()) {
+                if (block.getString("type") == "tool_use") {
+                    LLMToolCall toolCall;
+                    toolCall.toolName = block.getString("name");
+                    toolCall.arguments = block["input"].toJson();
+                    toolCall.id = block.getString("id");
+                    response.toolCall = toolCall;
+                    break;
+                }
+            }
+            if (!response.toolCall) {
+                for (const JsonValue& block : content.items()) {
+                    if (block.getString("type") == "text") {
+                        response.textContent = block.getString("text");
+                        break;
                     }
                 }
             }
             response.success = true;
+            
+            const JsonValue& usage = json["usage"];
+            response.inputTokens = usage.getInt("input_tokens", 0);
+            response.cachedInputTokens = usage.getInt("cache_read_input_tokens", 0);
+            response.cacheWriteTokens = usage.getInt("cache_creation_input_tokens", 0);
+            response.outputTokens = usage.getInt("output_tokens", 0);
         }
-        else if (responseBody.find("\"type\":\"text\"") != std::string::npos) {
-            // Text response
-            response.textContent = parseJsonString(responseBody, "text");
-            response.success = true;
-        }
-        else if (responseBody.find("\"error\"") != std::string::npos) {
-            response.error = parseJsonString(responseBody, "message");
+        else if (json.has("error")) {
+            response.error = json["error"].getString("message", "API error");
         }
         else {
             response.success = true;
@@ -375,57 +320,84 @@ LLMResponse OpenAIProvider::chat(
     LLMResponse response;
     response.success = false;
     
-    // Build request body
-    std::ostringstream body;
-    body << "{";
-    body << "\"model\":\"" << config.model << "\",";
-    body << "\"max_tokens\":" << config.maxTokens << ",";
+    // Build request body in this thread's scratch buffer (httpPost sends it before returning)
+    std::string& requestBody = JsonWriter::threadBuffer();
+    JsonWriter body(requestBody);
+    body.beginObject();
+    body.key("model").value(config.model);
+    body.key("max_tokens").value(config.maxTokens);
     
     // Messages
-    body << "\"messages\":[";
+    body.key("messages").beginArray();
     
     // Add system message if present
     if (!systemPrompt.empty()) {
-        body << "{\"role\":\"system\",\"content\":\"" << escapeJson(systemPrompt) << "\"},";
+        body.beginObject();
+        body.key("role").value("system");
+        body.key("content").value(systemPrompt);
+        body.endObject();
     }
     
-    bool first = true;
     for (const auto& msg : messages) {
-        if (!first) body << ",";
-        first = false;
-        
-        body << "{\"role\":\"";
-        switch (msg.role) {
-            case LLMMessage::Role::User: body << "user"; break;
-            case LLMMessage::Role::Assistant: body << "assistant"; break;
-            case LLMMessage::Role::System: body << "system"; break;
-            default: body << "user"; break;
+        body.beginObject();
+        if (msg.role == LLMMessage::Role::Assistant && msg.toolCall && !msg.toolCall->id.empty()) {
+            body.key("role").value("assistant");
+            body.key("content").null();
+            body.key("tool_calls").beginArray().beginObject();
+            body.key("id").value(msg.toolCall->id);
+            body.key("type").value("function");
+            body.key("function").beginObject();
+            body.key("name").value(msg.toolCall->toolName);
+            body.key("arguments").value(msg.toolCall->arguments.empty() ? "{}" : msg.toolCall->arguments);
+            body.endObject();
+            body.endObject().endArray();
+        } else if (msg.role == LLMMessage::Role::ToolResult && msg.toolCallId && !msg.toolCallId->empty()) {
+            body.key("role").value("tool");
+            body.key("tool_call_id").value(*msg.toolCallId);
+            body.key("content").value(msg.content);
+        } else {
+            const char* role = "user";
+            switch (msg.role) {
+                case LLMMessage::Role::User: role = "user"; break;
+                case LLMMessage::Role::Assistant: role = "assistant"; break;
+                case LLMMessage::Role::System: role = "system"; break;
+                default: break;
+            }
+            body.key("role").value(role);
+            if (msg.toolCall) {
+                body.key("content").value("Called " + msg.toolCall->toolName + " " + msg.toolCall->arguments);
+            } else {
+                body.key("content").value(msg.content);
+            }
         }
-        body << "\",\"content\":\"" << escapeJson(msg.content) << "\"}";
+        body.endObject();
     }
-    body << "],";
+    body.endArray();
     
     // Tools (OpenAI format)
-    body << "\"tools\":[";
-    first = true;
+    body.key("tools").beginArray();
     for (const auto& tool : tools) {
-        if (!first) body << ",";
-        first = false;
-        
-        body << "{";
-        body << "\"type\":\"function\",";
-        body << "\"function\":{";
-        body << "\"name\":\"" << tool.name << "\",";
-        body << "\"description\":\"" << escapeJson(tool.description) << "\",";
-        body << "\"parameters\":" << tool.parametersSchema;
-        body << "}}";
+        body.beginObject();
+        body.key("type").value("function");
+        body.key("function").beginObject();
+        body.key("name").value(tool.name);
+        body.key("description").value(tool.description);
+        body.key("parameters").raw(tool.parametersSchema);
+        body.endObject();
+        body.endObject();
     }
-    body << "],";
-    body << "\"tool_choice\":\"auto\"";
+    body.endArray();
+    body.key("tool_choice").value("auto");
     
-    body << "}";
+    // OpenAI caches long prompt prefixes on its own; a key shared by every
+    // request with this system prompt routes them to the same cache
+    if (config.promptCaching) {
+        char key[32];
+        snprintf(key, sizeof(key), "catan-%016zx", std::hash<std::string>{}(systemPrompt));
+        body.key("prompt_cache_key").value(key);
+    }
     
-    std::string requestBody = body.str();
+    body.endObject();
     
     // Make request
     try {
@@ -434,6 +406,7 @@ LLMResponse OpenAIProvider::chat(
             {"Authorization", "Bearer " + config.apiKey}
         };
         
+        response.requestBytes = requestBody.size();
         std::string responseBody = httpPost(
             config.baseUrl + "/v1/chat/completions",
             requestBody,
@@ -442,58 +415,34 @@ LLMResponse OpenAIProvider::chat(
         
         response.rawResponse = responseBody;
         
-        // Parse response - look for tool_calls
-        if (responseBody.find("\"tool_calls\"") != std::string::npos) {
-            // Extract function name and arguments
-            size_t funcPos = responseBody.find("\"function\":");
-            if (funcPos != std::string::npos) {
-                std::string funcName = parseJsonString(responseBody.substr(funcPos), "name");
-                
-                // Find arguments
-                size_t argsPos = responseBody.find("\"arguments\":", funcPos);
-                if (argsPos != std::string::npos) {
-                    argsPos += 12;
-                    // Skip to start of string
-                    while (argsPos < responseBody.size() && responseBody[argsPos] != '"') argsPos++;
-                    if (argsPos < responseBody.size()) {
-                        argsPos++;
-                        size_t argsEnd = argsPos;
-                        while (argsEnd < responseBody.size()) {
-                            if (responseBody[argsEnd] == '"' && responseBody[argsEnd-1] != '\\') break;
-                            argsEnd++;
-                        }
-                        std::string args = responseBody.substr(argsPos, argsEnd - argsPos);
-                        // Unescape the JSON string
-                        std::string unescaped;
-                        for (size_t i = 0; i < args.size(); i++) {
-                            if (args[i] == '\\' && i + 1 < args.size()) {
-                                char next = args[i + 1];
-                                if (next == 'n') { unescaped += '\n'; i++; }
-                                else if (next == 't') { unescaped += '\t'; i++; }
-                                else if (next == '"') { unescaped += '"'; i++; }
-                                else if (next == '\\') { unescaped += '\\'; i++; }
-                                else unescaped += args[i];
-                            } else {
-                                unescaped += args[i];
-                            }
-                        }
-                        
-                        LLMToolCall toolCall;
-                        toolCall.toolName = funcName;
-                        toolCall.arguments = unescaped;
-                        response.toolCall = toolCall;
-                    }
-                }
+        // Parse response: the first choice's message carries tool_calls or content
+        JsonValue json = JsonValue::parse(responseBody);
+        const JsonValue& message = json["choices"][0]["message"];
+        if (message.isObject()) {
+            const JsonValue& function = message["tool_calls"][0]["function"];
+            if (function.isObject()) {
+                // arguments is itself JSON, delivered as a string
+                LLMToolCall toolCall;
+                toolCall.toolName = function.getString("name");
+                toolCall.arguments = function.getString("arguments", "{}");
+                toolCall.id = message["tool_calls"][0].getString("id");
+                response.toolCall = toolCall;
+            } else {
+                response.textContent = message.getString("content");
             }
             response.success = true;
+            
+            // prompt_tokens includes the cached ones
+            const JsonValue& usage = json["usage"];
+            response.cachedInputTokens = usage["prompt_tokens_details"].getInt("cached_tokens", 0);
+            response.inputTokens = usage.getInt("prompt_tokens", 0) - response.cachedInputTokens;
+            response.outputTokens = usage.getInt("completion_tokens", 0);
         }
-        else if (responseBody.find("\"content\"") != std::string::npos) {
-            // Text response
-            response.textContent = parseJsonString(responseBody, "content");
-            response.success = true;
+        else if (json.has("error")) {
+            response.error = json["error"].getString("message", "API error");
         }
-        else if (responseBody.find("\"error\"") != std::string::npos) {
-            response.error = parseJsonString(responseBody, "message");
+        else {
+            response.error = "Unexpected response from provider";
         }
         
     } catch (const std::exception& e) {
@@ -503,6 +452,28 @@ LLMResponse OpenAIProvider::chat(
     return response;
 }
 
+// ============================================================================
+// HEURISTIC PROVIDER
+// ============================================================================
+
+std::optional<LLMToolCall> HeuristicProvider::decide(const Game& game, int playerId) {
+    PolicyAction action = chooseAction(game, playerId);
+    if (action.type == PolicyActionType::None) return std::nullopt;
+    return policyToolCall(action);
+}
+
+LLMResponse HeuristicProvider::chat(
+    const std::vector<LLMMessage>& messages,
+    const std::vector<LLMTool>& tools,
+    const std::string& systemPrompt
+) {
+    // Only reached when decide() had nothing to play
+    LLMResponse response;
+    response.success = false;
+    response.error = "The heuristic provider plays from the game state, not from a prompt";
+    return response;
+}
+
 // ============================================================================
 // LLM PROVIDER FACTORY
 // ============================================================================
@@ -514,6 +485,9 @@ std::unique_ptr<LLMProvider> LLMProviderFactory::create(const LLMConfig& config)
     else if (config.provider == "openai") {
         return std::make_unique<OpenAIProvider>(config);
     }
+    else if (config.provider == "heuristic") {
+        return std::make_unique<HeuristicProvider>(config);
+    }
     else {
         // Default to mock
         return std::make_unique<MockLLMProvider>(config);
@@ -521,7 +495,7 @@ std::unique_ptr<LLMProvider> LLMProviderFactory::create(const LLMConfig& config)
 }
 
 std::vector<std::string> LLMProviderFactory::availableProviders() {
-    return {"mock", "anthropic", "openai"};
+    return {"mock", "heuristic", "anthropic", "openai"};
 }
 
 // ============================================================================
@@ -534,6 +508,12 @@ LLMConfigManager::LLMConfigManager() {
 }
 
 void LLMConfigManager::loadFromEnvironment() {
+    // CATAN_AI_HYBRID=0 sends every decision to the model
+    const char* hybrid = std::getenv("CATAN_AI_HYBRID");
+    if (hybrid && strlen(hybrid) > 0) {
+        currentConfig.hybrid = std::atoi(hybrid) != 0;
+    }
+    
     // Check for Anthropic API key
     const char* anthropicKey = std::getenv("ANTHROPIC_API_KEY");
     if (anthropicKey && strlen(anthropicKey) > 0) {
@@ -609,7 +589,7 @@ LLMProvider* LLMConfigManager::getProvider() {
 }
 
 bool LLMConfigManager::isConfigured() const {
-    if (currentConfig.provider == "mock") {
+    if (currentConfig.provider == "mock" || currentConfig.provider == "heuristic") {
         return true;
     }
     return !currentConfig.apiKey.empty();
@@ -621,6 +601,10 @@ std::string LLMConfigManager::toJson() const {
     json << "\"provider\":\"" << currentConfig.provider << "\",";
     json << "\"model\":\"" << currentConfig.model << "\",";
     json << "\"configured\":" << (isConfigured() ? "true" : "false") << ",";
+    json << "\"connectTimeoutMs\":" << currentConfig.connectTimeoutMs << ",";
+    json << "\"requestTimeoutMs\":" << currentConfig.requestTimeoutMs << ",";
+    json << "\"hybrid\":" << (currentConfig.hybrid ? "true" : "false") << ",";
+    json << "\"promptCaching\":" << (currentConfig.promptCaching ? "true" : "false") << ",";
     json << "\"availableProviders\":[";
     auto providers = LLMProviderFactory::availableProviders();
     for (size_t i = 0; i < providers.size(); i++) {
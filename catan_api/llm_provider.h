@@ -7,6 +7,9 @@
 #include <optional>
 
 namespace catan {
+
+struct Game;
+
 namespace ai {
 
 // ============================================================================
@@ -18,6 +21,7 @@ namespace ai {
 struct LLMToolCall {
     std::string toolName;
     std::string arguments;  // JSON string
+    std::string id;         // provider's call id, echoed back with the result; may be empty
 };
 
 // Message for LLM conversation
@@ -38,12 +42,16 @@ struct LLMTool {
 
 // Configuration for LLM provider
 struct LLMConfig {
-    std::string provider;       // "anthropic", "openai", "mock"
+    std::string provider;       // "anthropic", "openai", "heuristic", "mock"
     std::string apiKey;
     std::string model;          // e.g., "claude-3-5-sonnet-20241022", "gpt-4"
     std::string baseUrl;        // Optional custom base URL
     int maxTokens = 1024;
     double temperature = 0.7;
+    int connectTimeoutMs = 10000;   // TCP + TLS setup for a new pooled connection
+    int requestTimeoutMs = 120000;  // full request/response
+    bool promptCaching = true;  // mark the static prompt prefix cacheable
+    bool hybrid = true;         // forced moves and setup are played locally, not sent to the model
 };
 
 // Response from LLM
@@ -53,6 +61,13 @@ struct LLMResponse {
     std::optional<LLMToolCall> toolCall;
     std::string textContent;    // If no tool call, may have text response
     std::string rawResponse;    // Full raw response for debugging
+    
+    // Request accounting; token counts stay 0 if the provider doesn't report them
+    size_t requestBytes = 0;
+    int inputTokens = 0;        // prompt tokens not served from the cache
+    int cachedInputTokens = 0;  // prompt tokens read from the provider's prompt cache
+    int cacheWriteTokens = 0;   // prompt tokens written to it (Anthropic)
+    int outputTokens = 0;
 };
 
 // ============================================================================
@@ -75,6 +90,16 @@ public:
     
     // Check if the provider is properly configured
     virtual bool isConfigured() const = 0;
+    
+    // Whether a call costs a network round-trip (and so is worth overlapping)
+    virtual bool isRemote() const { return false; }
+    
+    // Providers that play from the game itself rather than from a prompt
+    // answer here, and chat() is not called. Called with the game lock
+    // held; nullopt means no decision.
+    virtual std::optional<LLMToolCall> decide(const Game& game, int playerId) {
+        return std::nullopt;
+    }
 };
 
 // ============================================================================
@@ -99,6 +124,28 @@ public:
     bool isConfigured() const override { return true; }
 };
 
+// ============================================================================
+// HEURISTIC PROVIDER - The rule-based policy from heuristic_policy.h; plays
+// a move in microseconds with no API calls
+// ============================================================================
+
+class HeuristicProvider : public LLMProvider {
+public:
+    explicit HeuristicProvider(const LLMConfig& config) {}
+    
+    std::string getName() const override { return "heuristic"; }
+    
+    std::optional<LLMToolCall> decide(const Game& game, int playerId) override;
+    
+    LLMResponse chat(
+        const std::vector<LLMMessage>& messages,
+        const std::vector<LLMTool>& tools,
+        const std::string& systemPrompt
+    ) override;
+    
+    bool isConfigured() const override { return true; }
+};
+
 // ============================================================================
 // HTTP LLM PROVIDER BASE - Common functionality for API-based providers
 // ============================================================================
@@ -120,6 +167,8 @@ public:
     bool isConfigured() const override {
         return !config.apiKey.empty();
     }
+    
+    bool isRemote() const override { return true; }
 };
 
 // ============================================================================
@@ -0,0 +1,220 @@
+#include "metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace catan {
+
+// ============================================================================
+// COUNTER
+// ============================================================================
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const Slot& slot : slots) total += slot.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+// ============================================================================
+// HISTOGRAM
+// ============================================================================
+
+Histogram::Histogram() : slots(std::make_unique<std::array<Slot, METRIC_SLOTS>>()) {}
+
+uint64_t Histogram::bucketLowest(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) return bucket;
+    int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+    return (static_cast<uint64_t>(bucket % SUB_BUCKETS) + SUB_BUCKETS) << shift;
+}
+
+uint64_t Histogram::bucketHighest(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) return bucket;
+    int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+    return bucketLowest(bucket) + (uint64_t(1) << shift) - 1;
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snap;
+    snap.buckets.assign(BUCKETS, 0);
+    for (const Slot& slot : *slots) {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            uint64_t n = slot.buckets[i].load(std::memory_order_relaxed);
+            snap.buckets[i] += n;
+            snap.count += n;
+        }
+        snap.sum += slot.sum.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    if (buckets.size() < other.buckets.size()) buckets.resize(other.buckets.size(), 0);
+    for (size_t i = 0; i < other.buckets.size(); i++) buckets[i] += other.buckets[i];
+    count += other.count;
+    sum += other.sum;
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count)));
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) return Histogram::bucketHighest(i);
+    }
+    return Histogram::bucketHighest(buckets.size() - 1);
+}
+
+uint64_t HistogramSnapshot::countAtOrBelow(uint64_t value) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < buckets.size() && Histogram::bucketHighest(i) <= value; i++) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+// ============================================================================
+// METRICS REGISTRY
+// ============================================================================
+
+namespace {
+
+// Bucket boundaries exported for each unit, in the unit's exported scale
+const std::vector<double>& exportBounds(HistogramUnit unit) {
+    static const std::vector<double> seconds = {
+        0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+        0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60
+    };
+    static const std::vector<double> counts = {
+        0, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024
+    };
+    return unit == HistogramUnit::Nanoseconds ? seconds : counts;
+}
+
+void writeNumber(std::ostringstream& out, double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", value);
+    out << buf;
+}
+
+void writeSeries(std::ostringstream& out, const std::string& name, const std::string& labels,
+                 const std::string& extraLabel = "") {
+    out << name;
+    if (!labels.empty() || !extraLabel.empty()) {
+        out << '{' << labels;
+        if (!labels.empty() && !extraLabel.empty()) out << ',';
+        out << extraLabel << '}';
+    }
+    out << ' ';
+}
+
+}  // namespace
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family& family = families[name];
+    if (family.help.empty()) {
+        family.kind = Kind::Counter;
+        family.help = help;
+    }
+    auto& series = family.counters[labels];
+    if (!series) series = std::make_unique<Counter>();
+    return *series;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels,
+                                      HistogramUnit unit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family& family = families[name];
+    if (family.help.empty()) {
+        family.kind = Kind::Histogram;
+        family.help = help;
+        family.unit = unit;
+    }
+    auto& series = family.histograms[labels];
+    if (!series) series = std::make_unique<Histogram>();
+    return *series;
+}
+
+void MetricsRegistry::callback(const std::string& name, const std::string& help, MetricType type,
+                               std::function<double()> read, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family& family = families[name];
+    if (family.help.empty()) {
+        family.kind = type == MetricType::Counter ? Kind::Counter : Kind::Gauge;
+        family.help = help;
+    }
+    family.callbacks[labels] = std::move(read);
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    std::ostringstream out;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& [name, family] : families) {
+        const char* type = family.kind == Kind::Counter ? "counter"
+                         : family.kind == Kind::Gauge ? "gauge" : "histogram";
+        out << "# HELP " << name << ' ' << family.help << '\n';
+        out << "# TYPE " << name << ' ' << type << '\n';
+
+        for (const auto& [labels, series] : family.counters) {
+            writeSeries(out, name, labels);
+            out << series->value() << '\n';
+        }
+        for (const auto& [labels, read] : family.callbacks) {
+            writeSeries(out, name, labels);
+            writeNumber(out, read());
+            out << '\n';
+        }
+
+        const double scale = family.unit == HistogramUnit::Nanoseconds ? 1e-9 : 1.0;
+        for (const auto& [labels, series] : family.histograms) {
+            HistogramSnapshot snap = series->snapshot();
+            for (double bound : exportBounds(family.unit)) {
+                std::ostringstream le;
+                le << "le=\"";
+                writeNumber(le, bound);
+                le << '"';
+                writeSeries(out, name + "_bucket", labels, le.str());
+                out << snap.countAtOrBelow(static_cast<uint64_t>(bound / scale)) << '\n';
+            }
+            writeSeries(out, name + "_bucket", labels, "le=\"+Inf\"");
+            out << snap.count << '\n';
+            writeSeries(out, name + "_sum", labels);
+            writeNumber(out, static_cast<double>(snap.sum) * scale);
+            out << '\n';
+            writeSeries(out, name + "_count", labels);
+            out << snap.count << '\n';
+        }
+    }
+    return out.str();
+}
+
+MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+std::string metricLabels(std::initializer_list<std::pair<const char*, std::string_view>> labels) {
+    std::string out;
+    for (const auto& [key, value] : labels) {
+        if (!out.empty()) out += ',';
+        out += key;
+        out += "=\"";
+        for (char c : value) {
+            if (c == '\\' || c == '"') out += '\\';
+            if (c == '\n') {
+                out += "\\n";
+                continue;
+            }
+            out += c;
+        }
+        out += '"';
+    }
+    return out;
+}
+
+}  // namespace catan
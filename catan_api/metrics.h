@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace catan {
+
+// ============================================================================
+// METRICS
+// Counters and histograms cheap enough for the request path. Each one is
+// split into per-thread slots: a thread only ever adds to its own slot with
+// a relaxed atomic, and the slots are summed when the metrics are read.
+// Threads beyond METRIC_SLOTS share slots, which costs contention but never
+// correctness.
+// ============================================================================
+
+constexpr size_t METRIC_SLOTS = 16;
+
+// The calling thread's slot, handed out round-robin on first use
+inline size_t metricSlot() {
+    static std::atomic<size_t> nextSlot{0};
+    thread_local const size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % METRIC_SLOTS;
+    return slot;
+}
+
+class Counter {
+public:
+    void add(uint64_t n = 1) {
+        slots[metricSlot()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Slot, METRIC_SLOTS> slots;
+};
+
+// ============================================================================
+// HISTOGRAM
+// HDR-style buckets: values below 16 are exact, above that each power of two
+// is split into 8 linear sub-buckets, so a recorded value is off by at most
+// 12.5% across the whole range (up to 2^40, about 18 minutes in ns).
+// ============================================================================
+
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;         // sum of the buckets
+    uint64_t sum = 0;
+
+    void merge(const HistogramSnapshot& other);
+
+    // Smallest value with at least q (0..1) of the recorded values at or
+    // below it, to bucket precision. 0 if empty.
+    uint64_t percentile(double q) const;
+
+    // Recorded values no larger than `value`, counting a bucket only when
+    // all of it is
+    uint64_t countAtOrBelow(uint64_t value) const;
+};
+
+class Histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_BITS = 40;
+    static constexpr size_t BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    Histogram();
+
+    void record(uint64_t value) {
+        Slot& slot = (*slots)[metricSlot()];
+        slot.buckets[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+        slot.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    HistogramSnapshot snapshot() const;
+
+    static size_t bucketFor(uint64_t value) {
+        constexpr uint64_t maxValue = (uint64_t(1) << MAX_BITS) - 1;
+        if (value > maxValue) value = maxValue;
+        if (value < 2 * SUB_BUCKETS) return static_cast<size_t>(value);
+        int shift = (63 - __builtin_clzll(value)) - SUB_BUCKET_BITS;
+        return static_cast<size_t>((shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t bucketLowest(size_t bucket);
+    static uint64_t bucketHighest(size_t bucket);
+
+private:
+    struct alignas(64) Slot {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> sum{0};
+    };
+    std::unique_ptr<std::array<Slot, METRIC_SLOTS>> slots;
+};
+
+// Records the time from construction to destruction, in nanoseconds
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// ============================================================================
+// METRICS REGISTRY
+// Named series, rendered in the Prometheus text format. A series is created
+// on first lookup and lives as long as the registry, so hot paths look one
+// up once and keep the reference.
+// ============================================================================
+
+enum class MetricType { Counter, Gauge };
+
+// What a histogram's values are: latencies are recorded in nanoseconds and
+// exported in seconds, sizes and depths as they are
+enum class HistogramUnit { Nanoseconds, Count };
+
+class MetricsRegistry {
+public:
+    // labels is the inside of the braces, as built by metricLabels()
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "",
+                         HistogramUnit unit = HistogramUnit::Nanoseconds);
+
+    // A value owned elsewhere, read each time the metrics are rendered
+    void callback(const std::string& name, const std::string& help, MetricType type,
+                  std::function<double()> read, const std::string& labels = "");
+
+    std::string renderPrometheus() const;
+
+private:
+    enum class Kind { Counter, Gauge, Histogram };
+
+    struct Family {
+        Kind kind = Kind::Counter;
+        std::string help;
+        HistogramUnit unit = HistogramUnit::Nanoseconds;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+        std::map<std::string, std::function<double()>> callbacks;
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, Family> families;
+};
+
+// The process-wide registry served at GET /metrics
+MetricsRegistry& metrics();
+
+// name="value" pairs for a series, with the values escaped
+std::string metricLabels(std::initializer_list<std::pair<const char*, std::string_view>> labels);
+
+}  // namespace catan
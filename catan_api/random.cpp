@@ -0,0 +1,153 @@
+#include "random.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/random.h>
+
+namespace catan {
+
+// ============================================================================
+// CHACHA20 STREAM
+// ============================================================================
+
+namespace {
+
+constexpr size_t BLOCK_BYTES = 64;
+constexpr size_t KEY_BYTES = 32;
+constexpr size_t BLOCKS_PER_REFILL = 16;
+
+inline uint32_t rotl32(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+inline void quarterRound(uint32_t* x, int a, int b, int c, int d) {
+    x[a] += x[b]; x[d] ^= x[a]; x[d] = rotl32(x[d], 16);
+    x[c] += x[d]; x[b] ^= x[c]; x[b] = rotl32(x[b], 12);
+    x[a] += x[b]; x[d] ^= x[a]; x[d] = rotl32(x[d], 8);
+    x[c] += x[d]; x[b] ^= x[c]; x[b] = rotl32(x[b], 7);
+}
+
+inline uint32_t load32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+inline void store32(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+    p[2] = uint8_t(v >> 16);
+    p[3] = uint8_t(v >> 24);
+}
+
+// One 64-byte block of the RFC 8439 keystream
+void chachaBlock(const uint8_t key[KEY_BYTES], uint32_t counter, const uint8_t nonce[12],
+                 uint8_t out[BLOCK_BYTES]) {
+    uint32_t input[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+    for (int i = 0; i < 8; i++) input[4 + i] = load32(key + 4 * i);
+    input[12] = counter;
+    for (int i = 0; i < 3; i++) input[13 + i] = load32(nonce + 4 * i);
+
+    uint32_t x[16];
+    std::memcpy(x, input, sizeof(x));
+    for (int round = 0; round < 10; round++) {
+        quarterRound(x, 0, 4, 8, 12);
+        quarterRound(x, 1, 5, 9, 13);
+        quarterRound(x, 2, 6, 10, 14);
+        quarterRound(x, 3, 7, 11, 15);
+        quarterRound(x, 0, 5, 10, 15);
+        quarterRound(x, 1, 6, 11, 12);
+        quarterRound(x, 2, 7, 8, 13);
+        quarterRound(x, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; i++) store32(out + 4 * i, x[i] + input[i]);
+}
+
+void kernelRandom(uint8_t* out, size_t size) {
+    while (size > 0) {
+        ssize_t n = getrandom(out, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("getrandom failed: ") + std::strerror(errno));
+        }
+        out += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+// Each refill runs the keystream under a fresh key, replaces the key with
+// the first 32 bytes of output and hands out the rest, wiping bytes as they
+// go, so nothing already returned can be recomputed from the thread's state
+class ChaChaStream {
+public:
+    void read(uint8_t* out, size_t size) {
+        while (size > 0) {
+            if (position == sizeof(buffer)) refill();
+            size_t n = std::min(size, sizeof(buffer) - position);
+            std::memcpy(out, buffer + position, n);
+            std::memset(buffer + position, 0, n);
+            position += n;
+            out += n;
+            size -= n;
+        }
+    }
+
+private:
+    uint8_t key[KEY_BYTES];
+    uint8_t buffer[BLOCKS_PER_REFILL * BLOCK_BYTES - KEY_BYTES];
+    size_t position = sizeof(buffer);
+    bool keyed = false;
+
+    void refill() {
+        if (!keyed) {
+            kernelRandom(key, sizeof(key));
+            keyed = true;
+        }
+        static const uint8_t nonce[12] = {};
+        uint8_t block[BLOCKS_PER_REFILL * BLOCK_BYTES];
+        for (uint32_t i = 0; i < BLOCKS_PER_REFILL; i++) {
+            chachaBlock(key, i, nonce, block + i * BLOCK_BYTES);
+        }
+        std::memcpy(key, block, KEY_BYTES);
+        std::memcpy(buffer, block + KEY_BYTES, sizeof(buffer));
+        std::memset(block, 0, sizeof(block));
+        position = 0;
+    }
+};
+
+ChaChaStream& threadStream() {
+    thread_local ChaChaStream stream;
+    return stream;
+}
+
+}  // namespace
+
+// ============================================================================
+// SECURE RANDOMNESS
+// ============================================================================
+
+void secureRandomBytes(void* out, size_t size) {
+    threadStream().read(static_cast<uint8_t*>(out), size);
+}
+
+uint64_t secureRandom64() {
+    uint64_t value;
+    secureRandomBytes(&value, sizeof(value));
+    return value;
+}
+
+std::string secureRandomHex(size_t size) {
+    static const char HEX[] = "0123456789abcdef";
+    uint8_t bytes[64];
+    std::string result;
+    result.reserve(size * 2);
+    while (size > 0) {
+        size_t n = std::min(size, sizeof(bytes));
+        secureRandomBytes(bytes, n);
+        for (size_t i = 0; i < n; i++) {
+            result += HEX[bytes[i] >> 4];
+            result += HEX[bytes[i] & 15];
+        }
+        size -= n;
+    }
+    return result;
+}
+
+}  // namespace catan
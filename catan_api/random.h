@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+namespace catan {
+
+// ============================================================================
+// GAME RANDOMNESS
+// Everything random in a game (board layout, deck order, dice, robber
+// steals) comes from that game's GameRng, seeded once when the game is
+// created and saved with it. A game is therefore a function of its seed and
+// the actions applied to it. The draws below avoid the <random>
+// distributions and std::shuffle, whose output differs between standard
+// libraries, so a seed replays the same on every build.
+// ============================================================================
+
+// xoshiro256** (Blackman and Vigna), seeded through splitmix64. Not for
+// secrets; see secureRandomBytes.
+class GameRng {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    GameRng() { seed(0); }
+    explicit GameRng(uint64_t value) { seed(value); }
+
+    void seed(uint64_t value) {
+        for (uint64_t& word : state) {
+            value += 0x9E3779B97F4A7C15ull;
+            uint64_t z = value;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    result_type operator()() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound) for bound > 0, by multiply-and-reject (Lemire)
+    uint64_t uniform(uint64_t bound) {
+        unsigned __int128 product = static_cast<unsigned __int128>((*this)()) * bound;
+        uint64_t low = static_cast<uint64_t>(product);
+        if (low < bound) {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<unsigned __int128>((*this)()) * bound;
+                low = static_cast<uint64_t>(product);
+            }
+        }
+        return static_cast<uint64_t>(product >> 64);
+    }
+
+    // Uniform in [lo, hi]
+    int between(int lo, int hi) {
+        return lo + static_cast<int>(uniform(static_cast<uint64_t>(hi - lo) + 1));
+    }
+
+    // Fisher-Yates
+    template <typename RandomIt>
+    void shuffle(RandomIt first, RandomIt last) {
+        for (auto n = std::distance(first, last); n > 1; n--) {
+            std::iter_swap(first + (n - 1), first + static_cast<decltype(n)>(uniform(static_cast<uint64_t>(n))));
+        }
+    }
+
+    // Raw state, so a saved game resumes mid-stream
+    const std::array<uint64_t, 4>& getState() const { return state; }
+    void setState(const std::array<uint64_t, 4>& value) { state = value; }
+
+private:
+    std::array<uint64_t, 4> state;
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// ============================================================================
+// SECURE RANDOMNESS
+// Session tokens, game ids and game seeds. Each thread runs its own ChaCha20
+// stream, keyed from the kernel on first use and rekeyed from its own output
+// after every refill, so no lock is shared and no syscall is made per call.
+// ============================================================================
+
+// Throws std::runtime_error if the kernel can't supply a key
+void secureRandomBytes(void* out, size_t size);
+
+uint64_t secureRandom64();
+
+// size random bytes as 2 * size lowercase hex digits
+std::string secureRandomHex(size_t size);
+
+}  // namespace catan
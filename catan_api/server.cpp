@@ -9,106 +9,65 @@
 #include <vector>
 #include <sstream>
 #include <algorithm>
-#include <random>
 #include <queue>
 #include <condition_variable>
 #include <functional>
+#include <chrono>
+#include <future>
+#include <unordered_set>
 
 #include "catan_types.h"
 #include "session.h"
 #include "ai_agent.h"
+#include "ai_scheduler.h"
 #include "llm_provider.h"
 #include "sse_handler.h"
+#include "spectators.h"
 #include "game_logic.h"
+#include "game_actions.h"
+#include "http_server.h"
+#include "json_writer.h"
+#include "game_delta.h"
+#include "game_reaper.h"
+#include "game_store.h"
+#include "metrics.h"
+#include "async_log.h"
+#include "cluster.h"
 
 // Global LLM config manager
 catan::ai::LLMConfigManager llmConfigManager;
 
-// Map of game ID to AI turn executor
-std::unordered_map<std::string, std::unique_ptr<catan::ai::AITurnExecutor>> aiExecutors;
+// Map of game ID to AI turn executor (shared so queued scheduler steps can
+// detect an executor that has been dropped)
+std::unordered_map<std::string, std::shared_ptr<catan::ai::AITurnExecutor>> aiExecutors;
 std::mutex aiExecutorsMutex;
 
 // Forward declaration
-catan::ai::AITurnExecutor* getOrCreateAIExecutor(const std::string& gameId);
+std::shared_ptr<catan::ai::AITurnExecutor> getOrCreateAIExecutor(const std::string& gameId);
 
 // Global managers (in production, wrap these properly)
 catan::GameManager gameManager;
 catan::SessionManager sessionManager;
 
-// ============================================================================
-// BUILDING COSTS
-// ============================================================================
+// Persisted games; null unless CATAN_DATA_DIR is set
+std::unique_ptr<catan::GameStore> gameStore;
 
-const catan::ResourceHand ROAD_COST = {1, 1, 0, 0, 0};       // wood, brick
-const catan::ResourceHand SETTLEMENT_COST = {1, 1, 1, 1, 0}; // wood, brick, wheat, sheep
-const catan::ResourceHand CITY_COST = {0, 0, 2, 0, 3};       // 2 wheat, 3 ore
-const catan::ResourceHand DEV_CARD_COST = {0, 0, 1, 1, 1};   // wheat, sheep, ore
-
-bool canAfford(const catan::ResourceHand& have, const catan::ResourceHand& cost) {
-    return have.wood >= cost.wood &&
-           have.brick >= cost.brick &&
-           have.wheat >= cost.wheat &&
-           have.sheep >= cost.sheep &&
-           have.ore >= cost.ore;
-}
-
-void subtractResources(catan::ResourceHand& from, const catan::ResourceHand& cost) {
-    from.wood -= cost.wood;
-    from.brick -= cost.brick;
-    from.wheat -= cost.wheat;
-    from.sheep -= cost.sheep;
-    from.ore -= cost.ore;
-}
-
-// Simple JSON value parser (for {"give":"wood","receive":"ore"} style)
-std::string parseJsonString(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\":\"";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return "";
-    pos += searchKey.length();
-    size_t endPos = json.find("\"", pos);
-    if (endPos == std::string::npos) return "";
-    return json.substr(pos, endPos - pos);
-}
-
-int parseJsonInt(const std::string& json, const std::string& key, int defaultValue = 0) {
-    std::string searchKey = "\"" + key + "\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return defaultValue;
-    pos += searchKey.length();
-    // Skip whitespace
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t')) pos++;
-    // Parse integer
-    size_t endPos = pos;
-    if (json[endPos] == '-') endPos++;
-    while (endPos < json.size() && std::isdigit(json[endPos])) endPos++;
-    if (endPos == pos) return defaultValue;
-    try {
-        return std::stoi(json.substr(pos, endPos - pos));
-    } catch (...) {
-        return defaultValue;
-    }
-}
+// Request log lines, written to stdout by a background thread
+catan::AsyncLog requestLog;
 
-bool parseJsonBool(const std::string& json, const std::string& key, bool defaultValue = false) {
-    std::string searchKey = "\"" + key + "\":";
-    size_t pos = json.find(searchKey);
-    if (pos == std::string::npos) return defaultValue;
-    pos += searchKey.length();
-    // Skip whitespace
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t')) pos++;
-    if (json.substr(pos, 4) == "true") return true;
-    if (json.substr(pos, 5) == "false") return false;
-    return defaultValue;
-}
+// Set when CATAN_CLUSTER_NODES names more than one node
+std::unique_ptr<catan::ClusterNode> cluster;
+
+// ============================================================================
+// RESPONSE FIELDS
+// Names and locations as the API spells them. The rules themselves are in
+// game_actions.h.
+// ============================================================================
 
-catan::Resource stringToResource(const std::string& name) {
-    if (name == "wood") return catan::Resource::Wood;
-    if (name == "brick") return catan::Resource::Brick;
-    if (name == "wheat") return catan::Resource::Wheat;
-    if (name == "sheep") return catan::Resource::Sheep;
-    if (name == "ore") return catan::Resource::Ore;
-    return catan::Resource::None;
+// Canonical location fields for a vertex or edge
+std::string locationFields(const catan::HexCoord& hex, int direction) {
+    return "\"hexQ\":" + std::to_string(hex.q) + ",\"hexR\":" + std::to_string(hex.r) +
+           ",\"direction\":" + std::to_string(direction);
 }
 
 std::string resourceToString(catan::Resource r) {
@@ -122,91 +81,36 @@ std::string resourceToString(catan::Resource r) {
     }
 }
 
+std::string devCardToString(catan::DevCardType card) {
+    switch (card) {
+        case catan::DevCardType::Knight: return "knight";
+        case catan::DevCardType::VictoryPoint: return "victory_point";
+        case catan::DevCardType::RoadBuilding: return "road_building";
+        case catan::DevCardType::YearOfPlenty: return "year_of_plenty";
+        case catan::DevCardType::Monopoly: return "monopoly";
+    }
+    return "unknown";
+}
+
 // ============================================================================
-// HTTP PARSING HELPERS
+// HTTP RESPONSE HELPERS
 // ============================================================================
 
-struct HTTPRequest {
-    std::string method;
-    std::string path;
-    std::unordered_map<std::string, std::string> headers;
-    std::string body;
-    
-    // Parsed from Authorization header
-    std::string authToken;
-};
-
-HTTPRequest parseRequest(const std::string& raw) {
-    HTTPRequest req;
-    std::istringstream stream(raw);
-    std::string line;
-    
-    // Parse request line: GET /path HTTP/1.1
-    if (std::getline(stream, line)) {
-        std::istringstream requestLine(line);
-        requestLine >> req.method >> req.path;
-    }
-    
-    // Parse headers
-    while (std::getline(stream, line) && line != "\r" && !line.empty()) {
-        // Remove \r if present
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        
-        size_t colonPos = line.find(':');
-        if (colonPos != std::string::npos) {
-            std::string key = line.substr(0, colonPos);
-            std::string value = line.substr(colonPos + 1);
-            // Trim leading space from value
-            if (!value.empty() && value[0] == ' ') {
-                value = value.substr(1);
-            }
-            // Convert header name to lowercase for easy lookup
-            std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-            req.headers[key] = value;
-        }
-    }
-    
-    // Parse Authorization: Bearer <token>
-    auto authIt = req.headers.find("authorization");
-    if (authIt != req.headers.end()) {
-        const std::string& auth = authIt->second;
-        if (auth.substr(0, 7) == "Bearer ") {
-            req.authToken = auth.substr(7);
-        }
-    }
-    
-    // Rest is body
-    std::stringstream bodyStream;
-    bodyStream << stream.rdbuf();
-    req.body = bodyStream.str();
-    
-    return req;
-}
+using catan::HTTPRequest;
+using catan::HTTPResponse;
 
-std::string jsonResponse(int status, const std::string& json) {
-    std::string statusText = (status == 200) ? "OK" : 
-                             (status == 201) ? "Created" :
-                             (status == 400) ? "Bad Request" :
-                             (status == 401) ? "Unauthorized" :
-                             (status == 404) ? "Not Found" : "Error";
-    
-    std::ostringstream response;
-    response << "HTTP/1.1 " << status << " " << statusText << "\r\n"
-             << "Content-Type: application/json\r\n"
-             << "Content-Length: " << json.length() << "\r\n"
-             << "Connection: close\r\n"
-             << "\r\n"
-             << json;
-    return response.str();
+HTTPResponse jsonResponse(int status, std::string json) {
+    HTTPResponse response;
+    response.status = status;
+    response.body = std::move(json);
+    return response;
 }
 
 // ============================================================================
 // API HANDLERS
 // ============================================================================
 
-std::string handleCreateGame(const HTTPRequest& req) {
+HTTPResponse handleCreateGame(const HTTPRequest& req) {
     // TODO: Parse name from JSON body
     std::string gameId = gameManager.createGame("New Game", 4);
     
@@ -214,13 +118,13 @@ std::string handleCreateGame(const HTTPRequest& req) {
         "{\"gameId\":\"" + gameId + "\",\"message\":\"Game created\"}");
 }
 
-std::string handleJoinGame(const HTTPRequest& req, const std::string& gameId) {
-    catan::Game* game = gameManager.getGame(gameId);
+HTTPResponse handleJoinGame(const HTTPRequest& req, const std::string& gameId) {
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
         return jsonResponse(404, "{\"error\":\"Game not found\"}");
     }
     
-    std::lock_guard<std::mutex> lock(game->mutex);
+    catan::GameLock lock(*game);
     
     if (game->phase != catan::GamePhase::WaitingForPlayers) {
         return jsonResponse(400, "{\"error\":\"Game already started\"}");
@@ -231,8 +135,8 @@ std::string handleJoinGame(const HTTPRequest& req, const std::string& gameId) {
     }
     
     // Parse player info from JSON body
-    std::string playerName = parseJsonString(req.body, "name");
-    bool isAI = parseJsonBool(req.body, "isAI", false);
+    std::string playerName = req.json().getString("name");
+    bool isAI = req.json().getBool("isAI", false);
     
     int playerId = game->players.size();
     catan::Player player;
@@ -241,35 +145,37 @@ std::string handleJoinGame(const HTTPRequest& req, const std::string& gameId) {
     player.playerType = isAI ? catan::PlayerType::AI : catan::PlayerType::Human;
     player.isConnected = true;
     player.lastActivity = std::chrono::steady_clock::now();
-    game->players.push_back(player);
+    game->addPlayer(player);
     
     // Create session token (even AI players get tokens for API access)
     std::string token = sessionManager.createSession(gameId, playerId, player.name);
-    
-    std::string playerTypeStr = isAI ? "ai" : "human";
-    
-    return jsonResponse(200, 
-        "{\"token\":\"" + token + "\","
-        "\"playerId\":" + std::to_string(playerId) + ","
-        "\"playerName\":\"" + player.name + "\","
-        "\"playerType\":\"" + playerTypeStr + "\"}");
+    game->players.back().sessionToken = token;
+    
+    catan::JsonWriter json;
+    json.beginObject()
+        .key("token").value(token)
+        .key("playerId").value(playerId)
+        .key("playerName").value(player.name)
+        .key("playerType").value(isAI ? "ai" : "human")
+        .endObject();
+    return jsonResponse(200, json.take());
 }
 
 // Add AI players to fill the game
-std::string handleAddAIPlayers(const HTTPRequest& req, const std::string& gameId) {
-    catan::Game* game = gameManager.getGame(gameId);
+HTTPResponse handleAddAIPlayers(const HTTPRequest& req, const std::string& gameId) {
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
         return jsonResponse(404, "{\"error\":\"Game not found\"}");
     }
     
-    std::lock_guard<std::mutex> lock(game->mutex);
+    catan::GameLock lock(*game);
     
     if (game->phase != catan::GamePhase::WaitingForPlayers) {
         return jsonResponse(400, "{\"error\":\"Game already started\"}");
     }
     
     // Parse count from body, default to filling remaining slots
-    int requestedCount = parseJsonInt(req.body, "count", -1);
+    int requestedCount = req.json().getInt("count", -1);
     int availableSlots = game->maxPlayers - game->players.size();
     
     if (requestedCount < 0) {
@@ -301,10 +207,10 @@ std::string handleAddAIPlayers(const HTTPRequest& req, const std::string& gameId
         aiPlayer.playerType = catan::PlayerType::AI;
         aiPlayer.isConnected = true;
         aiPlayer.lastActivity = std::chrono::steady_clock::now();
-        game->players.push_back(aiPlayer);
+        game->addPlayer(aiPlayer);
         
         // Create session token for the AI player
-        sessionManager.createSession(gameId, playerId, aiPlayer.name);
+        game->players.back().sessionToken = sessionManager.createSession(gameId, playerId, aiPlayer.name);
         
         addedIds.push_back(playerId);
     }
@@ -321,264 +227,79 @@ std::string handleAddAIPlayers(const HTTPRequest& req, const std::string& gameId
     return jsonResponse(200, json.str());
 }
 
-std::string phaseToString(catan::GamePhase phase) {
-    switch (phase) {
-        case catan::GamePhase::WaitingForPlayers: return "waiting_for_players";
-        case catan::GamePhase::Setup: return "setup";
-        case catan::GamePhase::SetupReverse: return "setup_reverse";
-        case catan::GamePhase::Rolling: return "rolling";
-        case catan::GamePhase::Robber: return "robber";
-        case catan::GamePhase::Stealing: return "stealing";
-        case catan::GamePhase::MainTurn: return "main_turn";
-        case catan::GamePhase::Trading: return "trading";
-        case catan::GamePhase::Finished: return "finished";
-        default: return "unknown";
-    }
-}
-
-std::string hexTypeToString(catan::HexType type) {
-    switch (type) {
-        case catan::HexType::Desert: return "desert";
-        case catan::HexType::Forest: return "forest";
-        case catan::HexType::Hills: return "hills";
-        case catan::HexType::Fields: return "fields";
-        case catan::HexType::Pasture: return "pasture";
-        case catan::HexType::Mountains: return "mountains";
-        case catan::HexType::Ocean: return "ocean";
-        default: return "unknown";
-    }
-}
-
-std::string portTypeToString(catan::PortType type) {
-    switch (type) {
-        case catan::PortType::Generic: return "generic";
-        case catan::PortType::Wood: return "wood";
-        case catan::PortType::Brick: return "brick";
-        case catan::PortType::Wheat: return "wheat";
-        case catan::PortType::Sheep: return "sheep";
-        case catan::PortType::Ore: return "ore";
-        default: return "generic";
-    }
-}
-
-std::string handleGetGameState(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleGetGameState(const HTTPRequest& req, const std::string& gameId) {
     // Validate session
-    catan::Session* session = sessionManager.getSession(req.authToken);
+    catan::SharedSession session = sessionManager.getSession(req.authToken);
     if (!session || session->gameId != gameId) {
         return jsonResponse(401, "{\"error\":\"Unauthorized\"}");
     }
     
-    catan::Game* game = gameManager.getGame(gameId);
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
         return jsonResponse(404, "{\"error\":\"Game not found\"}");
     }
     
-    std::lock_guard<std::mutex> lock(game->mutex);
-    
-    // Build comprehensive game state JSON
-    std::ostringstream json;
-    json << "{"
-         << "\"gameId\":\"" << game->gameId << "\","
-         << "\"phase\":\"" << phaseToString(game->phase) << "\","
-         << "\"currentPlayer\":" << game->currentPlayerIndex << ","
-         << "\"playerCount\":" << game->players.size() << ","
-         << "\"yourPlayerId\":" << session->playerId << ","
-         << "\"setupRound\":" << game->setupRound;
-    
-    // Include this player's resources
-    if (session->playerId < (int)game->players.size()) {
-        auto& player = game->players[session->playerId];
-        json << ",\"resources\":{"
-             << "\"wood\":" << player.resources.wood << ","
-             << "\"brick\":" << player.resources.brick << ","
-             << "\"wheat\":" << player.resources.wheat << ","
-             << "\"sheep\":" << player.resources.sheep << ","
-             << "\"ore\":" << player.resources.ore
-             << "}";
-        
-        // Include dev cards
-        json << ",\"devCards\":[";
-        for (size_t i = 0; i < player.devCards.size(); i++) {
-            if (i > 0) json << ",";
-            switch (player.devCards[i]) {
-                case catan::DevCardType::Knight: json << "\"knight\""; break;
-                case catan::DevCardType::VictoryPoint: json << "\"victory_point\""; break;
-                case catan::DevCardType::RoadBuilding: json << "\"road_building\""; break;
-                case catan::DevCardType::YearOfPlenty: json << "\"year_of_plenty\""; break;
-                case catan::DevCardType::Monopoly: json << "\"monopoly\""; break;
-            }
-        }
-        json << "]";
-        
-        // Include building counts
-        json << ",\"settlementsRemaining\":" << player.settlementsRemaining;
-        json << ",\"citiesRemaining\":" << player.citiesRemaining;
-        json << ",\"roadsRemaining\":" << player.roadsRemaining;
-    }
-    
-    // Include last roll if any
-    if (game->lastRoll) {
-        json << ",\"lastRoll\":{\"die1\":" << game->lastRoll->die1 
-             << ",\"die2\":" << game->lastRoll->die2 
-             << ",\"total\":" << game->lastRoll->total() << "}";
-    }
-    
-    // Include all players info
-    json << ",\"players\":[";
-    for (size_t i = 0; i < game->players.size(); i++) {
-        auto& p = game->players[i];
-        if (i > 0) json << ",";
-        json << "{\"id\":" << p.id
-             << ",\"name\":\"" << p.name << "\""
-             << ",\"type\":\"" << (p.playerType == catan::PlayerType::AI ? "ai" : "human") << "\""
-             << ",\"resourceCount\":" << p.resources.total()
-             << ",\"devCardCount\":" << p.devCards.size()
-             << ",\"knightsPlayed\":" << p.knightsPlayed
-             << ",\"hasLongestRoad\":" << (p.hasLongestRoad ? "true" : "false")
-             << ",\"hasLargestArmy\":" << (p.hasLargestArmy ? "true" : "false")
-             << ",\"victoryPoints\":" << catan::calculateVisibleVictoryPoints(*game, p.id)
-             << ",\"settlementsRemaining\":" << p.settlementsRemaining
-             << ",\"citiesRemaining\":" << p.citiesRemaining
-             << ",\"roadsRemaining\":" << p.roadsRemaining
-             << "}";
-    }
-    json << "]";
-    
-    // Include board hexes
-    json << ",\"hexes\":[";
-    bool firstHex = true;
-    for (const auto& [coord, hex] : game->board.hexes) {
-        if (!firstHex) json << ",";
-        firstHex = false;
-        json << "{\"q\":" << coord.q << ",\"r\":" << coord.r
-             << ",\"type\":\"" << hexTypeToString(hex.type) << "\""
-             << ",\"numberToken\":" << hex.numberToken
-             << ",\"hasRobber\":" << (hex.hasRobber ? "true" : "false")
-             << "}";
-    }
-    json << "]";
+    const int viewerId = session->playerId;
     
-    // Include vertices with buildings
-    json << ",\"vertices\":[";
-    bool firstVertex = true;
-    for (const auto& [coord, vertex] : game->board.vertices) {
-        if (vertex.building != catan::Building::None) {
-            if (!firstVertex) json << ",";
-            firstVertex = false;
-            json << "{\"hexQ\":" << coord.hex.q << ",\"hexR\":" << coord.hex.r
-                 << ",\"direction\":" << coord.direction
-                 << ",\"building\":\"" << (vertex.building == catan::Building::Settlement ? "settlement" : "city") << "\""
-                 << ",\"playerId\":" << vertex.ownerPlayerId
-                 << "}";
+    // Unchanged since the client's copy: answer from the version alone,
+    // without the game lock
+    auto etagFor = [viewerId](uint64_t version) {
+        return "\"" + std::to_string(version) + "-" + std::to_string(viewerId) + "\"";
+    };
+    auto ifNoneMatch = req.headers.find("if-none-match");
+    if (ifNoneMatch != req.headers.end()) {
+        std::string etag = etagFor(game->version.load());
+        if (ifNoneMatch->second.find(etag) != std::string::npos) {
+            HTTPResponse notModified = jsonResponse(304, "");
+            notModified.headers = "ETag: " + etag + "\r\nCache-Control: no-cache\r\n";
+            return notModified;
         }
     }
-    json << "]";
     
-    // Include edges with roads
-    json << ",\"edges\":[";
-    bool firstEdge = true;
-    for (const auto& [coord, edge] : game->board.edges) {
-        if (edge.hasRoad) {
-            if (!firstEdge) json << ",";
-            firstEdge = false;
-            json << "{\"hexQ\":" << coord.hex.q << ",\"hexR\":" << coord.hex.r
-                 << ",\"direction\":" << coord.direction
-                 << ",\"playerId\":" << edge.ownerPlayerId
-                 << "}";
-        }
+    // Snapshots are cached per version; the lock is only taken to build one
+    catan::SharedGameState snapshot = catan::findCachedGameState(*game, viewerId);
+    if (!snapshot) {
+        catan::GameLock lock(*game, catan::GameLock::Mode::Read);
+        snapshot = catan::cachedGameState(*game, viewerId);
     }
-    json << "]";
     
-    // Include ports
-    json << ",\"ports\":[";
-    for (size_t i = 0; i < game->board.ports.size(); i++) {
-        auto& port = game->board.ports[i];
-        if (i > 0) json << ",";
-        json << "{\"type\":\"" << portTypeToString(port.type) << "\""
-             << ",\"v1q\":" << port.vertex1.hex.q << ",\"v1r\":" << port.vertex1.hex.r
-             << ",\"v1d\":" << port.vertex1.direction
-             << ",\"v2q\":" << port.vertex2.hex.q << ",\"v2r\":" << port.vertex2.hex.r
-             << ",\"v2d\":" << port.vertex2.direction
-             << "}";
-    }
-    json << "]";
+    HTTPResponse response = jsonResponse(200, snapshot->json);
+    response.headers = "ETag: " + etagFor(snapshot->version) + "\r\nCache-Control: no-cache\r\n";
+    return response;
+}
+
+HTTPResponse handleListGames(const HTTPRequest& req) {
+    auto games = gameManager.listGames();
     
-    // Include robber location
-    json << ",\"robberLocation\":{\"q\":" << game->board.robberLocation.q 
-         << ",\"r\":" << game->board.robberLocation.r << "}";
-    
-    // Include winner if game is finished
-    int winner = catan::checkForWinner(*game);
-    if (winner >= 0) {
-        json << ",\"winner\":" << winner;
-    }
-    
-    // Include valid build locations if it's this player's turn
-    if (game->currentPlayerIndex == session->playerId) {
-        if (game->phase == catan::GamePhase::Setup || game->phase == catan::GamePhase::SetupReverse) {
-            // Setup phase - valid settlement locations
-            auto validSettlements = catan::getValidSetupSettlementLocations(*game);
-            json << ",\"validSettlementLocations\":[";
-            for (size_t i = 0; i < validSettlements.size(); i++) {
-                if (i > 0) json << ",";
-                json << "{\"hexQ\":" << validSettlements[i].hex.q
-                     << ",\"hexR\":" << validSettlements[i].hex.r
-                     << ",\"direction\":" << validSettlements[i].direction << "}";
-            }
-            json << "]";
-        } else if (game->phase == catan::GamePhase::MainTurn) {
-            // Main turn - valid build locations
-            auto& player = game->players[session->playerId];
-            
-            // Valid settlement locations
-            if (canAfford(player.resources, SETTLEMENT_COST) && player.settlementsRemaining > 0) {
-                auto validSettlements = catan::getValidSettlementLocations(*game, session->playerId);
-                json << ",\"validSettlementLocations\":[";
-                for (size_t i = 0; i < validSettlements.size(); i++) {
-                    if (i > 0) json << ",";
-                    json << "{\"hexQ\":" << validSettlements[i].hex.q
-                         << ",\"hexR\":" << validSettlements[i].hex.r
-                         << ",\"direction\":" << validSettlements[i].direction << "}";
-                }
-                json << "]";
-            }
-            
-            // Valid road locations
-            if (canAfford(player.resources, ROAD_COST) && player.roadsRemaining > 0) {
-                auto validRoads = catan::getValidRoadLocations(*game, session->playerId);
-                json << ",\"validRoadLocations\":[";
-                for (size_t i = 0; i < validRoads.size(); i++) {
-                    if (i > 0) json << ",";
-                    json << "{\"hexQ\":" << validRoads[i].hex.q
-                         << ",\"hexR\":" << validRoads[i].hex.r
-                         << ",\"direction\":" << validRoads[i].direction << "}";
-                }
-                json << "]";
-            }
-            
-            // Valid city locations
-            if (canAfford(player.resources, CITY_COST) && player.citiesRemaining > 0) {
-                auto validCities = catan::getValidCityLocations(*game, session->playerId);
-                json << ",\"validCityLocations\":[";
-                for (size_t i = 0; i < validCities.size(); i++) {
-                    if (i > 0) json << ",";
-                    json << "{\"hexQ\":" << validCities[i].hex.q
-                         << ",\"hexR\":" << validCities[i].hex.r
-                         << ",\"direction\":" << validCities[i].direction << "}";
+    // In a cluster the node asked collects every node's local list; the
+    // other nodes are asked with a hop count so they answer for themselves
+    if (cluster && req.headers.get(catan::CLUSTER_HOPS_HEADER).empty()) {
+        std::vector<std::future<std::vector<std::string>>> remote;
+        for (int node = 0; node < cluster->nodeCount(); node++) {
+            if (node == cluster->self()) continue;
+            remote.push_back(std::async(std::launch::async, [node]() {
+                std::vector<std::string> ids;
+                try {
+                    auto reply = cluster->send(node, "GET", "/games", "", {{catan::CLUSTER_HOPS_HEADER, "1"}});
+                    catan::JsonValue listing = catan::JsonValue::parse(reply.body);
+                    for (const auto& id : listing["games"].items()) {
+                        ids.push_back(id.asString());
+                    }
+                } catch (const std::exception&) {
+                    // An unreachable node's games are left out of the listing
                 }
-                json << "]";
+                return ids;
+            }));
+        }
+        std::unordered_set<std::string> seen(games.begin(), games.end());
+        for (auto& ids : remote) {
+            for (auto& id : ids.get()) {
+                // A game mid-move may be listed by both nodes
+                if (seen.insert(id).second) games.push_back(std::move(id));
             }
         }
     }
     
-    json << "}";
-    
-    return jsonResponse(200, json.str());
-}
-
-std::string handleListGames(const HTTPRequest& req) {
-    auto games = gameManager.listGames();
-    
     std::ostringstream json;
     json << "{\"games\":[";
     for (size_t i = 0; i < games.size(); i++) {
@@ -596,9 +317,9 @@ std::string handleListGames(const HTTPRequest& req) {
 
 // Validates session and returns game/player, or error response
 struct GameContext {
-    catan::Game* game = nullptr;
+    std::shared_ptr<catan::Game> game;
     catan::Player* player = nullptr;
-    catan::Session* session = nullptr;
+    catan::SharedSession session;
     std::string error;
     int errorCode = 0;
 };
@@ -636,393 +357,242 @@ GameContext getGameContext(const HTTPRequest& req, const std::string& gameId, bo
     return ctx;
 }
 
+// Reads an action's arguments from the request body, which spells them as
+// the AI tools do
+catan::Action requestAction(catan::ActionType type, const HTTPRequest& req, int playerId) {
+    return catan::ai::actionFromArguments(type, req.json(), playerId);
+}
+
+// Applies an action through the rules engine and sends its chat and trade
+// events. Call with the game lock held.
+catan::ActionResult applyGameAction(catan::Game& game, const catan::Action& action) {
+    catan::ActionResult result = catan::applyAction(game, action);
+    catan::GameEvents::broadcastActionEvents(game, action, result);
+    return result;
+}
+
+HTTPResponse actionErrorResponse(const catan::Action& action, const catan::ActionResult& result) {
+    catan::JsonWriter json;
+    json.beginObject();
+    json.key("error").value(catan::actionErrorMessage(result.error, action.type));
+    json.endObject();
+    return jsonResponse(catan::actionErrorStatus(result.error), json.take());
+}
+
+// What an applied action did, as members of the response object. Board
+// locations are in canonical spelling.
+void writeActionOutcome(catan::JsonWriter& json, const catan::Game& game, const catan::Action& action,
+                        const catan::ActionResult& result) {
+    const catan::BoardTopology& topo = catan::boardTopology();
+    switch (action.type) {
+        case catan::ActionType::RollDice:
+            json.key("die1").value(result.roll.die1);
+            json.key("die2").value(result.roll.die2);
+            json.key("total").value(result.roll.total());
+            if (result.roll.total() == 7) json.key("robber").value(true);
+            break;
+        case catan::ActionType::EndTurn:
+            json.key("nextPlayer").value(result.nextPlayer);
+            json.key("nextPlayerIsAI").value(game.players[result.nextPlayer].isAI());
+            break;
+        case catan::ActionType::PlaceSetupSettlement:
+        case catan::ActionType::BuildSettlement:
+        case catan::ActionType::BuildCity:
+            catan::writeLocationFields(json, topo.vertexCoords[action.vertex].hex, topo.vertexCoords[action.vertex].direction);
+            break;
+        case catan::ActionType::PlaceSetupRoad:
+        case catan::ActionType::BuildRoad:
+            catan::writeLocationFields(json, topo.edgeCoords[action.edge].hex, topo.edgeCoords[action.edge].direction);
+            if (result.nextPlayer >= 0) json.key("nextPlayer").value(result.nextPlayer);
+            break;
+        case catan::ActionType::BuyDevCard:
+            json.key("card").value(devCardToString(result.card));
+            break;
+        case catan::ActionType::BankTrade:
+            json.key("gave").value(resourceToString(action.give));
+            json.key("gaveAmount").value(result.ratio);
+            json.key("received").value(resourceToString(action.receive));
+            json.key("receivedAmount").value(1);
+            break;
+        case catan::ActionType::MoveRobber:
+            json.key("hexQ").value(topo.hexCoords[action.hex].q);
+            json.key("hexR").value(topo.hexCoords[action.hex].r);
+            json.key("stolenResource").value(resourceToString(result.stolen));
+            break;
+        case catan::ActionType::SendChat:
+            json.key("messageId").value(std::to_string(result.chatMessageId));
+            break;
+        case catan::ActionType::ProposeTrade:
+        case catan::ActionType::RejectTrade:
+        case catan::ActionType::CancelTrade:
+            json.key("tradeId").value(result.tradeId);
+            break;
+        case catan::ActionType::AcceptTrade:
+            json.key("tradeId").value(result.tradeId);
+            json.key("executed").value(true);
+            break;
+        case catan::ActionType::CounterTrade:
+            json.key("counterTradeId").value(result.tradeId);
+            break;
+        case catan::ActionType::Count:
+            break;
+    }
+    if (result.winner >= 0) json.key("winner").value(result.winner);
+}
+
+// Starts server-side AI turn processing for the game; true if it started
+bool startAITurns(const std::string& gameId) {
+    auto executor = getOrCreateAIExecutor(gameId);
+    return executor && executor->startProcessing();
+}
+
 // ============================================================================
 // GAME ACTIONS
 // ============================================================================
 
-std::string handleRollDice(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleRollDice(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    if (ctx.game->phase != catan::GamePhase::Rolling) {
-        return jsonResponse(400, "{\"error\":\"Cannot roll now, phase is not Rolling\"}");
-    }
-    
-    // Roll two dice
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> die(1, 6);
+    catan::GameLock lock(*ctx.game);
     
-    catan::DiceRoll roll;
-    roll.die1 = die(gen);
-    roll.die2 = die(gen);
-    ctx.game->lastRoll = roll;
+    catan::Action action = requestAction(catan::ActionType::RollDice, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
-    int total = roll.total();
+    const catan::DiceRoll& roll = result.roll;
+    std::string dice = "{\"die1\":" + std::to_string(roll.die1) +
+                       ",\"die2\":" + std::to_string(roll.die2) +
+                       ",\"total\":" + std::to_string(roll.total());
     
     // Handle roll of 7 (robber)
-    if (total == 7) {
+    if (roll.total() == 7) {
         // Players with > 7 cards must discard half (TODO: implement discard phase)
-        ctx.game->phase = catan::GamePhase::Robber;
-        return jsonResponse(200, 
-            "{\"die1\":" + std::to_string(roll.die1) + 
-            ",\"die2\":" + std::to_string(roll.die2) + 
-            ",\"total\":7,\"robber\":true}");
+        return jsonResponse(200, dice + ",\"robber\":true}");
     }
     
-    // Distribute resources based on roll
+    // Resources paid out by the roll
     std::ostringstream production;
     production << ",\"production\":{";
     bool first = true;
     
-    for (const auto& [coord, hex] : ctx.game->board.hexes) {
-        if (hex.numberToken == total && !hex.hasRobber) {
-            catan::Resource resource = catan::hexTypeToResource(hex.type);
-            if (resource == catan::Resource::None) continue;
-            
-            // Find all settlements/cities on this hex's vertices
-            for (int dir = 0; dir < 6; dir++) {
-                catan::VertexCoord vc{coord, dir};
-                auto it = ctx.game->board.vertices.find(vc);
-                if (it != ctx.game->board.vertices.end() && it->second.ownerPlayerId >= 0) {
-                    catan::Player* owner = ctx.game->getPlayerById(it->second.ownerPlayerId);
-                    if (owner) {
-                        int amount = (it->second.building == catan::Building::City) ? 2 : 1;
-                        owner->resources[resource] += amount;
-                        
-                        if (!first) production << ",";
-                        first = false;
-                        production << "\"" << owner->name << "_" << resourceToString(resource) << "\":" << amount;
-                    }
-                }
-            }
-        }
+    for (const auto& entry : *result.production) {
+        catan::Player* owner = ctx.game->getPlayerById(entry.playerId);
+        if (!owner) continue;
+        if (!first) production << ",";
+        first = false;
+        production << "\"" << catan::escapeJson(owner->name) << "_" << resourceToString(entry.resource) << "\":" << entry.amount;
     }
     production << "}";
     
-    ctx.game->phase = catan::GamePhase::MainTurn;
-    
-    return jsonResponse(200, 
-        "{\"die1\":" + std::to_string(roll.die1) + 
-        ",\"die2\":" + std::to_string(roll.die2) + 
-        ",\"total\":" + std::to_string(total) +
-        production.str() + "}");
+    return jsonResponse(200, dice + production.str() + "}");
 }
 
-std::string handleBuyRoad(const HTTPRequest& req, const std::string& gameId) {
+// The three building handlers differ only in the action and the count they report
+HTTPResponse handleBuild(const HTTPRequest& req, const std::string& gameId, catan::ActionType type) {
     GameContext ctx = getGameContext(req, gameId);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    if (ctx.game->phase != catan::GamePhase::MainTurn) {
-        return jsonResponse(400, "{\"error\":\"Cannot build during this phase\"}");
-    }
-    
-    if (!canAfford(ctx.player->resources, ROAD_COST)) {
-        return jsonResponse(400, "{\"error\":\"Not enough resources. Road costs 1 wood + 1 brick\"}");
-    }
-    
-    if (ctx.player->roadsRemaining <= 0) {
-        return jsonResponse(400, "{\"error\":\"No roads remaining\"}");
-    }
+    catan::GameLock lock(*ctx.game);
     
-    // Parse location from request body
-    int hexQ = parseJsonInt(req.body, "hexQ", 0);
-    int hexR = parseJsonInt(req.body, "hexR", 0);
-    int direction = parseJsonInt(req.body, "direction", 0);
+    catan::Action action = requestAction(type, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
-    catan::EdgeCoord location{{hexQ, hexR}, direction};
-    
-    // Validate road placement
-    auto validLocations = catan::getValidRoadLocations(*ctx.game, ctx.session->playerId);
-    bool isValid = false;
-    for (const auto& loc : validLocations) {
-        if (loc.hex.q == hexQ && loc.hex.r == hexR && loc.direction == direction) {
-            isValid = true;
+    std::string built;
+    switch (type) {
+        case catan::ActionType::BuildRoad:
+            built = "\"message\":\"Road built\",\"roadsRemaining\":" + std::to_string(ctx.player->roadsRemaining);
+            break;
+        case catan::ActionType::BuildSettlement:
+            built = "\"message\":\"Settlement built\",\"settlementsRemaining\":" +
+                    std::to_string(ctx.player->settlementsRemaining);
+            break;
+        default:
+            built = "\"message\":\"City built\",\"citiesRemaining\":" + std::to_string(ctx.player->citiesRemaining);
             break;
-        }
-    }
-    
-    if (!isValid) {
-        return jsonResponse(400, "{\"error\":\"Invalid road location. Must connect to your network.\"}");
-    }
-    
-    // Place the road
-    auto it = ctx.game->board.edges.find(location);
-    if (it == ctx.game->board.edges.end()) {
-        return jsonResponse(400, "{\"error\":\"Invalid edge location\"}");
-    }
-    
-    it->second.hasRoad = true;
-    it->second.ownerPlayerId = ctx.session->playerId;
-    subtractResources(ctx.player->resources, ROAD_COST);
-    ctx.player->roadsRemaining--;
-    
-    // Update longest road
-    catan::updateLongestRoad(*ctx.game);
-    
-    // Check for winner
-    int winner = catan::checkForWinner(*ctx.game);
-    if (winner >= 0) {
-        ctx.game->phase = catan::GamePhase::Finished;
     }
     
-    return jsonResponse(200, 
-        "{\"success\":true,\"message\":\"Road built\","
-        "\"roadsRemaining\":" + std::to_string(ctx.player->roadsRemaining) + ","
-        "\"hexQ\":" + std::to_string(hexQ) + ","
-        "\"hexR\":" + std::to_string(hexR) + ","
-        "\"direction\":" + std::to_string(direction) + "}");
+    const catan::JsonValue& body = req.json();
+    return jsonResponse(200, "{\"success\":true," + built + "," +
+        locationFields({body.getInt("hexQ", 0), body.getInt("hexR", 0)}, body.getInt("direction", 0)) + "}");
 }
 
-std::string handleBuySettlement(const HTTPRequest& req, const std::string& gameId) {
-    GameContext ctx = getGameContext(req, gameId);
-    if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
-    
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    if (ctx.game->phase != catan::GamePhase::MainTurn) {
-        return jsonResponse(400, "{\"error\":\"Cannot build during this phase\"}");
-    }
-    
-    if (!canAfford(ctx.player->resources, SETTLEMENT_COST)) {
-        return jsonResponse(400, "{\"error\":\"Not enough resources. Settlement costs 1 wood + 1 brick + 1 wheat + 1 sheep\"}");
-    }
-    
-    if (ctx.player->settlementsRemaining <= 0) {
-        return jsonResponse(400, "{\"error\":\"No settlements remaining\"}");
-    }
-    
-    // Parse location from request body
-    int hexQ = parseJsonInt(req.body, "hexQ", 0);
-    int hexR = parseJsonInt(req.body, "hexR", 0);
-    int direction = parseJsonInt(req.body, "direction", 0);
-    
-    catan::VertexCoord location{{hexQ, hexR}, direction};
-    
-    // Validate settlement placement
-    auto validLocations = catan::getValidSettlementLocations(*ctx.game, ctx.session->playerId);
-    bool isValid = false;
-    for (const auto& loc : validLocations) {
-        if (loc.hex.q == hexQ && loc.hex.r == hexR && loc.direction == direction) {
-            isValid = true;
-            break;
-        }
-    }
-    
-    if (!isValid) {
-        return jsonResponse(400, "{\"error\":\"Invalid settlement location. Must be on your road network and 2+ edges from other buildings.\"}");
-    }
-    
-    // Place the settlement
-    auto it = ctx.game->board.vertices.find(location);
-    if (it == ctx.game->board.vertices.end()) {
-        return jsonResponse(400, "{\"error\":\"Invalid vertex location\"}");
-    }
-    
-    it->second.building = catan::Building::Settlement;
-    it->second.ownerPlayerId = ctx.session->playerId;
-    subtractResources(ctx.player->resources, SETTLEMENT_COST);
-    ctx.player->settlementsRemaining--;
-    
-    // Check for winner
-    int winner = catan::checkForWinner(*ctx.game);
-    if (winner >= 0) {
-        ctx.game->phase = catan::GamePhase::Finished;
-    }
-    
-    return jsonResponse(200, 
-        "{\"success\":true,\"message\":\"Settlement built\","
-        "\"settlementsRemaining\":" + std::to_string(ctx.player->settlementsRemaining) + ","
-        "\"hexQ\":" + std::to_string(hexQ) + ","
-        "\"hexR\":" + std::to_string(hexR) + ","
-        "\"direction\":" + std::to_string(direction) + "}");
+HTTPResponse handleBuyRoad(const HTTPRequest& req, const std::string& gameId) {
+    return handleBuild(req, gameId, catan::ActionType::BuildRoad);
 }
 
-std::string handleBuyCity(const HTTPRequest& req, const std::string& gameId) {
-    GameContext ctx = getGameContext(req, gameId);
-    if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
-    
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    if (ctx.game->phase != catan::GamePhase::MainTurn) {
-        return jsonResponse(400, "{\"error\":\"Cannot build during this phase\"}");
-    }
-    
-    if (!canAfford(ctx.player->resources, CITY_COST)) {
-        return jsonResponse(400, "{\"error\":\"Not enough resources. City costs 2 wheat + 3 ore\"}");
-    }
-    
-    if (ctx.player->citiesRemaining <= 0) {
-        return jsonResponse(400, "{\"error\":\"No cities remaining\"}");
-    }
-    
-    // Parse location from request body
-    int hexQ = parseJsonInt(req.body, "hexQ", 0);
-    int hexR = parseJsonInt(req.body, "hexR", 0);
-    int direction = parseJsonInt(req.body, "direction", 0);
-    
-    catan::VertexCoord location{{hexQ, hexR}, direction};
-    
-    // Validate city placement - must have your settlement there
-    auto validLocations = catan::getValidCityLocations(*ctx.game, ctx.session->playerId);
-    bool isValid = false;
-    for (const auto& loc : validLocations) {
-        if (loc.hex.q == hexQ && loc.hex.r == hexR && loc.direction == direction) {
-            isValid = true;
-            break;
-        }
-    }
-    
-    if (!isValid) {
-        return jsonResponse(400, "{\"error\":\"Invalid city location. Must upgrade your own settlement.\"}");
-    }
-    
-    // Upgrade to city
-    auto it = ctx.game->board.vertices.find(location);
-    if (it == ctx.game->board.vertices.end()) {
-        return jsonResponse(400, "{\"error\":\"Invalid vertex location\"}");
-    }
-    
-    it->second.building = catan::Building::City;
-    subtractResources(ctx.player->resources, CITY_COST);
-    ctx.player->citiesRemaining--;
-    ctx.player->settlementsRemaining++; // Get settlement back
-    
-    // Check for winner
-    int winner = catan::checkForWinner(*ctx.game);
-    if (winner >= 0) {
-        ctx.game->phase = catan::GamePhase::Finished;
-    }
-    
-    return jsonResponse(200, 
-        "{\"success\":true,\"message\":\"City built\","
-        "\"citiesRemaining\":" + std::to_string(ctx.player->citiesRemaining) + ","
-        "\"hexQ\":" + std::to_string(hexQ) + ","
-        "\"hexR\":" + std::to_string(hexR) + ","
-        "\"direction\":" + std::to_string(direction) + "}");
+HTTPResponse handleBuySettlement(const HTTPRequest& req, const std::string& gameId) {
+    return handleBuild(req, gameId, catan::ActionType::BuildSettlement);
+}
+
+HTTPResponse handleBuyCity(const HTTPRequest& req, const std::string& gameId) {
+    return handleBuild(req, gameId, catan::ActionType::BuildCity);
 }
 
-std::string handleBuyDevCard(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleBuyDevCard(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
+    catan::GameLock lock(*ctx.game);
     
-    if (ctx.game->phase != catan::GamePhase::MainTurn) {
-        return jsonResponse(400, "{\"error\":\"Cannot buy during this phase\"}");
-    }
-    
-    if (!canAfford(ctx.player->resources, DEV_CARD_COST)) {
-        return jsonResponse(400, "{\"error\":\"Not enough resources. Dev card costs 1 wheat + 1 sheep + 1 ore\"}");
-    }
-    
-    if (ctx.game->devCardDeck.empty()) {
-        return jsonResponse(400, "{\"error\":\"No development cards remaining\"}");
-    }
-    
-    subtractResources(ctx.player->resources, DEV_CARD_COST);
-    
-    // Draw from deck
-    catan::DevCardType card = ctx.game->devCardDeck.back();
-    ctx.game->devCardDeck.pop_back();
-    ctx.player->devCards.push_back(card);
-    
-    // Card type names for response
-    std::string cardName;
-    switch (card) {
-        case catan::DevCardType::Knight: cardName = "knight"; break;
-        case catan::DevCardType::VictoryPoint: cardName = "victory_point"; break;
-        case catan::DevCardType::RoadBuilding: cardName = "road_building"; break;
-        case catan::DevCardType::YearOfPlenty: cardName = "year_of_plenty"; break;
-        case catan::DevCardType::Monopoly: cardName = "monopoly"; break;
-    }
+    catan::Action action = requestAction(catan::ActionType::BuyDevCard, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
     return jsonResponse(200, 
-        "{\"success\":true,\"card\":\"" + cardName + "\","
+        "{\"success\":true,\"card\":\"" + devCardToString(result.card) + "\","
         "\"cardsInDeck\":" + std::to_string(ctx.game->devCardDeck.size()) + "}");
 }
 
-std::string handleBankTrade(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleBankTrade(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    if (ctx.game->phase != catan::GamePhase::MainTurn) {
-        return jsonResponse(400, "{\"error\":\"Cannot trade during this phase\"}");
-    }
-    
-    // Parse trade request: {"give":"wood","receive":"ore"}
-    std::string giveStr = parseJsonString(req.body, "give");
-    std::string receiveStr = parseJsonString(req.body, "receive");
+    catan::GameLock lock(*ctx.game);
     
-    catan::Resource give = stringToResource(giveStr);
-    catan::Resource receive = stringToResource(receiveStr);
+    // Trade request: {"give":"wood","receive":"ore"}
+    catan::Action action = requestAction(catan::ActionType::BankTrade, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    std::string giveStr = resourceToString(action.give);
+    std::string receiveStr = resourceToString(action.receive);
     
-    if (give == catan::Resource::None || receive == catan::Resource::None) {
-        return jsonResponse(400, "{\"error\":\"Invalid resources. Use: wood, brick, wheat, sheep, ore\"}");
-    }
-    
-    if (give == receive) {
-        return jsonResponse(400, "{\"error\":\"Cannot trade same resource\"}");
-    }
-    
-    // Determine trade ratio based on ports (2:1 specific, 3:1 generic, 4:1 default)
-    int ratio = catan::getTradeRatio(*ctx.game, ctx.session->playerId, give);
-    
-    if (ctx.player->resources[give] < ratio) {
+    if (result.error == catan::ActionError::NotEnoughResources) {
         return jsonResponse(400, 
-            "{\"error\":\"Not enough " + giveStr + ". Need " + std::to_string(ratio) + " for bank trade\"}");
+            "{\"error\":\"Not enough " + giveStr + ". Need " + std::to_string(result.ratio) + " for bank trade\"}");
     }
-    
-    ctx.player->resources[give] -= ratio;
-    ctx.player->resources[receive] += 1;
+    if (!result.ok()) return actionErrorResponse(action, result);
     
     return jsonResponse(200, 
         "{\"success\":true,"
-        "\"traded\":{\"gave\":\"" + giveStr + "\",\"gaveAmount\":" + std::to_string(ratio) + 
+        "\"traded\":{\"gave\":\"" + giveStr + "\",\"gaveAmount\":" + std::to_string(result.ratio) + 
         ",\"received\":\"" + receiveStr + "\",\"receivedAmount\":1}}");
 }
 
-std::string handleEndTurn(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleEndTurn(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
+    catan::GameLock lock(*ctx.game);
     
-    if (ctx.game->phase != catan::GamePhase::MainTurn) {
-        return jsonResponse(400, "{\"error\":\"Cannot end turn during this phase\"}");
-    }
-    
-    // Advance to next player
-    ctx.game->currentPlayerIndex = (ctx.game->currentPlayerIndex + 1) % ctx.game->players.size();
-    ctx.game->phase = catan::GamePhase::Rolling;
-    ctx.game->devCardPlayedThisTurn = false;
+    catan::Action action = requestAction(catan::ActionType::EndTurn, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
     catan::Player* nextPlayer = ctx.game->getCurrentPlayer();
     
     // Check if the next player is AI
-    catan::ai::AIPlayerManager aiManager(ctx.game);
+    catan::ai::AIPlayerManager aiManager(ctx.game.get());
     bool nextIsAI = aiManager.isCurrentPlayerAI();
     int nextHumanIndex = aiManager.getNextHumanPlayerIndex();
     
     // If next player is AI, automatically start AI turn processing
-    bool aiProcessingStarted = false;
-    if (nextIsAI) {
-        auto* executor = getOrCreateAIExecutor(gameId);
-        if (executor) {
-            aiProcessingStarted = executor->startProcessing();
-        }
-    }
+    bool aiProcessingStarted = nextIsAI && startAITurns(gameId);
     
     std::ostringstream json;
     json << "{\"success\":true";
     json << ",\"nextPlayer\":" << ctx.game->currentPlayerIndex;
-    json << ",\"nextPlayerName\":\"" << (nextPlayer ? nextPlayer->name : "unknown") << "\"";
+    json << ",\"nextPlayerName\":\"" << catan::escapeJson(nextPlayer ? nextPlayer->name : "unknown") << "\"";
     json << ",\"nextPlayerIsAI\":" << (nextIsAI ? "true" : "false");
     
     // If next player is AI, include info about when control returns to a human
@@ -1031,7 +601,7 @@ std::string handleEndTurn(const HTTPRequest& req, const std::string& gameId) {
         json << ",\"aiProcessingStarted\":" << (aiProcessingStarted ? "true" : "false");
         if (nextHumanIndex >= 0) {
             json << ",\"nextHumanPlayerIndex\":" << nextHumanIndex;
-            json << ",\"nextHumanPlayerName\":\"" << ctx.game->players[nextHumanIndex].name << "\"";
+            json << ",\"nextHumanPlayerName\":\"" << catan::escapeJson(ctx.game->players[nextHumanIndex].name) << "\"";
         }
     }
     
@@ -1044,530 +614,180 @@ std::string handleEndTurn(const HTTPRequest& req, const std::string& gameId) {
 // CHAT AND TRADE HANDLERS
 // ============================================================================
 
-std::string handleSendChat(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleSendChat(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId, false);  // Don't require turn
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    int toPlayerId = parseJsonInt(req.body, "toPlayerId", -1);
-    std::string message = parseJsonString(req.body, "message");
-    
-    if (message.empty()) {
-        return jsonResponse(400, "{\"error\":\"Message cannot be empty\"}");
-    }
-    
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    // Create chat message
-    catan::ChatMessage chatMsg;
-    chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-    chatMsg.fromPlayerId = ctx.session->playerId;
-    chatMsg.toPlayerId = toPlayerId;
-    chatMsg.content = message;
-    chatMsg.type = catan::ChatMessageType::Normal;
-    chatMsg.timestamp = std::chrono::steady_clock::now();
-    
-    ctx.game->chatMessages.push_back(chatMsg);
+    catan::GameLock lock(*ctx.game);
     
-    // Broadcast SSE event
-    catan::SSEEvent sseEvent = catan::GameEvents::createChatMessageEvent(
-        chatMsg.id,
-        chatMsg.fromPlayerId,
-        ctx.player->name,
-        chatMsg.toPlayerId,
-        chatMsg.content,
-        "normal"
-    );
-    catan::sseManager.broadcastToGame(gameId, sseEvent);
+    catan::Action action = requestAction(catan::ActionType::SendChat, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
     return jsonResponse(200, 
-        "{\"success\":true,\"messageId\":\"" + chatMsg.id + "\"}");
+        "{\"success\":true,\"messageId\":\"" + std::to_string(result.chatMessageId) + "\"}");
 }
 
-std::string handleGetChatHistory(const HTTPRequest& req, const std::string& gameId) {
+// GET /games/{id}/chat[?since=<id>][&limit=<n>]
+// Without since: the newest `limit` messages. With since: the oldest `limit`
+// messages after that id; pass nextSince back to page forward.
+HTTPResponse handleGetChatHistory(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId, false);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    std::ostringstream json;
-    json << "{\"messages\":[";
+    constexpr size_t DEFAULT_PAGE = 100;
+    constexpr size_t MAX_PAGE = 500;
+    const std::string sinceParam = req.queryParam("since");
+    const std::string limitParam = req.queryParam("limit");
+    const bool paging = !sinceParam.empty();
+    const uint64_t since = paging ? std::strtoull(sinceParam.c_str(), nullptr, 10) : 0;
+    size_t limit = limitParam.empty() ? DEFAULT_PAGE : std::strtoul(limitParam.c_str(), nullptr, 10);
+    limit = std::max<size_t>(1, std::min(limit, MAX_PAGE));
+    
+    catan::GameLock lock(*ctx.game, catan::GameLock::Mode::Read);
+    
+    const int viewerId = ctx.session->playerId;
+    catan::JsonWriter json(4096);
+    json.beginObject();
+    json.key("messages").beginArray();
+    
+    uint64_t lastId = since;
+    bool hasMore = false;
+    size_t written = 0;
+    auto writeMessage = [&](const catan::ChatEntry& msg) {
+        std::string senderName = "System";
+        if (msg.fromPlayerId >= 0 && msg.fromPlayerId < (int)ctx.game->players.size()) {
+            senderName = ctx.game->players[msg.fromPlayerId].name;
+        }
+        
+        const char* typeStr = "normal";
+        switch (msg.type) {
+            case catan::ChatMessageType::Normal: typeStr = "normal"; break;
+            case catan::ChatMessageType::TradeProposal: typeStr = "trade_proposal"; break;
+            case catan::ChatMessageType::TradeAccept: typeStr = "trade_accept"; break;
+            case catan::ChatMessageType::TradeReject: typeStr = "trade_reject"; break;
+            case catan::ChatMessageType::TradeCounter: typeStr = "trade_counter"; break;
+            case catan::ChatMessageType::System: typeStr = "system"; break;
+        }
+        
+        json.beginObject();
+        json.key("id").value(std::to_string(msg.id));
+        json.key("fromPlayerId").value(msg.fromPlayerId);
+        json.key("fromPlayerName").value(senderName);
+        json.key("toPlayerId").value(msg.toPlayerId);
+        json.key("content").value(msg.content);
+        json.key("type").value(typeStr);
+        json.key("relatedTradeId").value(msg.relatedTradeId);
+        json.endObject();
+        lastId = msg.id;
+    };
     
-    bool first = true;
-    for (const auto& msg : ctx.game->chatMessages) {
-        // Only show messages visible to this player
-        if (msg.toPlayerId == -1 || msg.toPlayerId == ctx.session->playerId || 
-            msg.fromPlayerId == ctx.session->playerId) {
-            if (!first) json << ",";
-            first = false;
-            
-            std::string senderName = "System";
-            if (msg.fromPlayerId >= 0 && msg.fromPlayerId < (int)ctx.game->players.size()) {
-                senderName = ctx.game->players[msg.fromPlayerId].name;
+    // Only show messages visible to this player
+    if (paging) {
+        ctx.game->chatMessages.forEachSince(since, [&](const catan::ChatEntry& msg) {
+            if (!msg.visibleTo(viewerId)) return true;
+            if (written == limit) {
+                hasMore = true;
+                return false;
             }
-            
-            std::string typeStr = "normal";
-            switch (msg.type) {
-                case catan::ChatMessageType::Normal: typeStr = "normal"; break;
-                case catan::ChatMessageType::TradeProposal: typeStr = "trade_proposal"; break;
-                case catan::ChatMessageType::TradeAccept: typeStr = "trade_accept"; break;
-                case catan::ChatMessageType::TradeReject: typeStr = "trade_reject"; break;
-                case catan::ChatMessageType::TradeCounter: typeStr = "trade_counter"; break;
-                case catan::ChatMessageType::System: typeStr = "system"; break;
-            }
-            
-            // Escape content
-            std::string escapedContent;
-            for (char c : msg.content) {
-                if (c == '"') escapedContent += "\\\"";
-                else if (c == '\\') escapedContent += "\\\\";
-                else if (c == '\n') escapedContent += "\\n";
-                else escapedContent += c;
-            }
-            
-            json << "{\"id\":\"" << msg.id << "\"";
-            json << ",\"fromPlayerId\":" << msg.fromPlayerId;
-            json << ",\"fromPlayerName\":\"" << senderName << "\"";
-            json << ",\"toPlayerId\":" << msg.toPlayerId;
-            json << ",\"content\":\"" << escapedContent << "\"";
-            json << ",\"type\":\"" << typeStr << "\"";
-            json << ",\"relatedTradeId\":" << msg.relatedTradeId;
-            json << "}";
-        }
+            writeMessage(msg);
+            written++;
+            return true;
+        });
+    } else {
+        auto visible = [viewerId](const catan::ChatEntry& msg) { return msg.visibleTo(viewerId); };
+        ctx.game->chatMessages.forEachRecent(limit, visible, writeMessage);
     }
     
-    json << "]}";
-    return jsonResponse(200, json.str());
+    // Everything up to the newest message has been seen unless the page was cut short
+    uint64_t nextSince = hasMore ? lastId : std::max(lastId, ctx.game->chatMessages.latestId());
+    
+    json.endArray();
+    json.key("nextSince").value(nextSince);
+    json.key("hasMore").value(hasMore);
+    json.endObject();
+    return jsonResponse(200, json.take());
 }
 
-std::string handleProposeTrade(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleProposeTrade(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId, false);  // Any player can propose
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    int toPlayerId = parseJsonInt(req.body, "toPlayerId", -1);
-    std::string message = parseJsonString(req.body, "message");
-    
-    // Parse offering resources
-    catan::ResourceHand offering;
-    offering.wood = parseJsonInt(req.body, "giveWood", 0);
-    offering.brick = parseJsonInt(req.body, "giveBrick", 0);
-    offering.wheat = parseJsonInt(req.body, "giveWheat", 0);
-    offering.sheep = parseJsonInt(req.body, "giveSheep", 0);
-    offering.ore = parseJsonInt(req.body, "giveOre", 0);
-    
-    // Parse requesting resources
-    catan::ResourceHand requesting;
-    requesting.wood = parseJsonInt(req.body, "wantWood", 0);
-    requesting.brick = parseJsonInt(req.body, "wantBrick", 0);
-    requesting.wheat = parseJsonInt(req.body, "wantWheat", 0);
-    requesting.sheep = parseJsonInt(req.body, "wantSheep", 0);
-    requesting.ore = parseJsonInt(req.body, "wantOre", 0);
-    
-    // Validate player has resources to offer
-    if (ctx.player->resources.wood < offering.wood ||
-        ctx.player->resources.brick < offering.brick ||
-        ctx.player->resources.wheat < offering.wheat ||
-        ctx.player->resources.sheep < offering.sheep ||
-        ctx.player->resources.ore < offering.ore) {
-        return jsonResponse(400, "{\"error\":\"You don't have enough resources to offer\"}");
-    }
-    
-    // Create trade offer
-    catan::TradeOffer trade;
-    trade.id = ctx.game->nextTradeId++;
-    trade.fromPlayerId = ctx.session->playerId;
-    trade.toPlayerId = toPlayerId;
-    trade.offering = offering;
-    trade.requesting = requesting;
-    trade.isActive = true;
-    
-    // Create accompanying chat message
-    catan::ChatMessage chatMsg;
-    chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-    chatMsg.fromPlayerId = ctx.session->playerId;
-    chatMsg.toPlayerId = toPlayerId;
-    chatMsg.type = catan::ChatMessageType::TradeProposal;
-    chatMsg.relatedTradeId = trade.id;
-    chatMsg.tradeOffering = offering;
-    chatMsg.tradeRequesting = requesting;
-    chatMsg.timestamp = std::chrono::steady_clock::now();
-    
-    // Build trade description message
-    std::ostringstream tradeDesc;
-    tradeDesc << "📦 Trade Proposal: Offering ";
-    bool firstOffer = true;
-    if (offering.wood > 0) { tradeDesc << offering.wood << " wood"; firstOffer = false; }
-    if (offering.brick > 0) { tradeDesc << (firstOffer ? "" : ", ") << offering.brick << " brick"; firstOffer = false; }
-    if (offering.wheat > 0) { tradeDesc << (firstOffer ? "" : ", ") << offering.wheat << " wheat"; firstOffer = false; }
-    if (offering.sheep > 0) { tradeDesc << (firstOffer ? "" : ", ") << offering.sheep << " sheep"; firstOffer = false; }
-    if (offering.ore > 0) { tradeDesc << (firstOffer ? "" : ", ") << offering.ore << " ore"; firstOffer = false; }
-    tradeDesc << " for ";
-    bool firstReq = true;
-    if (requesting.wood > 0) { tradeDesc << requesting.wood << " wood"; firstReq = false; }
-    if (requesting.brick > 0) { tradeDesc << (firstReq ? "" : ", ") << requesting.brick << " brick"; firstReq = false; }
-    if (requesting.wheat > 0) { tradeDesc << (firstReq ? "" : ", ") << requesting.wheat << " wheat"; firstReq = false; }
-    if (requesting.sheep > 0) { tradeDesc << (firstReq ? "" : ", ") << requesting.sheep << " sheep"; firstReq = false; }
-    if (requesting.ore > 0) { tradeDesc << (firstReq ? "" : ", ") << requesting.ore << " ore"; firstReq = false; }
-    if (!message.empty()) {
-        tradeDesc << " - \"" << message << "\"";
-    }
-    chatMsg.content = tradeDesc.str();
-    
-    trade.chatMessageId = chatMsg.id;
-    
-    ctx.game->tradeOffers.push_back(trade);
-    ctx.game->chatMessages.push_back(chatMsg);
-    
-    // Broadcast SSE events
-    catan::SSEEvent chatEvent = catan::GameEvents::createChatMessageEvent(
-        chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-        chatMsg.toPlayerId, chatMsg.content, "trade_proposal"
-    );
-    catan::sseManager.broadcastToGame(gameId, chatEvent);
-    
-    catan::SSEEvent tradeEvent = catan::GameEvents::createTradeProposedEvent(
-        trade.id, trade.fromPlayerId, ctx.player->name, trade.toPlayerId,
-        offering.wood, offering.brick, offering.wheat, offering.sheep, offering.ore,
-        requesting.wood, requesting.brick, requesting.wheat, requesting.sheep, requesting.ore,
-        message
-    );
-    catan::sseManager.broadcastToGame(gameId, tradeEvent);
+    catan::GameLock lock(*ctx.game);
+    
+    // {"toPlayerId", "giveWood"..."giveOre", "wantWood"..."wantOre", "message"}
+    catan::Action action = requestAction(catan::ActionType::ProposeTrade, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
     return jsonResponse(200, 
-        "{\"success\":true,\"tradeId\":" + std::to_string(trade.id) + 
-        ",\"messageId\":\"" + chatMsg.id + "\"}");
+        "{\"success\":true,\"tradeId\":" + std::to_string(result.tradeId) + 
+        ",\"messageId\":\"" + std::to_string(result.chatMessageId) + "\"}");
 }
 
-std::string handleAcceptTrade(const HTTPRequest& req, const std::string& gameId, int tradeId) {
-    GameContext ctx = getGameContext(req, gameId, false);
-    if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
-    
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    // Find the trade
-    catan::TradeOffer* trade = nullptr;
-    for (auto& t : ctx.game->tradeOffers) {
-        if (t.id == tradeId) {
-            trade = &t;
-            break;
-        }
-    }
-    
-    if (!trade) {
-        return jsonResponse(404, "{\"error\":\"Trade not found\"}");
-    }
-    
-    if (!trade->isActive) {
-        return jsonResponse(400, "{\"error\":\"Trade is no longer active\"}");
-    }
-    
-    if (trade->fromPlayerId == ctx.session->playerId) {
-        return jsonResponse(400, "{\"error\":\"Cannot accept your own trade\"}");
-    }
-    
-    // Check if trade is open or directed to this player
-    if (trade->toPlayerId != -1 && trade->toPlayerId != ctx.session->playerId) {
-        return jsonResponse(400, "{\"error\":\"This trade is not for you\"}");
-    }
-    
-    // Verify accepting player has resources
-    if (ctx.player->resources.wood < trade->requesting.wood ||
-        ctx.player->resources.brick < trade->requesting.brick ||
-        ctx.player->resources.wheat < trade->requesting.wheat ||
-        ctx.player->resources.sheep < trade->requesting.sheep ||
-        ctx.player->resources.ore < trade->requesting.ore) {
-        return jsonResponse(400, "{\"error\":\"You don't have enough resources\"}");
-    }
-    
-    // Verify proposer still has resources
-    catan::Player* proposer = ctx.game->getPlayerById(trade->fromPlayerId);
-    if (!proposer ||
-        proposer->resources.wood < trade->offering.wood ||
-        proposer->resources.brick < trade->offering.brick ||
-        proposer->resources.wheat < trade->offering.wheat ||
-        proposer->resources.sheep < trade->offering.sheep ||
-        proposer->resources.ore < trade->offering.ore) {
-        trade->isActive = false;
-        return jsonResponse(400, "{\"error\":\"Proposer no longer has the resources\"}");
-    }
-    
-    // Execute the trade!
-    // Proposer gives, acceptor receives
-    proposer->resources.wood -= trade->offering.wood;
-    proposer->resources.brick -= trade->offering.brick;
-    proposer->resources.wheat -= trade->offering.wheat;
-    proposer->resources.sheep -= trade->offering.sheep;
-    proposer->resources.ore -= trade->offering.ore;
-    
-    ctx.player->resources.wood += trade->offering.wood;
-    ctx.player->resources.brick += trade->offering.brick;
-    ctx.player->resources.wheat += trade->offering.wheat;
-    ctx.player->resources.sheep += trade->offering.sheep;
-    ctx.player->resources.ore += trade->offering.ore;
-    
-    // Acceptor gives, proposer receives
-    ctx.player->resources.wood -= trade->requesting.wood;
-    ctx.player->resources.brick -= trade->requesting.brick;
-    ctx.player->resources.wheat -= trade->requesting.wheat;
-    ctx.player->resources.sheep -= trade->requesting.sheep;
-    ctx.player->resources.ore -= trade->requesting.ore;
-    
-    proposer->resources.wood += trade->requesting.wood;
-    proposer->resources.brick += trade->requesting.brick;
-    proposer->resources.wheat += trade->requesting.wheat;
-    proposer->resources.sheep += trade->requesting.sheep;
-    proposer->resources.ore += trade->requesting.ore;
-    
-    // Mark trade as completed
-    trade->isActive = false;
-    trade->acceptedByPlayerIds.push_back(ctx.session->playerId);
-    
-    // Create chat message about accepted trade
-    catan::ChatMessage chatMsg;
-    chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-    chatMsg.fromPlayerId = ctx.session->playerId;
-    chatMsg.toPlayerId = -1;  // Public announcement
-    chatMsg.type = catan::ChatMessageType::TradeAccept;
-    chatMsg.relatedTradeId = trade->id;
-    chatMsg.content = "✅ " + ctx.player->name + " accepted the trade with " + proposer->name + "!";
-    chatMsg.timestamp = std::chrono::steady_clock::now();
-    ctx.game->chatMessages.push_back(chatMsg);
-    
-    // Broadcast SSE events
-    catan::SSEEvent acceptEvent = catan::GameEvents::createTradeResponseEvent(
-        catan::GameEvents::TRADE_ACCEPTED, trade->id, ctx.session->playerId, ctx.player->name
-    );
-    catan::sseManager.broadcastToGame(gameId, acceptEvent);
-    
-    catan::SSEEvent execEvent = catan::GameEvents::createTradeExecutedEvent(
-        trade->id, trade->fromPlayerId, proposer->name, ctx.session->playerId, ctx.player->name
-    );
-    catan::sseManager.broadcastToGame(gameId, execEvent);
-    
-    catan::SSEEvent chatEvent = catan::GameEvents::createChatMessageEvent(
-        chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-        chatMsg.toPlayerId, chatMsg.content, "trade_accept"
-    );
-    catan::sseManager.broadcastToGame(gameId, chatEvent);
-    
-    return jsonResponse(200, "{\"success\":true,\"tradeId\":" + std::to_string(trade->id) + 
-        ",\"executed\":true}");
-}
-
-std::string handleRejectTrade(const HTTPRequest& req, const std::string& gameId, int tradeId) {
+// Accept, reject and cancel name the trade in the path and carry no body
+HTTPResponse handleTradeResponse(const HTTPRequest& req, const std::string& gameId, int tradeId,
+                                 catan::ActionType type) {
     GameContext ctx = getGameContext(req, gameId, false);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
+    catan::GameLock lock(*ctx.game);
     
-    // Find the trade
-    catan::TradeOffer* trade = nullptr;
-    for (auto& t : ctx.game->tradeOffers) {
-        if (t.id == tradeId) {
-            trade = &t;
-            break;
-        }
-    }
+    catan::Action action;
+    action.type = type;
+    action.playerId = ctx.session->playerId;
+    action.tradeId = tradeId;
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
-    if (!trade) {
-        return jsonResponse(404, "{\"error\":\"Trade not found\"}");
+    if (type == catan::ActionType::AcceptTrade) {
+        return jsonResponse(200, "{\"success\":true,\"tradeId\":" + std::to_string(result.tradeId) + 
+            ",\"executed\":true}");
     }
-    
-    if (!trade->isActive) {
-        return jsonResponse(400, "{\"error\":\"Trade is no longer active\"}");
-    }
-    
-    // Record rejection
-    trade->rejectedByPlayerIds.push_back(ctx.session->playerId);
-    
-    // Create chat message
-    catan::ChatMessage chatMsg;
-    chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-    chatMsg.fromPlayerId = ctx.session->playerId;
-    chatMsg.toPlayerId = -1;
-    chatMsg.type = catan::ChatMessageType::TradeReject;
-    chatMsg.relatedTradeId = trade->id;
-    chatMsg.content = "❌ " + ctx.player->name + " rejected the trade.";
-    chatMsg.timestamp = std::chrono::steady_clock::now();
-    ctx.game->chatMessages.push_back(chatMsg);
-    
-    // Broadcast SSE events
-    catan::SSEEvent rejectEvent = catan::GameEvents::createTradeResponseEvent(
-        catan::GameEvents::TRADE_REJECTED, trade->id, ctx.session->playerId, ctx.player->name
-    );
-    catan::sseManager.broadcastToGame(gameId, rejectEvent);
-    
-    catan::SSEEvent chatEvent = catan::GameEvents::createChatMessageEvent(
-        chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-        chatMsg.toPlayerId, chatMsg.content, "trade_reject"
-    );
-    catan::sseManager.broadcastToGame(gameId, chatEvent);
-    
     return jsonResponse(200, "{\"success\":true}");
 }
 
-std::string handleCounterTrade(const HTTPRequest& req, const std::string& gameId, int originalTradeId) {
+HTTPResponse handleAcceptTrade(const HTTPRequest& req, const std::string& gameId, int tradeId) {
+    return handleTradeResponse(req, gameId, tradeId, catan::ActionType::AcceptTrade);
+}
+
+HTTPResponse handleRejectTrade(const HTTPRequest& req, const std::string& gameId, int tradeId) {
+    return handleTradeResponse(req, gameId, tradeId, catan::ActionType::RejectTrade);
+}
+
+HTTPResponse handleCounterTrade(const HTTPRequest& req, const std::string& gameId, int originalTradeId) {
     GameContext ctx = getGameContext(req, gameId, false);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
+    catan::GameLock lock(*ctx.game);
     
-    // Find the original trade
-    catan::TradeOffer* originalTrade = nullptr;
-    for (auto& t : ctx.game->tradeOffers) {
-        if (t.id == originalTradeId) {
-            originalTrade = &t;
-            break;
-        }
-    }
-    
-    if (!originalTrade) {
-        return jsonResponse(404, "{\"error\":\"Original trade not found\"}");
-    }
-    
-    std::string message = parseJsonString(req.body, "message");
-    
-    // Parse counter-offer resources
-    catan::ResourceHand offering;
-    offering.wood = parseJsonInt(req.body, "giveWood", 0);
-    offering.brick = parseJsonInt(req.body, "giveBrick", 0);
-    offering.wheat = parseJsonInt(req.body, "giveWheat", 0);
-    offering.sheep = parseJsonInt(req.body, "giveSheep", 0);
-    offering.ore = parseJsonInt(req.body, "giveOre", 0);
-    
-    catan::ResourceHand requesting;
-    requesting.wood = parseJsonInt(req.body, "wantWood", 0);
-    requesting.brick = parseJsonInt(req.body, "wantBrick", 0);
-    requesting.wheat = parseJsonInt(req.body, "wantWheat", 0);
-    requesting.sheep = parseJsonInt(req.body, "wantSheep", 0);
-    requesting.ore = parseJsonInt(req.body, "wantOre", 0);
-    
-    // Validate resources
-    if (ctx.player->resources.wood < offering.wood ||
-        ctx.player->resources.brick < offering.brick ||
-        ctx.player->resources.wheat < offering.wheat ||
-        ctx.player->resources.sheep < offering.sheep ||
-        ctx.player->resources.ore < offering.ore) {
-        return jsonResponse(400, "{\"error\":\"You don't have enough resources\"}");
-    }
-    
-    // Create new counter trade
-    catan::TradeOffer counterTrade;
-    counterTrade.id = ctx.game->nextTradeId++;
-    counterTrade.fromPlayerId = ctx.session->playerId;
-    counterTrade.toPlayerId = originalTrade->fromPlayerId;  // Counter goes to original proposer
-    counterTrade.offering = offering;
-    counterTrade.requesting = requesting;
-    counterTrade.isActive = true;
-    
-    // Create chat message
-    catan::ChatMessage chatMsg;
-    chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-    chatMsg.fromPlayerId = ctx.session->playerId;
-    chatMsg.toPlayerId = originalTrade->fromPlayerId;
-    chatMsg.type = catan::ChatMessageType::TradeCounter;
-    chatMsg.relatedTradeId = counterTrade.id;
-    chatMsg.tradeOffering = offering;
-    chatMsg.tradeRequesting = requesting;
-    chatMsg.timestamp = std::chrono::steady_clock::now();
-    
-    std::ostringstream desc;
-    desc << "🔄 Counter-offer to Trade #" << originalTradeId << ": ";
-    // ... build description similar to propose
-    if (!message.empty()) {
-        desc << "\"" << message << "\"";
-    }
-    chatMsg.content = desc.str();
-    
-    counterTrade.chatMessageId = chatMsg.id;
-    ctx.game->tradeOffers.push_back(counterTrade);
-    ctx.game->chatMessages.push_back(chatMsg);
-    
-    // Broadcast events
-    catan::SSEEvent counterEvent = catan::GameEvents::createTradeResponseEvent(
-        catan::GameEvents::TRADE_COUNTERED, originalTradeId, ctx.session->playerId, ctx.player->name
-    );
-    catan::sseManager.broadcastToGame(gameId, counterEvent);
-    
-    catan::SSEEvent tradeEvent = catan::GameEvents::createTradeProposedEvent(
-        counterTrade.id, counterTrade.fromPlayerId, ctx.player->name, counterTrade.toPlayerId,
-        offering.wood, offering.brick, offering.wheat, offering.sheep, offering.ore,
-        requesting.wood, requesting.brick, requesting.wheat, requesting.sheep, requesting.ore,
-        message
-    );
-    catan::sseManager.broadcastToGame(gameId, tradeEvent);
+    catan::Action action = requestAction(catan::ActionType::CounterTrade, req, ctx.session->playerId);
+    action.tradeId = originalTradeId;
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
     return jsonResponse(200, 
-        "{\"success\":true,\"counterTradeId\":" + std::to_string(counterTrade.id) + "}");
+        "{\"success\":true,\"counterTradeId\":" + std::to_string(result.tradeId) + "}");
 }
 
-std::string handleCancelTrade(const HTTPRequest& req, const std::string& gameId, int tradeId) {
-    GameContext ctx = getGameContext(req, gameId, false);
-    if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
-    
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    // Find the trade
-    catan::TradeOffer* trade = nullptr;
-    for (auto& t : ctx.game->tradeOffers) {
-        if (t.id == tradeId) {
-            trade = &t;
-            break;
-        }
-    }
-    
-    if (!trade) {
-        return jsonResponse(404, "{\"error\":\"Trade not found\"}");
-    }
-    
-    // Only proposer can cancel
-    if (trade->fromPlayerId != ctx.session->playerId) {
-        return jsonResponse(403, "{\"error\":\"Only the proposer can cancel this trade\"}");
-    }
-    
-    if (!trade->isActive) {
-        return jsonResponse(400, "{\"error\":\"Trade is already inactive\"}");
-    }
-    
-    trade->isActive = false;
-    
-    // Create chat message
-    catan::ChatMessage chatMsg;
-    chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-    chatMsg.fromPlayerId = ctx.session->playerId;
-    chatMsg.toPlayerId = -1;
-    chatMsg.type = catan::ChatMessageType::System;
-    chatMsg.relatedTradeId = trade->id;
-    chatMsg.content = "🚫 " + ctx.player->name + " cancelled their trade offer.";
-    chatMsg.timestamp = std::chrono::steady_clock::now();
-    ctx.game->chatMessages.push_back(chatMsg);
-    
-    // Broadcast SSE events
-    catan::SSEEvent cancelEvent;
-    cancelEvent.event = catan::GameEvents::TRADE_CANCELLED;
-    cancelEvent.data = "{\"tradeId\":" + std::to_string(trade->id) + "}";
-    cancelEvent.id = catan::sseManager.nextEventId();
-    catan::sseManager.broadcastToGame(gameId, cancelEvent);
-    
-    return jsonResponse(200, "{\"success\":true}");
+HTTPResponse handleCancelTrade(const HTTPRequest& req, const std::string& gameId, int tradeId) {
+    return handleTradeResponse(req, gameId, tradeId, catan::ActionType::CancelTrade);
 }
 
-std::string handleGetActiveTrades(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleGetActiveTrades(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId, false);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
+    catan::GameLock lock(*ctx.game, catan::GameLock::Mode::Read);
     
     std::ostringstream json;
     json << "{\"trades\":[";
     
     bool first = true;
-    for (const auto& trade : ctx.game->tradeOffers) {
-        // Show if active and visible to this player
-        if (trade.isActive && 
-            (trade.toPlayerId == -1 || trade.toPlayerId == ctx.session->playerId || 
-             trade.fromPlayerId == ctx.session->playerId)) {
+    ctx.game->tradeOffers.forEachActive([&](const catan::TradeOffer& trade) {
+        // Show if visible to this player
+        if (trade.toPlayerId == -1 || trade.toPlayerId == ctx.session->playerId || 
+            trade.fromPlayerId == ctx.session->playerId) {
             if (!first) json << ",";
             first = false;
             
@@ -1578,34 +798,34 @@ std::string handleGetActiveTrades(const HTTPRequest& req, const std::string& gam
             
             json << "{\"id\":" << trade.id;
             json << ",\"fromPlayerId\":" << trade.fromPlayerId;
-            json << ",\"fromPlayerName\":\"" << fromName << "\"";
+            json << ",\"fromPlayerName\":\"" << catan::escapeJson(fromName) << "\"";
             json << ",\"toPlayerId\":" << trade.toPlayerId;
             json << ",\"offering\":{";
-            json << "\"wood\":" << trade.offering.wood;
-            json << ",\"brick\":" << trade.offering.brick;
-            json << ",\"wheat\":" << trade.offering.wheat;
-            json << ",\"sheep\":" << trade.offering.sheep;
-            json << ",\"ore\":" << trade.offering.ore << "}";
+            json << "\"wood\":" << trade.offering[catan::Resource::Wood];
+            json << ",\"brick\":" << trade.offering[catan::Resource::Brick];
+            json << ",\"wheat\":" << trade.offering[catan::Resource::Wheat];
+            json << ",\"sheep\":" << trade.offering[catan::Resource::Sheep];
+            json << ",\"ore\":" << trade.offering[catan::Resource::Ore] << "}";
             json << ",\"requesting\":{";
-            json << "\"wood\":" << trade.requesting.wood;
-            json << ",\"brick\":" << trade.requesting.brick;
-            json << ",\"wheat\":" << trade.requesting.wheat;
-            json << ",\"sheep\":" << trade.requesting.sheep;
-            json << ",\"ore\":" << trade.requesting.ore << "}";
+            json << "\"wood\":" << trade.requesting[catan::Resource::Wood];
+            json << ",\"brick\":" << trade.requesting[catan::Resource::Brick];
+            json << ",\"wheat\":" << trade.requesting[catan::Resource::Wheat];
+            json << ",\"sheep\":" << trade.requesting[catan::Resource::Sheep];
+            json << ",\"ore\":" << trade.requesting[catan::Resource::Ore] << "}";
             json << ",\"isActive\":" << (trade.isActive ? "true" : "false");
             json << "}";
         }
-    }
+    });
     
     json << "]}";
     return jsonResponse(200, json.str());
 }
 
-std::string handleStartGame(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleStartGame(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId, false); // Don't require current turn
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
+    catan::GameLock lock(*ctx.game);
     
     if (ctx.game->phase != catan::GamePhase::WaitingForPlayers) {
         return jsonResponse(400, "{\"error\":\"Game already started\"}");
@@ -1621,14 +841,18 @@ std::string handleStartGame(const HTTPRequest& req, const std::string& gameId) {
     ctx.game->setupRound = 0;
     
     // Check if the first player is AI
-    catan::ai::AIPlayerManager aiManager(ctx.game);
+    catan::ai::AIPlayerManager aiManager(ctx.game.get());
     bool firstIsAI = aiManager.isCurrentPlayerAI();
     
+    // AI setup pieces are placed server-side, like AI turns
+    bool aiProcessingStarted = firstIsAI && startAITurns(gameId);
+    
     std::ostringstream json;
     json << "{\"success\":true,\"message\":\"Game started - setup phase\"";
     json << ",\"currentPlayer\":0";
     json << ",\"phase\":\"setup\"";
     json << ",\"currentPlayerIsAI\":" << (firstIsAI ? "true" : "false");
+    json << ",\"aiProcessingStarted\":" << (aiProcessingStarted ? "true" : "false");
     
     // Include player info
     json << ",\"players\":[";
@@ -1636,7 +860,7 @@ std::string handleStartGame(const HTTPRequest& req, const std::string& gameId) {
         if (i > 0) json << ",";
         auto& p = ctx.game->players[i];
         json << "{\"id\":" << p.id;
-        json << ",\"name\":\"" << p.name << "\"";
+        json << ",\"name\":\"" << catan::escapeJson(p.name) << "\"";
         json << ",\"type\":\"" << (p.isAI() ? "ai" : "human") << "\"}";
     }
     json << "]";
@@ -1646,135 +870,49 @@ std::string handleStartGame(const HTTPRequest& req, const std::string& gameId) {
 }
 
 // Handle setup phase settlement placement
-std::string handleSetupPlaceSettlement(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleSetupPlaceSettlement(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    if (ctx.game->phase != catan::GamePhase::Setup && ctx.game->phase != catan::GamePhase::SetupReverse) {
-        return jsonResponse(400, "{\"error\":\"Not in setup phase\"}");
-    }
-    
-    // Parse location
-    int hexQ = parseJsonInt(req.body, "hexQ", 0);
-    int hexR = parseJsonInt(req.body, "hexR", 0);
-    int direction = parseJsonInt(req.body, "direction", 0);
+    catan::GameLock lock(*ctx.game);
     
-    catan::VertexCoord location{{hexQ, hexR}, direction};
-    
-    // Validate location
-    auto validLocations = catan::getValidSetupSettlementLocations(*ctx.game);
-    bool isValid = false;
-    for (const auto& loc : validLocations) {
-        if (loc.hex.q == hexQ && loc.hex.r == hexR && loc.direction == direction) {
-            isValid = true;
-            break;
-        }
-    }
-    
-    if (!isValid) {
-        return jsonResponse(400, "{\"error\":\"Invalid settlement location for setup\"}");
-    }
-    
-    // Place settlement
-    if (!catan::placeSetupSettlement(*ctx.game, ctx.session->playerId, location)) {
-        return jsonResponse(400, "{\"error\":\"Failed to place settlement\"}");
-    }
-    
-    // If this is the second settlement (setup_reverse), give initial resources
-    if (ctx.game->phase == catan::GamePhase::SetupReverse) {
-        catan::giveInitialResources(*ctx.game, ctx.session->playerId, location);
-    }
-    
-    // Store the settlement location for road placement
-    ctx.game->lastActivity = std::chrono::steady_clock::now();
+    catan::Action action = requestAction(catan::ActionType::PlaceSetupSettlement, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
+    const catan::JsonValue& body = req.json();
     return jsonResponse(200, 
-        "{\"success\":true,\"message\":\"Settlement placed - now place a road\","
-        "\"hexQ\":" + std::to_string(hexQ) + ","
-        "\"hexR\":" + std::to_string(hexR) + ","
-        "\"direction\":" + std::to_string(direction) + ","
-        "\"needsRoad\":true}");
+        "{\"success\":true,\"message\":\"Settlement placed - now place a road\"," +
+        locationFields({body.getInt("hexQ", 0), body.getInt("hexR", 0)}, body.getInt("direction", 0)) +
+        ",\"needsRoad\":true}");
 }
 
 // Handle setup phase road placement
-std::string handleSetupPlaceRoad(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleSetupPlaceRoad(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    if (ctx.game->phase != catan::GamePhase::Setup && ctx.game->phase != catan::GamePhase::SetupReverse) {
-        return jsonResponse(400, "{\"error\":\"Not in setup phase\"}");
-    }
-    
-    // Parse location
-    int hexQ = parseJsonInt(req.body, "hexQ", 0);
-    int hexR = parseJsonInt(req.body, "hexR", 0);
-    int direction = parseJsonInt(req.body, "direction", 0);
-    
-    catan::EdgeCoord location{{hexQ, hexR}, direction};
-    
-    // Find player's most recently placed settlement (for validation)
-    // In setup, the road must connect to the settlement just placed
-    catan::VertexCoord lastSettlement{{0, 0}, 0};
-    bool foundSettlement = false;
-    
-    // Find the last settlement placed by this player
-    for (const auto& [coord, vertex] : ctx.game->board.vertices) {
-        if (vertex.ownerPlayerId == ctx.session->playerId && vertex.building == catan::Building::Settlement) {
-            // Check if road could connect to this settlement
-            auto validRoads = catan::getValidSetupRoadLocations(*ctx.game, coord);
-            for (const auto& vr : validRoads) {
-                if (vr.hex.q == hexQ && vr.hex.r == hexR && vr.direction == direction) {
-                    lastSettlement = coord;
-                    foundSettlement = true;
-                    break;
-                }
-            }
-            if (foundSettlement) break;
-        }
-    }
-    
-    if (!foundSettlement) {
-        return jsonResponse(400, "{\"error\":\"Road must connect to your settlement\"}");
-    }
+    catan::GameLock lock(*ctx.game);
     
-    // Validate road location
-    auto validLocations = catan::getValidSetupRoadLocations(*ctx.game, lastSettlement);
-    bool isValid = false;
-    for (const auto& loc : validLocations) {
-        if (loc.hex.q == hexQ && loc.hex.r == hexR && loc.direction == direction) {
-            isValid = true;
-            break;
-        }
-    }
-    
-    if (!isValid) {
-        return jsonResponse(400, "{\"error\":\"Invalid road location for setup\"}");
-    }
-    
-    // Place road
-    if (!catan::placeSetupRoad(*ctx.game, ctx.session->playerId, location)) {
-        return jsonResponse(400, "{\"error\":\"Failed to place road\"}");
-    }
-    
-    // Advance to next player/phase
-    catan::advanceSetupPhase(*ctx.game);
+    catan::Action action = requestAction(catan::ActionType::PlaceSetupRoad, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
     
     bool setupComplete = (ctx.game->phase == catan::GamePhase::Rolling);
     catan::Player* nextPlayer = ctx.game->getCurrentPlayer();
     
+    bool aiProcessingStarted = nextPlayer && nextPlayer->isAI() && startAITurns(gameId);
+    
     std::ostringstream json;
     json << "{\"success\":true";
     json << ",\"message\":\"" << (setupComplete ? "Setup complete! Game starting." : "Road placed") << "\"";
     json << ",\"setupComplete\":" << (setupComplete ? "true" : "false");
-    json << ",\"phase\":\"" << phaseToString(ctx.game->phase) << "\"";
+    json << ",\"phase\":\"" << catan::phaseToString(ctx.game->phase) << "\"";
     json << ",\"currentPlayer\":" << ctx.game->currentPlayerIndex;
     if (nextPlayer) {
-        json << ",\"currentPlayerName\":\"" << nextPlayer->name << "\"";
+        json << ",\"currentPlayerName\":\"" << catan::escapeJson(nextPlayer->name) << "\"";
         json << ",\"currentPlayerIsAI\":" << (nextPlayer->isAI() ? "true" : "false");
+        json << ",\"aiProcessingStarted\":" << (aiProcessingStarted ? "true" : "false");
     }
     json << "}";
     
@@ -1786,11 +924,11 @@ std::string handleSetupPlaceRoad(const HTTPRequest& req, const std::string& game
 // ============================================================================
 
 // Get AI game state for decision making
-std::string handleGetAIState(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleGetAIState(const HTTPRequest& req, const std::string& gameId) {
     GameContext ctx = getGameContext(req, gameId, false);
     if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
     
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
+    catan::GameLock lock(*ctx.game, catan::GameLock::Mode::Read);
     
     catan::ai::AIGameState state = catan::ai::getAIGameState(*ctx.game, ctx.session->playerId);
     std::string stateJson = catan::ai::aiGameStateToJson(state);
@@ -1799,15 +937,15 @@ std::string handleGetAIState(const HTTPRequest& req, const std::string& gameId)
 }
 
 // Get available tools and their definitions
-std::string handleGetAITools(const HTTPRequest& req) {
+HTTPResponse handleGetAITools(const HTTPRequest& req) {
     auto tools = catan::ai::getToolDefinitions();
     
     std::ostringstream json;
     json << "{\"tools\":[";
     for (size_t i = 0; i < tools.size(); i++) {
         if (i > 0) json << ",";
-        json << "{\"name\":\"" << tools[i].name << "\"";
-        json << ",\"description\":\"" << tools[i].description << "\"";
+        json << "{\"name\":\"" << catan::escapeJson(tools[i].name) << "\"";
+        json << ",\"description\":\"" << catan::escapeJson(tools[i].description) << "\"";
         json << ",\"parameters\":" << tools[i].parametersSchema;
         json << "}";
     }
@@ -1816,659 +954,117 @@ std::string handleGetAITools(const HTTPRequest& req) {
     return jsonResponse(200, json.str());
 }
 
-// Execute an AI tool
-std::string handleExecuteAITool(const HTTPRequest& req, const std::string& gameId) {
-    GameContext ctx = getGameContext(req, gameId);
-    if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
-    
-    // Verify this is an AI player
-    if (!ctx.player->isAI()) {
-        return jsonResponse(400, "{\"error\":\"This endpoint is for AI players only\"}");
-    }
-    
-    std::string toolName = parseJsonString(req.body, "tool");
-    if (toolName.empty()) {
-        return jsonResponse(400, "{\"error\":\"Missing 'tool' parameter\"}");
-    }
-    
-    std::lock_guard<std::mutex> lock(ctx.game->mutex);
-    
-    // Route to appropriate action handler based on tool name
-    // This reuses existing game logic
-    
-    if (toolName == "roll_dice") {
-        // Simulate the roll dice action
-        if (ctx.game->phase != catan::GamePhase::Rolling) {
-            return jsonResponse(400, "{\"error\":\"Cannot roll now\"}");
-        }
-        
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_int_distribution<> die(1, 6);
-        
-        catan::DiceRoll roll;
-        roll.die1 = die(gen);
-        roll.die2 = die(gen);
-        ctx.game->lastRoll = roll;
-        
-        int total = roll.total();
-        
-        if (total == 7) {
-            ctx.game->phase = catan::GamePhase::Robber;
-            return jsonResponse(200, 
-                "{\"success\":true,\"tool\":\"roll_dice\","
-                "\"die1\":" + std::to_string(roll.die1) + 
-                ",\"die2\":" + std::to_string(roll.die2) + 
-                ",\"total\":7,\"robber\":true}");
-        }
-        
-        // Resource distribution logic...
-        ctx.game->phase = catan::GamePhase::MainTurn;
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"roll_dice\","
-            "\"die1\":" + std::to_string(roll.die1) + 
-            ",\"die2\":" + std::to_string(roll.die2) + 
-            ",\"total\":" + std::to_string(total) + "}");
-    }
-    
-    if (toolName == "end_turn") {
-        if (ctx.game->phase != catan::GamePhase::MainTurn) {
-            return jsonResponse(400, "{\"error\":\"Cannot end turn during this phase\"}");
-        }
-        
-        ctx.game->currentPlayerIndex = (ctx.game->currentPlayerIndex + 1) % ctx.game->players.size();
-        ctx.game->phase = catan::GamePhase::Rolling;
-        ctx.game->devCardPlayedThisTurn = false;
-        
-        catan::Player* nextPlayer = ctx.game->getCurrentPlayer();
-        bool nextIsAI = nextPlayer && nextPlayer->isAI();
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"end_turn\","
-            "\"nextPlayer\":" + std::to_string(ctx.game->currentPlayerIndex) + 
-            ",\"nextPlayerIsAI\":" + (nextIsAI ? "true" : "false") + "}");
-    }
-    
-    if (toolName == "build_road") {
-        if (ctx.game->phase != catan::GamePhase::MainTurn) {
-            return jsonResponse(400, "{\"error\":\"Cannot build during this phase\"}");
-        }
-        if (!canAfford(ctx.player->resources, ROAD_COST)) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources\"}");
-        }
-        if (ctx.player->roadsRemaining <= 0) {
-            return jsonResponse(400, "{\"error\":\"No roads remaining\"}");
-        }
-        
-        // Parse location
-        int hexQ = parseJsonInt(req.body, "hexQ", 0);
-        int hexR = parseJsonInt(req.body, "hexR", 0);
-        int direction = parseJsonInt(req.body, "direction", 0);
-        
-        // TODO: Validate placement rules
-        
-        subtractResources(ctx.player->resources, ROAD_COST);
-        ctx.player->roadsRemaining--;
-        
-        // Place the road on the board
-        catan::EdgeCoord coord{{hexQ, hexR}, direction};
-        auto it = ctx.game->board.edges.find(coord);
-        if (it != ctx.game->board.edges.end()) {
-            it->second.hasRoad = true;
-            it->second.ownerPlayerId = ctx.player->id;
-        }
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"build_road\","
-            "\"hexQ\":" + std::to_string(hexQ) +
-            ",\"hexR\":" + std::to_string(hexR) +
-            ",\"direction\":" + std::to_string(direction) + "}");
-    }
-    
-    if (toolName == "build_settlement") {
-        if (ctx.game->phase != catan::GamePhase::MainTurn) {
-            return jsonResponse(400, "{\"error\":\"Cannot build during this phase\"}");
-        }
-        if (!canAfford(ctx.player->resources, SETTLEMENT_COST)) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources\"}");
-        }
-        if (ctx.player->settlementsRemaining <= 0) {
-            return jsonResponse(400, "{\"error\":\"No settlements remaining\"}");
-        }
-        
-        int hexQ = parseJsonInt(req.body, "hexQ", 0);
-        int hexR = parseJsonInt(req.body, "hexR", 0);
-        int direction = parseJsonInt(req.body, "direction", 0);
-        
-        // TODO: Validate placement rules
-        
-        subtractResources(ctx.player->resources, SETTLEMENT_COST);
-        ctx.player->settlementsRemaining--;
-        
-        catan::VertexCoord coord{{hexQ, hexR}, direction};
-        auto it = ctx.game->board.vertices.find(coord);
-        if (it != ctx.game->board.vertices.end()) {
-            it->second.building = catan::Building::Settlement;
-            it->second.ownerPlayerId = ctx.player->id;
-        }
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"build_settlement\","
-            "\"hexQ\":" + std::to_string(hexQ) +
-            ",\"hexR\":" + std::to_string(hexR) +
-            ",\"direction\":" + std::to_string(direction) + "}");
-    }
-    
-    if (toolName == "build_city") {
-        if (ctx.game->phase != catan::GamePhase::MainTurn) {
-            return jsonResponse(400, "{\"error\":\"Cannot build during this phase\"}");
-        }
-        if (!canAfford(ctx.player->resources, CITY_COST)) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources\"}");
-        }
-        if (ctx.player->citiesRemaining <= 0) {
-            return jsonResponse(400, "{\"error\":\"No cities remaining\"}");
-        }
-        
-        int hexQ = parseJsonInt(req.body, "hexQ", 0);
-        int hexR = parseJsonInt(req.body, "hexR", 0);
-        int direction = parseJsonInt(req.body, "direction", 0);
-        
-        // Verify there's a settlement to upgrade
-        catan::VertexCoord coord{{hexQ, hexR}, direction};
-        auto it = ctx.game->board.vertices.find(coord);
-        if (it == ctx.game->board.vertices.end() || 
-            it->second.building != catan::Building::Settlement ||
-            it->second.ownerPlayerId != ctx.player->id) {
-            return jsonResponse(400, "{\"error\":\"No settlement to upgrade at this location\"}");
-        }
-        
-        subtractResources(ctx.player->resources, CITY_COST);
-        ctx.player->citiesRemaining--;
-        ctx.player->settlementsRemaining++;  // Return settlement
-        it->second.building = catan::Building::City;
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"build_city\","
-            "\"hexQ\":" + std::to_string(hexQ) +
-            ",\"hexR\":" + std::to_string(hexR) +
-            ",\"direction\":" + std::to_string(direction) + "}");
-    }
-    
-    if (toolName == "buy_dev_card") {
-        if (ctx.game->phase != catan::GamePhase::MainTurn) {
-            return jsonResponse(400, "{\"error\":\"Cannot buy during this phase\"}");
-        }
-        if (!canAfford(ctx.player->resources, DEV_CARD_COST)) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources\"}");
-        }
-        if (ctx.game->devCardDeck.empty()) {
-            return jsonResponse(400, "{\"error\":\"No dev cards remaining\"}");
-        }
-        
-        subtractResources(ctx.player->resources, DEV_CARD_COST);
-        
-        catan::DevCardType card = ctx.game->devCardDeck.back();
-        ctx.game->devCardDeck.pop_back();
-        ctx.player->devCards.push_back(card);
-        
-        std::string cardName;
-        switch (card) {
-            case catan::DevCardType::Knight: cardName = "knight"; break;
-            case catan::DevCardType::VictoryPoint: cardName = "victory_point"; break;
-            case catan::DevCardType::RoadBuilding: cardName = "road_building"; break;
-            case catan::DevCardType::YearOfPlenty: cardName = "year_of_plenty"; break;
-            case catan::DevCardType::Monopoly: cardName = "monopoly"; break;
-        }
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"buy_dev_card\",\"card\":\"" + cardName + "\"}");
-    }
-    
-    if (toolName == "bank_trade") {
-        if (ctx.game->phase != catan::GamePhase::MainTurn) {
-            return jsonResponse(400, "{\"error\":\"Cannot trade during this phase\"}");
-        }
-        
-        std::string giveStr = parseJsonString(req.body, "give");
-        std::string receiveStr = parseJsonString(req.body, "receive");
-        
-        catan::Resource give = stringToResource(giveStr);
-        catan::Resource receive = stringToResource(receiveStr);
-        
-        if (give == catan::Resource::None || receive == catan::Resource::None) {
-            return jsonResponse(400, "{\"error\":\"Invalid resources\"}");
-        }
-        
-        int ratio = 4;  // TODO: Check for ports
-        
-        if (ctx.player->resources[give] < ratio) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources\"}");
-        }
-        
-        ctx.player->resources[give] -= ratio;
-        ctx.player->resources[receive] += 1;
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"bank_trade\","
-            "\"gave\":\"" + giveStr + "\",\"gaveAmount\":" + std::to_string(ratio) +
-            ",\"received\":\"" + receiveStr + "\",\"receivedAmount\":1}");
-    }
-    
-    if (toolName == "move_robber") {
-        if (ctx.game->phase != catan::GamePhase::Robber) {
-            return jsonResponse(400, "{\"error\":\"Not in robber phase\"}");
-        }
-        
-        int hexQ = parseJsonInt(req.body, "hexQ", 0);
-        int hexR = parseJsonInt(req.body, "hexR", 0);
-        int stealFrom = parseJsonInt(req.body, "stealFromPlayerId", -1);
-        
-        // Move robber
-        catan::HexCoord oldLoc = ctx.game->board.robberLocation;
-        catan::HexCoord newLoc{hexQ, hexR};
-        
-        auto oldIt = ctx.game->board.hexes.find(oldLoc);
-        if (oldIt != ctx.game->board.hexes.end()) {
-            oldIt->second.hasRobber = false;
-        }
-        
-        auto newIt = ctx.game->board.hexes.find(newLoc);
-        if (newIt != ctx.game->board.hexes.end()) {
-            newIt->second.hasRobber = true;
-        }
-        ctx.game->board.robberLocation = newLoc;
-        
-        // Steal from player if specified
-        std::string stolenResource = "none";
-        if (stealFrom >= 0 && stealFrom < (int)ctx.game->players.size()) {
-            catan::Player* victim = &ctx.game->players[stealFrom];
-            if (victim->resources.total() > 0) {
-                // Randomly steal one resource
-                std::vector<catan::Resource> available;
-                if (victim->resources.wood > 0) available.push_back(catan::Resource::Wood);
-                if (victim->resources.brick > 0) available.push_back(catan::Resource::Brick);
-                if (victim->resources.wheat > 0) available.push_back(catan::Resource::Wheat);
-                if (victim->resources.sheep > 0) available.push_back(catan::Resource::Sheep);
-                if (victim->resources.ore > 0) available.push_back(catan::Resource::Ore);
-                
-                if (!available.empty()) {
-                    static std::random_device rd;
-                    static std::mt19937 gen(rd());
-                    std::uniform_int_distribution<> dis(0, available.size() - 1);
-                    catan::Resource stolen = available[dis(gen)];
-                    victim->resources[stolen]--;
-                    ctx.player->resources[stolen]++;
-                    stolenResource = resourceToString(stolen);
-                }
-            }
-        }
-        
-        ctx.game->phase = catan::GamePhase::MainTurn;
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"move_robber\","
-            "\"hexQ\":" + std::to_string(hexQ) +
-            ",\"hexR\":" + std::to_string(hexR) +
-            ",\"stolenResource\":\"" + stolenResource + "\"}");
+// Execute an AI tool
+HTTPResponse handleExecuteAITool(const HTTPRequest& req, const std::string& gameId) {
+    GameContext ctx = getGameContext(req, gameId);
+    if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
+    
+    // Verify this is an AI player
+    if (!ctx.player->isAI()) {
+        return jsonResponse(400, "{\"error\":\"This endpoint is for AI players only\"}");
     }
     
-    // ============ CHAT AND TRADE TOOLS ============
+    std::string toolName = req.json().getString("tool");
+    if (toolName.empty()) {
+        return jsonResponse(400, "{\"error\":\"Missing 'tool' parameter\"}");
+    }
     
-    if (toolName == "send_chat") {
-        int toPlayerId = parseJsonInt(req.body, "toPlayerId", -1);
-        std::string message = parseJsonString(req.body, "message");
-        
-        if (message.empty()) {
-            return jsonResponse(400, "{\"error\":\"Message cannot be empty\"}");
-        }
-        
-        // Create chat message
-        catan::ChatMessage chatMsg;
-        chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-        chatMsg.fromPlayerId = ctx.session->playerId;
-        chatMsg.toPlayerId = toPlayerId;
-        chatMsg.content = message;
-        chatMsg.type = catan::ChatMessageType::Normal;
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        
-        ctx.game->chatMessages.push_back(chatMsg);
-        
-        // Broadcast SSE event
-        catan::SSEEvent sseEvent = catan::GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-            chatMsg.toPlayerId, chatMsg.content, "normal"
-        );
-        catan::sseManager.broadcastToGame(gameId, sseEvent);
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"send_chat\",\"messageId\":\"" + chatMsg.id + "\"}");
+    // Tool arguments sit beside "tool" in the body
+    catan::ActionType type;
+    if (!catan::actionTypeFromName(toolName, type)) {
+        return jsonResponse(400, "{\"error\":\"Unknown tool: " + catan::escapeJson(toolName) + "\"}");
     }
     
-    if (toolName == "propose_trade") {
-        int toPlayerId = parseJsonInt(req.body, "toPlayerId", -1);
-        std::string message = parseJsonString(req.body, "message");
-        
-        catan::ResourceHand offering;
-        offering.wood = parseJsonInt(req.body, "giveWood", 0);
-        offering.brick = parseJsonInt(req.body, "giveBrick", 0);
-        offering.wheat = parseJsonInt(req.body, "giveWheat", 0);
-        offering.sheep = parseJsonInt(req.body, "giveSheep", 0);
-        offering.ore = parseJsonInt(req.body, "giveOre", 0);
-        
-        catan::ResourceHand requesting;
-        requesting.wood = parseJsonInt(req.body, "wantWood", 0);
-        requesting.brick = parseJsonInt(req.body, "wantBrick", 0);
-        requesting.wheat = parseJsonInt(req.body, "wantWheat", 0);
-        requesting.sheep = parseJsonInt(req.body, "wantSheep", 0);
-        requesting.ore = parseJsonInt(req.body, "wantOre", 0);
-        
-        // Validate
-        if (ctx.player->resources.wood < offering.wood ||
-            ctx.player->resources.brick < offering.brick ||
-            ctx.player->resources.wheat < offering.wheat ||
-            ctx.player->resources.sheep < offering.sheep ||
-            ctx.player->resources.ore < offering.ore) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources to offer\"}");
-        }
-        
-        // Create trade
-        catan::TradeOffer trade;
-        trade.id = ctx.game->nextTradeId++;
-        trade.fromPlayerId = ctx.session->playerId;
-        trade.toPlayerId = toPlayerId;
-        trade.offering = offering;
-        trade.requesting = requesting;
-        trade.isActive = true;
-        
-        // Create chat message
-        catan::ChatMessage chatMsg;
-        chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-        chatMsg.fromPlayerId = ctx.session->playerId;
-        chatMsg.toPlayerId = toPlayerId;
-        chatMsg.type = catan::ChatMessageType::TradeProposal;
-        chatMsg.relatedTradeId = trade.id;
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        
-        std::ostringstream desc;
-        desc << "📦 Trade Proposal: ";
-        if (!message.empty()) desc << message << " - ";
-        desc << "Offering ";
-        bool first = true;
-        if (offering.wood > 0) { desc << offering.wood << " wood"; first = false; }
-        if (offering.brick > 0) { desc << (first ? "" : ", ") << offering.brick << " brick"; first = false; }
-        if (offering.wheat > 0) { desc << (first ? "" : ", ") << offering.wheat << " wheat"; first = false; }
-        if (offering.sheep > 0) { desc << (first ? "" : ", ") << offering.sheep << " sheep"; first = false; }
-        if (offering.ore > 0) { desc << (first ? "" : ", ") << offering.ore << " ore"; first = false; }
-        desc << " for ";
-        first = true;
-        if (requesting.wood > 0) { desc << requesting.wood << " wood"; first = false; }
-        if (requesting.brick > 0) { desc << (first ? "" : ", ") << requesting.brick << " brick"; first = false; }
-        if (requesting.wheat > 0) { desc << (first ? "" : ", ") << requesting.wheat << " wheat"; first = false; }
-        if (requesting.sheep > 0) { desc << (first ? "" : ", ") << requesting.sheep << " sheep"; first = false; }
-        if (requesting.ore > 0) { desc << (first ? "" : ", ") << requesting.ore << " ore"; first = false; }
-        chatMsg.content = desc.str();
-        
-        trade.chatMessageId = chatMsg.id;
-        ctx.game->tradeOffers.push_back(trade);
-        ctx.game->chatMessages.push_back(chatMsg);
-        
-        // Broadcast
-        catan::SSEEvent chatEvent = catan::GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_proposal"
-        );
-        catan::sseManager.broadcastToGame(gameId, chatEvent);
-        
-        catan::SSEEvent tradeEvent = catan::GameEvents::createTradeProposedEvent(
-            trade.id, trade.fromPlayerId, ctx.player->name, trade.toPlayerId,
-            offering.wood, offering.brick, offering.wheat, offering.sheep, offering.ore,
-            requesting.wood, requesting.brick, requesting.wheat, requesting.sheep, requesting.ore,
-            message
-        );
-        catan::sseManager.broadcastToGame(gameId, tradeEvent);
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"propose_trade\",\"tradeId\":" + std::to_string(trade.id) + "}");
+    catan::GameLock lock(*ctx.game);
+    
+    catan::Action action = requestAction(type, req, ctx.session->playerId);
+    catan::ActionResult result = applyGameAction(*ctx.game, action);
+    if (!result.ok()) return actionErrorResponse(action, result);
+    
+    catan::JsonWriter json;
+    json.beginObject();
+    json.key("success").value(true);
+    json.key("tool").value(toolName);
+    writeActionOutcome(json, *ctx.game, action, result);
+    json.endObject();
+    return jsonResponse(200, json.take());
+}
+
+// POST /games/{id}/actions {"actions": [{"action": "build_road", "hexQ": 0, ...}, ...]}
+// Applies the actions in order under one lock acquisition, stopping at the
+// first one the rules refuse; the ones before it stay applied. Arguments
+// are spelled as for the AI tools.
+constexpr size_t MAX_BATCH_ACTIONS = 32;
+
+HTTPResponse handleApplyActions(const HTTPRequest& req, const std::string& gameId) {
+    GameContext ctx = getGameContext(req, gameId, false);  // each action checks the turn itself
+    if (ctx.errorCode) return jsonResponse(ctx.errorCode, ctx.error);
+    
+    const catan::JsonValue& list = req.json()["actions"];
+    if (!list.isArray() || list.size() == 0) {
+        return jsonResponse(400, "{\"error\":\"Expected a non-empty 'actions' array\"}");
+    }
+    if (list.size() > MAX_BATCH_ACTIONS) {
+        return jsonResponse(400, "{\"error\":\"At most " + std::to_string(MAX_BATCH_ACTIONS) +
+                                 " actions per request\"}");
     }
     
-    if (toolName == "accept_trade") {
-        int tradeId = parseJsonInt(req.body, "tradeId", -1);
-        
-        catan::TradeOffer* trade = nullptr;
-        for (auto& t : ctx.game->tradeOffers) {
-            if (t.id == tradeId) {
-                trade = &t;
-                break;
-            }
-        }
-        
-        if (!trade) {
-            return jsonResponse(400, "{\"error\":\"Trade not found\"}");
-        }
-        
-        if (!trade->isActive) {
-            return jsonResponse(400, "{\"error\":\"Trade no longer active\"}");
-        }
-        
-        if (trade->fromPlayerId == ctx.session->playerId) {
-            return jsonResponse(400, "{\"error\":\"Cannot accept own trade\"}");
-        }
-        
-        // Verify resources
-        if (ctx.player->resources.wood < trade->requesting.wood ||
-            ctx.player->resources.brick < trade->requesting.brick ||
-            ctx.player->resources.wheat < trade->requesting.wheat ||
-            ctx.player->resources.sheep < trade->requesting.sheep ||
-            ctx.player->resources.ore < trade->requesting.ore) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources\"}");
-        }
-        
-        catan::Player* proposer = ctx.game->getPlayerById(trade->fromPlayerId);
-        if (!proposer ||
-            proposer->resources.wood < trade->offering.wood ||
-            proposer->resources.brick < trade->offering.brick ||
-            proposer->resources.wheat < trade->offering.wheat ||
-            proposer->resources.sheep < trade->offering.sheep ||
-            proposer->resources.ore < trade->offering.ore) {
-            trade->isActive = false;
-            return jsonResponse(400, "{\"error\":\"Proposer no longer has resources\"}");
+    size_t count = list.size();
+    std::array<catan::Action, MAX_BATCH_ACTIONS> actions;
+    for (size_t i = 0; i < count; i++) {
+        std::string name = list[i].getString("action");
+        catan::ActionType type;
+        if (!catan::actionTypeFromName(name, type)) {
+            return jsonResponse(400, "{\"error\":\"Unknown action: " + catan::escapeJson(name) + "\"}");
         }
-        
-        // Execute trade
-        proposer->resources.wood -= trade->offering.wood;
-        proposer->resources.brick -= trade->offering.brick;
-        proposer->resources.wheat -= trade->offering.wheat;
-        proposer->resources.sheep -= trade->offering.sheep;
-        proposer->resources.ore -= trade->offering.ore;
-        
-        ctx.player->resources.wood += trade->offering.wood;
-        ctx.player->resources.brick += trade->offering.brick;
-        ctx.player->resources.wheat += trade->offering.wheat;
-        ctx.player->resources.sheep += trade->offering.sheep;
-        ctx.player->resources.ore += trade->offering.ore;
-        
-        ctx.player->resources.wood -= trade->requesting.wood;
-        ctx.player->resources.brick -= trade->requesting.brick;
-        ctx.player->resources.wheat -= trade->requesting.wheat;
-        ctx.player->resources.sheep -= trade->requesting.sheep;
-        ctx.player->resources.ore -= trade->requesting.ore;
-        
-        proposer->resources.wood += trade->requesting.wood;
-        proposer->resources.brick += trade->requesting.brick;
-        proposer->resources.wheat += trade->requesting.wheat;
-        proposer->resources.sheep += trade->requesting.sheep;
-        proposer->resources.ore += trade->requesting.ore;
-        
-        trade->isActive = false;
-        trade->acceptedByPlayerIds.push_back(ctx.session->playerId);
-        
-        // Chat message
-        catan::ChatMessage chatMsg;
-        chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-        chatMsg.fromPlayerId = ctx.session->playerId;
-        chatMsg.toPlayerId = -1;
-        chatMsg.type = catan::ChatMessageType::TradeAccept;
-        chatMsg.relatedTradeId = trade->id;
-        chatMsg.content = "✅ " + ctx.player->name + " accepted the trade with " + proposer->name + "!";
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        ctx.game->chatMessages.push_back(chatMsg);
-        
-        // Broadcast
-        catan::SSEEvent execEvent = catan::GameEvents::createTradeExecutedEvent(
-            trade->id, trade->fromPlayerId, proposer->name, ctx.session->playerId, ctx.player->name
-        );
-        catan::sseManager.broadcastToGame(gameId, execEvent);
-        
-        catan::SSEEvent chatEvent = catan::GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_accept"
-        );
-        catan::sseManager.broadcastToGame(gameId, chatEvent);
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"accept_trade\",\"executed\":true}");
+        actions[i] = catan::ai::actionFromArguments(type, list[i], ctx.session->playerId);
     }
     
-    if (toolName == "reject_trade") {
-        int tradeId = parseJsonInt(req.body, "tradeId", -1);
-        
-        catan::TradeOffer* trade = nullptr;
-        for (auto& t : ctx.game->tradeOffers) {
-            if (t.id == tradeId) {
-                trade = &t;
-                break;
-            }
-        }
-        
-        if (!trade) {
-            return jsonResponse(400, "{\"error\":\"Trade not found\"}");
-        }
-        
-        trade->rejectedByPlayerIds.push_back(ctx.session->playerId);
-        
-        // Chat message
-        catan::ChatMessage chatMsg;
-        chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-        chatMsg.fromPlayerId = ctx.session->playerId;
-        chatMsg.toPlayerId = -1;
-        chatMsg.type = catan::ChatMessageType::TradeReject;
-        chatMsg.relatedTradeId = trade->id;
-        chatMsg.content = "❌ " + ctx.player->name + " rejected the trade.";
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        ctx.game->chatMessages.push_back(chatMsg);
-        
-        catan::SSEEvent chatEvent = catan::GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_reject"
-        );
-        catan::sseManager.broadcastToGame(gameId, chatEvent);
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"reject_trade\"}");
+    catan::GameLock lock(*ctx.game);
+    
+    std::array<catan::ActionResult, MAX_BATCH_ACTIONS> results;
+    size_t applied = catan::applyActions(*ctx.game, actions.data(), count, results.data());
+    bool turnPassed = false;
+    for (size_t i = 0; i < applied; i++) {
+        catan::GameEvents::broadcastActionEvents(*ctx.game, actions[i], results[i]);
+        turnPassed = turnPassed || results[i].nextPlayer >= 0;
     }
     
-    if (toolName == "counter_trade") {
-        int originalTradeId = parseJsonInt(req.body, "originalTradeId", -1);
-        std::string message = parseJsonString(req.body, "message");
-        
-        catan::TradeOffer* originalTrade = nullptr;
-        for (auto& t : ctx.game->tradeOffers) {
-            if (t.id == originalTradeId) {
-                originalTrade = &t;
-                break;
-            }
-        }
-        
-        if (!originalTrade) {
-            return jsonResponse(400, "{\"error\":\"Original trade not found\"}");
-        }
-        
-        catan::ResourceHand offering;
-        offering.wood = parseJsonInt(req.body, "giveWood", 0);
-        offering.brick = parseJsonInt(req.body, "giveBrick", 0);
-        offering.wheat = parseJsonInt(req.body, "giveWheat", 0);
-        offering.sheep = parseJsonInt(req.body, "giveSheep", 0);
-        offering.ore = parseJsonInt(req.body, "giveOre", 0);
-        
-        catan::ResourceHand requesting;
-        requesting.wood = parseJsonInt(req.body, "wantWood", 0);
-        requesting.brick = parseJsonInt(req.body, "wantBrick", 0);
-        requesting.wheat = parseJsonInt(req.body, "wantWheat", 0);
-        requesting.sheep = parseJsonInt(req.body, "wantSheep", 0);
-        requesting.ore = parseJsonInt(req.body, "wantOre", 0);
-        
-        if (ctx.player->resources.wood < offering.wood ||
-            ctx.player->resources.brick < offering.brick ||
-            ctx.player->resources.wheat < offering.wheat ||
-            ctx.player->resources.sheep < offering.sheep ||
-            ctx.player->resources.ore < offering.ore) {
-            return jsonResponse(400, "{\"error\":\"Not enough resources\"}");
-        }
-        
-        // Create counter trade
-        catan::TradeOffer counterTrade;
-        counterTrade.id = ctx.game->nextTradeId++;
-        counterTrade.fromPlayerId = ctx.session->playerId;
-        counterTrade.toPlayerId = originalTrade->fromPlayerId;
-        counterTrade.offering = offering;
-        counterTrade.requesting = requesting;
-        counterTrade.isActive = true;
-        
-        // Chat message
-        catan::ChatMessage chatMsg;
-        chatMsg.id = std::to_string(ctx.game->nextChatMessageId++);
-        chatMsg.fromPlayerId = ctx.session->playerId;
-        chatMsg.toPlayerId = originalTrade->fromPlayerId;
-        chatMsg.type = catan::ChatMessageType::TradeCounter;
-        chatMsg.relatedTradeId = counterTrade.id;
-        chatMsg.timestamp = std::chrono::steady_clock::now();
-        
-        std::string proposerName = "Unknown";
-        if (originalTrade->fromPlayerId >= 0 && originalTrade->fromPlayerId < (int)ctx.game->players.size()) {
-            proposerName = ctx.game->players[originalTrade->fromPlayerId].name;
+    catan::Player* current = ctx.game->getCurrentPlayer();
+    if (turnPassed && current && current->isAI()) startAITurns(gameId);
+    
+    catan::JsonWriter json;
+    json.beginObject();
+    json.key("applied").value(applied);
+    json.key("results").beginArray();
+    for (size_t i = 0; i < count && i <= applied; i++) {
+        json.beginObject();
+        json.key("action").value(catan::actionName(actions[i].type));
+        json.key("success").value(i < applied);
+        if (i < applied) {
+            writeActionOutcome(json, *ctx.game, actions[i], results[i]);
+        } else {
+            json.key("error").value(catan::actionErrorMessage(results[i].error, actions[i].type));
         }
-        
-        std::ostringstream desc;
-        desc << "🔄 Counter-offer to " << proposerName << ": ";
-        if (!message.empty()) desc << message;
-        chatMsg.content = desc.str();
-        
-        counterTrade.chatMessageId = chatMsg.id;
-        ctx.game->tradeOffers.push_back(counterTrade);
-        ctx.game->chatMessages.push_back(chatMsg);
-        
-        catan::SSEEvent tradeEvent = catan::GameEvents::createTradeProposedEvent(
-            counterTrade.id, counterTrade.fromPlayerId, ctx.player->name, counterTrade.toPlayerId,
-            offering.wood, offering.brick, offering.wheat, offering.sheep, offering.ore,
-            requesting.wood, requesting.brick, requesting.wheat, requesting.sheep, requesting.ore,
-            message
-        );
-        catan::sseManager.broadcastToGame(gameId, tradeEvent);
-        
-        catan::SSEEvent chatEvent = catan::GameEvents::createChatMessageEvent(
-            chatMsg.id, chatMsg.fromPlayerId, ctx.player->name,
-            chatMsg.toPlayerId, chatMsg.content, "trade_counter"
-        );
-        catan::sseManager.broadcastToGame(gameId, chatEvent);
-        
-        return jsonResponse(200, 
-            "{\"success\":true,\"tool\":\"counter_trade\",\"counterTradeId\":" + std::to_string(counterTrade.id) + "}");
+        json.endObject();
     }
+    json.endArray();
+    json.endObject();
     
-    return jsonResponse(400, "{\"error\":\"Unknown tool: " + toolName + "\"}");
+    int status = applied == count ? 200 : catan::actionErrorStatus(results[applied].error);
+    return jsonResponse(status, json.take());
 }
 
 // Get information about pending AI turns
-std::string handleGetPendingAITurns(const HTTPRequest& req, const std::string& gameId) {
-    catan::Game* game = gameManager.getGame(gameId);
+HTTPResponse handleGetPendingAITurns(const HTTPRequest& req, const std::string& gameId) {
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
         return jsonResponse(404, "{\"error\":\"Game not found\"}");
     }
     
-    std::lock_guard<std::mutex> lock(game->mutex);
+    catan::GameLock lock(*game, catan::GameLock::Mode::Read);
     
-    catan::ai::AIPlayerManager aiManager(game);
+    catan::ai::AIPlayerManager aiManager(game.get());
     
     std::ostringstream json;
     json << "{";
@@ -2480,14 +1076,14 @@ std::string handleGetPendingAITurns(const HTTPRequest& req, const std::string& g
         auto& currentPlayer = game->players[game->currentPlayerIndex];
         json << ",\"currentAIPlayer\":{";
         json << "\"id\":" << currentPlayer.id;
-        json << ",\"name\":\"" << currentPlayer.name << "\"";
+        json << ",\"name\":\"" << catan::escapeJson(currentPlayer.name) << "\"";
         json << "}";
     }
     
     int nextHuman = aiManager.getNextHumanPlayerIndex();
     if (nextHuman >= 0) {
         json << ",\"nextHumanPlayerIndex\":" << nextHuman;
-        json << ",\"nextHumanPlayerName\":\"" << game->players[nextHuman].name << "\"";
+        json << ",\"nextHumanPlayerName\":\"" << catan::escapeJson(game->players[nextHuman].name) << "\"";
     }
     
     json << ",\"humanCount\":" << aiManager.humanPlayerCount();
@@ -2502,33 +1098,32 @@ std::string handleGetPendingAITurns(const HTTPRequest& req, const std::string& g
 // ============================================================================
 
 // Get or create AI executor for a game
-catan::ai::AITurnExecutor* getOrCreateAIExecutor(const std::string& gameId) {
+std::shared_ptr<catan::ai::AITurnExecutor> getOrCreateAIExecutor(const std::string& gameId) {
     std::lock_guard<std::mutex> lock(aiExecutorsMutex);
     
     auto it = aiExecutors.find(gameId);
     if (it != aiExecutors.end()) {
-        return it->second.get();
+        return it->second;
     }
     
-    catan::Game* game = gameManager.getGame(gameId);
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
         return nullptr;
     }
     
-    auto executor = std::make_unique<catan::ai::AITurnExecutor>(game, gameId, llmConfigManager);
-    auto* ptr = executor.get();
-    aiExecutors[gameId] = std::move(executor);
-    return ptr;
+    auto executor = std::make_shared<catan::ai::AITurnExecutor>(game, gameId, llmConfigManager);
+    aiExecutors[gameId] = executor;
+    return executor;
 }
 
 // Start AI turn processing for a game
-std::string handleStartAITurns(const HTTPRequest& req, const std::string& gameId) {
-    catan::Game* game = gameManager.getGame(gameId);
+HTTPResponse handleStartAITurns(const HTTPRequest& req, const std::string& gameId) {
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
         return jsonResponse(404, "{\"error\":\"Game not found\"}");
     }
     
-    auto* executor = getOrCreateAIExecutor(gameId);
+    auto executor = getOrCreateAIExecutor(gameId);
     if (!executor) {
         return jsonResponse(500, "{\"error\":\"Failed to create AI executor\"}");
     }
@@ -2539,14 +1134,14 @@ std::string handleStartAITurns(const HTTPRequest& req, const std::string& gameId
     json << "{";
     json << "\"started\":" << (started ? "true" : "false");
     json << ",\"status\":\"" << (started ? "processing" : "already_running_or_no_ai_turns") << "\"";
-    json << ",\"llmProvider\":\"" << llmConfigManager.getConfig().provider << "\"";
+    json << ",\"llmProvider\":\"" << catan::escapeJson(llmConfigManager.getConfig().provider) << "\"";
     json << "}";
     
     return jsonResponse(200, json.str());
 }
 
 // Stop AI turn processing for a game
-std::string handleStopAITurns(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleStopAITurns(const HTTPRequest& req, const std::string& gameId) {
     std::lock_guard<std::mutex> lock(aiExecutorsMutex);
     
     auto it = aiExecutors.find(gameId);
@@ -2560,13 +1155,13 @@ std::string handleStopAITurns(const HTTPRequest& req, const std::string& gameId)
 }
 
 // Get AI turn processing status
-std::string handleGetAITurnStatus(const HTTPRequest& req, const std::string& gameId) {
-    catan::Game* game = gameManager.getGame(gameId);
+HTTPResponse handleGetAITurnStatus(const HTTPRequest& req, const std::string& gameId) {
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
         return jsonResponse(404, "{\"error\":\"Game not found\"}");
     }
     
-    auto* executor = getOrCreateAIExecutor(gameId);
+    auto executor = getOrCreateAIExecutor(gameId);
     if (!executor) {
         return jsonResponse(500, "{\"error\":\"Failed to get AI executor\"}");
     }
@@ -2575,7 +1170,7 @@ std::string handleGetAITurnStatus(const HTTPRequest& req, const std::string& gam
 }
 
 // Get AI action log for a game
-std::string handleGetAIActionLog(const HTTPRequest& req, const std::string& gameId) {
+HTTPResponse handleGetAIActionLog(const HTTPRequest& req, const std::string& gameId) {
     std::lock_guard<std::mutex> lock(aiExecutorsMutex);
     
     auto it = aiExecutors.find(gameId);
@@ -2592,12 +1187,12 @@ std::string handleGetAIActionLog(const HTTPRequest& req, const std::string& game
         const auto& a = actions[i];
         json << "{";
         json << "\"playerId\":" << a.playerId;
-        json << ",\"playerName\":\"" << a.playerName << "\"";
-        json << ",\"action\":\"" << a.action << "\"";
-        json << ",\"description\":\"" << a.description << "\"";
+        json << ",\"playerName\":\"" << catan::escapeJson(a.playerName) << "\"";
+        json << ",\"action\":\"" << catan::escapeJson(a.action) << "\"";
+        json << ",\"description\":\"" << catan::escapeJson(a.description) << "\"";
         json << ",\"success\":" << (a.success ? "true" : "false");
         if (!a.error.empty()) {
-            json << ",\"error\":\"" << a.error << "\"";
+            json << ",\"error\":\"" << catan::escapeJson(a.error) << "\"";
         }
         json << "}";
     }
@@ -2606,21 +1201,279 @@ std::string handleGetAIActionLog(const HTTPRequest& req, const std::string& game
     return jsonResponse(200, json.str());
 }
 
+// ============================================================================
+// GAME LIFECYCLE
+// ============================================================================
+
+// Stops and forgets a game's AI executor; true if it had one
+bool dropAIExecutor(const std::string& gameId) {
+    std::shared_ptr<catan::ai::AITurnExecutor> executor;
+    {
+        std::lock_guard<std::mutex> lock(aiExecutorsMutex);
+        auto it = aiExecutors.find(gameId);
+        if (it != aiExecutors.end()) {
+            executor = std::move(it->second);
+            aiExecutors.erase(it);
+        }
+    }
+    // Waits out a step in flight, outside the map lock
+    if (executor) {
+        executor->stopProcessing();
+    }
+    return executor != nullptr;
+}
+
+// Drops the stored copy of a game the reaper is about to remove, before it
+// leaves memory; otherwise a lookup in between would load it back
+void forgetStoredGame(const std::string& gameId) {
+    if (gameStore) gameStore->erase(gameId);
+}
+
+// Release everything keyed by a game the reaper removed: its AI executor,
+// its sessions and its SSE subscribers
+void releaseGame(const std::string& gameId) {
+    dropAIExecutor(gameId);
+    sessionManager.removeGameSessions(gameId);
+    catan::sseManager.closeGameClients(gameId);
+    catan::spectatorTier.closeGame(gameId);
+}
+
+void markGameDirty(const catan::Game& game) {
+    gameStore->markDirty(game.gameId);
+}
+
+// Game loader for the manager: decodes a stored game and restores the
+// sessions of its players, so tokens issued before a restart keep working
+bool loadStoredGame(const std::string& gameId, catan::Game& game) {
+    if (!gameStore->load(gameId, game)) return false;
+    for (const auto& player : game.players) {
+        if (!player.sessionToken.empty()) {
+            sessionManager.restoreSession(player.sessionToken, gameId, player.id, player.name);
+        }
+    }
+    return true;
+}
+
+// Session miss handler: loading the token's game restores the session
+void loadGameForToken(const std::string& token) {
+    std::string gameId = gameStore->gameForToken(token);
+    if (!gameId.empty()) {
+        gameManager.getGame(gameId);
+    }
+}
+
+// Opens the store and hooks it into the managers. Lobby games are loaded
+// up front so they are listed; everything else loads on first use.
+void openGameStore(const catan::GameStoreConfig& storeConfig) {
+    gameStore = std::make_unique<catan::GameStore>(storeConfig, [](const std::string& gameId) {
+        return gameManager.getLoadedGame(gameId);
+    });
+    gameStore->open();
+    gameManager.setLoader(loadStoredGame);
+    sessionManager.setMissHandler(loadGameForToken);
+    catan::setWriteListener(markGameDirty);
+    for (const auto& gameId : gameStore->waitingGames()) {
+        gameManager.getGame(gameId);
+    }
+    gameStore->start();
+    std::cout << "Game store: " << gameStore->storedGameCount() << " games in "
+              << storeConfig.directory << std::endl;
+}
+
+// ============================================================================
+// CLUSTER
+// A game moves between nodes as its binary encoding. The sending node holds
+// the game lock from encoding until the receiver has installed it, so no
+// write lands in between; writers that were waiting find the game retired
+// and are forwarded. SSE clients on either side stay connected: the sender
+// relays its clients from the new owner, and the receiver stops relaying
+// the ones it was feeding from the sender and sends them a fresh snapshot.
+// ============================================================================
+
+// POST /games/{id}/migrate {"node": n} - move a game to another node
+HTTPResponse handleMigrateGame(const HTTPRequest& req, const std::string& gameId) {
+    if (!cluster) {
+        return jsonResponse(400, "{\"error\":\"Not running as a cluster\"}");
+    }
+    int target = req.json().getInt("node", -1);
+    if (target < 0 || target >= cluster->nodeCount() || target == cluster->self()) {
+        return jsonResponse(400, "{\"error\":\"node must be another node's index\"}");
+    }
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
+    if (!game) {
+        return jsonResponse(404, "{\"error\":\"Game not found\"}");
+    }
+    
+    // The new owner restarts AI turns itself
+    bool hadAI = dropAIExecutor(gameId);
+    
+    uint64_t version;
+    std::vector<std::pair<int, std::string>> tokens;   // playerId -> token, for relaying viewers
+    {
+        catan::GameLock lock(*game, catan::GameLock::Mode::Read);
+        if (game->retired) {
+            return jsonResponse(409, "{\"error\":\"Game is already moving\"}");
+        }
+        version = game->version.load();
+        for (const auto& player : game->players) {
+            tokens.emplace_back(player.id, player.sessionToken);
+        }
+        
+        int status = 0;
+        std::string error;
+        try {
+            auto reply = cluster->send(target, "POST", "/cluster/games/" + gameId, catan::encodeGame(*game),
+                                       {{"Content-Type", "application/octet-stream"}});
+            status = reply.status;
+            error = reply.body;
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        if (status != 201) {
+            lock.unlock();
+            if (hadAI) {
+                auto executor = getOrCreateAIExecutor(gameId);
+                if (executor) executor->startProcessing();
+            }
+            catan::JsonWriter json;
+            json.beginObject().key("error").value("Node " + std::to_string(target) + " did not take the game")
+                .key("detail").value(error).endObject();
+            return jsonResponse(502, json.take());
+        }
+        
+        cluster->setLocation(gameId, target);
+        game->retired = true;
+    }
+    
+    // Erase the stored copy first, so a lookup after the game has left
+    // this node cannot load it back here
+    if (gameStore) gameStore->erase(gameId);
+    gameManager.removeGame(gameId);
+    sessionManager.removeGameSessions(gameId);
+    
+    // Spectators reconnect and are relayed from the new owner
+    catan::spectatorTier.closeGame(gameId);
+    
+    // Our subscribers now listen through the new owner
+    size_t relayed = 0;
+    for (const auto& [clientId, viewerId] : catan::sseManager.gameClientViewers(gameId)) {
+        std::string token;
+        for (const auto& [playerId, playerToken] : tokens) {
+            if (playerId == viewerId) token = playerToken;
+        }
+        cluster->relay().subscribe(clientId, gameId, token, version, true, 1);
+        relayed++;
+    }
+    
+    // The home forwards there too, for nodes that haven't learned the move
+    int home = cluster->homeOf(gameId);
+    if (home != cluster->self() && home != target) {
+        catan::JsonWriter locate;
+        locate.beginObject().key("gameId").value(gameId).key("node").value(target).endObject();
+        try {
+            cluster->send(home, "POST", "/cluster/locate", locate.take(), {{"Content-Type", "application/json"}});
+        } catch (const std::exception& e) {
+            std::cerr << "Cluster: could not tell node " << home << " where " << gameId
+                      << " went: " << e.what() << std::endl;
+        }
+    }
+    
+    catan::JsonWriter json;
+    json.beginObject()
+        .key("gameId").value(gameId)
+        .key("node").value(target)
+        .key("version").value(version)
+        .key("relayedClients").value(relayed)
+        .endObject();
+    return jsonResponse(200, json.take());
+}
+
+// POST /cluster/games/{id} - install a game sent by another node (internal)
+HTTPResponse handleInstallGame(const HTTPRequest& req, const std::string& gameId) {
+    if (!cluster || !cluster->authorized(req)) {
+        return jsonResponse(403, "{\"error\":\"Forbidden\"}");
+    }
+    if (gameManager.getLoadedGame(gameId)) {
+        return jsonResponse(409, "{\"error\":\"Game already here\"}");
+    }
+    
+    // Subscribers we were feeding from the sender get local broadcasts from now on
+    std::vector<catan::SSERelay::Released> relayed = cluster->relay().releaseGame(gameId);
+    
+    std::shared_ptr<catan::Game> game = gameManager.installGame(gameId, [&](catan::Game& g) {
+        return catan::decodeGame(req.body, g);
+    });
+    if (!game) {
+        return jsonResponse(400, "{\"error\":\"Undecodable game\"}");
+    }
+    cluster->setLocation(gameId, cluster->self());
+    
+    bool aiTurn;
+    uint64_t version;
+    {
+        catan::GameLock lock(*game, catan::GameLock::Mode::Read);
+        version = game->version.load();
+        for (const auto& player : game->players) {
+            if (!player.sessionToken.empty()) {
+                sessionManager.restoreSession(player.sessionToken, gameId, player.id, player.name);
+            }
+        }
+        for (const auto& released : relayed) {
+            int viewerId = -1;
+            for (const auto& player : game->players) {
+                if (!released.token.empty() && player.sessionToken == released.token) viewerId = player.id;
+            }
+            catan::sseManager.setClientViewer(released.clientId, viewerId);
+            if (released.lastVersion < version) {
+                catan::sseManager.sendToClient(released.clientId, catan::GameEvents::createGameStateChangedEvent(
+                    version, catan::cachedGameState(*game, viewerId)->json));
+            }
+        }
+        catan::ai::AIPlayerManager aiManager(game.get());
+        aiTurn = game->phase != catan::GamePhase::WaitingForPlayers &&
+                 game->phase != catan::GamePhase::Finished && aiManager.isCurrentPlayerAI();
+    }
+    if (gameStore) gameStore->markDirty(gameId);
+    
+    if (aiTurn) {
+        auto executor = getOrCreateAIExecutor(gameId);
+        if (executor) executor->startProcessing();
+    }
+    
+    return jsonResponse(201, "{\"gameId\":\"" + gameId + "\",\"version\":" + std::to_string(version) + "}");
+}
+
+// POST /cluster/locate {"gameId", "node"} - a game homed here moved (internal)
+HTTPResponse handleLocateGame(const HTTPRequest& req) {
+    if (!cluster || !cluster->authorized(req)) {
+        return jsonResponse(403, "{\"error\":\"Forbidden\"}");
+    }
+    std::string gameId = req.json().getString("gameId");
+    int node = req.json().getInt("node", -1);
+    if (gameId.empty() || node < 0 || node >= cluster->nodeCount()) {
+        return jsonResponse(400, "{\"error\":\"gameId and node required\"}");
+    }
+    if (!gameManager.getLoadedGame(gameId)) {
+        cluster->setLocation(gameId, node);
+    }
+    return jsonResponse(200, "{\"success\":true}");
+}
+
 // ============================================================================
 // LLM CONFIGURATION ENDPOINTS
 // ============================================================================
 
 // Get current LLM configuration
-std::string handleGetLLMConfig(const HTTPRequest& req) {
+HTTPResponse handleGetLLMConfig(const HTTPRequest& req) {
     return jsonResponse(200, llmConfigManager.toJson());
 }
 
 // Set LLM configuration
-std::string handleSetLLMConfig(const HTTPRequest& req) {
-    std::string provider = parseJsonString(req.body, "provider");
-    std::string apiKey = parseJsonString(req.body, "apiKey");
-    std::string model = parseJsonString(req.body, "model");
-    std::string baseUrl = parseJsonString(req.body, "baseUrl");
+HTTPResponse handleSetLLMConfig(const HTTPRequest& req) {
+    std::string provider = req.json().getString("provider");
+    std::string apiKey = req.json().getString("apiKey");
+    std::string model = req.json().getString("model");
+    std::string baseUrl = req.json().getString("baseUrl");
     
     if (provider.empty()) {
         return jsonResponse(400, "{\"error\":\"Missing provider\"}");
@@ -2631,56 +1484,130 @@ std::string handleSetLLMConfig(const HTTPRequest& req) {
     config.apiKey = apiKey;
     config.model = model;
     config.baseUrl = baseUrl;
+    config.connectTimeoutMs = req.json().getInt("connectTimeoutMs", config.connectTimeoutMs);
+    config.requestTimeoutMs = req.json().getInt("requestTimeoutMs", config.requestTimeoutMs);
+    config.hybrid = req.json().getBool("hybrid", llmConfigManager.getConfig().hybrid);
+    config.promptCaching = req.json().getBool("promptCaching", llmConfigManager.getConfig().promptCaching);
     
     llmConfigManager.setConfig(config);
     
+    // Optional scheduler limits for this provider
+    catan::ai::AIScheduler& scheduler = catan::ai::AIScheduler::instance();
+    catan::ai::AIScheduler::ProviderLimits limits = scheduler.getProviderLimits(provider);
+    limits.maxConcurrent = std::max(1, req.json().getInt("maxConcurrent", limits.maxConcurrent));
+    limits.requestsPerSecond = req.json().getDouble("requestsPerSecond", limits.requestsPerSecond);
+    limits.tokensPerSecond = req.json().getDouble("tokensPerSecond", limits.tokensPerSecond);
+    limits.speculationsPerSecond = req.json().getDouble("speculationsPerSecond", limits.speculationsPerSecond);
+    scheduler.setProviderLimits(provider, limits);
+    
     return jsonResponse(200, llmConfigManager.toJson());
 }
 
+// Get AI scheduler queue depths and per-provider throughput
+HTTPResponse handleGetAIScheduler(const HTTPRequest& req) {
+    return jsonResponse(200, catan::ai::AIScheduler::instance().statsToJson());
+}
+
+// Counters and histograms in the Prometheus text format
+HTTPResponse handleGetMetrics(const HTTPRequest& req) {
+    HTTPResponse response;
+    response.contentType = "text/plain; version=0.0.4";
+    response.body = catan::metrics().renderPrometheus();
+    return response;
+}
+
 // ============================================================================
 // SSE ENDPOINT HANDLER
 // ============================================================================
 
-// Handle SSE connection for game events
-// This function blocks and streams events - it doesn't return a normal response
-bool handleSSEGameEvents(int clientSocket, const std::string& gameId) {
-    catan::Game* game = gameManager.getGame(gameId);
+// Fan a recorded change out to the game's subscribers, one body per viewer.
+// Runs under the game lock, so deltas are queued in version order.
+void publishGameChange(const catan::Game& game, const catan::GameChange& change) {
+    catan::sseManager.broadcastPerViewer(game.gameId, [&](int viewerId) {
+        return catan::GameEvents::createGameDeltaEvent(change.version, catan::deltaJson(change, viewerId));
+    });
+}
+
+// Open an SSE subscription for game events. Runs on a worker, so it can take
+// the game lock and load the game; the socket then stays on the HTTP
+// server's event loop, where events queued by broadcasters are flushed when
+// the socket is writable.
+//
+// ?token= picks the player whose private fields the deltas carry. A client
+// resuming from a version (the Last-Event-ID header on reconnect, or ?since=
+// with the version of the state it just fetched) is sent the deltas it
+// missed, or a full snapshot if they have left the change log.
+//
+// ?spectate=1 subscribes through the spectator tier instead: public events
+// only, in frames, deflated if the client sends Accept-Encoding: deflate.
+std::unique_ptr<catan::StreamSession> openSSEGameEvents(const HTTPRequest& req, const std::string& gameId,
+                                                        int clientSocket, catan::StreamWaker waker) {
+    std::shared_ptr<catan::Game> game = gameManager.getGame(gameId);
     if (!game) {
-        // Send error and close
-        std::string error = jsonResponse(404, "{\"error\":\"Game not found\"}");
-        send(clientSocket, error.c_str(), error.length(), 0);
-        return false;
+        return nullptr;
     }
     
-    // Write SSE headers
-    if (!catan::SSEManager::writeSSEHeaders(clientSocket)) {
-        return false;
+    std::string spectate = req.queryParam("spectate");
+    bool spectating = spectate == "1" || spectate == "true";
+    
+    int viewerId = -1;
+    std::string token = req.queryParam("token");
+    if (!token.empty() && !spectating) {
+        catan::SharedSession session = sessionManager.getSession(token);
+        if (session && session->gameId == gameId) {
+            viewerId = session->playerId;
+        }
+    }
+    
+    std::string resumeFrom = req.queryParam("since");
+    auto lastEventIt = req.headers.find("last-event-id");
+    if (lastEventIt != req.headers.end() && !lastEventIt->second.empty()) {
+        resumeFrom = lastEventIt->second;
     }
     
-    // Register this client
-    catan::SSEClient* client = catan::sseManager.registerClient(clientSocket, gameId);
+    // Register and catch up under the lock so no change lands in between
+    catan::GameLock lock(*game, catan::GameLock::Mode::Read);
+    uint64_t current = game->version.load();
     
-    // Send initial connection event
+    // Initial connection event, then whatever the client missed
+    std::vector<catan::SSEEvent> opening;
     catan::SSEEvent connectEvent;
     connectEvent.event = "connected";
-    connectEvent.data = "{\"gameId\":\"" + gameId + "\",\"message\":\"Connected to game events\"}";
-    connectEvent.id = catan::sseManager.nextEventId();
-    catan::sseManager.sendToClient(client, connectEvent);
-    
-    // Keep connection alive and handle events
-    // The actual events will be sent by the AI executor and other game actions
-    while (client->connected) {
-        // Send keepalive every 15 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(15));
-        
-        if (!catan::SSEManager::writeKeepalive(clientSocket)) {
-            break;
+    connectEvent.data = "{\"gameId\":\"" + gameId + "\",\"version\":" + std::to_string(current) +
+                        ",\"message\":\"Connected to game events\"}";
+    opening.push_back(std::move(connectEvent));
+    
+    if (!resumeFrom.empty()) {
+        char* end = nullptr;
+        uint64_t since = std::strtoull(resumeFrom.c_str(), &end, 10);
+        bool valid = end && *end == '\0' && since <= current;
+        
+        if (valid && since < current && game->changes.find(since + 1)) {
+            for (uint64_t v = since + 1; v <= current; v++) {
+                const catan::GameChange* change = game->changes.find(v);
+                opening.push_back(catan::GameEvents::createGameDeltaEvent(v, catan::deltaJson(*change, viewerId)));
+            }
+        } else if (!valid || since < current) {
+            opening.push_back(catan::GameEvents::createGameStateChangedEvent(
+                current, catan::cachedGameState(*game, viewerId)->json));
         }
     }
     
-    // Cleanup
-    catan::sseManager.unregisterClient(client);
-    return true;
+    // Spectators see what a viewer without a seat sees, batched into frames
+    if (spectating && catan::spectatorTier.running()) {
+        bool deflate = req.headers.get("accept-encoding").find("deflate") != std::string::npos;
+        catan::SSEClient* client = catan::spectatorTier.registerClient(
+            clientSocket, gameId, std::move(waker), deflate, opening);
+        return std::make_unique<catan::SpectatorStream>(client);
+    }
+    
+    // Register this client (queues the stream headers)
+    catan::SSEClient* client = catan::sseManager.registerClient(clientSocket, gameId, std::move(waker), viewerId);
+    for (const catan::SSEEvent& event : opening) {
+        catan::sseManager.sendToClient(client, event);
+    }
+    
+    return std::make_unique<catan::SSEStream>(client);
 }
 
 // ============================================================================
@@ -2718,7 +1645,7 @@ ParsedGamePath parseGamePath(const std::string& path) {
     return result;
 }
 
-std::string routeRequest(const HTTPRequest& req) {
+HTTPResponse routeRequest(const HTTPRequest& req) {
     // POST /games - Create a new game
     if (req.method == "POST" && req.path == "/games") {
         return handleCreateGame(req);
@@ -2746,10 +1673,37 @@ std::string routeRequest(const HTTPRequest& req) {
         return handleSetLLMConfig(req);
     }
     
+    // GET /ai/scheduler - Get shared AI scheduler stats
+    if (req.method == "GET" && req.path == "/ai/scheduler") {
+        return handleGetAIScheduler(req);
+    }
+    
+    // GET /metrics - Prometheus metrics
+    if (req.method == "GET" && req.path == "/metrics") {
+        return handleGetMetrics(req);
+    }
+    
+    // ============ CLUSTER (internal) ============
+    
+    // POST /cluster/games/{id} - Take over a game from another node
+    if (req.method == "POST" && req.path.compare(0, 15, "/cluster/games/") == 0 && req.path.size() > 15) {
+        return handleInstallGame(req, req.path.substr(15));
+    }
+    
+    // POST /cluster/locate - Where a game homed here has gone
+    if (req.method == "POST" && req.path == "/cluster/locate") {
+        return handleLocateGame(req);
+    }
+    
     // Parse game-specific routes
     ParsedGamePath gamePath = parseGamePath(req.path);
     
     if (gamePath.valid) {
+        // POST /games/{id}/migrate - Move the game to another cluster node
+        if (req.method == "POST" && gamePath.action == "migrate") {
+            return handleMigrateGame(req, gamePath.gameId);
+        }
+        
         // POST /games/{id}/join - Join a game
         if (req.method == "POST" && gamePath.action == "join") {
             return handleJoinGame(req, gamePath.gameId);
@@ -2807,6 +1761,11 @@ std::string routeRequest(const HTTPRequest& req) {
             return handleBankTrade(req, gamePath.gameId);
         }
         
+        // POST /games/{id}/actions - Apply several actions under one lock
+        if (req.method == "POST" && gamePath.action == "actions") {
+            return handleApplyActions(req, gamePath.gameId);
+        }
+        
         // ============ CHAT ENDPOINTS ============
         
         // POST /games/{id}/chat - Send a chat message
@@ -2909,167 +1868,309 @@ std::string routeRequest(const HTTPRequest& req) {
         return jsonResponse(200, 
             "{\"status\":\"ok\","
             "\"activeGames\":" + std::to_string(gameManager.gameCount()) + ","
-            "\"activeSessions\":" + std::to_string(sessionManager.activeSessionCount()) + ","
-            "\"llmProvider\":\"" + llmConfigManager.getConfig().provider + "\"}");
+            "\"activeSessions\":" + std::to_string(sessionManager.activeSessionCount()) + "," +
+            (cluster ? "\"clusterNode\":" + std::to_string(cluster->self()) + "," : std::string()) +
+            "\"llmProvider\":\"" + catan::escapeJson(llmConfigManager.getConfig().provider) + "\"}");
     }
     
     return jsonResponse(404, "{\"error\":\"Not found\"}");
 }
 
+
 // ============================================================================
 // HTTP SERVER
 // ============================================================================
 
-class HTTPServer {
-private:
-    int server_fd;
-    struct sockaddr_in address;
-    bool running;
-
-    void handleClient(int client_socket) {
-        char buffer[4096] = {0};
-        int valread = read(client_socket, buffer, sizeof(buffer) - 1);
-
-        if (valread > 0) {
-            HTTPRequest req = parseRequest(std::string(buffer, valread));
-            
-            std::cout << req.method << " " << req.path;
-            if (!req.authToken.empty()) {
-                std::cout << " [auth:" << req.authToken.substr(0, 8) << "...]";
-            }
-            
-            // Check if this is an SSE request
-            auto acceptIt = req.headers.find("accept");
-            bool isSSE = (acceptIt != req.headers.end() && 
-                         acceptIt->second.find("text/event-stream") != std::string::npos);
-            
-            // Handle SSE requests for game events
-            if (isSSE && req.method == "GET" && req.path.substr(0, 7) == "/games/") {
-                std::string rest = req.path.substr(7);
-                size_t slashPos = rest.find('/');
-                std::string gameId = (slashPos != std::string::npos) ? rest.substr(0, slashPos) : rest;
-                std::string action = (slashPos != std::string::npos) ? rest.substr(slashPos + 1) : "";
-                
-                if (action == "events" || action == "sse") {
-                    std::cout << " [SSE]" << std::endl;
-                    // This blocks until the client disconnects
-                    handleSSEGameEvents(client_socket, gameId);
-                    // Don't close socket here - handleSSEGameEvents manages it
-                    return;
-                }
-            }
-            
-            std::cout << std::endl;
-
-            std::string response = routeRequest(req);
-            send(client_socket, response.c_str(), response.length(), 0);
-        }
-
-        close(client_socket);
+// SSE subscriptions: GET /games/{id}/events (or /sse) with Accept: text/event-stream
+bool isSSERequest(const HTTPRequest& req) {
+    if (req.method != "GET") return false;
+    auto acceptIt = req.headers.find("accept");
+    if (acceptIt == req.headers.end() ||
+        acceptIt->second.find("text/event-stream") == std::string::npos) {
+        return false;
     }
+    ParsedGamePath gamePath = parseGamePath(req.path);
+    return gamePath.valid && (gamePath.action == "events" || gamePath.action == "sse");
+}
 
-public:
-    HTTPServer(int port = 8080) : running(false) {
-        server_fd = socket(AF_INET, SOCK_STREAM, 0);
-        if (server_fd < 0) {
-            throw std::runtime_error("Socket creation failed");
-        }
-
-        int opt = 1;
-        if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-            close(server_fd);
-            throw std::runtime_error("Setsockopt failed");
-        }
+// Forwards a game request to the node that should hold the game, or answers
+// 404 when that is this node or the request has been passed around too long
+HTTPResponse forwardGameRequest(const HTTPRequest& req, const std::string& gameId) {
+    int hops = std::atoi(std::string(req.headers.get(catan::CLUSTER_HOPS_HEADER)).c_str());
+    int owner = cluster->ownerOf(gameId);
+    if (owner == cluster->self() || hops >= catan::CLUSTER_MAX_HOPS) {
+        return jsonResponse(404, "{\"error\":\"Game not found\"}");
+    }
+    return cluster->forward(owner, req, gameId, hops + 1);
+}
 
-        address.sin_family = AF_INET;
-        address.sin_addr.s_addr = INADDR_ANY;
-        address.sin_port = htons(port);
+// Routes a request in cluster mode: game requests are handled where the
+// game is and tagged with this node, or forwarded
+HTTPResponse routeClusterRequest(const HTTPRequest& req) {
+    ParsedGamePath gamePath = parseGamePath(req.path);
+    if (!gamePath.valid) return routeRequest(req);
+    
+    const std::string& gameId = gamePath.gameId;
+    if (!gameManager.getGame(gameId)) return forwardGameRequest(req, gameId);
+    
+    HTTPResponse response;
+    try {
+        response = routeRequest(req);
+    } catch (const catan::GameMovedError&) {
+        return forwardGameRequest(req, gameId);
+    }
+    // Moved away between the lookup and the handler's own
+    if (response.status == 404 && !gameManager.getLoadedGame(gameId) &&
+        cluster->ownerOf(gameId) != cluster->self()) {
+        return forwardGameRequest(req, gameId);
+    }
+    response.headers += std::string(catan::CLUSTER_NODE_HEADER) + ": " + std::to_string(cluster->self()) + "\r\n";
+    return response;
+}
 
-        if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
-            close(server_fd);
-            throw std::runtime_error("Bind failed");
-        }
+// SSE subscription for a game held on another node: the client is
+// registered here and fed by the relay
+std::unique_ptr<catan::StreamSession> openRelayedGameEvents(const HTTPRequest& req, const std::string& gameId,
+                                                            int clientSocket, catan::StreamWaker waker) {
+    int hops = std::atoi(std::string(req.headers.get(catan::CLUSTER_HOPS_HEADER)).c_str());
+    int owner = cluster->ownerOf(gameId);
+    if (owner == cluster->self() || hops >= catan::CLUSTER_MAX_HOPS) {
+        return nullptr;
+    }
+    
+    std::string resumeFrom = req.queryParam("since");
+    std::string_view lastEventId = req.headers.get("last-event-id");
+    if (!lastEventId.empty()) resumeFrom = std::string(lastEventId);
+    uint64_t since = std::strtoull(resumeFrom.c_str(), nullptr, 10);
+    
+    catan::SSEClient* client = catan::sseManager.registerClient(clientSocket, gameId, std::move(waker));
+    cluster->relay().subscribe(client->id, gameId, req.queryParam("token"), since, false, hops + 1);
+    return std::make_unique<catan::SSEStream>(client);
+}
 
-        if (listen(server_fd, 10) < 0) {
-            close(server_fd);
-            throw std::runtime_error("Listen failed");
-        }
+// status and durationNs are left out of the line for a stream, which has neither
+void logRequest(const HTTPRequest& req, bool isSSE, int status = 0, uint64_t durationNs = 0) {
+    std::string line = req.method + " " + req.path;
+    if (!req.authToken.empty()) {
+        line += " [auth:" + req.authToken.substr(0, 8) + "...]";
+    }
+    if (isSSE) {
+        line += " [SSE]";
+    } else {
+        char timing[48];
+        std::snprintf(timing, sizeof(timing), " %d %.2fms", status, static_cast<double>(durationNs) / 1e6);
+        line += timing;
+    }
+    requestLog.write(line);
+}
 
-        std::cout << "🎲 Catan Game Server listening on port " << port << std::endl;
-        std::cout << "\n   LOBBY:" << std::endl;
-        std::cout << "   POST /games              - Create a new game" << std::endl;
-        std::cout << "   GET  /games              - List all games" << std::endl;
-        std::cout << "   POST /games/{id}/join    - Join a game (body: {name, isAI})" << std::endl;
-        std::cout << "   POST /games/{id}/add-ai  - Add AI players to fill slots" << std::endl;
-        std::cout << "   POST /games/{id}/start   - Start the game" << std::endl;
-        std::cout << "   GET  /games/{id}         - Get game state" << std::endl;
-        std::cout << "\n   GAMEPLAY: (require auth token)" << std::endl;
-        std::cout << "   POST /games/{id}/roll           - Roll dice" << std::endl;
-        std::cout << "   POST /games/{id}/buy/road       - Buy a road" << std::endl;
-        std::cout << "   POST /games/{id}/buy/settlement - Buy a settlement" << std::endl;
-        std::cout << "   POST /games/{id}/buy/city       - Buy a city" << std::endl;
-        std::cout << "   POST /games/{id}/buy/devcard    - Buy dev card" << std::endl;
-        std::cout << "   POST /games/{id}/trade/bank     - Trade with bank (4:1)" << std::endl;
-        std::cout << "   POST /games/{id}/end-turn       - End your turn (auto-triggers AI)" << std::endl;
-        std::cout << "\n   SERVER-SIDE AI (auto-runs when AI player's turn):" << std::endl;
-        std::cout << "   POST /games/{id}/ai/start      - Manually start AI processing" << std::endl;
-        std::cout << "   POST /games/{id}/ai/stop       - Stop AI processing" << std::endl;
-        std::cout << "   GET  /games/{id}/ai/status     - Get AI processing status" << std::endl;
-        std::cout << "   GET  /games/{id}/ai/log        - Get AI action log" << std::endl;
-        std::cout << "\n   REAL-TIME EVENTS (SSE):" << std::endl;
-        std::cout << "   GET  /games/{id}/events        - Subscribe to game events (SSE)" << std::endl;
-        std::cout << "\n   LLM CONFIGURATION:" << std::endl;
-        std::cout << "   GET  /llm/config               - Get LLM config" << std::endl;
-        std::cout << "   POST /llm/config               - Set LLM config (provider, apiKey, model)" << std::endl;
-        std::cout << "\n   Current LLM: " << llmConfigManager.getConfig().provider << std::endl;
-        std::cout << "   (Set ANTHROPIC_API_KEY or OPENAI_API_KEY env var to auto-configure)" << std::endl;
-        std::cout << std::endl;
-    }
-
-    ~HTTPServer() {
-        if (server_fd >= 0) {
-            close(server_fd);
+// Route label for request metrics: game routes with the id taken out, and
+// one label for every unmatched request so clients can't mint new series
+std::string routeLabel(const HTTPRequest& req, int status) {
+    if (status == 404) return "unmatched";
+    if (req.path.compare(0, 15, "/cluster/games/") == 0) return "/cluster/games/{id}";
+    ParsedGamePath gamePath = parseGamePath(req.path);
+    if (gamePath.valid) {
+        const std::string& action = gamePath.action;
+        if (action.empty()) return "/games/{id}";
+        if (action.compare(0, 6, "trade/") == 0 && action != "trade/bank" && action != "trade/propose") {
+            // trade/{tradeId}/{action}: the trade id is the client's to choose
+            size_t slashPos = action.find('/', 6);
+            std::string tradeAction = slashPos == std::string::npos ? "" : action.substr(slashPos + 1);
+            if (tradeAction == "accept" || tradeAction == "reject" ||
+                tradeAction == "counter" || tradeAction == "cancel") {
+                return "/games/{id}/trade/{tradeId}/" + tradeAction;
+            }
+            return "unmatched";
         }
+        return "/games/{id}/" + action;
     }
+    return req.path;
+}
 
-    void run() {
-        running = true;
-        std::vector<std::thread> threads;
-
-        while (running) {
-            int addrlen = sizeof(address);
-            int client_socket = accept(server_fd, (struct sockaddr*)&address, (socklen_t*)&addrlen);
-
-            if (client_socket < 0) {
-                if (running) {
-                    std::cerr << "Accept failed" << std::endl;
-                }
-                continue;
-            }
+// Per-route latency and per-status counts. Each worker keeps its own index
+// of the series it has used, so only a thread's first request to a route
+// goes through the registry.
+void recordRequest(const HTTPRequest& req, int status, uint64_t durationNs) {
+    thread_local std::unordered_map<std::string, catan::Histogram*> latencies;
+    thread_local std::unordered_map<int, catan::Counter*> responses;
+    
+    std::string route = routeLabel(req, status);
+    const std::string& method = status == 404 ? route : req.method;
+    std::string key = method + " " + route;
+    auto latency = latencies.find(key);
+    if (latency == latencies.end()) {
+        catan::Histogram& series = catan::metrics().histogram(
+            "catan_http_request_seconds", "Time to route and handle a request",
+            catan::metricLabels({{"method", method}, {"route", route}}));
+        latency = latencies.emplace(std::move(key), &series).first;
+    }
+    latency->second->record(durationNs);
+    
+    auto response = responses.find(status);
+    if (response == responses.end()) {
+        catan::Counter& series = catan::metrics().counter(
+            "catan_http_responses_total", "Responses by status code",
+            catan::metricLabels({{"code", std::to_string(status)}}));
+        response = responses.emplace(status, &series).first;
+    }
+    response->second->add();
+    
+    logRequest(req, false, status, durationNs);
+}
 
-            threads.emplace_back([this, client_socket]() {
-                this->handleClient(client_socket);
-            });
-        }
+// Values owned by the managers, read when /metrics is scraped
+void registerMetricCallbacks() {
+    catan::MetricsRegistry& registry = catan::metrics();
+    registry.callback("catan_games_active", "Games in memory", catan::MetricType::Gauge,
+                      [] { return static_cast<double>(gameManager.gameCount()); });
+    registry.callback("catan_sessions_active", "Player sessions", catan::MetricType::Gauge,
+                      [] { return static_cast<double>(sessionManager.activeSessionCount()); });
+    registry.callback("catan_sse_clients", "Connected SSE clients", catan::MetricType::Gauge,
+                      [] { return static_cast<double>(catan::sseManager.totalClientCount()); });
+    registry.callback("catan_spectators", "Connected spectator streams", catan::MetricType::Gauge,
+                      [] { return static_cast<double>(catan::spectatorTier.clientCount()); });
+    if (cluster) {
+        registry.callback("catan_cluster_relays", "SSE clients fed from another node", catan::MetricType::Gauge,
+                          [] { return static_cast<double>(cluster->relay().relayCount()); });
+    }
+    registry.callback("catan_request_log_dropped_total", "Request log lines dropped on a full ring",
+                      catan::MetricType::Counter,
+                      [] { return static_cast<double>(requestLog.droppedLines()); });
+}
 
-        for (auto& thread : threads) {
-            if (thread.joinable()) {
-                thread.join();
-            }
-        }
-    }
+int envInt(const char* name, int defaultValue) {
+    const char* value = std::getenv(name);
+    return (value && *value) ? std::atoi(value) : defaultValue;
+}
 
-    void stop() {
-        running = false;
-        shutdown(server_fd, SHUT_RDWR);
-    }
-};
+void printBanner(const catan::HTTPServer& server, int port) {
+    std::cout << "🎲 Catan Game Server listening on port " << port
+              << " (" << server.ioThreadCount() << " I/O threads, "
+              << server.workerThreadCount() << " workers)" << std::endl;
+    std::cout << "\n   LOBBY:" << std::endl;
+    std::cout << "   POST /games              - Create a new game" << std::endl;
+    std::cout << "   GET  /games              - List all games" << std::endl;
+    std::cout << "   POST /games/{id}/join    - Join a game (body: {name, isAI})" << std::endl;
+    std::cout << "   POST /games/{id}/add-ai  - Add AI players to fill slots" << std::endl;
+    std::cout << "   POST /games/{id}/start   - Start the game" << std::endl;
+    std::cout << "   GET  /games/{id}         - Get game state" << std::endl;
+    std::cout << "\n   GAMEPLAY: (require auth token)" << std::endl;
+    std::cout << "   POST /games/{id}/roll           - Roll dice" << std::endl;
+    std::cout << "   POST /games/{id}/buy/road       - Buy a road" << std::endl;
+    std::cout << "   POST /games/{id}/buy/settlement - Buy a settlement" << std::endl;
+    std::cout << "   POST /games/{id}/buy/city       - Buy a city" << std::endl;
+    std::cout << "   POST /games/{id}/buy/devcard    - Buy dev card" << std::endl;
+    std::cout << "   POST /games/{id}/trade/bank     - Trade with bank (4:1)" << std::endl;
+    std::cout << "   POST /games/{id}/end-turn       - End your turn (auto-triggers AI)" << std::endl;
+    std::cout << "\n   SERVER-SIDE AI (auto-runs when AI player's turn):" << std::endl;
+    std::cout << "   POST /games/{id}/ai/start      - Manually start AI processing" << std::endl;
+    std::cout << "   POST /games/{id}/ai/stop       - Stop AI processing" << std::endl;
+    std::cout << "   GET  /games/{id}/ai/status     - Get AI processing status" << std::endl;
+    std::cout << "   GET  /games/{id}/ai/log        - Get AI action log" << std::endl;
+    std::cout << "   GET  /ai/scheduler             - Get shared AI scheduler stats" << std::endl;
+    std::cout << "   GET  /metrics                  - Prometheus metrics" << std::endl;
+    if (cluster) {
+        std::cout << "\n   CLUSTER: node " << cluster->self() << " of " << cluster->nodeCount() << std::endl;
+        std::cout << "   POST /games/{id}/migrate       - Move a game to another node (body: {node})" << std::endl;
+    }
+    std::cout << "\n   REAL-TIME EVENTS (SSE):" << std::endl;
+    std::cout << "   GET  /games/{id}/events        - Subscribe to game events (SSE; ?token=, ?since=, ?spectate=1)" << std::endl;
+    std::cout << "\n   LLM CONFIGURATION:" << std::endl;
+    std::cout << "   GET  /llm/config               - Get LLM config" << std::endl;
+    std::cout << "   POST /llm/config               - Set LLM config (provider, apiKey, model, rate limits)" << std::endl;
+    std::cout << "\n   Current LLM: " << llmConfigManager.getConfig().provider << std::endl;
+    std::cout << "   (Set ANTHROPIC_API_KEY or OPENAI_API_KEY env var to auto-configure)" << std::endl;
+    std::cout << std::endl;
+}
 
 int main() {
     try {
-        HTTPServer server(8080);
+        catan::HTTPServerConfig config;
+        config.port = envInt("CATAN_PORT", 8080);
+        config.backlog = envInt("CATAN_LISTEN_BACKLOG", config.backlog);
+        config.ioThreads = envInt("CATAN_IO_THREADS", 0);
+        config.workerThreads = envInt("CATAN_WORKER_THREADS", 0);
+        config.maxQueuedRequests = static_cast<size_t>(
+            envInt("CATAN_MAX_QUEUED_REQUESTS", static_cast<int>(config.maxQueuedRequests)));
+
+        gameManager.setHistoryLimits(
+            static_cast<size_t>(std::max(1, envInt("CATAN_CHAT_HISTORY", static_cast<int>(catan::DEFAULT_CHAT_HISTORY)))),
+            static_cast<size_t>(std::max(1, envInt("CATAN_TRADE_HISTORY", static_cast<int>(catan::DEFAULT_TRADE_HISTORY)))));
+        catan::setChangeListener(publishGameChange);
+        
+        std::vector<std::string> clusterNodes = catan::parseClusterNodes(
+            std::getenv("CATAN_CLUSTER_NODES") ? std::getenv("CATAN_CLUSTER_NODES") : "");
+        if (clusterNodes.size() > 1) {
+            catan::ClusterConfig clusterConfig;
+            clusterConfig.nodes = clusterNodes;
+            clusterConfig.self = envInt("CATAN_CLUSTER_NODE", -1);
+            clusterConfig.secret = std::getenv("CATAN_CLUSTER_SECRET") ? std::getenv("CATAN_CLUSTER_SECRET") : "";
+            clusterConfig.forwardTimeoutMs = envInt("CATAN_CLUSTER_TIMEOUT_MS", clusterConfig.forwardTimeoutMs);
+            cluster = std::make_unique<catan::ClusterNode>(clusterConfig, [](const std::string& gameId) {
+                return gameManager.getLoadedGame(gameId) != nullptr;
+            });
+            gameManager.setIdPrefix(cluster->gameIdPrefix());
+        }
+
+        catan::HTTPHandlers handlers;
+        handlers.route = [](const HTTPRequest& req) {
+            auto start = std::chrono::steady_clock::now();
+            HTTPResponse response = cluster ? routeClusterRequest(req) : routeRequest(req);
+            recordRequest(req, response.status, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+            return response;
+        };
+        handlers.isStream = isSSERequest;
+        handlers.stream = [](const HTTPRequest& req, int socket, catan::StreamWaker waker) {
+            logRequest(req, true);
+            std::string gameId = parseGamePath(req.path).gameId;
+            if (cluster && !gameManager.getGame(gameId)) {
+                return openRelayedGameEvents(req, gameId, socket, std::move(waker));
+            }
+            return openSSEGameEvents(req, gameId, socket, std::move(waker));
+        };
+
+        catan::GameReaperConfig reaperConfig;
+        reaperConfig.idleTtl = std::chrono::minutes(
+            envInt("CATAN_GAME_TTL_MINUTES", static_cast<int>(reaperConfig.idleTtl.count())));
+        reaperConfig.finishedTtl = std::chrono::minutes(
+            envInt("CATAN_FINISHED_GAME_TTL_MINUTES", static_cast<int>(reaperConfig.finishedTtl.count())));
+        reaperConfig.interval = std::chrono::seconds(std::max(1,
+            envInt("CATAN_REAP_INTERVAL_SECONDS", static_cast<int>(reaperConfig.interval.count()))));
+        
+        const char* dataDir = std::getenv("CATAN_DATA_DIR");
+        if (dataDir && *dataDir) {
+            catan::GameStoreConfig storeConfig;
+            storeConfig.directory = dataDir;
+            storeConfig.shards = static_cast<size_t>(std::max(1, envInt("CATAN_STORE_SHARDS", 8)));
+            storeConfig.flushInterval = std::chrono::milliseconds(std::max(1,
+                envInt("CATAN_STORE_FLUSH_MS", static_cast<int>(storeConfig.flushInterval.count()))));
+            storeConfig.sync = envInt("CATAN_STORE_FSYNC", 1) != 0;
+            storeConfig.maxAge = reaperConfig.idleTtl;
+            openGameStore(storeConfig);
+        }
+        
+        catan::SpectatorConfig spectatorConfig;
+        spectatorConfig.frameInterval = std::chrono::milliseconds(std::max(1,
+            envInt("CATAN_SPECTATOR_FRAME_MS", static_cast<int>(spectatorConfig.frameInterval.count()))));
+        spectatorConfig.threads = std::max(1, envInt("CATAN_SPECTATOR_THREADS", spectatorConfig.threads));
+        spectatorConfig.deflate = envInt("CATAN_SPECTATOR_DEFLATE", 1) != 0;
+        catan::spectatorTier.start(spectatorConfig);
+        
+        catan::GameReaper reaper(gameManager, reaperConfig, releaseGame, forgetStoredGame);
+        reaper.start();
+
+        registerMetricCallbacks();
+        
+        catan::HTTPServer server(config, std::move(handlers));
+        printBanner(server, config.port);
         std::cout << "Server started. Press Ctrl+C to stop." << std::endl;
+        requestLog.start();
         server.run();
+        catan::spectatorTier.stop();
+        requestLog.stop();
+        cluster.reset();
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -1,172 +1,194 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
-#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <chrono>
-#include <random>
-#include <sstream>
-#include <iomanip>
+#include <functional>
+
+#include "random.h"
+#include "striped_map.h"
 
 namespace catan {
 
 struct Session {
+    using Clock = std::chrono::steady_clock;
+
     std::string token;
     std::string gameId;
     int playerId;
     std::string playerName;
-    std::chrono::steady_clock::time_point createdAt;
-    std::chrono::steady_clock::time_point lastActivity;
-    bool isActive = true;
+    Clock::time_point createdAt;
+    // Written on every authenticated request, so atomic rather than
+    // guarded: lookups only ever need the map's shared lock
+    std::atomic<Clock::rep> lastActivity{0};
+    std::atomic<bool> isActive{true};
+
+    void touch() {
+        lastActivity.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    Clock::time_point lastActive() const {
+        return Clock::time_point(Clock::duration(lastActivity.load(std::memory_order_relaxed)));
+    }
 };
 
+using SharedSession = std::shared_ptr<Session>;
+
 class SessionManager {
 private:
-    // token -> Session
-    std::unordered_map<std::string, Session> sessions;
+    // token -> Session. Sessions are shared so a handler's pointer stays
+    // valid even if the session is removed while it runs.
+    StripedMap<SharedSession> sessions;
     
     // Reverse lookup: gameId:playerId -> token (for reconnection)
-    std::unordered_map<std::string, std::string> playerToToken;
+    StripedMap<std::string> playerToToken;
     
-    mutable std::mutex mutex;
+    std::function<void(const std::string& token)> missHandler;
     
+    // 128 bits from the thread's CSPRNG, as 32 hex digits
     std::string generateToken() {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_int_distribution<uint64_t> dis;
-        
-        std::stringstream ss;
-        ss << std::hex << std::setfill('0');
-        ss << std::setw(16) << dis(gen);
-        ss << std::setw(16) << dis(gen);
-        return ss.str();
+        return secureRandomHex(16);
     }
     
-    std::string makePlayerKey(const std::string& gameId, int playerId) {
+    static std::string makePlayerKey(const std::string& gameId, int playerId) {
         return gameId + ":" + std::to_string(playerId);
     }
 
+    SharedSession findSession(const std::string& token) const {
+        SharedSession result;
+        sessions.visit(token, [&](const SharedSession& session) { result = session; });
+        return result;
+    }
+
+    // Drops the reverse entry only if it still points at this token
+    void forgetPlayer(const Session& session) {
+        std::string key = makePlayerKey(session.gameId, session.playerId);
+        std::string current;
+        playerToToken.visit(key, [&](const std::string& token) { current = token; });
+        if (current == session.token) {
+            playerToToken.erase(key);
+        }
+    }
+
 public:
     // Create a new session when player joins a game
     // Returns the session token
     std::string createSession(const std::string& gameId, int playerId, const std::string& playerName) {
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        std::string token = generateToken();
-        auto now = std::chrono::steady_clock::now();
-        
-        Session session;
-        session.token = token;
-        session.gameId = gameId;
-        session.playerId = playerId;
-        session.playerName = playerName;
-        session.createdAt = now;
-        session.lastActivity = now;
-        session.isActive = true;
-        
-        sessions[token] = session;
-        playerToToken[makePlayerKey(gameId, playerId)] = token;
-        
-        return token;
+        auto session = std::make_shared<Session>();
+        session->gameId = gameId;
+        session->playerId = playerId;
+        session->playerName = playerName;
+        session->createdAt = Session::Clock::now();
+        session->touch();
+        
+        do {
+            session->token = generateToken();
+        } while (!sessions.insert(session->token, SharedSession(session)));
+        playerToToken.assign(makePlayerKey(gameId, playerId), session->token);
+        
+        return session->token;
+    }
+    
+    // Recreate a session for a token issued before a restart. Leaves an
+    // existing session under the token alone.
+    void restoreSession(const std::string& token, const std::string& gameId, int playerId,
+                        const std::string& playerName) {
+        auto session = std::make_shared<Session>();
+        session->token = token;
+        session->gameId = gameId;
+        session->playerId = playerId;
+        session->playerName = playerName;
+        session->createdAt = Session::Clock::now();
+        session->touch();
+        
+        if (sessions.insert(token, SharedSession(session))) {
+            playerToToken.assign(makePlayerKey(gameId, playerId), token);
+        }
+    }
+    
+    // Called with a token that has no session, e.g. to restore it from
+    // storage; getSession looks it up again afterwards
+    void setMissHandler(std::function<void(const std::string& token)> handler) {
+        missHandler = std::move(handler);
     }
     
     // Validate a token and get the session
     // Returns nullptr if invalid/expired
-    Session* getSession(const std::string& token) {
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        auto it = sessions.find(token);
-        if (it == sessions.end()) {
-            return nullptr;
+    SharedSession getSession(const std::string& token) {
+        SharedSession session = findSession(token);
+        if (!session && missHandler && !token.empty()) {
+            missHandler(token);
+            session = findSession(token);
         }
-        
-        if (!it->second.isActive) {
+        if (!session || !session->isActive.load(std::memory_order_relaxed)) {
             return nullptr;
         }
         
         // Update last activity
-        it->second.lastActivity = std::chrono::steady_clock::now();
-        return &it->second;
+        session->touch();
+        return session;
     }
     
     // Get session by game and player (for reconnection scenarios)
-    Session* getSessionByPlayer(const std::string& gameId, int playerId) {
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        auto it = playerToToken.find(makePlayerKey(gameId, playerId));
-        if (it == playerToToken.end()) {
+    SharedSession getSessionByPlayer(const std::string& gameId, int playerId) {
+        std::string token;
+        if (!playerToToken.visit(makePlayerKey(gameId, playerId),
+                                 [&](const std::string& found) { token = found; })) {
             return nullptr;
         }
-        
-        auto sessionIt = sessions.find(it->second);
-        if (sessionIt == sessions.end()) {
-            return nullptr;
-        }
-        
-        return &sessionIt->second;
+        return findSession(token);
     }
     
     // Invalidate a session (player leaves/disconnects)
     bool invalidateSession(const std::string& token) {
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        auto it = sessions.find(token);
-        if (it != sessions.end()) {
-            it->second.isActive = false;
-            return true;
+        SharedSession session = findSession(token);
+        if (!session) {
+            return false;
         }
-        return false;
+        session->isActive.store(false, std::memory_order_relaxed);
+        return true;
     }
     
     // Remove all sessions for a game (game ended)
     void removeGameSessions(const std::string& gameId) {
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        std::vector<std::string> tokensToRemove;
-        for (const auto& pair : sessions) {
-            if (pair.second.gameId == gameId) {
-                tokensToRemove.push_back(pair.first);
-            }
-        }
+        std::vector<SharedSession> removed;
+        sessions.eraseIf([&](const std::string&, const SharedSession& session) {
+            if (session->gameId != gameId) return false;
+            removed.push_back(session);
+            return true;
+        });
         
-        for (const auto& token : tokensToRemove) {
-            auto& session = sessions[token];
-            playerToToken.erase(makePlayerKey(session.gameId, session.playerId));
-            sessions.erase(token);
+        for (const auto& session : removed) {
+            forgetPlayer(*session);
         }
     }
     
     // Clean up expired sessions (call periodically)
     // Returns number of sessions cleaned
     size_t cleanupExpiredSessions(std::chrono::minutes timeout = std::chrono::minutes(30)) {
-        std::lock_guard<std::mutex> lock(mutex);
-        
-        auto now = std::chrono::steady_clock::now();
-        std::vector<std::string> tokensToRemove;
-        
-        for (const auto& pair : sessions) {
-            auto elapsed = now - pair.second.lastActivity;
-            if (elapsed > timeout) {
-                tokensToRemove.push_back(pair.first);
-            }
-        }
+        auto now = Session::Clock::now();
+        std::vector<SharedSession> removed;
+        sessions.eraseIf([&](const std::string&, const SharedSession& session) {
+            if (now - session->lastActive() <= timeout) return false;
+            removed.push_back(session);
+            return true;
+        });
         
-        for (const auto& token : tokensToRemove) {
-            auto& session = sessions[token];
-            playerToToken.erase(makePlayerKey(session.gameId, session.playerId));
-            sessions.erase(token);
+        for (const auto& session : removed) {
+            forgetPlayer(*session);
         }
         
-        return tokensToRemove.size();
+        return removed.size();
     }
     
     // Get count of active sessions
     size_t activeSessionCount() const {
-        std::lock_guard<std::mutex> lock(mutex);
         size_t count = 0;
-        for (const auto& pair : sessions) {
-            if (pair.second.isActive) count++;
-        }
+        sessions.forEach([&](const std::string&, const SharedSession& session) {
+            if (session->isActive.load(std::memory_order_relaxed)) count++;
+        });
         return count;
     }
 };
@@ -0,0 +1,428 @@
+#include "spectators.h"
+#include "metrics.h"
+#include <algorithm>
+#include <zlib.h>
+
+namespace catan {
+
+// Global spectator tier instance
+SpectatorTier spectatorTier;
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+namespace {
+
+struct SpectatorMetrics {
+    Counter& frames;
+    Counter& identityBytes;
+    Counter& deflateBytes;
+    Counter& dropped;
+    Histogram& fanout;
+};
+
+const SpectatorMetrics& spectatorMetrics() {
+    static const SpectatorMetrics m{
+        metrics().counter("catan_spectator_frames_total", "Frames closed for spectator audiences"),
+        metrics().counter("catan_spectator_frame_bytes_total", "Bytes of spectator frames, before fan-out",
+                          metricLabels({{"encoding", "identity"}})),
+        metrics().counter("catan_spectator_frame_bytes_total", "Bytes of spectator frames, before fan-out",
+                          metricLabels({{"encoding", "deflate"}})),
+        metrics().counter("catan_spectator_dropped_clients_total", "Spectators disconnected for a full queue"),
+        metrics().histogram("catan_spectator_fanout_seconds",
+                            "Time from a spectator frame closing until one shard of its audience has it queued"),
+    };
+    return m;
+}
+
+// Raw deflate of one frame, ended with a sync flush. Each frame is
+// compressed on its own, so it refers to nothing sent before it and every
+// spectator can share the same bytes whenever they joined. Null on failure.
+SSEFrame deflateFrame(const std::string& text) {
+    struct Deflater {
+        z_stream stream{};
+        bool ready = false;
+        Deflater() {
+            ready = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                                 Z_DEFAULT_STRATEGY) == Z_OK;
+        }
+        ~Deflater() {
+            if (ready) deflateEnd(&stream);
+        }
+    };
+    thread_local Deflater deflater;
+    if (!deflater.ready) return nullptr;
+
+    z_stream& z = deflater.stream;
+    deflateReset(&z);
+    std::string out(deflateBound(&z, text.size()) + 16, '\0');
+    z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    z.avail_in = static_cast<uInt>(text.size());
+    size_t produced = 0;
+    while (true) {
+        z.next_out = reinterpret_cast<Bytef*>(&out[produced]);
+        z.avail_out = static_cast<uInt>(out.size() - produced);
+        int status = deflate(&z, Z_SYNC_FLUSH);
+        produced = out.size() - z.avail_out;
+        if (status != Z_OK && status != Z_BUF_ERROR) return nullptr;
+        if (z.avail_out > 0) break;
+        out.resize(out.size() * 2);
+    }
+    out.resize(produced);
+    return std::make_shared<const std::string>(std::move(out));
+}
+
+// The body of a compressed stream is one zlib stream; a two-byte header
+// (32K window, default level) follows the response head
+const SSEFrame PLAIN_HEAD = std::make_shared<const std::string>(sseResponseHead());
+const SSEFrame DEFLATE_HEAD = std::make_shared<const std::string>(
+    sseResponseHead("Content-Encoding: deflate\r\nVary: Accept-Encoding\r\n") + "\x78\x9c");
+
+const SSEFrame& deflatedKeepalive() {
+    static const SSEFrame frame = deflateFrame(": keepalive\n\n");
+    return frame;
+}
+
+void wake(SSEClient& client) {
+    if (!client.wakePending.exchange(true) && client.waker) {
+        client.waker();
+    }
+}
+
+}  // namespace
+
+// ============================================================================
+// SPECTATOR TIER IMPLEMENTATION
+// ============================================================================
+
+struct SpectatorTier::Game {
+    struct alignas(64) Shard {
+        std::shared_mutex mutex;    // shared while a frame fans out, exclusive to join or leave
+        std::vector<Spectator*> clients;
+    };
+    std::array<Shard, SPECTATOR_SHARDS> shards;
+    std::atomic<size_t> clientCount{0};
+    std::atomic<size_t> deflateCount{0};
+    std::atomic<bool> closed{false};
+
+    // Set while a frame is being closed or fanned out. The next frame waits
+    // for it, so every client gets the game's frames in order.
+    std::atomic<bool> busy{false};
+    std::atomic<size_t> shardsLeft{0};
+
+    std::mutex pendingMutex;
+    std::string pending;            // events of the frame being gathered
+    uint64_t frameSeq = 1;          // that frame's number
+    bool queued = false;            // on the dirty list
+};
+
+struct SpectatorTier::Spectator : SSEClient {
+    std::shared_ptr<Game> game;
+    size_t shard = 0;
+    bool deflate = false;
+    uint64_t firstFrame = 0;        // frames numbered below this predate the client
+    size_t skipBytes = 0;           // bytes of frame firstFrame that did too
+};
+
+struct SpectatorTier::Frame {
+    uint64_t seq = 0;
+    SSEFrame plain;
+    SSEFrame deflated;
+    std::chrono::steady_clock::time_point closedAt;
+};
+
+SpectatorTier::~SpectatorTier() {
+    stop();
+    games.forEach([](const std::string&, const std::shared_ptr<Game>& game) {
+        for (auto& shard : game->shards) {
+            for (Spectator* client : shard.clients) delete client;
+            shard.clients.clear();
+        }
+    });
+}
+
+void SpectatorTier::start(const SpectatorConfig& settings) {
+    if (active.exchange(true)) return;
+    config = settings;
+    if (config.frameInterval.count() < 1) config.frameInterval = std::chrono::milliseconds(1);
+    if (config.deflate && !deflatedKeepalive()) config.deflate = false;
+    for (int i = 0; i < std::max(1, config.threads); i++) {
+        workers.emplace_back(&SpectatorTier::runWorker, this);
+    }
+    ticker = std::thread(&SpectatorTier::runTicker, this);
+}
+
+void SpectatorTier::stop() {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        if (!active.exchange(false)) return;
+    }
+    tickerWake.notify_all();
+    tasksReady.notify_all();
+    if (ticker.joinable()) ticker.join();
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+}
+
+std::shared_ptr<SpectatorTier::Game> SpectatorTier::findGame(const std::string& gameId) const {
+    std::shared_ptr<Game> result;
+    games.visit(gameId, [&](const std::shared_ptr<Game>& game) { result = game; });
+    return result;
+}
+
+SSEClient* SpectatorTier::registerClient(int socket, const std::string& gameId, StreamWaker waker,
+                                         bool deflate, const std::vector<SSEEvent>& opening) {
+    auto* client = new Spectator();
+    client->socket = socket;
+    client->gameId = gameId;
+    client->waker = std::move(waker);
+    client->id = nextClientId++;
+    client->shard = client->id % SPECTATOR_SHARDS;
+
+    // No one else can reach the client yet, so the opening goes in first
+    std::string text;
+    for (const SSEEvent& event : opening) text += event.serialize();
+    SSEFrame openingFrame;
+    if (deflate && config.deflate) {
+        openingFrame = deflateFrame(text);
+        client->deflate = openingFrame != nullptr;
+    }
+    if (!client->deflate) openingFrame = std::make_shared<const std::string>(std::move(text));
+    client->pendingEvents[0].data = client->deflate ? DEFLATE_HEAD : PLAIN_HEAD;
+    client->pendingCount = 1;
+    if (client->deflate) client->keepaliveFrame = deflatedKeepalive();
+    if (!openingFrame->empty()) queueSSEFrame(*client, openingFrame, nullptr);
+
+    std::shared_ptr<Game> game;
+    while (!(game = findGame(gameId))) {
+        games.insert(gameId, std::make_shared<Game>());
+    }
+    client->game = game;
+
+    // Holding the shard keeps the frame open at the cut from fanning out
+    // until the client is on the list
+    Game::Shard& shard = game->shards[client->shard];
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        {
+            std::lock_guard<std::mutex> pendingLock(game->pendingMutex);
+            client->firstFrame = game->frameSeq;
+            client->skipBytes = game->pending.size();
+        }
+        shard.clients.push_back(client);
+        game->clientCount++;
+        if (client->deflate) game->deflateCount++;
+    }
+    clients++;
+
+    // Closed while joining: let the I/O loop unregister it like the rest
+    if (game->closed) {
+        client->connected = false;
+        wake(*client);
+    }
+    return client;
+}
+
+void SpectatorTier::unregisterClient(SSEClient* base) {
+    if (!base) return;
+    auto* client = static_cast<Spectator*>(base);
+    client->connected = false;
+
+    // Kept past the delete, which drops the client's reference
+    std::shared_ptr<Game> game = client->game;
+    {
+        Game::Shard& shard = game->shards[client->shard];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.clients.erase(std::remove(shard.clients.begin(), shard.clients.end(), client),
+                            shard.clients.end());
+        game->clientCount--;
+        if (client->deflate) game->deflateCount--;
+    }
+    clients--;
+    delete client;
+}
+
+void SpectatorTier::publish(const std::string& gameId, const SSEFrame& frame) {
+    if (clients.load(std::memory_order_relaxed) == 0 || !active.load(std::memory_order_relaxed)) return;
+    std::shared_ptr<Game> game = findGame(gameId);
+    if (!game || game->clientCount.load() == 0) return;
+
+    bool schedule;
+    {
+        std::lock_guard<std::mutex> lock(game->pendingMutex);
+        game->pending += *frame;
+        schedule = !game->queued;
+        game->queued = true;
+    }
+    if (schedule) {
+        std::lock_guard<std::mutex> lock(dirtyMutex);
+        dirty.push_back(std::move(game));
+    }
+}
+
+bool SpectatorTier::hasSpectators(const std::string& gameId) const {
+    if (clients.load(std::memory_order_relaxed) == 0) return false;
+    std::shared_ptr<Game> game = findGame(gameId);
+    return game && game->clientCount.load() > 0;
+}
+
+size_t SpectatorTier::closeGame(const std::string& gameId) {
+    std::shared_ptr<Game> game = findGame(gameId);
+    if (!game) return 0;
+    games.erase(gameId);
+    game->closed = true;
+
+    size_t closed = 0;
+    for (auto& shard : game->shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (Spectator* client : shard.clients) {
+            client->connected = false;
+            wake(*client);
+            closed++;
+        }
+    }
+    return closed;
+}
+
+// ============================================================================
+// BROADCAST THREADS
+// The ticker closes the frames gathered since the last tick and hands each
+// game to the pool. A worker builds the game's frame once, in each encoding
+// its audience uses, and queues it to a small audience itself or splits a
+// large one into a task per shard.
+// ============================================================================
+
+void SpectatorTier::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push_back(std::move(task));
+    }
+    tasksReady.notify_one();
+}
+
+void SpectatorTier::runTicker() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point next = Clock::now() + config.frameInterval;
+    std::vector<std::shared_ptr<Game>> ready;
+    std::vector<std::shared_ptr<Game>> deferred;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tickerWake.wait_until(lock, next, [&] { return !active.load(); });
+            if (!active) return;
+        }
+        Clock::time_point now = Clock::now();
+        next += config.frameInterval;
+        if (next < now) next = now + config.frameInterval;  // fell behind: don't burst
+
+        {
+            std::lock_guard<std::mutex> lock(dirtyMutex);
+            ready.swap(dirty);
+        }
+        for (auto& game : ready) {
+            // Still sending its last frame: this one keeps gathering
+            if (game->busy.exchange(true)) {
+                deferred.push_back(std::move(game));
+                continue;
+            }
+            submit([this, game] { closeFrame(game); });
+        }
+        ready.clear();
+        if (!deferred.empty()) {
+            std::lock_guard<std::mutex> lock(dirtyMutex);
+            for (auto& game : deferred) dirty.push_back(std::move(game));
+            deferred.clear();
+        }
+    }
+}
+
+void SpectatorTier::runWorker() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksReady.wait(lock, [&] { return !tasks.empty() || !active.load(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void SpectatorTier::closeFrame(const std::shared_ptr<Game>& game) {
+    auto frame = std::make_shared<Frame>();
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(game->pendingMutex);
+        frame->seq = game->frameSeq++;
+        text.swap(game->pending);
+        game->queued = false;
+    }
+    if (text.empty() || game->closed) {
+        game->busy = false;
+        return;
+    }
+
+    const SpectatorMetrics& m = spectatorMetrics();
+    frame->closedAt = std::chrono::steady_clock::now();
+    m.frames.add();
+    m.identityBytes.add(text.size());
+    frame->plain = std::make_shared<const std::string>(std::move(text));
+    if (game->deflateCount.load() > 0) {
+        frame->deflated = deflateFrame(*frame->plain);
+        if (frame->deflated) m.deflateBytes.add(frame->deflated->size());
+    }
+
+    if (game->clientCount.load() <= SPECTATOR_INLINE_FANOUT) {
+        for (size_t shard = 0; shard < SPECTATOR_SHARDS; shard++) fanOut(*game, shard, *frame);
+        game->busy = false;
+        return;
+    }
+    game->shardsLeft = SPECTATOR_SHARDS;
+    for (size_t shard = 0; shard < SPECTATOR_SHARDS; shard++) {
+        submit([this, game, frame, shard] {
+            fanOut(*game, shard, *frame);
+            if (--game->shardsLeft == 0) game->busy = false;
+        });
+    }
+}
+
+void SpectatorTier::fanOut(Game& game, size_t index, const Frame& frame) {
+    const SpectatorMetrics& m = spectatorMetrics();
+    Game::Shard& shard = game.shards[index];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (Spectator* client : shard.clients) {
+            if (client->firstFrame > frame.seq) continue;
+            SSEFrame data = client->deflate ? frame.deflated : frame.plain;
+            if (client->firstFrame == frame.seq && client->skipBytes > 0) {
+                // Joined while this frame gathered: only what followed its catch-up
+                if (client->skipBytes >= frame.plain->size()) continue;
+                auto rest = std::make_shared<const std::string>(*frame.plain, client->skipBytes);
+                data = client->deflate ? deflateFrame(*rest) : rest;
+            }
+            if (!data) {
+                client->connected = false;
+                wake(*client);
+                continue;
+            }
+            if (!queueSSEFrame(*client, data, nullptr)) m.dropped.add();
+        }
+    }
+    m.fanout.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - frame.closedAt).count()));
+}
+
+// ============================================================================
+// SPECTATOR STREAM
+// ============================================================================
+
+void SpectatorStream::onClose() {
+    spectatorTier.unregisterClient(client);
+    client = nullptr;
+}
+
+}  // namespace catan
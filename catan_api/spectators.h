@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sse_handler.h"
+#include "striped_map.h"
+
+namespace catan {
+
+// ============================================================================
+// SPECTATOR TIER
+// Viewers without a seat who subscribe with ?spectate=1. They get what any
+// viewer may see (public game deltas and public chat, trade and AI events)
+// and never a hand, a dev card or a stolen card. Their events are not sent
+// one at a time: each game gathers them into a frame that closes every
+// frame interval, is serialized and optionally deflated once, and is queued
+// to the game's spectators by a pool of broadcast threads, one shard of the
+// audience per task. Spectators are kept apart from SSEManager, so a
+// featured game with thousands of them adds nothing to clientsMutex or to
+// the broadcasts its players wait on.
+// ============================================================================
+
+struct SpectatorConfig {
+    std::chrono::milliseconds frameInterval{100};
+    int threads = 2;                // broadcast threads
+    bool deflate = true;            // compress streams for clients that accept it
+};
+
+// Spectators per game are split over this many independently locked shards
+constexpr size_t SPECTATOR_SHARDS = 8;
+
+// Audiences up to this size are fanned out by the task that closed the frame
+constexpr size_t SPECTATOR_INLINE_FANOUT = 256;
+
+class SpectatorTier {
+public:
+    SpectatorTier() = default;
+    ~SpectatorTier();
+
+    SpectatorTier(const SpectatorTier&) = delete;
+    SpectatorTier& operator=(const SpectatorTier&) = delete;
+
+    void start(const SpectatorConfig& config);
+    void stop();
+    bool running() const { return active.load(); }
+
+    // Registers a spectator. opening (the connect event and any catch-up) is
+    // queued after the stream headers and ahead of every frame; events
+    // published before the call are not repeated. Call with the game's read
+    // lock held, so no change lands between the catch-up and the first
+    // frame. deflate asks for a compressed stream, granted if the tier
+    // compresses.
+    SSEClient* registerClient(int socket, const std::string& gameId, StreamWaker waker, bool deflate,
+                              const std::vector<SSEEvent>& opening);
+    void unregisterClient(SSEClient* client);
+
+    // Adds a serialized event to the game's next frame. Costs a lookup and
+    // nothing more for a game nobody spectates.
+    void publish(const std::string& gameId, const SSEFrame& frame);
+    bool hasSpectators(const std::string& gameId) const;
+
+    // Disconnects a game's spectators (a removed or migrated game). Their
+    // I/O loops unregister them. Returns the number disconnected.
+    size_t closeGame(const std::string& gameId);
+
+    size_t clientCount() const { return clients.load(); }
+
+private:
+    struct Game;
+    struct Spectator;
+    struct Frame;
+
+    SpectatorConfig config;
+    StripedMap<std::shared_ptr<Game>> games;
+    std::atomic<size_t> clients{0};
+    std::atomic<uint64_t> nextClientId{1};
+
+    // Games with a frame being gathered, waiting for the next tick
+    std::mutex dirtyMutex;
+    std::vector<std::shared_ptr<Game>> dirty;
+
+    std::mutex tasksMutex;          // guards tasks; also what the ticker sleeps on
+    std::condition_variable tasksReady;
+    std::condition_variable tickerWake;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    std::thread ticker;
+    std::atomic<bool> active{false};
+
+    std::shared_ptr<Game> findGame(const std::string& gameId) const;
+    void submit(std::function<void()> task);
+    void runTicker();
+    void runWorker();
+    void closeFrame(const std::shared_ptr<Game>& game);
+    void fanOut(Game& game, size_t shard, const Frame& frame);
+};
+
+// The tier's SSE stream: like SSEStream, but unregisters from the tier
+class SpectatorStream : public SSEStream {
+public:
+    explicit SpectatorStream(SSEClient* c) : SSEStream(c) {}
+    void onClose() override;
+};
+
+// Global spectator tier, started by the server
+extern SpectatorTier spectatorTier;
+
+}  // namespace catan
@@ -1,7 +1,14 @@
 #include "sse_handler.h"
+#include "game_actions.h"
+#include "spectators.h"
+#include "json_writer.h"
+#include "metrics.h"
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <cstring>
+#include <cerrno>
+#include <algorithm>
 #include <sstream>
 
 namespace catan {
@@ -13,6 +20,15 @@ SSEManager sseManager;
 // SSE MANAGER IMPLEMENTATION
 // ============================================================================
 
+std::string sseResponseHead(const std::string& extraHeaders) {
+    return "HTTP/1.1 200 OK\r\n"
+           "Content-Type: text/event-stream\r\n"
+           "Cache-Control: no-cache\r\n"
+           "Connection: keep-alive\r\n"
+           "Access-Control-Allow-Origin: *\r\n"
+           "Access-Control-Allow-Headers: *\r\n" + extraHeaders + "\r\n";
+}
+
 SSEManager::~SSEManager() {
     std::lock_guard<std::mutex> lock(clientsMutex);
     for (auto* client : allClients) {
@@ -20,19 +36,61 @@ SSEManager::~SSEManager() {
         delete client;
     }
     allClients.clear();
+    clientsById.clear();
     gameClients.clear();
 }
 
-SSEClient* SSEManager::registerClient(int socket, const std::string& gameId, const std::string& playerId) {
+namespace {
+
+const SSEFrame SSE_HEADERS = std::make_shared<const std::string>(sseResponseHead());
+
+const SSEFrame SSE_KEEPALIVE = std::make_shared<const std::string>(": keepalive\n\n");
+
+// Frames handed to a single writev call
+constexpr size_t MAX_IOVECS = 64;
+
+struct SSEMetrics {
+    Counter& frames;
+    Counter& coalesced;
+    Counter& dropped;
+    Histogram& queueDepth;
+};
+
+const SSEMetrics& sseMetrics() {
+    static const SSEMetrics sse{
+        metrics().counter("catan_sse_frames_total", "Frames queued to SSE clients"),
+        metrics().counter("catan_sse_coalesced_frames_total", "Queued SSE frames superseded by a newer copy"),
+        metrics().counter("catan_sse_dropped_clients_total", "SSE clients disconnected for a full queue"),
+        metrics().histogram("catan_sse_queue_depth", "Frames waiting in a client's queue after each enqueue",
+                            "", HistogramUnit::Count),
+    };
+    return sse;
+}
+
+// Events that carry a full state and make any earlier unsent copy redundant
+const char* coalesceKeyFor(const SSEEvent& event) {
+    if (event.event == GameEvents::GAME_STATE_CHANGED) return GameEvents::GAME_STATE_CHANGED;
+    return nullptr;
+}
+
+}  // namespace
+
+SSEClient* SSEManager::registerClient(int socket, const std::string& gameId, StreamWaker waker,
+                                      int viewerId) {
     auto* client = new SSEClient();
     client->socket = socket;
     client->gameId = gameId;
-    client->playerId = playerId;
+    client->viewerId = viewerId;
     client->connected = true;
+    client->waker = std::move(waker);
+    client->pendingEvents[0].data = SSE_HEADERS;
+    client->pendingCount = 1;
     
     std::lock_guard<std::mutex> lock(clientsMutex);
+    client->id = nextClientId++;
     gameClients[gameId].push_back(client);
     allClients.insert(client);
+    clientsById[client->id] = client;
     
     return client;
 }
@@ -59,38 +117,228 @@ void SSEManager::unregisterClient(SSEClient* client) {
     
     // Remove from all clients
     allClients.erase(client);
+    clientsById.erase(client->id);
     
     delete client;
 }
 
-void SSEManager::broadcastToGame(const std::string& gameId, const SSEEvent& event) {
-    std::vector<SSEClient*> clientsCopy;
-    
+bool queueSSEFrame(SSEClient& client, const SSEFrame& frame, const char* coalesceKey) {
+    if (!client.connected) return true;
+
+    bool queued = true;
     {
-        std::lock_guard<std::mutex> lock(clientsMutex);
-        auto it = gameClients.find(gameId);
-        if (it != gameClients.end()) {
-            clientsCopy = it->second;
+        std::lock_guard<std::mutex> lock(client.eventMutex);
+        const size_t capacity = client.pendingEvents.size();
+
+        // Supersede an older unsent frame of the same kind. The head frame
+        // may be partially written, so it is left alone.
+        if (coalesceKey) {
+            for (size_t i = 1; i < client.pendingCount; i++) {
+                auto& pending = client.pendingEvents[(client.pendingHead + i) % capacity];
+                if (pending.coalesceKey == coalesceKey) {
+                    pending.data.reset();
+                    pending.coalesceKey = nullptr;
+                    sseMetrics().coalesced.add();
+                }
+            }
+        }
+
+        if (client.pendingCount == capacity) {
+            // Slow consumer: drop it rather than grow without bound. The
+            // browser's EventSource reconnects on its own.
+            client.connected = false;
+            sseMetrics().dropped.add();
+            queued = false;
+        } else {
+            auto& slot = client.pendingEvents[(client.pendingHead + client.pendingCount) % capacity];
+            slot.data = frame;
+            slot.coalesceKey = coalesceKey;
+            client.pendingCount++;
+            sseMetrics().frames.add();
+            sseMetrics().queueDepth.record(client.pendingCount);
         }
     }
-    
-    for (auto* client : clientsCopy) {
-        if (client->connected) {
-            sendToClient(client, event);
+
+    if (!client.wakePending.exchange(true) && client.waker) {
+        client.waker();
+    }
+    return queued;
+}
+
+void SSEManager::enqueueFrame(SSEClient* client, const SSEFrame& frame, const char* coalesceKey) {
+    if (!queueSSEFrame(*client, frame, coalesceKey)) droppedClients++;
+}
+
+void SSEManager::broadcastToGame(const std::string& gameId, const SSEEvent& event, bool publicEvent) {
+    // Serialized once; every subscriber queue holds a reference to the same buffer
+    SSEFrame frame = makeFrame(event);
+    const char* coalesceKey = coalesceKeyFor(event);
+    if (publicEvent) spectatorTier.publish(gameId, frame);
+
+    // Queuing never touches a socket, so holding clientsMutex here is cheap
+    // and keeps clients from being freed mid-broadcast
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = gameClients.find(gameId);
+    if (it == gameClients.end()) return;
+
+    for (auto* client : it->second) {
+        enqueueFrame(client, frame, coalesceKey);
+    }
+}
+
+void SSEManager::broadcastPerViewer(const std::string& gameId,
+                                    const std::function<SSEEvent(int viewerId)>& build) {
+    // A game has a handful of viewers, so a linear cache beats a map
+    std::vector<std::pair<int, SSEFrame>> frames;
+    if (spectatorTier.hasSpectators(gameId)) {
+        SSEFrame frame = makeFrame(build(-1));
+        frames.emplace_back(-1, frame);
+        spectatorTier.publish(gameId, frame);
+    }
+
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = gameClients.find(gameId);
+    if (it == gameClients.end()) return;
+
+    for (auto* client : it->second) {
+        SSEFrame frame;
+        for (const auto& cached : frames) {
+            if (cached.first == client->viewerId) {
+                frame = cached.second;
+                break;
+            }
+        }
+        if (!frame) {
+            frame = makeFrame(build(client->viewerId));
+            frames.emplace_back(client->viewerId, frame);
         }
+        enqueueFrame(client, frame, nullptr);
     }
 }
 
 void SSEManager::sendToClient(SSEClient* client, const SSEEvent& event) {
     if (!client || !client->connected) return;
-    
-    if (!writeEvent(client->socket, event)) {
-        client->connected = false;
+
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    if (allClients.count(client)) {
+        enqueueFrame(client, makeFrame(event), coalesceKeyFor(event));
     }
 }
 
-std::string SSEManager::nextEventId() {
-    return std::to_string(eventIdCounter.fetch_add(1));
+bool SSEManager::sendToClient(uint64_t clientId, const SSEEvent& event) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = clientsById.find(clientId);
+    if (it == clientsById.end() || !it->second->connected) return false;
+    enqueueFrame(it->second, makeFrame(event), coalesceKeyFor(event));
+    return true;
+}
+
+bool SSEManager::hasClient(uint64_t clientId) const {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = clientsById.find(clientId);
+    return it != clientsById.end() && it->second->connected;
+}
+
+void SSEManager::closeClient(uint64_t clientId) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = clientsById.find(clientId);
+    if (it == clientsById.end()) return;
+    SSEClient* client = it->second;
+    client->connected = false;
+    if (!client->wakePending.exchange(true) && client->waker) {
+        client->waker();
+    }
+}
+
+void SSEManager::setClientViewer(uint64_t clientId, int viewerId) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = clientsById.find(clientId);
+    if (it != clientsById.end()) it->second->viewerId = viewerId;
+}
+
+std::vector<std::pair<uint64_t, int>> SSEManager::gameClientViewers(const std::string& gameId) const {
+    std::vector<std::pair<uint64_t, int>> result;
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = gameClients.find(gameId);
+    if (it == gameClients.end()) return result;
+    for (const SSEClient* client : it->second) {
+        result.emplace_back(client->id, client->viewerId);
+    }
+    return result;
+}
+
+bool SSEManager::flushClient(SSEClient* client) {
+    client->wakePending = false;
+
+    std::lock_guard<std::mutex> lock(client->eventMutex);
+    const size_t capacity = client->pendingEvents.size();
+
+    while (client->pendingCount > 0) {
+        // Gather queued frames into one writev; superseded slots are skipped
+        struct iovec iov[MAX_IOVECS];
+        int iovCount = 0;
+        for (size_t i = 0; i < client->pendingCount && iovCount < static_cast<int>(MAX_IOVECS); i++) {
+            const auto& pending = client->pendingEvents[(client->pendingHead + i) % capacity];
+            if (!pending.data) continue;
+            size_t offset = (i == 0) ? client->headOffset : 0;
+            iov[iovCount].iov_base = const_cast<char*>(pending.data->data() + offset);
+            iov[iovCount].iov_len = pending.data->size() - offset;
+            iovCount++;
+        }
+
+        size_t written = 0;
+        if (iovCount > 0) {
+            struct msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = iovCount;
+            ssize_t n = sendmsg(client->socket, &msg, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;  // resume on the next writable edge
+            }
+            if (n <= 0) {
+                client->connected = false;
+                return false;
+            }
+            written = static_cast<size_t>(n);
+        }
+
+        // Retire fully written frames, remember how far into the next one we got
+        while (client->pendingCount > 0) {
+            auto& head = client->pendingEvents[client->pendingHead];
+            size_t remaining = head.data ? head.data->size() - client->headOffset : 0;
+            if (written < remaining) {
+                client->headOffset += written;
+                break;
+            }
+            written -= remaining;
+            head.data.reset();
+            head.coalesceKey = nullptr;
+            client->headOffset = 0;
+            client->pendingHead = (client->pendingHead + 1) % capacity;
+            client->pendingCount--;
+        }
+
+        if (client->pendingCount > 0 && client->headOffset > 0) {
+            break;  // short write: the socket buffer is full
+        }
+    }
+
+    return client->connected.load();
+}
+
+bool SSEManager::keepaliveClient(SSEClient* client) {
+    if (!client->connected) return false;
+    {
+        std::lock_guard<std::mutex> lock(client->eventMutex);
+        if (client->pendingCount == 0) {
+            client->pendingEvents[client->pendingHead].data =
+                client->keepaliveFrame ? client->keepaliveFrame : SSE_KEEPALIVE;
+            client->pendingCount = 1;
+        }
+    }
+    return flushClient(client);
 }
 
 size_t SSEManager::getClientCount(const std::string& gameId) const {
@@ -102,34 +350,45 @@ size_t SSEManager::getClientCount(const std::string& gameId) const {
     return 0;
 }
 
+size_t SSEManager::totalClientCount() const {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    return allClients.size();
+}
+
+size_t SSEManager::closeGameClients(const std::string& gameId) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = gameClients.find(gameId);
+    if (it == gameClients.end()) {
+        return 0;
+    }
+    for (auto* client : it->second) {
+        client->connected = false;
+        if (!client->wakePending.exchange(true) && client->waker) {
+            client->waker();
+        }
+    }
+    return it->second.size();
+}
+
 bool SSEManager::isClientConnected(SSEClient* client) const {
     return client && client->connected.load();
 }
 
-bool SSEManager::writeSSEHeaders(int socket) {
-    const char* headers = 
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: text/event-stream\r\n"
-        "Cache-Control: no-cache\r\n"
-        "Connection: keep-alive\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "Access-Control-Allow-Headers: *\r\n"
-        "\r\n";
-    
-    ssize_t written = send(socket, headers, strlen(headers), MSG_NOSIGNAL);
-    return written > 0;
+// ============================================================================
+// SSE STREAM IMPLEMENTATION
+// ============================================================================
+
+bool SSEStream::onWritable(int) {
+    return client && sseManager.flushClient(client);
 }
 
-bool SSEManager::writeEvent(int socket, const SSEEvent& event) {
-    std::string data = event.serialize();
-    ssize_t written = send(socket, data.c_str(), data.length(), MSG_NOSIGNAL);
-    return written > 0;
+bool SSEStream::onKeepalive(int) {
+    return client && sseManager.keepaliveClient(client);
 }
 
-bool SSEManager::writeKeepalive(int socket) {
-    const char* keepalive = ": keepalive\n\n";
-    ssize_t written = send(socket, keepalive, strlen(keepalive), MSG_NOSIGNAL);
-    return written > 0;
+void SSEStream::onClose() {
+    sseManager.unregisterClient(client);
+    client = nullptr;
 }
 
 // ============================================================================
@@ -148,16 +407,15 @@ SSEEvent createAIActionEvent(
     std::ostringstream json;
     json << "{";
     json << "\"playerId\":" << playerId << ",";
-    json << "\"playerName\":\"" << playerName << "\",";
-    json << "\"action\":\"" << action << "\",";
-    json << "\"description\":\"" << description << "\",";
+    json << "\"playerName\":\"" << escapeJson(playerName) << "\",";
+    json << "\"action\":\"" << escapeJson(action) << "\",";
+    json << "\"description\":\"" << escapeJson(description) << "\",";
     json << "\"success\":" << (success ? "true" : "false");
     json << "}";
     
     SSEEvent event;
     event.event = AI_ACTION;
     event.data = json.str();
-    event.id = sseManager.nextEventId();
     return event;
 }
 
@@ -169,22 +427,29 @@ SSEEvent createTurnChangedEvent(
     std::ostringstream json;
     json << "{";
     json << "\"currentPlayerIndex\":" << currentPlayerIndex << ",";
-    json << "\"playerName\":\"" << playerName << "\",";
+    json << "\"playerName\":\"" << escapeJson(playerName) << "\",";
     json << "\"isAI\":" << (isAI ? "true" : "false");
     json << "}";
     
     SSEEvent event;
     event.event = TURN_CHANGED;
     event.data = json.str();
-    event.id = sseManager.nextEventId();
     return event;
 }
 
-SSEEvent createGameStateChangedEvent(const std::string& gameStateJson) {
+SSEEvent createGameStateChangedEvent(uint64_t version, std::string gameStateJson) {
     SSEEvent event;
     event.event = GAME_STATE_CHANGED;
-    event.data = gameStateJson;
-    event.id = sseManager.nextEventId();
+    event.data = std::move(gameStateJson);
+    event.id = std::to_string(version);
+    return event;
+}
+
+SSEEvent createGameDeltaEvent(uint64_t version, std::string deltaJson) {
+    SSEEvent event;
+    event.event = GAME_DELTA;
+    event.data = std::move(deltaJson);
+    event.id = std::to_string(version);
     return event;
 }
 
@@ -200,26 +465,15 @@ SSEEvent createChatMessageEvent(
     json << "{";
     json << "\"messageId\":\"" << messageId << "\",";
     json << "\"fromPlayerId\":" << fromPlayerId << ",";
-    json << "\"fromPlayerName\":\"" << fromPlayerName << "\",";
+    json << "\"fromPlayerName\":\"" << escapeJson(fromPlayerName) << "\",";
     json << "\"toPlayerId\":" << toPlayerId << ",";
-    // Escape special characters in content
-    std::string escapedContent;
-    for (char c : content) {
-        if (c == '"') escapedContent += "\\\"";
-        else if (c == '\\') escapedContent += "\\\\";
-        else if (c == '\n') escapedContent += "\\n";
-        else if (c == '\r') escapedContent += "\\r";
-        else if (c == '\t') escapedContent += "\\t";
-        else escapedContent += c;
-    }
-    json << "\"content\":\"" << escapedContent << "\",";
+    json << "\"content\":\"" << escapeJson(content) << "\",";
     json << "\"type\":\"" << messageType << "\"";
     json << "}";
     
     SSEEvent event;
     event.event = CHAT_MESSAGE;
     event.data = json.str();
-    event.id = sseManager.nextEventId();
     return event;
 }
 
@@ -236,7 +490,7 @@ SSEEvent createTradeProposedEvent(
     json << "{";
     json << "\"tradeId\":" << tradeId << ",";
     json << "\"fromPlayerId\":" << fromPlayerId << ",";
-    json << "\"fromPlayerName\":\"" << fromPlayerName << "\",";
+    json << "\"fromPlayerName\":\"" << escapeJson(fromPlayerName) << "\",";
     json << "\"toPlayerId\":" << toPlayerId << ",";
     json << "\"offering\":{";
     json << "\"wood\":" << offerWood << ",";
@@ -251,21 +505,13 @@ SSEEvent createTradeProposedEvent(
     json << "\"sheep\":" << requestSheep << ",";
     json << "\"ore\":" << requestOre << "}";
     if (!message.empty()) {
-        std::string escapedMessage;
-        for (char c : message) {
-            if (c == '"') escapedMessage += "\\\"";
-            else if (c == '\\') escapedMessage += "\\\\";
-            else if (c == '\n') escapedMessage += "\\n";
-            else escapedMessage += c;
-        }
-        json << ",\"message\":\"" << escapedMessage << "\"";
+        json << ",\"message\":\"" << escapeJson(message) << "\"";
     }
     json << "}";
     
     SSEEvent event;
     event.event = TRADE_PROPOSED;
     event.data = json.str();
-    event.id = sseManager.nextEventId();
     return event;
 }
 
@@ -279,13 +525,12 @@ SSEEvent createTradeResponseEvent(
     json << "{";
     json << "\"tradeId\":" << tradeId << ",";
     json << "\"responderId\":" << responderId << ",";
-    json << "\"responderName\":\"" << responderName << "\"";
+    json << "\"responderName\":\"" << escapeJson(responderName) << "\"";
     json << "}";
     
     SSEEvent event;
     event.event = eventType;
     event.data = json.str();
-    event.id = sseManager.nextEventId();
     return event;
 }
 
@@ -300,18 +545,92 @@ SSEEvent createTradeExecutedEvent(
     json << "{";
     json << "\"tradeId\":" << tradeId << ",";
     json << "\"player1Id\":" << player1Id << ",";
-    json << "\"player1Name\":\"" << player1Name << "\",";
+    json << "\"player1Name\":\"" << escapeJson(player1Name) << "\",";
     json << "\"player2Id\":" << player2Id << ",";
-    json << "\"player2Name\":\"" << player2Name << "\"";
+    json << "\"player2Name\":\"" << escapeJson(player2Name) << "\"";
     json << "}";
     
     SSEEvent event;
     event.event = TRADE_EXECUTED;
     event.data = json.str();
-    event.id = sseManager.nextEventId();
     return event;
 }
 
+static std::string playerName(const Game& game, int playerId) {
+    for (const Player& p : game.players) {
+        if (p.id == playerId) return p.name;
+    }
+    return "Unknown";
+}
+
+static const char* chatTypeName(ChatMessageType type) {
+    switch (type) {
+        case ChatMessageType::TradeProposal: return "trade_proposal";
+        case ChatMessageType::TradeAccept: return "trade_accept";
+        case ChatMessageType::TradeReject: return "trade_reject";
+        case ChatMessageType::TradeCounter: return "trade_counter";
+        case ChatMessageType::System: return "system";
+        default: return "normal";
+    }
+}
+
+void broadcastActionEvents(const Game& game, const Action& action, const ActionResult& result) {
+    if (!result.ok()) return;
+    const std::string& gameId = game.gameId;
+    std::string name = playerName(game, action.playerId);
+
+    const TradeOffer* trade = result.tradeId >= 0 ? game.tradeOffers.find(result.tradeId) : nullptr;
+    switch (action.type) {
+        case ActionType::ProposeTrade:
+        case ActionType::CounterTrade:
+            if (action.type == ActionType::CounterTrade) {
+                sseManager.broadcastToGame(gameId, createTradeResponseEvent(
+                    TRADE_COUNTERED, action.tradeId, action.playerId, name));
+            }
+            if (trade) {
+                const ResourceHand& give = trade->offering;
+                const ResourceHand& want = trade->requesting;
+                sseManager.broadcastToGame(gameId, createTradeProposedEvent(
+                    trade->id, trade->fromPlayerId, name, trade->toPlayerId,
+                    give[Resource::Wood], give[Resource::Brick], give[Resource::Wheat],
+                    give[Resource::Sheep], give[Resource::Ore],
+                    want[Resource::Wood], want[Resource::Brick], want[Resource::Wheat],
+                    want[Resource::Sheep], want[Resource::Ore], action.message),
+                    trade->toPlayerId == -1);
+            }
+            break;
+        case ActionType::AcceptTrade:
+            sseManager.broadcastToGame(gameId, createTradeResponseEvent(
+                TRADE_ACCEPTED, result.tradeId, action.playerId, name));
+            if (trade) {
+                sseManager.broadcastToGame(gameId, createTradeExecutedEvent(
+                    trade->id, trade->fromPlayerId, playerName(game, trade->fromPlayerId), action.playerId, name));
+            }
+            break;
+        case ActionType::RejectTrade:
+            sseManager.broadcastToGame(gameId, createTradeResponseEvent(
+                TRADE_REJECTED, result.tradeId, action.playerId, name));
+            break;
+        case ActionType::CancelTrade: {
+            SSEEvent cancelled;
+            cancelled.event = TRADE_CANCELLED;
+            cancelled.data = "{\"tradeId\":" + std::to_string(result.tradeId) + "}";
+            sseManager.broadcastToGame(gameId, cancelled);
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (result.chatMessageId == 0) return;
+    game.chatMessages.forEachSince(result.chatMessageId - 1, [&](const ChatEntry& msg) {
+        sseManager.broadcastToGame(gameId, createChatMessageEvent(
+            std::to_string(msg.id), msg.fromPlayerId, name, msg.toPlayerId,
+            std::string(msg.content), chatTypeName(msg.type)), msg.toPlayerId == -1);
+        return false;
+    });
+}
+
 }  // namespace GameEvents
 
 }  // namespace catan
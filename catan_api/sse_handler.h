@@ -5,14 +5,20 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <mutex>
-#include <queue>
+#include <memory>
 #include <functional>
 #include <atomic>
 #include <thread>
 #include <condition_variable>
 
+#include "http_server.h"
+
 namespace catan {
 
+struct Game;
+struct Action;
+struct ActionResult;
+
 // ============================================================================
 // SSE EVENT
 // ============================================================================
@@ -20,46 +26,91 @@ namespace catan {
 struct SSEEvent {
     std::string event;      // Event type (e.g., "ai_action", "game_update")
     std::string data;       // JSON data
-    std::string id;         // Optional event ID
+    std::string id;         // Game version, on game-state events only; the
+                            // browser resumes from it via Last-Event-ID
     
+    // Wire format, built in a single pass
     std::string serialize() const {
         std::string result;
+        result.reserve(event.size() + id.size() + data.size() + 24);
         if (!event.empty()) {
-            result += "event: " + event + "\n";
+            result.append("event: ").append(event).append("\n");
         }
         if (!id.empty()) {
-            result += "id: " + id + "\n";
+            result.append("id: ").append(id).append("\n");
         }
-        // Handle multiline data
-        size_t pos = 0;
-        std::string dataStr = data;
-        while ((pos = dataStr.find('\n')) != std::string::npos) {
-            result += "data: " + dataStr.substr(0, pos) + "\n";
-            dataStr = dataStr.substr(pos + 1);
+        // Multiline data becomes one "data:" line per line
+        size_t start = 0;
+        while (true) {
+            size_t pos = data.find('\n', start);
+            result.append("data: ");
+            if (pos == std::string::npos) {
+                result.append(data, start, std::string::npos).append("\n");
+                break;
+            }
+            result.append(data, start, pos - start).append("\n");
+            start = pos + 1;
         }
-        result += "data: " + dataStr + "\n";
         result += "\n";  // Empty line to end event
         return result;
     }
 };
 
+// Serialized event shared by every subscriber queue it is broadcast to
+using SSEFrame = std::shared_ptr<const std::string>;
+
+inline SSEFrame makeFrame(const SSEEvent& event) {
+    return std::make_shared<const std::string>(event.serialize());
+}
+
+// Response head that opens every SSE stream; extraHeaders are complete
+// "Name: value\r\n" lines
+std::string sseResponseHead(const std::string& extraHeaders = "");
+
 // ============================================================================
 // SSE CLIENT CONNECTION
 // ============================================================================
 
+// Frames a client may have queued before it counts as a slow consumer
+constexpr size_t SSE_CLIENT_QUEUE_CAPACITY = 256;
+
 struct SSEClient {
+    uint64_t id = 0;            // never reused; names the client where a pointer could dangle
     int socket;
     std::string gameId;
-    std::string playerId;
+    int viewerId = -1;          // player whose private state this client sees, -1 for none
     std::atomic<bool> connected{true};
-    std::queue<SSEEvent> pendingEvents;
+
+    // Bounded ring of serialized frames, filled by broadcasters and drained by
+    // the I/O loop that owns the socket. Guarded by eventMutex.
+    struct PendingFrame {
+        SSEFrame data;
+        const char* coalesceKey = nullptr;  // newer frame with the same key supersedes this one
+    };
+    std::vector<PendingFrame> pendingEvents = std::vector<PendingFrame>(SSE_CLIENT_QUEUE_CAPACITY);
+    size_t pendingHead = 0;
+    size_t pendingCount = 0;
+    size_t headOffset = 0;      // bytes of the head frame already on the wire
     std::mutex eventMutex;
-    std::condition_variable eventCv;
+
+    // Set while a wakeup is outstanding so a burst of events costs one wakeup
+    std::atomic<bool> wakePending{false};
+    StreamWaker waker;
+
+    // Queued when the stream has been idle; null for the plain comment. A
+    // compressed stream needs its own.
+    SSEFrame keepaliveFrame;
 };
 
+// Queue a frame on a client and wake its I/O loop. Returns false if the
+// queue was full and the client has been disconnected as a slow consumer.
+// The caller keeps the client alive for the duration.
+bool queueSSEFrame(SSEClient& client, const SSEFrame& frame, const char* coalesceKey);
+
 // ============================================================================
 // SSE MANAGER
-// Manages SSE connections and broadcasts events
+// Manages SSE connections and broadcasts events. Broadcasting only queues
+// frames and wakes the owning I/O loop, so it never blocks on a socket.
 // ============================================================================
 
 class SSEManager {
@@ -70,43 +121,86 @@ private:
     
     // All clients (for cleanup)
     std::unordered_set<SSEClient*> allClients;
+    std::unordered_map<uint64_t, SSEClient*> clientsById;
+    uint64_t nextClientId = 1;
     
-    // Event ID counter
-    std::atomic<uint64_t> eventIdCounter{0};
+    // Clients disconnected because their queue overflowed
+    std::atomic<uint64_t> droppedClients{0};
+
+    // Queue a frame and wake the owner. Caller holds clientsMutex.
+    void enqueueFrame(SSEClient* client, const SSEFrame& frame, const char* coalesceKey);
     
 public:
     SSEManager() = default;
     ~SSEManager();
     
-    // Register a new SSE client for a game
-    SSEClient* registerClient(int socket, const std::string& gameId, const std::string& playerId = "");
+    // Register a new SSE client for a game. The stream headers are queued as
+    // the first frame.
+    SSEClient* registerClient(int socket, const std::string& gameId, StreamWaker waker,
+                              int viewerId = -1);
     
     // Unregister a client
     void unregisterClient(SSEClient* client);
     
-    // Broadcast event to all clients watching a game
-    void broadcastToGame(const std::string& gameId, const SSEEvent& event);
+    // Broadcast event to all clients watching a game. Public events also go
+    // to the game's spectators (see spectators.h); a private chat message or
+    // a trade offered to one player passes publicEvent = false.
+    void broadcastToGame(const std::string& gameId, const SSEEvent& event, bool publicEvent = true);
+    
+    // Broadcast an event whose body depends on the viewer. build runs once
+    // per distinct viewerId; spectators get the viewerId -1 body.
+    void broadcastPerViewer(const std::string& gameId, const std::function<SSEEvent(int viewerId)>& build);
     
     // Send event to a specific client
     void sendToClient(SSEClient* client, const SSEEvent& event);
-    
-    // Get next event ID
-    std::string nextEventId();
+
+    // By client id, for holders that don't own the client and can't tell
+    // whether it is still alive. Return false once it is gone.
+    bool sendToClient(uint64_t clientId, const SSEEvent& event);
+    bool hasClient(uint64_t clientId) const;
+    void closeClient(uint64_t clientId);
+    void setClientViewer(uint64_t clientId, int viewerId);
+
+    // (client id, viewerId) of every client watching a game
+    std::vector<std::pair<uint64_t, int>> gameClientViewers(const std::string& gameId) const;
+
+    // Write as much of the client's queue as the socket accepts without
+    // blocking. Returns false once the client should be disconnected.
+    // Called on the owning I/O loop only.
+    bool flushClient(SSEClient* client);
+
+    // Queue a keepalive comment if nothing else is waiting, then flush
+    bool keepaliveClient(SSEClient* client);
     
     // Get count of clients for a game
     size_t getClientCount(const std::string& gameId) const;
+    size_t totalClientCount() const;
+    
+    // Disconnect every client watching a game. Each is closed by its I/O
+    // loop, which unregisters it. Returns the number disconnected.
+    size_t closeGameClients(const std::string& gameId);
+
+    uint64_t droppedClientCount() const { return droppedClients.load(); }
     
     // Check if a client is still connected
     bool isClientConnected(SSEClient* client) const;
-    
-    // Write SSE headers to socket
-    static bool writeSSEHeaders(int socket);
-    
-    // Write event to socket
-    static bool writeEvent(int socket, const SSEEvent& event);
-    
-    // Write keepalive comment
-    static bool writeKeepalive(int socket);
+};
+
+// ============================================================================
+// SSE STREAM
+// Adapts an SSEClient to the HTTP server's stream session interface
+// ============================================================================
+
+class SSEStream : public StreamSession {
+protected:
+    SSEClient* client;
+
+public:
+    explicit SSEStream(SSEClient* c) : client(c) {}
+
+    bool onWritable(int socket) override;
+    bool onKeepalive(int socket) override;
+    void onClose() override;
 };
 
 // ============================================================================
@@ -119,7 +213,8 @@ namespace GameEvents {
     constexpr const char* AI_ACTION = "ai_action";
     constexpr const char* AI_TURN_COMPLETE = "ai_turn_complete";
     constexpr const char* AI_ERROR = "ai_error";
-    constexpr const char* GAME_STATE_CHANGED = "game_state_changed";
+    constexpr const char* GAME_STATE_CHANGED = "game_state_changed";   // full snapshot
+    constexpr const char* GAME_DELTA = "game_delta";                   // changes in one version
     constexpr const char* TURN_CHANGED = "turn_changed";
     constexpr const char* PLAYER_JOINED = "player_joined";
     constexpr const char* GAME_STARTED = "game_started";
@@ -150,8 +245,9 @@ namespace GameEvents {
         bool isAI
     );
     
-    // Helper to create game state changed event
-    SSEEvent createGameStateChangedEvent(const std::string& gameStateJson);
+    // Helpers to create game state events, tagged with the game version
+    SSEEvent createGameStateChangedEvent(uint64_t version, std::string gameStateJson);
+    SSEEvent createGameDeltaEvent(uint64_t version, std::string deltaJson);
     
     // Helper to create chat message event
     SSEEvent createChatMessageEvent(
@@ -190,6 +286,11 @@ namespace GameEvents {
         int player2Id,
         const std::string& player2Name
     );
+
+    // Chat and trade events for an applied action. Board, dice and turn
+    // actions have none of their own; their changes reach clients as game
+    // deltas. Call with the game lock held.
+    void broadcastActionEvents(const Game& game, const Action& action, const ActionResult& result);
 }
 
 // Global SSE manager instance
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+#include <array>
+#include <functional>
+#include <cstddef>
+
+namespace catan {
+
+// ============================================================================
+// STRIPED MAP
+// String-keyed hash map split into independently locked stripes. A key's
+// stripe is picked by its hash, so lookups on different keys rarely touch
+// the same lock, and lookups on the same key share it as readers. Only
+// inserts and erases take a stripe exclusively.
+// ============================================================================
+
+template <typename Value, size_t StripeCount = 16>
+class StripedMap {
+    static_assert((StripeCount & (StripeCount - 1)) == 0, "StripeCount must be a power of two");
+
+    // One cache line per stripe so neighbouring locks don't false-share
+    struct alignas(64) Stripe {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Value> map;
+    };
+
+    std::array<Stripe, StripeCount> stripes;
+
+    Stripe& stripeFor(const std::string& key) {
+        return stripes[std::hash<std::string>{}(key) & (StripeCount - 1)];
+    }
+    const Stripe& stripeFor(const std::string& key) const {
+        return stripes[std::hash<std::string>{}(key) & (StripeCount - 1)];
+    }
+
+public:
+    // Insert if absent; returns false (and leaves value untouched) if the
+    // key already exists
+    bool insert(const std::string& key, Value&& value) {
+        Stripe& stripe = stripeFor(key);
+        std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+        return stripe.map.try_emplace(key, std::move(value)).second;
+    }
+
+    // Insert or replace
+    void assign(const std::string& key, Value value) {
+        Stripe& stripe = stripeFor(key);
+        std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+        stripe.map[key] = std::move(value);
+    }
+
+    // Calls visitor(const Value&) under the stripe's shared lock if the key
+    // exists. Returns whether it did.
+    template <typename Visitor>
+    bool visit(const std::string& key, Visitor&& visitor) const {
+        const Stripe& stripe = stripeFor(key);
+        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+        auto it = stripe.map.find(key);
+        if (it == stripe.map.end()) return false;
+        visitor(it->second);
+        return true;
+    }
+
+    bool erase(const std::string& key) {
+        Stripe& stripe = stripeFor(key);
+        std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+        return stripe.map.erase(key) > 0;
+    }
+
+    // Visits every entry, one stripe at a time under its shared lock. Not a
+    // consistent snapshot across stripes.
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const {
+        for (const Stripe& stripe : stripes) {
+            std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+            for (const auto& pair : stripe.map) {
+                visitor(pair.first, pair.second);
+            }
+        }
+    }
+
+    // Stripes, for callers that sweep the map a stripe at a time
+    static constexpr size_t stripeCount() { return StripeCount; }
+
+    // Visits the entries of one stripe under its shared lock
+    template <typename Visitor>
+    void forEachInStripe(size_t index, Visitor&& visitor) const {
+        const Stripe& stripe = stripes[index % StripeCount];
+        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+        for (const auto& pair : stripe.map) {
+            visitor(pair.first, pair.second);
+        }
+    }
+
+    // Erases every entry for which predicate(key, value) is true, one
+    // stripe at a time. Returns the number erased.
+    template <typename Predicate>
+    size_t eraseIf(Predicate&& predicate) {
+        size_t erased = 0;
+        for (Stripe& stripe : stripes) {
+            std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+            for (auto it = stripe.map.begin(); it != stripe.map.end();) {
+                if (predicate(it->first, it->second)) {
+                    it = stripe.map.erase(it);
+                    erased++;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return erased;
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const Stripe& stripe : stripes) {
+            std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+            total += stripe.map.size();
+        }
+        return total;
+    }
+};
+
+}  // namespace catan
@@ -0,0 +1,272 @@
+// Randomized differential test of the board queries. Plays random legal
+// placements on random boards and, after every one, checks the bitboard
+// answers (placement masks and lists, the distance rule, road connection,
+// longest road and the longest road title) against plain reference
+// versions that walk the topology's adjacency lists and the board's flat
+// arrays, as the rules engine did before it kept bitboards.
+//
+//   g++ -std=c++17 -O2 -I. -o board_test tests/board_test.cpp catan_game.cpp game_logic.cpp
+//       metrics.cpp random.cpp -lpthread
+//   ./board_test [boards] [seed]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "catan_types.h"
+#include "game_logic.h"
+#include "random.h"
+
+using namespace catan;
+
+namespace {
+
+// ============================================================================
+// REFERENCE IMPLEMENTATION
+// ============================================================================
+
+bool refDistanceValid(const Game& game, VertexId v) {
+    const BoardTopology& topo = boardTopology();
+    if (game.board.building[v] != Building::None) return false;
+    for (VertexId n : topo.vertexNeighbors[v]) {
+        if (n == INVALID_ID) break;
+        if (game.board.building[n] != Building::None) return false;
+    }
+    return true;
+}
+
+bool refTouchesRoad(const Game& game, int playerId, VertexId v) {
+    for (EdgeId e : boardTopology().vertexEdges[v]) {
+        if (e == INVALID_ID) break;
+        if (game.board.roadOwner[e] == playerId) return true;
+    }
+    return false;
+}
+
+bool refRoadConnected(const Game& game, int playerId, EdgeId edge) {
+    for (VertexId v : boardTopology().edgeVertices[edge]) {
+        if (game.board.building[v] != Building::None && game.board.vertexOwner[v] == playerId) return true;
+        if (refTouchesRoad(game, playerId, v)) return true;
+    }
+    return false;
+}
+
+std::vector<VertexId> refSetupSettlements(const Game& game) {
+    std::vector<VertexId> valid;
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        if (refDistanceValid(game, v)) valid.push_back(v);
+    }
+    return valid;
+}
+
+std::vector<VertexId> refSettlements(const Game& game, int playerId) {
+    std::vector<VertexId> valid;
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        if (refDistanceValid(game, v) && refTouchesRoad(game, playerId, v)) valid.push_back(v);
+    }
+    return valid;
+}
+
+std::vector<EdgeId> refRoads(const Game& game, int playerId) {
+    std::vector<EdgeId> valid;
+    for (EdgeId e = 0; e < NUM_EDGES; e++) {
+        if (game.board.roadOwner[e] < 0 && refRoadConnected(game, playerId, e)) valid.push_back(e);
+    }
+    return valid;
+}
+
+std::vector<VertexId> refCities(const Game& game, int playerId) {
+    std::vector<VertexId> valid;
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        if (game.board.building[v] == Building::Settlement && game.board.vertexOwner[v] == playerId) {
+            valid.push_back(v);
+        }
+    }
+    return valid;
+}
+
+// Longest trail leaving vertex over unused roads. A road may end at an
+// opponent's building but not pass through one.
+int refTrailFrom(const Game& game, int playerId, VertexId vertex, std::vector<bool>& used, bool start) {
+    const BoardTopology& topo = boardTopology();
+    if (!start && game.board.building[vertex] != Building::None &&
+        game.board.vertexOwner[vertex] != playerId) {
+        return 0;
+    }
+    int longest = 0;
+    for (EdgeId e : topo.vertexEdges[vertex]) {
+        if (e == INVALID_ID) break;
+        if (game.board.roadOwner[e] != playerId || used[e]) continue;
+        VertexId other = topo.edgeVertices[e][0] == vertex ? topo.edgeVertices[e][1] : topo.edgeVertices[e][0];
+        used[e] = true;
+        longest = std::max(longest, 1 + refTrailFrom(game, playerId, other, used, false));
+        used[e] = false;
+    }
+    return longest;
+}
+
+int refLongestRoad(const Game& game, int playerId) {
+    int longest = 0;
+    std::vector<bool> used(NUM_EDGES, false);
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        longest = std::max(longest, refTrailFrom(game, playerId, v, used, true));
+    }
+    return longest;
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+int failures = 0;
+
+void fail(const std::string& what, uint64_t seed, int step) {
+    if (failures < 20) {
+        std::cerr << "FAIL seed " << seed << " step " << step << ": " << what << std::endl;
+    }
+    failures++;
+}
+
+template <typename T>
+bool sameSet(std::vector<T> a, std::vector<T> b) {
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+void checkBoard(const Game& game, uint64_t seed, int step) {
+    if (!sameSet(getValidSetupSettlementLocations(game), refSetupSettlements(game))) {
+        fail("setup settlement locations", seed, step);
+    }
+    for (VertexId v = 0; v < NUM_VERTICES; v++) {
+        if (isVertexDistanceValid(game, v) != refDistanceValid(game, v)) {
+            fail("distance rule at vertex " + std::to_string(v), seed, step);
+        }
+    }
+
+    int bestLength = 0;
+    for (const Player& player : game.players) {
+        const int p = player.id;
+        if (!sameSet(getValidSettlementLocations(game, p), refSettlements(game, p))) {
+            fail("settlement locations for player " + std::to_string(p), seed, step);
+        }
+        if (!sameSet(getValidRoadLocations(game, p), refRoads(game, p))) {
+            fail("road locations for player " + std::to_string(p), seed, step);
+        }
+        if (!sameSet(getValidCityLocations(game, p), refCities(game, p))) {
+            fail("city locations for player " + std::to_string(p), seed, step);
+        }
+        for (EdgeId e = 0; e < NUM_EDGES; e++) {
+            if (isRoadConnectedToNetwork(game, p, e) != refRoadConnected(game, p, e)) {
+                fail("road connection of edge " + std::to_string(e), seed, step);
+            }
+        }
+        int expected = refLongestRoad(game, p);
+        int actual = calculateLongestRoad(game, p);
+        if (actual != expected) {
+            fail("longest road for player " + std::to_string(p) + ": " + std::to_string(actual) +
+                 " instead of " + std::to_string(expected), seed, step);
+        }
+        bestLength = std::max(bestLength, expected);
+        if (player.hasLongestRoad != (game.longestRoadPlayerId == p)) {
+            fail("longest road flag for player " + std::to_string(p), seed, step);
+        }
+    }
+
+    // Whoever holds the title has a longest road of at least 5
+    int holder = game.longestRoadPlayerId;
+    if (holder >= 0 && (refLongestRoad(game, holder) != bestLength || bestLength < 5)) {
+        fail("longest road title held by player " + std::to_string(holder) + " at " +
+             std::to_string(refLongestRoad(game, holder)) + " (longest " + std::to_string(bestLength) + ")",
+             seed, step);
+    }
+    if (holder < 0 && bestLength >= 5) {
+        int atBest = 0;
+        for (const Player& player : game.players) {
+            if (refLongestRoad(game, player.id) == bestLength) atBest++;
+        }
+        if (atBest == 1) fail("unique longest road of " + std::to_string(bestLength) + " unclaimed", seed, step);
+    }
+}
+
+// ============================================================================
+// RANDOM PLAY
+// ============================================================================
+
+template <typename T>
+T pick(GameRng& rng, const std::vector<T>& items) {
+    return items[rng.uniform(items.size())];
+}
+
+void playBoard(uint64_t seed) {
+    Game game;
+    seedGame(game, seed);
+    GameRng rng(seed ^ 0x5DEECE66Dull);
+    const int players = 2 + static_cast<int>(rng.uniform(3));
+    for (int p = 0; p < players; p++) {
+        Player player;
+        player.id = p;
+        player.name = "p" + std::to_string(p);
+        game.addPlayer(player);
+    }
+    checkBoard(game, seed, 0);
+
+    // Two unconnected settlements and a road each, as in setup
+    int step = 1;
+    for (int round = 0; round < 2; round++) {
+        for (int p = 0; p < players; p++, step++) {
+            auto spots = refSetupSettlements(game);
+            if (spots.empty()) break;
+            VertexId v = pick(rng, spots);
+            game.board.placeSettlement(v, p);
+            std::vector<EdgeId> edges;
+            for (EdgeId e : boardTopology().vertexEdges[v]) {
+                if (e != INVALID_ID && game.board.roadOwner[e] < 0) edges.push_back(e);
+            }
+            if (!edges.empty()) game.board.placeRoad(pick(rng, edges), p);
+            updateLongestRoad(game);
+            checkBoard(game, seed, step);
+        }
+    }
+
+    // Then mostly roads, so networks grow long, branch and get cut
+    for (int moves = 0; moves < 60; moves++, step++) {
+        int p = static_cast<int>(rng.uniform(players));
+        uint64_t kind = rng.uniform(10);
+        if (kind < 7) {
+            auto roads = refRoads(game, p);
+            if (roads.empty()) continue;
+            game.board.placeRoad(pick(rng, roads), p);
+        } else if (kind < 9) {
+            auto spots = refSettlements(game, p);
+            if (spots.empty()) continue;
+            game.board.placeSettlement(pick(rng, spots), p);
+        } else {
+            auto cities = refCities(game, p);
+            if (cities.empty()) continue;
+            game.board.upgradeToCity(pick(rng, cities));
+        }
+        updateLongestRoad(game);
+        checkBoard(game, seed, step);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t boards = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    for (uint64_t i = 0; i < boards; i++) {
+        playBoard(seed + i);
+    }
+
+    if (failures) {
+        std::cerr << failures << " mismatch(es) over " << boards << " boards" << std::endl;
+        return 1;
+    }
+    std::cout << "board test: " << boards << " boards, no mismatches" << std::endl;
+    return 0;
+}
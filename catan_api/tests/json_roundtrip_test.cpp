@@ -0,0 +1,90 @@
+// JSON round-trip check. Player names and chat text arrive through the JSON
+// reader, which decodes \" and \\, so they can hold raw quotes and
+// backslashes. Every writer that emits them must escape them again: each
+// document below is built from such strings, parsed back and compared.
+//
+//   g++ -std=c++17 -O1 -I. -o json_roundtrip_test tests/json_roundtrip_test.cpp sse_handler.cpp
+//       spectators.cpp game_actions.cpp catan_game.cpp game_logic.cpp game_delta.cpp
+//       json_writer.cpp json_reader.cpp metrics.cpp random.cpp -lpthread -lz
+//   ./json_roundtrip_test
+
+#include <iostream>
+#include <string>
+
+#include "catan_types.h"
+#include "game_delta.h"
+#include "json_reader.h"
+#include "json_writer.h"
+#include "sse_handler.h"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAIL " << what << std::endl;
+        failures++;
+    }
+}
+
+// Parses json and checks that field (a path of keys) reads back as expected
+void expectField(const std::string& what, const std::string& json,
+                 std::initializer_list<const char*> path, const std::string& expected) {
+    std::string error;
+    catan::JsonValue root = catan::JsonValue::parse(json, &error);
+    if (root.isNull()) {
+        check(false, what + ": does not parse (" + error + "): " + json);
+        return;
+    }
+    const catan::JsonValue* node = &root;
+    for (const char* key : path) node = &(*node)[key];
+    check(node->asString() == expected, what + ": read back \"" + node->asString() + "\"");
+}
+
+}  // namespace
+
+int main() {
+    const std::string name = "A\"l\\ice";
+    const std::string text = "say \"hi\" \\ then\nleave";
+
+    // The request body a client sends, decoded the way a handler sees it
+    catan::JsonWriter body;
+    body.beginObject().key("name").value(name).endObject();
+    expectField("request body", body.take(), {"name"}, name);
+
+    expectField("escapeJson", "{\"v\":\"" + catan::escapeJson(name) + "\"}", {"v"}, name);
+
+    namespace ev = catan::GameEvents;
+    expectField("chat name", ev::createChatMessageEvent("1", 0, name, -1, text, "normal").data,
+                {"fromPlayerName"}, name);
+    expectField("chat content", ev::createChatMessageEvent("1", 0, name, -1, text, "normal").data,
+                {"content"}, text);
+    expectField("ai action name", ev::createAIActionEvent(0, name, "end_turn", text, true).data,
+                {"playerName"}, name);
+    expectField("ai action description", ev::createAIActionEvent(0, name, "end_turn", text, true).data,
+                {"description"}, text);
+    expectField("turn changed", ev::createTurnChangedEvent(0, name, false).data, {"playerName"}, name);
+    expectField("trade proposed", ev::createTradeProposedEvent(1, 0, name, -1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, text).data,
+                {"fromPlayerName"}, name);
+    expectField("trade response", ev::createTradeResponseEvent(ev::TRADE_ACCEPTED, 1, 0, name).data,
+                {"responderName"}, name);
+    expectField("trade executed", ev::createTradeExecutedEvent(1, 0, name, 1, name).data,
+                {"player2Name"}, name);
+
+    catan::Game game;
+    catan::seedGame(game, 1);
+    catan::Player player;
+    player.id = 0;
+    player.name = name;
+    game.addPlayer(player);
+    catan::JsonValue state = catan::JsonValue::parse(catan::gameStateJson(game, 0));
+    check(state["players"][size_t(0)].getString("name") == name, "game state name");
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "json round-trip: all checks passed" << std::endl;
+    return 0;
+}
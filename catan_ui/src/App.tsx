@@ -1,7 +1,7 @@
 import { useState, useCallback, useEffect, useRef } from 'react';
 import { api, type LLMConfig } from './api';
-import { useGameEvents, type ChatMessageEvent, type TradeProposedEvent, type TradeExecutedEvent, type TradeResponseEvent } from './useGameEvents';
-import type { GameState, ResourceHand, PlayerType, ChatMessage, TradeOffer, Player } from './types';
+import { useGameEvents, applyGameDelta, type ChatMessageEvent, type TradeProposedEvent, type TradeExecutedEvent, type TradeResponseEvent } from './useGameEvents';
+import type { GameState, GameStateDelta, ResourceHand, PlayerType, ChatMessage, TradeOffer, Player } from './types';
 import { HexBoard } from './HexBoard';
 import './App.css';
 
@@ -56,7 +56,7 @@ function LLMConfigPanel({ config, onConfigChange }: LLMConfigPanelProps) {
           ))}
         </select>
       </div>
-      {provider !== 'mock' && (
+      {provider !== 'mock' && provider !== 'heuristic' && (
         <>
           <div className="config-row">
             <label>API Key:</label>
@@ -631,9 +631,11 @@ interface GameBoardProps {
   gameState: GameState;
   players: Player[];
   onGameUpdate: () => void;
+  onGameDelta: (delta: GameStateDelta) => void;
+  onGameSnapshot: (state: GameState) => void;
 }
 
-function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps) {
+function GameBoard({ gameId, gameState, players, onGameUpdate, onGameDelta, onGameSnapshot }: GameBoardProps) {
   const [actionLog, setActionLog] = useState<string[]>([]);
   const [aiThinking, setAIThinking] = useState<{ playerId: number; playerName: string } | null>(null);
   const [error, setError] = useState<string | null>(null);
@@ -677,8 +679,16 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
     loadInitialData();
   }, [gameId, refreshTrades]);
 
-  // Use SSE for real-time updates
+  // Use SSE for real-time updates; game state arrives as versioned deltas
   const { isConnected } = useGameEvents(gameId, {
+    token: api.getAuthToken(),
+    sinceVersion: gameState.version,
+    onGameDelta: (delta) => {
+      onGameDelta(delta);
+      const tradeIds = delta.activeTradeIds;
+      if (tradeIds) setActiveTrades(prev => prev.filter(t => tradeIds.includes(t.id)));
+    },
+    onGameStateChanged: onGameSnapshot,
     onConnected: () => addToLog('📡 Connected to game events'),
     onDisconnected: () => addToLog('📡 Disconnected from game events'),
     onAIThinking: (event) => {
@@ -689,7 +699,6 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
     onAITurnComplete: () => {
       setAIThinking(null);
       addToLog('✅ AI turns completed');
-      onGameUpdate();
     },
     onAIError: (errorMsg) => {
       setAIThinking(null);
@@ -698,7 +707,6 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
     },
     onTurnChanged: (event) => {
       addToLog(`🔄 Turn changed to ${event.playerName}`);
-      onGameUpdate();
     },
     onChatMessage: (event: ChatMessageEvent) => {
       handleNewChatMessage({
@@ -728,7 +736,6 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
     onTradeExecuted: (event: TradeExecutedEvent) => {
       setActiveTrades(prev => prev.filter(t => t.id !== event.tradeId));
       addToLog(`🤝 Trade completed between ${event.player1Name} and ${event.player2Name}`);
-      onGameUpdate();
     },
     onTradeCancelled: (tradeId: number) => {
       setActiveTrades(prev => prev.filter(t => t.id !== tradeId));
@@ -736,6 +743,11 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
     },
   });
 
+  // Deltas keep the state current while the stream is up; refetch only without it
+  const syncGameState = () => {
+    if (!isConnected) onGameUpdate();
+  };
+
   // Load LLM provider info
   useEffect(() => {
     api.getLLMConfig().then(config => setLLMProvider(config.provider)).catch(console.error);
@@ -756,7 +768,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
       const result = await api.rollDice(gameId);
       addToLog(`🎲 You rolled ${result.total} (${result.die1} + ${result.die2})`);
       if (result.robber) addToLog('⚠️ Rolled a 7! Move the robber.');
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -768,7 +780,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
       addToLog(`⏭️ You ended your turn. Next: ${result.nextPlayerName}`);
       setBuildMode('none');
       if (result.nextPlayerIsAI) addToLog('🤖 AI players are taking their turns...');
-      else onGameUpdate();
+      else syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -778,7 +790,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
     try {
       const result = await api.buyDevCard(gameId);
       addToLog(`🃏 Bought a ${result.card} card!`);
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -788,7 +800,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
     try {
       const result = await api.bankTrade(gameId, give, receive);
       addToLog(`💱 Traded ${result.traded.gaveAmount} ${give} for 1 ${receive}`);
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -801,7 +813,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
       addToLog(`🏠 Placed settlement - now place a road`);
       setSetupNeedsRoad(true);
       setBuildMode('road');
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -814,7 +826,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
       setSetupNeedsRoad(false);
       setBuildMode('none');
       if (result.setupComplete) addToLog('🎉 Setup complete! Game starting...');
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -826,7 +838,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
       await api.buySettlement(gameId, hexQ, hexR, direction);
       addToLog(`🏠 Built settlement`);
       setBuildMode('none');
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -837,7 +849,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
       await api.buyRoad(gameId, hexQ, hexR, direction);
       addToLog(`🛤️ Built road`);
       setBuildMode('none');
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -848,7 +860,7 @@ function GameBoard({ gameId, gameState, players, onGameUpdate }: GameBoardProps)
       await api.buyCity(gameId, hexQ, hexR, direction);
       addToLog(`🏰 Built city`);
       setBuildMode('none');
-      onGameUpdate();
+      syncGameState();
     } catch (err) {
       setError(`${err}`);
     }
@@ -1159,6 +1171,10 @@ function App() {
     }
   };
 
+  const handleGameDelta = (delta: GameStateDelta) => {
+    setGameState(prev => (prev ? applyGameDelta(prev, delta) : prev));
+  };
+
   return (
     <div className="app">
       {!gameId || !gameState ? (
@@ -1169,6 +1185,8 @@ function App() {
           gameState={gameState}
           players={players}
           onGameUpdate={handleGameUpdate}
+          onGameDelta={handleGameDelta}
+          onGameSnapshot={setGameState}
         />
       )}
     </div>
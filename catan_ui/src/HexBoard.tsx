@@ -399,22 +399,34 @@ export function HexBoard({
   
   const viewBox = `${minX - 40} ${minY - 40} ${maxX - minX + 80} ${maxY - minY + 80}`;
   
-  // Generate all possible vertex positions for clickable areas
+  // Generate all possible vertex positions for clickable areas. Corners shared
+  // by neighboring hexes are kept once, using the first spelling in hex order
+  // (the same canonical spelling the server reports).
   const allVertexPositions = useMemo(() => {
     const positions: { hexQ: number; hexR: number; direction: number }[] = [];
+    const seen = new Set<string>();
     hexes.forEach(hex => {
       for (let d = 0; d < 6; d++) {
+        const p = getVertexPosition(hex.q, hex.r, d);
+        const key = `${Math.round(p.x)},${Math.round(p.y)}`;
+        if (seen.has(key)) continue;
+        seen.add(key);
         positions.push({ hexQ: hex.q, hexR: hex.r, direction: d });
       }
     });
     return positions;
   }, [hexes]);
   
-  // Generate all possible edge positions
+  // Generate all possible edge positions (shared sides kept once)
   const allEdgePositions = useMemo(() => {
     const positions: { hexQ: number; hexR: number; direction: number }[] = [];
+    const seen = new Set<string>();
     hexes.forEach(hex => {
       for (let d = 0; d < 6; d++) {
+        const p = getEdgePosition(hex.q, hex.r, d);
+        const key = `${Math.round(p.x)},${Math.round(p.y)}`;
+        if (seen.has(key)) continue;
+        seen.add(key);
         positions.push({ hexQ: hex.q, hexR: hex.r, direction: d });
       }
     });
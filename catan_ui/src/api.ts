@@ -237,8 +237,9 @@ class CatanAPI {
     return this.request('POST', `/games/${gameId}/chat`, { toPlayerId, message });
   }
 
-  async getChatHistory(gameId: string): Promise<ChatHistoryResponse> {
-    return this.request('GET', `/games/${gameId}/chat`);
+  async getChatHistory(gameId: string, since?: number): Promise<ChatHistoryResponse> {
+    const query = since !== undefined ? `?since=${since}` : '';
+    return this.request('GET', `/games/${gameId}/chat${query}`);
   }
 
   // ============================================================================
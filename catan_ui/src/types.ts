@@ -81,6 +81,7 @@ export interface LastRoll {
 
 export interface GameState {
   gameId: string;
+  version?: number;  // bumped on every visible change; SSE deltas resume from it
   phase: GamePhase;
   currentPlayer: number;
   playerCount: number;
@@ -104,6 +105,31 @@ export interface GameState {
   validCityLocations?: BoardLocation[];
 }
 
+// Changes in one game version, pushed over SSE. Keys mirror GameState:
+// scalars replace, players/vertices/edges are upserts, location lists replace.
+export interface GameStateDelta {
+  version: number;
+  phase?: GamePhase;
+  currentPlayer?: number;
+  playerCount?: number;
+  setupRound?: number;
+  resources?: ResourceHand;
+  devCards?: DevCardType[];
+  settlementsRemaining?: number;
+  citiesRemaining?: number;
+  roadsRemaining?: number;
+  lastRoll?: LastRoll | null;
+  players?: Player[];
+  vertices?: VertexInfo[];
+  edges?: EdgeInfo[];
+  robberLocation?: { q: number; r: number };
+  activeTradeIds?: number[];
+  winner?: number;
+  validSettlementLocations?: BoardLocation[];
+  validRoadLocations?: BoardLocation[];
+  validCityLocations?: BoardLocation[];
+}
+
 // ============================================================================
 // AI STATE TYPES
 // ============================================================================
@@ -248,6 +274,8 @@ export interface TradeOffer {
 
 export interface ChatHistoryResponse {
   messages: ChatMessage[];
+  nextSince: number;   // pass as ?since= to fetch only newer messages
+  hasMore: boolean;
 }
 
 export interface ActiveTradesResponse {
@@ -1,4 +1,5 @@
 import { useEffect, useRef, useState } from 'react';
+import type { GameState, GameStateDelta } from './types';
 
 // ============================================================================
 // SSE EVENT TYPES
@@ -23,10 +24,8 @@ export interface TurnChangedEvent {
   isAI: boolean;
 }
 
-export interface GameStateChangedEvent {
-  // Full game state JSON
-  [key: string]: unknown;
-}
+// Full snapshot, sent when a resuming client is older than the change log
+export type GameStateChangedEvent = GameState;
 
 export interface ChatMessageEvent {
   messageId: string;
@@ -80,6 +79,7 @@ export type GameEventType =
   | 'ai_turn_complete'
   | 'ai_error'
   | 'game_state_changed'
+  | 'game_delta'
   | 'turn_changed'
   | 'player_joined'
   | 'game_started'
@@ -104,6 +104,7 @@ export interface UseGameEventsOptions {
   onAIError?: (error: string) => void;
   onTurnChanged?: (event: TurnChangedEvent) => void;
   onGameStateChanged?: (state: GameStateChangedEvent) => void;
+  onGameDelta?: (delta: GameStateDelta) => void;
   onConnected?: () => void;
   onDisconnected?: () => void;
   onError?: (error: Event) => void;
@@ -115,6 +116,68 @@ export interface UseGameEventsOptions {
   onTradeCountered?: (event: TradeResponseEvent) => void;
   onTradeExecuted?: (event: TradeExecutedEvent) => void;
   onTradeCancelled?: (tradeId: number) => void;
+  // Session token, so deltas include this player's private state
+  token?: string | null;
+  // Version of the state the caller already has; missed deltas are replayed
+  sinceVersion?: number;
+}
+
+// ============================================================================
+// DELTA APPLICATION
+// ============================================================================
+
+function sameLocation(a: { hexQ: number; hexR: number; direction: number },
+                      b: { hexQ: number; hexR: number; direction: number }) {
+  return a.hexQ === b.hexQ && a.hexR === b.hexR && a.direction === b.direction;
+}
+
+function upsert<T>(items: T[], updates: T[], same: (a: T, b: T) => boolean): T[] {
+  const result = [...items];
+  for (const update of updates) {
+    const index = result.findIndex(item => same(item, update));
+    if (index >= 0) result[index] = update;
+    else result.push(update);
+  }
+  return result;
+}
+
+// Apply a delta to a snapshot. Deltas not newer than the state are ignored,
+// so a refetch racing the event stream is harmless.
+export function applyGameDelta(state: GameState, delta: GameStateDelta): GameState {
+  if (state.version !== undefined && delta.version <= state.version) return state;
+
+  const next: GameState = { ...state, version: delta.version };
+  if (delta.phase !== undefined) next.phase = delta.phase;
+  if (delta.currentPlayer !== undefined) next.currentPlayer = delta.currentPlayer;
+  if (delta.playerCount !== undefined) next.playerCount = delta.playerCount;
+  if (delta.setupRound !== undefined) next.setupRound = delta.setupRound;
+  if (delta.resources !== undefined) next.resources = delta.resources;
+  if (delta.devCards !== undefined) next.devCards = delta.devCards;
+  if (delta.settlementsRemaining !== undefined) next.settlementsRemaining = delta.settlementsRemaining;
+  if (delta.citiesRemaining !== undefined) next.citiesRemaining = delta.citiesRemaining;
+  if (delta.roadsRemaining !== undefined) next.roadsRemaining = delta.roadsRemaining;
+  if (delta.lastRoll !== undefined) next.lastRoll = delta.lastRoll ?? undefined;
+  if (delta.winner !== undefined) next.winner = delta.winner;
+  if (delta.validSettlementLocations !== undefined) next.validSettlementLocations = delta.validSettlementLocations;
+  if (delta.validRoadLocations !== undefined) next.validRoadLocations = delta.validRoadLocations;
+  if (delta.validCityLocations !== undefined) next.validCityLocations = delta.validCityLocations;
+
+  if (delta.players) {
+    next.players = upsert(state.players ?? [], delta.players, (a, b) => a.id === b.id);
+  }
+  if (delta.vertices) {
+    next.vertices = upsert(state.vertices ?? [], delta.vertices, sameLocation)
+      .filter(v => v.building !== 'none');
+  }
+  if (delta.edges) {
+    next.edges = upsert(state.edges ?? [], delta.edges, sameLocation);
+  }
+  const robber = delta.robberLocation;
+  if (robber) {
+    next.robberLocation = robber;
+    next.hexes = state.hexes?.map(h => ({ ...h, hasRobber: h.q === robber.q && h.r === robber.r }));
+  }
+  return next;
 }
 
 // ============================================================================
@@ -129,6 +192,8 @@ export function useGameEvents(
   const reconnectTimeoutRef = useRef<ReturnType<typeof setTimeout> | null>(null);
   const [isConnected, setIsConnected] = useState(false);
   const [lastEventId, setLastEventId] = useState<string | null>(null);
+  // Newest game version received on this hook's stream
+  const versionRef = useRef<number | undefined>(undefined);
 
   // Store options in a ref to avoid stale closures
   const optionsRef = useRef(options);
@@ -142,8 +207,15 @@ export function useGameEvents(
       return;
     }
 
-    // Create the EventSource connection
-    const url = `http://localhost:8080/games/${gameId}/events`;
+    // Create the EventSource connection, resuming from the newest version we
+    // know of. The browser sends Last-Event-ID on its own reconnects.
+    const params = new URLSearchParams();
+    const { token, sinceVersion } = optionsRef.current;
+    const since = versionRef.current ?? sinceVersion;
+    if (token) params.set('token', token);
+    if (since !== undefined) params.set('since', String(since));
+    const query = params.toString();
+    const url = `http://localhost:8080/games/${gameId}/events${query ? `?${query}` : ''}`;
     const eventSource = new EventSource(url);
     eventSourceRef.current = eventSource;
 
@@ -227,12 +299,24 @@ export function useGameEvents(
       try {
         const data = JSON.parse(event.data) as GameStateChangedEvent;
         setLastEventId(event.lastEventId);
+        versionRef.current = data.version;
         optionsRef.current.onGameStateChanged?.(data);
       } catch {
         console.error('Failed to parse game_state_changed event');
       }
     });
 
+    eventSource.addEventListener('game_delta', (event: MessageEvent) => {
+      try {
+        const data = JSON.parse(event.data) as GameStateDelta;
+        setLastEventId(event.lastEventId);
+        versionRef.current = data.version;
+        optionsRef.current.onGameDelta?.(data);
+      } catch {
+        console.error('Failed to parse game_delta event');
+      }
+    });
+
     // Chat and trade events
     eventSource.addEventListener('chat_message', (event: MessageEvent) => {
       try {
@@ -312,6 +396,7 @@ export function useGameEvents(
       }
       eventSource.close();
       eventSourceRef.current = null;
+      versionRef.current = undefined;
       setIsConnected(false);
     };
   }, [gameId]);